@@ -0,0 +1,421 @@
+/**
+ * *sturdins-bench.cpp*
+ *
+ * =======  ========================================================================================
+ * @file    bench/sturdins-bench.cpp
+ * @brief   Google Benchmark suite for the navigation filters and least squares solvers.
+ * @date    January 2025
+ * @author  Daniel Sturdivant <sturdivant20@gmail.com>
+ * =======  ========================================================================================
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <Eigen/Dense>
+#include <atomic>
+#include <complex>
+#include <cstdlib>
+#include <navtools/constants.hpp>
+#include <navtools/frames.hpp>
+#include <string>
+#include <vector>
+
+#include "sturdins/inertial-nav.hpp"
+#include "sturdins/kinematic-nav.hpp"
+#include "sturdins/least-squares.hpp"
+#include "sturdins/strapdown.hpp"
+#include "sturdins/sv-state-cache.hpp"
+#include "test_common.hpp"
+
+#ifndef STURDINS_TEST_DATA_DIR
+#define STURDINS_TEST_DATA_DIR "src/sturdins/tests/"
+#endif
+
+/**
+ * @brief Heap allocation counter. On glibc every malloc family call is routed through the counting
+ *        wrappers below (Eigen allocates with malloc, operator new ends up in malloc as well), on
+ *        other platforms the allocs_per_epoch counters read zero
+ */
+static std::atomic<long> g_allocs{0};
+
+#if defined(__GLIBC__)
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+void *malloc(size_t size) {
+  g_allocs.fetch_add(1, std::memory_order_relaxed);
+  return __libc_malloc(size);
+}
+void *calloc(size_t n, size_t size) {
+  g_allocs.fetch_add(1, std::memory_order_relaxed);
+  return __libc_calloc(n, size);
+}
+void *realloc(void *ptr, size_t size) {
+  g_allocs.fetch_add(1, std::memory_order_relaxed);
+  return __libc_realloc(ptr, size);
+}
+void free(void *ptr) {
+  __libc_free(ptr);
+}
+}
+#endif
+
+// Auburn, AL
+static const Eigen::Vector3d LLA{
+    navtools::DEG2RAD<> * 32.586279, navtools::DEG2RAD<> * -85.494372, 190.0};
+static const double LAMBDA = navtools::LIGHT_SPEED<> / 1575.42e6 / navtools::TWO_PI<>;
+static const Eigen::Matrix3Xd ANT_XYZ{
+    {0.0, 0.09514, 0.0, 0.09514}, {0.0, 0.0, -0.09514, -0.09514}, {0.0, 0.0, 0.0, 0.0}};
+
+/**
+ * @brief Synthetic (noise free) GNSS epoch with N satellites spread in azimuth and elevation about
+ *        a static user at LLA
+ */
+struct SyntheticEpoch {
+  Eigen::Matrix3Xd sv_pos, sv_vel, u_ned, u_body;
+  Eigen::VectorXd psr, psrdot, psr_var, psrdot_var, u_body_var;
+  Eigen::MatrixXd phase, phase_var;
+  Eigen::MatrixXcd prompt;
+
+  SyntheticEpoch(const int N)
+      : sv_pos(3, N),
+        sv_vel(3, N),
+        u_ned(3, N),
+        u_body(3, N),
+        psr(N),
+        psrdot(N),
+        psr_var{30.0 * Eigen::VectorXd::Ones(N)},
+        psrdot_var{0.01 * Eigen::VectorXd::Ones(N)},
+        u_body_var{Eigen::VectorXd::Ones(N)},
+        phase{Eigen::MatrixXd::Zero(4, N)},
+        phase_var{0.01 * Eigen::MatrixXd::Ones(4, N)},
+        prompt(4, N) {
+    Eigen::Vector3d ecef_p, ecef_u;
+    navtools::lla2ecef<double>(ecef_p, LLA);
+    const double A = std::sqrt(2.0 * std::pow(10.0, 4.4) * 0.02);
+    for (int i = 0; i < N; i++) {
+      const double az = navtools::TWO_PI<> * i / N;
+      const double el = navtools::DEG2RAD<> * (15.0 + 60.0 * (i % 4) / 3.0);
+      u_ned.col(i) << std::cos(el) * std::cos(az), std::cos(el) * std::sin(az), -std::sin(el);
+      navtools::ned2ecefv<double>(ecef_u, u_ned.col(i), LLA);
+      sv_pos.col(i) = ecef_p + 2.0e7 * ecef_u;
+      sv_vel.col(i) = 3.0e3 * ecef_u.cross(Eigen::Vector3d::UnitZ()).normalized();
+      psr(i) = 2.0e7;
+      psrdot(i) = -ecef_u.dot(sv_vel.col(i));
+      u_body.col(i) = u_ned.col(i);  // level, north facing body
+      for (int k = 0; k < 4; k++) {
+        double ph = -u_ned.col(i).dot(ANT_XYZ.col(k)) / LAMBDA;
+        phase(k, i) = -ph;
+        prompt(k, i) = A * std::exp(navtools::COMPLEX_I<> * ph);
+      }
+      phase.col(i).array() -= phase(0, i);
+    }
+  }
+};
+
+//! ------------------------------------------------------------------------------------------------
+//! Micro benchmarks
+//! ------------------------------------------------------------------------------------------------
+
+template <typename T>
+static void BM_Mechanize(benchmark::State &state) {
+  sturdins::Strapdown<T> sd(LLA(0), LLA(1), LLA(2), 0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  const Eigen::Vector3<T> wb{1e-3, -2e-3, 5e-3}, fb{0.1, -0.05, -9.8};
+  for (auto _ : state) {
+    sd.Mechanize(wb, fb, 0.01);
+    benchmark::DoNotOptimize(sd.vd_);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Mechanize<double>);
+BENCHMARK(BM_Mechanize<float>);
+
+template <typename T>
+static void BM_InertialNavPropagate(benchmark::State &state) {
+  sturdins::InertialNav<T> ins(LLA(0), LLA(1), LLA(2), 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  ins.SetImuSpec(Ba, Na, Bg, Ng);
+  ins.SetClockSpec(h0, h1, h2);
+  const Eigen::Vector3<T> wb{1e-3, -2e-3, 5e-3}, fb{0.1, -0.05, -9.8};
+  for (auto _ : state) {
+    ins.Propagate(wb, fb, 0.01);
+    benchmark::DoNotOptimize(ins.P_.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_InertialNavPropagate<double>);
+BENCHMARK(BM_InertialNavPropagate<float>);
+
+static void BM_KinematicNavGnssUpdate(benchmark::State &state) {
+  const SyntheticEpoch ep(state.range(0));
+  sturdins::KinematicNav<> kns(LLA(0), LLA(1), LLA(2), 0.0, 0.0, 0.0, 0.0, 0.0);
+  kns.SetClockSpec(h0, h1, h2);
+  kns.SetProcessNoise(1.0, 0.01);
+  for (auto _ : state) {
+    kns.GnssUpdate(ep.sv_pos, ep.sv_vel, ep.psr, ep.psrdot, ep.psr_var, ep.psrdot_var);
+    benchmark::DoNotOptimize(kns.P_.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_KinematicNavGnssUpdate)->DenseRange(4, 32, 4);
+
+static void BM_KinematicNavPhasedArrayUpdate(benchmark::State &state) {
+  const SyntheticEpoch ep(state.range(0));
+  sturdins::KinematicNav<> kns(LLA(0), LLA(1), LLA(2), 0.0, 0.0, 0.0, 0.0, 0.0);
+  kns.SetClockSpec(h0, h1, h2);
+  kns.SetProcessNoise(1.0, 0.01);
+  for (auto _ : state) {
+    kns.PhasedArrayUpdate(
+        ep.sv_pos,
+        ep.sv_vel,
+        ep.psr,
+        ep.psrdot,
+        ep.phase,
+        ep.psr_var,
+        ep.psrdot_var,
+        ep.phase_var,
+        ANT_XYZ,
+        4,
+        LAMBDA);
+    benchmark::DoNotOptimize(kns.P_.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_KinematicNavPhasedArrayUpdate)->DenseRange(4, 32, 4);
+
+static void BM_GnssPVT(benchmark::State &state) {
+  const SyntheticEpoch ep(state.range(0));
+  Eigen::VectorXd x(8);
+  Eigen::MatrixXd P(8, 8);
+  for (auto _ : state) {
+    x.setZero();
+    P.setZero();
+    sturdins::GnssPVT(x, P, ep.sv_pos, ep.sv_vel, ep.psr, ep.psrdot, ep.psr_var, ep.psrdot_var);
+    benchmark::DoNotOptimize(x.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GnssPVT)->DenseRange(4, 32, 4);
+
+static void BM_GnssPVTRobust(benchmark::State &state) {
+  const SyntheticEpoch ep(state.range(0));
+  sturdins::GnssPVTWorkspace ws;
+  Eigen::VectorXd x(8);
+  Eigen::MatrixXd P(8, 8);
+  for (auto _ : state) {
+    x.setZero();
+    P.setZero();
+    benchmark::DoNotOptimize(
+        ws.SolveRobust(x, P, ep.sv_pos, ep.sv_vel, ep.psr, ep.psrdot, ep.psr_var, ep.psrdot_var));
+    benchmark::DoNotOptimize(x.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GnssPVTRobust)->DenseRange(4, 32, 4);
+
+static void BM_PhasedArrayAttitude(benchmark::State &state) {
+  const SyntheticEpoch ep(state.range(0));
+  Eigen::Matrix3d C_b_l;
+  for (auto _ : state) {
+    C_b_l = Eigen::AngleAxisd(0.1, Eigen::Vector3d::UnitZ()).matrix();
+    sturdins::PhasedArrayAttitude(
+        C_b_l, ep.u_ned, ep.phase, ep.phase_var, ANT_XYZ, 4, LAMBDA, 1e-9);
+    benchmark::DoNotOptimize(C_b_l.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PhasedArrayAttitude)->DenseRange(4, 12, 4);
+
+static void BM_PhasedArrayAttitudeWarm(benchmark::State &state) {
+  const SyntheticEpoch ep(state.range(0));
+  sturdins::PhasedArrayAttitudeSolver solver(1e-9);
+  Eigen::Matrix3d C_b_l = Eigen::AngleAxisd(0.1, Eigen::Vector3d::UnitZ()).matrix();
+  solver.Solve(C_b_l, ep.u_ned, ep.phase, ep.phase_var, ANT_XYZ, 4, LAMBDA);
+  long n_iter = 0;
+  for (auto _ : state) {
+    n_iter += solver.Solve(C_b_l, ep.u_ned, ep.phase, ep.phase_var, ANT_XYZ, 4, LAMBDA, true)
+                  .iterations_;
+    benchmark::DoNotOptimize(C_b_l.data());
+  }
+  state.counters["iterations"] = benchmark::Counter(n_iter, benchmark::Counter::kAvgIterations);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PhasedArrayAttitudeWarm)->DenseRange(4, 12, 4);
+
+static void BM_Wahba(benchmark::State &state) {
+  const SyntheticEpoch ep(state.range(0));
+  Eigen::Matrix3d C_l_b;
+  for (auto _ : state) {
+    sturdins::Wahba(C_l_b, ep.u_body, ep.u_ned, ep.u_body_var);
+    benchmark::DoNotOptimize(C_l_b.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Wahba)->DenseRange(4, 12, 4);
+
+static void BM_MUSIC(benchmark::State &state) {
+  const SyntheticEpoch ep(1);
+  double az, el;
+  for (auto _ : state) {
+    sturdins::MUSIC(az, el, ep.prompt.col(0), ANT_XYZ, 4, LAMBDA, 1e-4, state.range(0));
+    benchmark::DoNotOptimize(az);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MUSIC)->Arg(1)->Arg(0)->Unit(benchmark::kMicrosecond);
+
+// satellite states of a 5 Hz epoch, Kepler solve per satellite (0) or shared SvStateCache (1)
+static void BM_SatelliteStates(benchmark::State &state) {
+  std::vector<satutils::KeplerEphem<double>> eph =
+      ParseEphemeris<double>(std::string(STURDINS_TEST_DATA_DIR) + "sv_ephem.bin");
+  if (eph.empty()) {
+    state.SkipWithError("could not read " STURDINS_TEST_DATA_DIR "sv_ephem.bin");
+    return;
+  }
+  const int N = eph.size();
+  sturdins::SvStateCache cache(eph);
+  Eigen::Matrix3Xd sv_pos(3, N), sv_vel(3, N);
+  Eigen::Vector3d clk, acc;
+  double ToW = 521400;
+  for (auto _ : state) {
+    if (state.range(0)) {
+      cache.Evaluate(ToW, sv_pos, sv_vel);
+    } else {
+      for (int i = 0; i < N; i++) {
+        eph[i].CalcNavStates<false>(clk, sv_pos.col(i), sv_vel.col(i), acc, ToW);
+      }
+    }
+    benchmark::DoNotOptimize(sv_pos.data());
+    ToW += 0.2;
+  }
+  state.SetItemsProcessed(state.iterations() * N);
+}
+BENCHMARK(BM_SatelliteStates)->Arg(0)->Arg(1);
+
+//! ------------------------------------------------------------------------------------------------
+//! Macro benchmarks (replay of truth_data.bin with sv_ephem.bin)
+//! ------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Simulated IMU samples and 5 Hz GNSS epochs of the whole truth trajectory, generated once
+ *        so that only the filters are timed
+ */
+struct ReplayData {
+  std::vector<NavData<double>> truth;
+  std::vector<Eigen::Vector3d> wb, fb;
+  std::vector<MeasurementData> meas;  // one per GNSS epoch (every 20th IMU sample)
+  Eigen::VectorXd psr_var, psrdot_var;
+  bool ok = false;
+
+  ReplayData() {
+    std::vector<satutils::KeplerEphem<double>> eph =
+        ParseEphemeris<double>(std::string(STURDINS_TEST_DATA_DIR) + "sv_ephem.bin");
+    std::ifstream fin(std::string(STURDINS_TEST_DATA_DIR) + "truth_data.bin", std::ios::binary);
+    if (!fin || eph.empty()) {
+      return;
+    }
+    psr_var = 30.0 * Eigen::VectorXd::Ones(eph.size());
+    psrdot_var = 0.01 * Eigen::VectorXd::Ones(eph.size());
+    NavData<double> rec;
+    Eigen::Vector3d lla, ned_v, ecef_p, ecef_v, w, f;
+    Eigen::Vector3d drift_a{Eigen::Vector3d::Zero()}, drift_g{Eigen::Vector3d::Zero()};
+    Eigen::Vector2d clk{Eigen::Vector2d::Zero()};
+    double ToW = 521400;
+    for (int i = 0; fin.read(reinterpret_cast<char *>(&rec), sizeof(rec)); i++) {
+      truth.push_back(rec);
+      w << rec.wx, rec.wy, rec.wz;
+      f << rec.fx, rec.fy, rec.fz;
+      ImuModel(w, f, drift_g, drift_a);
+      ClockModel(clk, 0.01);
+      wb.push_back(w);
+      fb.push_back(f);
+      if (i % 20 == 0) {
+        lla << navtools::DEG2RAD<> * rec.lat, navtools::DEG2RAD<> * rec.lon, rec.h;
+        ned_v << rec.vn, rec.ve, rec.vd;
+        navtools::lla2ecef<double>(ecef_p, lla);
+        navtools::ned2ecefv<double>(ecef_v, ned_v, lla);
+        meas.push_back(MeasurementModel(ToW, 5.48, 0.1, ecef_p, ecef_v, clk(0), clk(1), eph));
+      }
+      ToW += 0.01;
+    }
+    ok = !truth.empty();
+  }
+};
+
+static const ReplayData &Replay() {
+  static const ReplayData data;
+  return data;
+}
+
+template <typename T>
+static void BM_ReplayInertialNav(benchmark::State &state) {
+  const ReplayData &data = Replay();
+  if (!data.ok) {
+    state.SkipWithError("could not read " STURDINS_TEST_DATA_DIR "truth_data.bin/sv_ephem.bin");
+    return;
+  }
+  const NavData<double> &t0 = data.truth.front();
+  long allocs = 0, epochs = 0;
+  for (auto _ : state) {
+    sturdins::InertialNav<T> ins;
+    ins.SetPosition(navtools::DEG2RAD<> * t0.lat, navtools::DEG2RAD<> * t0.lon, t0.h);
+    ins.SetVelocity(t0.vn, t0.ve, t0.vd);
+    ins.SetAttitude(
+        navtools::DEG2RAD<> * t0.roll, navtools::DEG2RAD<> * t0.pitch, navtools::DEG2RAD<> * t0.yaw);
+    ins.SetClockSpec(h0, h1, h2);
+    ins.SetImuSpec(Ba, Na, Bg, Ng);
+    const long a0 = g_allocs.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < data.wb.size(); i++) {
+      const Eigen::Vector3<T> w = data.wb[i].cast<T>(), f = data.fb[i].cast<T>();
+      ins.Mechanize(w, f, 0.01);
+      ins.Propagate(w, f, 0.01);
+      if (i % 20 == 0) {
+        const MeasurementData &m = data.meas[i / 20];
+        ins.GnssUpdate(m.sv_pos, m.sv_vel, m.psr, m.psrdot, data.psr_var, data.psrdot_var);
+      }
+    }
+    allocs += g_allocs.load(std::memory_order_relaxed) - a0;
+    epochs += data.wb.size();
+    benchmark::DoNotOptimize(ins.phi_);
+  }
+  state.counters["epochs_per_sec"] = benchmark::Counter(epochs, benchmark::Counter::kIsRate);
+  state.counters["allocs_per_epoch"] = static_cast<double>(allocs) / std::max(epochs, 1L);
+}
+BENCHMARK(BM_ReplayInertialNav<double>)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ReplayInertialNav<float>)->Unit(benchmark::kMillisecond);
+
+template <typename T>
+static void BM_ReplayKinematicNav(benchmark::State &state) {
+  const ReplayData &data = Replay();
+  if (!data.ok) {
+    state.SkipWithError("could not read " STURDINS_TEST_DATA_DIR "truth_data.bin/sv_ephem.bin");
+    return;
+  }
+  const NavData<double> &t0 = data.truth.front();
+  long allocs = 0, epochs = 0;
+  for (auto _ : state) {
+    sturdins::KinematicNav<T> kns;
+    kns.SetPosition(navtools::DEG2RAD<> * t0.lat, navtools::DEG2RAD<> * t0.lon, t0.h);
+    kns.SetVelocity(t0.vn, t0.ve, t0.vd);
+    kns.SetClockSpec(h0, h1, h2);
+    kns.SetProcessNoise(1.0, 0.01);
+    const long a0 = g_allocs.load(std::memory_order_relaxed);
+    for (size_t k = 0; k < data.meas.size(); k++) {
+      const MeasurementData &m = data.meas[k];
+      if (k > 0) {
+        kns.Propagate(0.2);
+      }
+      kns.GnssUpdate(m.sv_pos, m.sv_vel, m.psr, m.psrdot, data.psr_var, data.psrdot_var);
+    }
+    allocs += g_allocs.load(std::memory_order_relaxed) - a0;
+    epochs += data.meas.size();
+    benchmark::DoNotOptimize(kns.phi_);
+  }
+  state.counters["epochs_per_sec"] = benchmark::Counter(epochs, benchmark::Counter::kIsRate);
+  state.counters["allocs_per_epoch"] = static_cast<double>(allocs) / std::max(epochs, 1L);
+}
+BENCHMARK(BM_ReplayKinematicNav<double>)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ReplayKinematicNav<float>)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
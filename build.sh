@@ -28,6 +28,7 @@ build_type='Release'
 c_compiler='clang-18'
 cpp_compiler='clang++-18'
 build_tests='True'
+build_bench='False'
 build_python='True'
 
 case "$OSTYPE" in
@@ -37,6 +38,7 @@ case "$OSTYPE" in
         -DCMAKE_C_COMPILER=$c_compiler \
         -DCMAKE_CXX_COMPILER=$cpp_compiler \
         -DINSTALL_STURDINS_TESTS=$build_tests \
+        -DINSTALL_STURDINS_BENCHMARKS=$build_bench \
         -DINSTALL_PYTHON=$build_python \
         -DCMAKE_INSTALL_PREFIX=../build \
         -DCMAKE_BUILD_TYPE=$build_type \
@@ -48,6 +50,7 @@ case "$OSTYPE" in
         -DCMAKE_C_COMPILER=$c_compiler \
         -DCMAKE_CXX_COMPILER=$cpp_compiler \
         -DINSTALL_STURDINS_TESTS=$build_tests \
+        -DINSTALL_STURDINS_BENCHMARKS=$build_bench \
         -DINSTALL_PYTHON=$build_python \
         -DCMAKE_INSTALL_PREFIX=../build \
         -DCMAKE_BUILD_TYPE=$build_type \
@@ -60,6 +63,7 @@ case "$OSTYPE" in
         -DCMAKE_CXX_COMPILER=C:/MinGW/bin/g++.exe \
         -DCMAKE_C_COMPILER=C:/MinGW/bin/gcc.exe \
         -DINSTALL_STURDINS_TESTS=$build_tests \
+        -DINSTALL_STURDINS_BENCHMARKS=$build_bench \
         -DINSTALL_PYTHON=$build_python \
         -DCMAKE_INSTALL_PREFIX=../build \
         -DCMAKE_BUILD_TYPE=$build_type \
@@ -0,0 +1,100 @@
+/**
+ * *batch-run.hpp*
+ *
+ * =======  ========================================================================================
+ * @file    sturdins/batch-run.hpp
+ * @brief   Run the navigation filters over entire IMU/GNSS logs.
+ * @date    January 2025
+ * @author  Daniel Sturdivant <sturdivant20@gmail.com>
+ * =======  ========================================================================================
+ */
+
+#ifndef STURDINS_BATCH_RUN_HPP
+#define STURDINS_BATCH_RUN_HPP
+
+#include <Eigen/Dense>
+
+#include "sturdins/inertial-nav.hpp"
+#include "sturdins/kinematic-nav.hpp"
+
+namespace sturdins {
+
+/**
+ * @brief Row-major logs, one sample per row (matches C-contiguous NumPy arrays)
+ */
+using RowMatrixX3d = Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>;
+using RowMatrixXd = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+/**
+ * @brief Columns of the batch state outputs (see InertialNav/KinematicNav::GetStateVector)
+ */
+inline constexpr int INS_BATCH_STATES = InertialNav<>::STATE_SIZE;
+inline constexpr int KNS_BATCH_STATES = KinematicNav<>::STATE_SIZE;
+
+/**
+ * *=== RunInertialNav ===*
+ * @brief Mechanize and propagate every IMU sample, GNSS epochs are applied after the first IMU
+ *        sample at or past their time. States and covariance diagonals are written per IMU sample.
+ * @param filt        Initialized navigation filter (updated in place)
+ * @param imu_t       IMU sample times [s]
+ * @param imu_wb      IMU angular rates, one sample per row [rad/s]
+ * @param imu_fb      IMU specific forces, one sample per row [m/s^2]
+ * @param gnss_t      GNSS epoch times [s]
+ * @param offsets     First measurement row of each epoch (size of gnss_t + 1)
+ * @param sv_pos      Satellite ECEF positions of all epochs, one satellite per row [m]
+ * @param sv_vel      Satellite ECEF velocities of all epochs, one satellite per row [m/s]
+ * @param psr         Pseudorange measurements of all epochs [m]
+ * @param psrdot      Pseudorange-rate measurements of all epochs [m/s]
+ * @param psr_var     Pseudorange measurement variance of all epochs [m^2]
+ * @param psrdot_var  Pseudorange-rate measurement variance of all epochs [(m/s)^2]
+ * @param states      Output states, one row per IMU sample (INS_BATCH_STATES columns)
+ * @param cov_diag    Output covariance diagonals, one row per IMU sample (17 columns)
+ */
+void RunInertialNav(
+    InertialNav<> &filt,
+    const Eigen::Ref<const Eigen::VectorXd> &imu_t,
+    const Eigen::Ref<const RowMatrixX3d> &imu_wb,
+    const Eigen::Ref<const RowMatrixX3d> &imu_fb,
+    const Eigen::Ref<const Eigen::VectorXd> &gnss_t,
+    const Eigen::Ref<const Eigen::VectorXi> &offsets,
+    const Eigen::Ref<const RowMatrixX3d> &sv_pos,
+    const Eigen::Ref<const RowMatrixX3d> &sv_vel,
+    const Eigen::Ref<const Eigen::VectorXd> &psr,
+    const Eigen::Ref<const Eigen::VectorXd> &psrdot,
+    const Eigen::Ref<const Eigen::VectorXd> &psr_var,
+    const Eigen::Ref<const Eigen::VectorXd> &psrdot_var,
+    Eigen::Ref<RowMatrixXd> states,
+    Eigen::Ref<RowMatrixXd> cov_diag);
+
+/**
+ * *=== RunKinematicNav ===*
+ * @brief Propagate to and correct with every GNSS epoch, the first epoch is not propagated. States
+ *        and covariance diagonals are written per epoch.
+ * @param filt        Initialized navigation filter (updated in place)
+ * @param gnss_t      GNSS epoch times [s]
+ * @param offsets     First measurement row of each epoch (size of gnss_t + 1)
+ * @param sv_pos      Satellite ECEF positions of all epochs, one satellite per row [m]
+ * @param sv_vel      Satellite ECEF velocities of all epochs, one satellite per row [m/s]
+ * @param psr         Pseudorange measurements of all epochs [m]
+ * @param psrdot      Pseudorange-rate measurements of all epochs [m/s]
+ * @param psr_var     Pseudorange measurement variance of all epochs [m^2]
+ * @param psrdot_var  Pseudorange-rate measurement variance of all epochs [(m/s)^2]
+ * @param states      Output states, one row per epoch (KNS_BATCH_STATES columns)
+ * @param cov_diag    Output covariance diagonals, one row per epoch (11 columns)
+ */
+void RunKinematicNav(
+    KinematicNav<> &filt,
+    const Eigen::Ref<const Eigen::VectorXd> &gnss_t,
+    const Eigen::Ref<const Eigen::VectorXi> &offsets,
+    const Eigen::Ref<const RowMatrixX3d> &sv_pos,
+    const Eigen::Ref<const RowMatrixX3d> &sv_vel,
+    const Eigen::Ref<const Eigen::VectorXd> &psr,
+    const Eigen::Ref<const Eigen::VectorXd> &psrdot,
+    const Eigen::Ref<const Eigen::VectorXd> &psr_var,
+    const Eigen::Ref<const Eigen::VectorXd> &psrdot_var,
+    Eigen::Ref<RowMatrixXd> states,
+    Eigen::Ref<RowMatrixXd> cov_diag);
+
+}  // namespace sturdins
+
+#endif
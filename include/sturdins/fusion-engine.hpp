@@ -0,0 +1,268 @@
+/**
+ * *fusion-engine.hpp*
+ *
+ * =======  ========================================================================================
+ * @file    sturdins/fusion-engine.hpp
+ * @brief   Time-tagged multi-rate fusion of IMU and GNSS measurements around InertialNav.
+ * @date    January 2025
+ * @author  Daniel Sturdivant <sturdivant20@gmail.com>
+ * =======  ========================================================================================
+ */
+
+#ifndef STURDINS_FUSION_ENGINE_HPP
+#define STURDINS_FUSION_ENGINE_HPP
+
+#include <Eigen/Dense>
+#include <cstddef>
+#include <vector>
+
+#include "sturdins/inertial-nav.hpp"
+#include "sturdins/kalman-update.hpp"
+
+namespace sturdins {
+
+/**
+ * @brief Maximum number of antennas of a buffered phased array measurement
+ */
+inline constexpr int MAX_ANT = 8;
+
+/**
+ * @brief Measurements buffered by the FusionEngine
+ */
+enum class MeasurementType { GNSS, PHASED_ARRAY, ATTITUDE };
+
+/**
+ * *=== FusionMeasurement ===*
+ * @brief Time-tagged measurement stored inline (at most MAX_SV satellites and MAX_ANT antennas),
+ *        only the fields of its type are valid
+ */
+struct FusionMeasurement {
+  double t_;
+  MeasurementType type_;
+  Eigen::Matrix<double, 3, Eigen::Dynamic, Eigen::ColMajor, 3, MAX_SV> sv_pos_;  // ECEF [m]
+  Eigen::Matrix<double, 3, Eigen::Dynamic, Eigen::ColMajor, 3, MAX_SV> sv_vel_;  // ECEF [m/s]
+  Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::ColMajor, MAX_SV, 1> psr_;     // [m]
+  Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::ColMajor, MAX_SV, 1> psrdot_;  // [m/s]
+  Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::ColMajor, MAX_SV, 1> psr_var_;
+  Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::ColMajor, MAX_SV, 1> psrdot_var_;
+  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, MAX_ANT, MAX_SV> phase_;
+  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, MAX_ANT, MAX_SV>
+      phase_var_;
+  Eigen::Matrix<double, 3, Eigen::Dynamic, Eigen::ColMajor, 3, MAX_ANT> ant_xyz_;  // body [m]
+  int n_ant_;
+  double lamb_;
+  Eigen::Matrix3d C_;  // measured body-to-ned rotation
+  Eigen::Matrix3d R_;  // attitude error covariance [rad^2]
+};
+
+/**
+ * *=== FusionEngine ===*
+ * @brief Buffers time-tagged IMU samples and GNSS/phased array/attitude measurements and runs an
+ *        InertialNav through them in time order, propagating to each measurement time. Checkpoints
+ *        of the filter are kept in a ring covering the last `lag` seconds, a measurement older
+ *        than the filter time is handled by rolling back to the newest checkpoint before it and
+ *        re-running only the buffered IMU samples and measurements since then. All buffers are
+ *        allocated by the constructor.
+ */
+template <typename T = double>
+class FusionEngine {
+ public:
+  /**
+   * *=== FusionEngine ===*
+   * @brief constructor
+   * @param filt           Initialized navigation filter (copied)
+   * @param t0             Time of the filter state [s]
+   * @param lag            Oldest measurement delay handled [s]
+   * @param max_imu        Number of buffered IMU samples (bounds the lag in IMU samples)
+   * @param ckpt_interval  IMU samples between checkpoints (at most max_imu / 2)
+   * @param max_meas       Number of buffered measurements
+   */
+  FusionEngine(
+      const InertialNav<T> &filt,
+      const double &t0,
+      const double &lag = 0.5,
+      const int &max_imu = 1024,
+      const int &ckpt_interval = 10,
+      const int &max_meas = 32);
+
+  /**
+   * *=== ~FusionEngine ===*
+   * @brief Destructor
+   */
+  ~FusionEngine();
+
+  /**
+   * *=== AddImu ===*
+   * @brief Mechanize and propagate through an IMU sample, applying the buffered measurements that
+   *        fall inside it
+   * @param t   Time at the end of the sample interval [s] (must increase)
+   * @param wb  Measured angular rates in the body frame [rad/s]
+   * @param fb  Measured specific forces in the body frame [m/s^2]
+   * @return False if the sample is not newer than the filter time (it is ignored)
+   */
+  bool AddImu(
+      const double &t,
+      const Eigen::Ref<const Eigen::Vector3<T>> &wb,
+      const Eigen::Ref<const Eigen::Vector3<T>> &fb);
+
+  /**
+   * *=== AddGnss ===*
+   * @brief Buffer a GNSS epoch (see InertialNav::GnssUpdate)
+   * @param t           Measurement time [s]
+   * @param sv_pos      Satellite ECEF positions [m]
+   * @param sv_vel      Satellite ECEF velocities [m/s]
+   * @param psr         Pseudorange measurements [m]
+   * @param psrdot      Pseudorange-rate measurements [m/s]
+   * @param psr_var     Pseudorange measurement variance [m^2]
+   * @param psrdot_var  Pseudorange-rate measurement variance [(m/s)^2]
+   * @return False if the measurement was dropped (older than the oldest checkpoint, too many
+   *         satellites or no free buffer)
+   */
+  bool AddGnss(
+      const double &t,
+      const Eigen::Ref<const Eigen::Matrix3Xd> &sv_pos,
+      const Eigen::Ref<const Eigen::Matrix3Xd> &sv_vel,
+      const Eigen::Ref<const Eigen::VectorXd> &psr,
+      const Eigen::Ref<const Eigen::VectorXd> &psrdot,
+      const Eigen::Ref<const Eigen::VectorXd> &psr_var,
+      const Eigen::Ref<const Eigen::VectorXd> &psrdot_var);
+
+  /**
+   * *=== AddPhasedArray ===*
+   * @brief Buffer a phased array GNSS epoch (see InertialNav::PhasedArrayUpdate)
+   * @param t           Measurement time [s]
+   * @param sv_pos      Satellite ECEF positions [m]
+   * @param sv_vel      Satellite ECEF velocities [m/s]
+   * @param psr         Pseudorange measurements [m]
+   * @param psrdot      Pseudorange-rate measurements [m/s]
+   * @param phase       Phase measurements, one antenna per row [rad]
+   * @param psr_var     Pseudorange measurement variance [m^2]
+   * @param psrdot_var  Pseudorange-rate measurement variance [(m/s)^2]
+   * @param phase_var   Phase measurement variance [rad^2]
+   * @param ant_xyz     Antenna positions in the body frame [m]
+   * @param n_ant       Number of antennas
+   * @param lamb        Wavelength [m/rad]
+   * @return False if the measurement was dropped
+   */
+  bool AddPhasedArray(
+      const double &t,
+      const Eigen::Ref<const Eigen::Matrix3Xd> &sv_pos,
+      const Eigen::Ref<const Eigen::Matrix3Xd> &sv_vel,
+      const Eigen::Ref<const Eigen::VectorXd> &psr,
+      const Eigen::Ref<const Eigen::VectorXd> &psrdot,
+      const Eigen::Ref<const Eigen::MatrixXd> &phase,
+      const Eigen::Ref<const Eigen::VectorXd> &psr_var,
+      const Eigen::Ref<const Eigen::VectorXd> &psrdot_var,
+      const Eigen::Ref<const Eigen::MatrixXd> &phase_var,
+      const Eigen::Ref<const Eigen::Matrix3Xd> &ant_xyz,
+      const int &n_ant,
+      const double &lamb);
+
+  /**
+   * *=== AddAttitude ===*
+   * @brief Buffer an attitude measurement (see InertialNav::AttitudeUpdate)
+   * @param t   Measurement time [s]
+   * @param C   Measured body-to-ned rotation matrix
+   * @param R   Attitude error covariance (small angles about the ned axes) [rad^2]
+   * @return False if the measurement was dropped
+   */
+  bool AddAttitude(
+      const double &t,
+      const Eigen::Ref<const Eigen::Matrix3d> &C,
+      const Eigen::Ref<const Eigen::Matrix3d> &R);
+
+  /**
+   * *=== Filter ===*
+   * @brief Navigation filter at the time of the latest IMU sample
+   */
+  const InertialNav<T> &Filter() const;
+
+  /**
+   * *=== Time ===*
+   * @brief Time of the filter state [s]
+   */
+  double Time() const;
+
+  /**
+   * *=== NumPending ===*
+   * @brief Number of buffered measurements newer than the filter time
+   */
+  int NumPending() const;
+
+  /**
+   * @brief Statistics
+   */
+  int n_late_;      // measurements applied by rolling back to a checkpoint
+  int n_dropped_;   // measurements dropped
+  long n_replays_;  // IMU samples re-run after a roll back
+
+ private:
+  struct ImuSample {
+    double t_;
+    Eigen::Vector3<T> wb_;
+    Eigen::Vector3<T> fb_;
+  };
+  struct Checkpoint {
+    double t_;       // time of the checkpoint [s]
+    std::size_t k_;  // first IMU sample after the checkpoint
+    InertialNavSnapshot<T> state_;
+  };
+
+  InertialNav<T> filt_;
+  double t_;    // filter time [s]
+  double lag_;  // measurement delay handled [s]
+  std::size_t ckpt_interval_;
+
+  /**
+   * @brief Rings indexed by absolute sample/checkpoint number modulo their size
+   */
+  std::vector<ImuSample> imu_;
+  std::size_t imu_begin_;
+  std::size_t imu_end_;
+  std::vector<Checkpoint> ckpt_;
+  std::size_t ckpt_begin_;
+  std::size_t ckpt_end_;
+
+  /**
+   * @brief Measurement slots, order_ holds the slots in use sorted by time, the first next_ of
+   *        them are already applied to the filter
+   */
+  std::vector<FusionMeasurement> meas_;
+  std::vector<int> order_;
+  std::vector<int> free_;
+  std::size_t next_;
+
+  /**
+   * *=== AcquireSlot ===*
+   * @brief Free measurement slot, or -1 if the measurement is too old or no slot is free
+   */
+  int AcquireSlot(const double &t);
+
+  /**
+   * *=== Insert ===*
+   * @brief Insert a filled measurement slot, rolling back and re-running if it is late
+   */
+  void Insert(const int &slot);
+
+  /**
+   * *=== Step ===*
+   * @brief Run the filter through an IMU sample
+   */
+  void Step(const std::size_t &k);
+
+  /**
+   * *=== Apply ===*
+   * @brief Run the measurement update of a slot
+   */
+  void Apply(const FusionMeasurement &m);
+
+  /**
+   * *=== Retire ===*
+   * @brief Drop checkpoints, IMU samples and measurements that fell out of the lag window
+   */
+  void Retire();
+};
+
+}  // namespace sturdins
+
+#endif
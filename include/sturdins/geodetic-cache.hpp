@@ -0,0 +1,120 @@
+/**
+ * *geodetic-cache.hpp*
+ *
+ * =======  ========================================================================================
+ * @file    sturdins/geodetic-cache.hpp
+ * @brief   Cache of the position dependent WGS84 terms shared by the navigation filters.
+ * @date    January 2025
+ * @author  Daniel Sturdivant <sturdivant20@gmail.com>
+ * @ref     1. "Principles of GNSS, Inertial, and Multisensor Integrated Navigation Systems", 2nd
+ *              Edition, 2013 - Groves
+ * =======  ========================================================================================
+ */
+
+#ifndef STURDINS_GEODETIC_CACHE_HPP
+#define STURDINS_GEODETIC_CACHE_HPP
+
+#include <Eigen/Dense>
+
+namespace sturdins {
+
+/**
+ * @brief Functions of latitude, radii of curvature, ECEF position and the NED to ECEF rotation at a
+ *        geodetic position. Update only re-evaluates the terms whose inputs changed (latitude,
+ *        longitude or height), and the ECEF position and rotation are evaluated on first request
+ */
+class GeodeticCache {
+ public:
+  /**
+   * *=== GeodeticCache ===*
+   * @brief constructor, the first Update always evaluates every term
+   */
+  GeodeticCache();
+
+  /**
+   * *=== ~GeodeticCache ===*
+   * @brief Destructor
+   */
+  ~GeodeticCache();
+
+  /**
+   * *=== Update ===*
+   * @brief Move the cache to a new position
+   * @param phi   Latitude [rad]
+   * @param lam   Longitude [rad]
+   * @param h     Altitude [m]
+   * @return True if the position differs from the cached one
+   */
+  bool Update(const double &phi, const double &lam, const double &h);
+
+  /**
+   * *=== Invalidate ===*
+   * @brief Force the next Update to evaluate every term
+   */
+  void Invalidate();
+
+  /**
+   * *=== EcefPosition ===*
+   * @brief ECEF position of the cached point [m]
+   */
+  const Eigen::Vector3d &EcefPosition();
+
+  /**
+   * *=== NedToEcef ===*
+   * @brief Rotation from the NED frame of the cached point to the ECEF frame (C_l_e)
+   */
+  const Eigen::Matrix3d &NedToEcef();
+
+  /**
+   * @brief Functions of latitude
+   */
+  double sL_;    // sin(phi)
+  double cL_;    // cos(phi)
+  double tL_;    // tan(phi)
+  double sLsq_;  // sin(phi)^2
+  double cLsq_;  // cos(phi)^2
+
+  /**
+   * @brief Functions of longitude
+   */
+  double sLam_;  // sin(lam)
+  double cLam_;  // cos(lam)
+
+  /**
+   * @brief Radii of curvature
+   */
+  double X1ME2_;    // 1 - e^2
+  double X1ME2sq_;  // (1 - e^2)^2
+  double Re_;       // Meridian radius
+  double Rn_;       // Transverse radius
+  double Rg_;       // Geocentric radius
+  double Hn_;       // Rn + h
+  double He_;       // Re + h
+  double Hnsq_;     // (Rn + h)^2
+  double Hesq_;     // (Re + h)^2
+
+  /**
+   * @brief Somigliana model gravity at the ellipsoid surface [m/s^2]
+   */
+  double g0_;
+
+ private:
+  /**
+   * @brief Cached position
+   */
+  double phi_;
+  double lam_;
+  double h_;
+
+  /**
+   * @brief Lazily evaluated terms
+   */
+  Eigen::Vector3d ecef_p_;
+  Eigen::Matrix3d C_l_e_;
+  bool ecef_valid_;
+  bool dcm_valid_;
+};
+
+}  // namespace sturdins
+
+#endif
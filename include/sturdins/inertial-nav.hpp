@@ -19,13 +19,35 @@
 #define STURDINS_INS_HPP
 
 #include <Eigen/Dense>
+#include <memory>
 
+#include "sturdins/kalman-update.hpp"
+#include "sturdins/least-squares.hpp"
+#include "sturdins/nav-snapshot.hpp"
+#include "sturdins/process-noise.hpp"
+#include "sturdins/state-layout.hpp"
 #include "sturdins/strapdown.hpp"
 
 namespace sturdins {
 
-class InertialNav : public Strapdown {
+/**
+ * @brief GNSS/INS error state filter on scalar type T (float or double). The covariance, error
+ *        state and Kalman workspace are of type T, position, clock and ECEF states as well as the
+ *        measurement predictions are always double (metre level pseudoranges of ~2e7 m do not fit
+ *        a float mantissa)
+ */
+template <typename T = double>
+class InertialNav : public Strapdown<T> {
  public:
+  using Strapdown<T>::phi_;
+  using Strapdown<T>::lam_;
+  using Strapdown<T>::h_;
+  using Strapdown<T>::vn_;
+  using Strapdown<T>::ve_;
+  using Strapdown<T>::vd_;
+  using Strapdown<T>::q_b_l_;
+  using Strapdown<T>::C_b_l_;
+
   /**
    * *=== InertialNav ===*
    * @brief constructor
@@ -82,6 +104,21 @@ class InertialNav : public Strapdown {
    */
   void SetClockSpec(const double &h0, const double &h1, const double &h2);
 
+  /**
+   * *=== SetProcessNoiseModel ===*
+   * @brief Use a (shared) process noise model instead of the one built by SetImuSpec and
+   *        SetClockSpec, propagation looks up the blocks of dt in the model (the KinematicNav
+   *        parameters of the model are unused)
+   * @param model   Process noise model
+   */
+  void SetProcessNoiseModel(const std::shared_ptr<const ProcessNoiseModel> &model);
+
+  /**
+   * *=== GetProcessNoiseModel ===*
+   * @brief Process noise model used by the filter
+   */
+  const std::shared_ptr<const ProcessNoiseModel> &GetProcessNoiseModel() const;
+
   /**
    * *=== SetClock ===*
    * @brief Set the clock states of the INS system
@@ -90,6 +127,57 @@ class InertialNav : public Strapdown {
    */
   void SetClock(const double &cb, const double &cd);
 
+  /**
+   * *=== SetUpdateStrategy ===*
+   * @brief Choose between batch and sequential (scalar) measurement updates, sequential updates
+   *        avoid factorizing the innovation covariance and are cheaper for large constellations
+   * @param strategy  UpdateStrategy::BATCH (default) or UpdateStrategy::SEQUENTIAL
+   */
+  void SetUpdateStrategy(const UpdateStrategy &strategy);
+
+  /**
+   * *=== SetInnovationGate ===*
+   * @brief Reject measurements whose normalized innovation |dy| / sqrt(HPH' + R)_ii exceeds the
+   *        gate, rejected measurements are removed from the update in place (see rejected_)
+   * @param gate  Innovation gate [sigma] (0 disables gating, default)
+   */
+  void SetInnovationGate(const double &gate);
+
+  /**
+   * *=== SetDensePropagation ===*
+   * @brief Use the dense 17x17 covariance propagation instead of the block-structured kernel
+   *        (for validation only, both give the same result)
+   * @param dense   True to use the dense products
+   */
+  void SetDensePropagation(const bool &dense);
+
+  /**
+   * *=== SetSquareRoot ===*
+   * @brief Carry a square root S of the covariance (P_ = S*S') instead of P_ itself, propagation
+   *        is a QR factorization of [S'*F'; Lq'*F'; Lq'] (Q = Lq*Lq') and measurements use
+   *        Potter's square root update, so P_ stays positive definite. The current P_ is factored
+   *        when enabled and the initial settling iterations are not run (P_ must hold the initial
+   *        uncertainty), P_ is kept current for reading but changes to it are not seen by the
+   *        filter until SetSquareRoot is called again. A covariance propagation costs a 45x17 QR,
+   *        so combine with SetPropagationInterval at high IMU rates
+   * @param sqrt_form   True to use the square root covariance form
+   */
+  void SetSquareRoot(const bool &sqrt_form);
+
+  /**
+   * *=== SetPropagationInterval ===*
+   * @brief Propagate the covariance once every n calls to Propagate, the transition and process
+   *        noise are accumulated in between (updates always apply pending propagation first)
+   * @param n   Number of Propagate calls per covariance propagation (1 propagates every call)
+   */
+  void SetPropagationInterval(const int &n);
+
+  /**
+   * *=== FlushPropagation ===*
+   * @brief Apply the accumulated covariance propagation so P_ is current
+   */
+  void FlushPropagation();
+
   /**
    * *=== Propagate ===*
    * @brief Propagate the error state matrices
@@ -98,8 +186,21 @@ class InertialNav : public Strapdown {
    * @param dt  Integration time [s]
    */
   void Propagate(
-      const Eigen::Ref<const Eigen::Vector3d> &wb,
-      const Eigen::Ref<const Eigen::Vector3d> &fb,
+      const Eigen::Ref<const Eigen::Vector3<T>> &wb,
+      const Eigen::Ref<const Eigen::Vector3<T>> &fb,
+      const double &dt);
+
+  /**
+   * *=== PropagateIncrements ===*
+   * @brief MechanizeIncrements followed by Propagate over the whole burst, using its coning and
+   *        sculling compensated mean angular rate and specific force
+   * @param dtheta  Delta thetas in the body frame, one IMU sample per column [rad]
+   * @param dvel    Delta velocities in the body frame, one IMU sample per column [m/s]
+   * @param dt      IMU sample interval [s]
+   */
+  void PropagateIncrements(
+      const Eigen::Ref<const Eigen::Matrix3X<T>> &dtheta,
+      const Eigen::Ref<const Eigen::Matrix3X<T>> &dvel,
       const double &dt);
 
   /**
@@ -122,7 +223,8 @@ class InertialNav : public Strapdown {
 
   /**
    * *=== PhasedArrayUpdate ===*
-   * @brief Correct state with GPS measurements
+   * @brief Correct state with GPS measurements, at most 2*MAX_SV - 1 antennas (n_ant + 1 rows per
+   *        satellite must fit in a measurement block, otherwise nothing is updated)
    * @param sv_pos      Satellite ECEF positions [m]
    * @param sv_vel      Satellite ECEF velocities [m/s]
    * @param psr         Pseudorange measurements [m]
@@ -143,46 +245,188 @@ class InertialNav : public Strapdown {
       const int &n_ant,
       const double &lamb);
 
+  /**
+   * *=== AttitudeUpdate ===*
+   * @brief Correct state with an attitude measurement
+   * @param C   Measured body-to-ned rotation matrix
+   * @param R   Attitude error covariance (small angles about the ned axes) [rad^2]
+   */
+  void AttitudeUpdate(
+      const Eigen::Ref<const Eigen::Matrix3d> &C, const Eigen::Ref<const Eigen::Matrix3d> &R);
+
+  /**
+   * *=== SaveSnapshot ===*
+   * @brief Copy the navigation states, biases, clock and covariance into a caller-provided
+   *        snapshot, pending covariance propagation is applied first (see SetPropagationInterval)
+   * @param snap  Output snapshot
+   */
+  void SaveSnapshot(InertialNavSnapshot<T> &snap);
+
+  /**
+   * *=== RestoreSnapshot ===*
+   * @brief Set the navigation states, biases, clock and covariance from a snapshot, any
+   *        propagation accumulated since is dropped
+   * @param snap  Snapshot from SaveSnapshot (of this or another filter with the same settings)
+   */
+  void RestoreSnapshot(const InertialNavSnapshot<T> &snap);
+
+  /**
+   * *=== GetStateVector ===*
+   * @brief Copy the navigation states into a caller-provided buffer (does not allocate)
+   *        [lat, lon, alt, vn, ve, vd, q0, q1, q2, q3, bgx, bgy, bgz, bax, bay, baz, cb, cd]
+   * @param x   Output buffer (STATE_SIZE elements)
+   */
+  void GetStateVector(Eigen::Ref<Eigen::VectorXd> x) const;
+  static constexpr int STATE_SIZE = 18;
+  static constexpr int ERROR_SIZE = 17;
+  static_assert(InertialStateLayout::NX == ERROR_SIZE);
+  using Snapshot = InertialNavSnapshot<T>;
+
+  /**
+   * *=== SetSmootherLog ===*
+   * @brief Log the transition, predicted covariance and corrections between calls to
+   *        TakeSmootherLog (see RtsSmoother), off by default
+   * @param enable  True to log
+   */
+  void SetSmootherLog(const bool &enable);
+
+  /**
+   * *=== TakeSmootherLog ===*
+   * @brief Copy out the log since the last call and restart it, pending covariance propagation is
+   *        applied first. Measurement updates must only follow the last propagation of the
+   *        interval (take the log after the updates of each epoch)
+   * @param Phi     Transition since the last call (product of the propagations)
+   * @param P_pred  Covariance after the last propagation, before the updates
+   * @param dx      Corrections applied since the last propagation
+   */
+  void TakeSmootherLog(
+      Eigen::Matrix<T, 17, 17> &Phi, Eigen::Matrix<T, 17, 17> &P_pred, Eigen::Vector<T, 17> &dx);
+
+  /**
+   * *=== CorrectState ===*
+   * @brief Feed an error state back into the navigation states (as a measurement update does)
+   * @param dx  Error state [pos ned, vel ned, att ned, accel bias, gyro bias, clock bias, drift]
+   */
+  void CorrectState(const Eigen::Ref<const Eigen::Vector<T, 17>> &dx);
+
   /**
    * @brief States not included from Strapdown
    */
   Eigen::Vector3d ecef_p_;
   Eigen::Vector3d ecef_v_;
-  Eigen::Vector3d bg_;  // gyroscope bias estimate
-  Eigen::Vector3d ba_;  // accelerometer bias estimate
-  double cb_;           // clock bias estimate
-  double cd_;           // clock drift estimate
-  Eigen::MatrixXd P_;   // error state covariance
+  Eigen::Vector3<T> bg_;        // gyroscope bias estimate
+  Eigen::Vector3<T> ba_;        // accelerometer bias estimate
+  double cb_;                   // clock bias estimate
+  double cd_;                   // clock drift estimate
+  Eigen::Matrix<T, 17, 17> P_;  // error state covariance
+
+  /**
+   * @brief Measurements rejected by the innovation gate in the most recent update, ordered as its
+   *        inputs [psr; psrdot; phase (n_ant - 1 per satellite)]
+   */
+  Eigen::VectorX<bool> rejected_;
 
  private:
+  using Strapdown<T>::geo_;
+  using Strapdown<T>::w_en_n_;
+  using Strapdown<T>::w_ie_n_;
+  using Strapdown<T>::dtheta_b_;
+  using Strapdown<T>::dv_b_;
+
   /**
    * @brief Kalman Filter Matrices (these have constant size)
    */
-  Eigen::VectorXd x_;  // error state vector
-  Eigen::MatrixXd F_;  // state transition matrix
-  Eigen::MatrixXd Q_;  // process covariance matrix
-  Eigen::MatrixXd I17_;
+  Eigen::Vector<T, 17> x_;        // error state vector
+  Eigen::Matrix<T, 17, 17> F_;    // state transition matrix
+  Eigen::Matrix<T, 17, 17> Q_;    // process covariance matrix
+  Eigen::Matrix<T, 17, 17> Phi_;  // accumulated state transition matrix
+  Eigen::Matrix<T, 17, 17> Qd_;   // accumulated process covariance matrix
+  double Tp_;                     // accumulated propagation time [s]
+  Eigen::Matrix<T, 17, 17> S_;    // covariance square root (P_ = S_*S_', if sqrt_form_)
+  Eigen::Matrix<T, 45, 17> A_;    // square root propagation pre-array
+  Eigen::HouseholderQR<Eigen::Matrix<T, 45, 17>> qr_;
+  int n_prop_;                             // Propagate calls since last covariance propagation
+  int prop_interval_;                      // Propagate calls per covariance propagation
+  KalmanWorkspace<17, 2 * MAX_SV, T> ws_;  // measurement workspace
+  RangeAndRateBuffer<MAX_SV> pred_;        // measurement predictions
+  UpdateStrategy strategy_;
+  bool dense_propagation_;
+  bool sqrt_form_;
   bool is_init_;
+  PhaseDifferenceBuffer<MAX_SV, 2 * MAX_SV> phase_pred_;  // phased array predictions
 
   /**
-   * @brief IMU allan variance parameters
+   * @brief Smoother log (see SetSmootherLog)
    */
-  double Sra_;   // accelerometer measurement noise PSD
-  double Sbad_;  // accelerometer bias variation PSD
-  double Srg_;   // gyroscope measurement noise PSD
-  double Sbgd_;  // gyroscope bias variation PSD
+  bool log_;
+  int n_log_;                         // covariance propagations since the last TakeSmootherLog
+  Eigen::Matrix<T, 17, 17> Phi_log_;  // transition since the last TakeSmootherLog
+  Eigen::Matrix<T, 17, 17> P_log_;    // covariance after the last propagation
+  Eigen::Vector<T, 17> dx_log_;       // corrections since the last propagation
 
   /**
-   * @brief Clock allan variance parameters
+   * @brief IMU and clock allan variance parameters and their process noise model
    */
-  double h0_;
-  double h1_;
-  double h2_;
+  NavigationIMU imu_;
+  NavigationClock clock_;
+  std::shared_ptr<const ProcessNoiseModel> noise_;
+  double q_dt_;  // integration time Q_ was filled for (0 if stale)
 
-  void KalmanUpdate(
-      const Eigen::Ref<const Eigen::MatrixXd> &R,
-      const Eigen::Ref<const Eigen::MatrixXd> &H,
-      const Eigen::Ref<const Eigen::VectorXd> &dy);
+  /**
+   * *=== PropagateCovariance ===*
+   * @brief Block-structured P = F*(P+Q)*F' + Q, only the navigation rows of F (and the clock 2x2)
+   *        are multiplied, the bias rows of F are identity
+   * @param F         State transition matrix
+   * @param Q         Process covariance matrix
+   * @param dt        Integration time [s]
+   * @param dense_Fnb True if the navigation/bias block of F is full (accumulated transition)
+   */
+  void PropagateCovariance(
+      const Eigen::Matrix<T, 17, 17> &F,
+      const Eigen::Matrix<T, 17, 17> &Q,
+      const double &dt,
+      const bool &dense_Fnb);
+
+  /**
+   * *=== FactorSquareRoot ===*
+   * @brief Set the covariance square root S_ from P_ (P_ may be singular)
+   */
+  void FactorSquareRoot();
+
+  /**
+   * *=== PropagateSquareRoot ===*
+   * @brief Square root form of P = F*(P+Q)*F' + Q
+   * @param F   State transition matrix
+   * @param Q   Process covariance (diagonal with a 2x2 clock block)
+   */
+  void PropagateSquareRoot(const Eigen::Matrix<T, 17, 17> &F, const Eigen::Matrix<T, 17, 17> &Q);
+
+  /**
+   * *=== ClockProcessCov ===*
+   * @brief Fill the clock block of a process covariance matrix from the process noise model
+   * @param Q   Process covariance matrix
+   * @param dt  Integration time [s]
+   */
+  void ClockProcessCov(Eigen::Matrix<T, 17, 17> &Q, const double &dt);
+
+  /**
+   * *=== LogPropagation ===*
+   * @brief Add a covariance propagation to the smoother log
+   * @param F   State transition matrix of the propagation
+   */
+  void LogPropagation(const Eigen::Matrix<T, 17, 17> &F);
+
+  /**
+   * *=== KalmanUpdate ===*
+   * @brief Update the error state and covariance with the measurement block in the workspace
+   */
+  void KalmanUpdate();
+
+  /**
+   * *=== ClosedLoopCorrection ===*
+   * @brief Feed the accumulated error state back into the navigation states
+   */
+  void ClosedLoopCorrection();
 };
 
 }  // namespace sturdins
@@ -0,0 +1,164 @@
+/**
+ * *instrument.hpp*
+ *
+ * =======  ========================================================================================
+ * @file    sturdins/instrument.hpp
+ * @brief   Optional per-stage call and timing counters of the library hot paths.
+ * @date    January 2025
+ * @author  Daniel Sturdivant <sturdivant20@gmail.com>
+ * =======  ========================================================================================
+ */
+
+#ifndef STURDINS_INSTRUMENT_HPP
+#define STURDINS_INSTRUMENT_HPP
+
+#include <cstdint>
+
+#ifdef STURDINS_INSTRUMENT
+#include <atomic>
+#include <chrono>
+#endif
+
+namespace sturdins {
+
+/**
+ * @brief Instrumented stages of the library
+ */
+enum class Stage {
+  MECHANIZE,           // Strapdown::Mechanize and MechanizeIncrements
+  PROPAGATE,           // InertialNav and KinematicNav Propagate
+  MEASUREMENT_MODEL,   // predictions and observation matrix of the filter measurement updates
+  KALMAN_UPDATE,       // gain, factorization and covariance update of each update block
+  GNSS_PVT_ITERATION,  // one iteration of the least squares GNSS position and velocity solvers
+  MUSIC_LEVEL,         // one grid level (coarse or refinement) of the MUSIC search
+};
+
+/**
+ * @brief Number of instrumented stages
+ */
+inline constexpr int N_STAGES = 6;
+
+/**
+ * @brief True when the library was built with STURDINS_INSTRUMENT, otherwise the counters stay at
+ *        zero and the timers compile to nothing
+ */
+#ifdef STURDINS_INSTRUMENT
+inline constexpr bool INSTRUMENTATION_ENABLED = true;
+#else
+inline constexpr bool INSTRUMENTATION_ENABLED = false;
+#endif
+
+/**
+ * *=== StageCounters ===*
+ * @brief Totals of a stage over all threads since the last ResetStageCounters
+ */
+struct StageCounters {
+  std::uint64_t calls_;        // completed calls
+  std::uint64_t nanoseconds_;  // time spent in the stage [ns]
+};
+
+/**
+ * *=== GetStageCounters ===*
+ * @brief Totals of a stage over all threads (including threads that have exited)
+ * @param stage Instrumented stage
+ * @return Call count and time of the stage
+ */
+StageCounters GetStageCounters(const Stage &stage);
+
+/**
+ * *=== ResetStageCounters ===*
+ * @brief Restart the totals of every stage from zero
+ */
+void ResetStageCounters();
+
+/**
+ * *=== StageName ===*
+ * @brief Name of a stage
+ */
+const char *StageName(const Stage &stage);
+
+#ifdef STURDINS_INSTRUMENT
+
+/**
+ * *=== ThreadStageCounters ===*
+ * @brief Counters of one thread. Only the owning thread writes them (relaxed load and store, no
+ *        locked instructions), readers sum them through the registry the constructor adds them to
+ *        and the destructor folds them into when the thread exits
+ */
+struct ThreadStageCounters {
+  std::atomic<std::uint64_t> calls_[N_STAGES];
+  std::atomic<std::uint64_t> nanoseconds_[N_STAGES];
+
+  ThreadStageCounters();
+  ~ThreadStageCounters();
+  ThreadStageCounters(const ThreadStageCounters &) = delete;
+  ThreadStageCounters &operator=(const ThreadStageCounters &) = delete;
+
+  /**
+   * *=== Add ===*
+   * @brief Count a completed call of a stage
+   */
+  void Add(const Stage &stage, const std::uint64_t &ns) {
+    const int i = static_cast<int>(stage);
+    calls_[i].store(calls_[i].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    nanoseconds_[i].store(
+        nanoseconds_[i].load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+  }
+};
+
+/**
+ * @brief Counters of the calling thread
+ */
+inline thread_local ThreadStageCounters thread_stage_counters;
+
+/**
+ * *=== StageTimer ===*
+ * @brief Times its scope (or until Stop) and adds it to a stage of the calling thread's counters
+ */
+class StageTimer {
+ public:
+  explicit StageTimer(const Stage &stage)
+      : stage_{stage}, running_{true}, t0_{std::chrono::steady_clock::now()} {
+  }
+  ~StageTimer() {
+    Stop();
+  }
+  StageTimer(const StageTimer &) = delete;
+  StageTimer &operator=(const StageTimer &) = delete;
+
+  /**
+   * *=== Stop ===*
+   * @brief End the timed section before the end of the scope
+   */
+  void Stop() {
+    if (running_) {
+      const auto dt = std::chrono::steady_clock::now() - t0_;
+      thread_stage_counters.Add(
+          stage_, std::chrono::duration_cast<std::chrono::nanoseconds>(dt).count());
+      running_ = false;
+    }
+  }
+
+ private:
+  Stage stage_;
+  bool running_;
+  std::chrono::steady_clock::time_point t0_;
+};
+
+/**
+ * @brief Time the rest of the scope as a stage, STURDINS_STAGE_TIMER_STOP ends it early (one timer
+ *        per scope). Both expand to nothing without STURDINS_INSTRUMENT
+ */
+#define STURDINS_STAGE_TIMER(stage) ::sturdins::StageTimer sturdins_stage_timer_(stage)
+#define STURDINS_STAGE_TIMER_STOP() sturdins_stage_timer_.Stop()
+
+#else
+
+#define STURDINS_STAGE_TIMER(stage) static_cast<void>(0)
+#define STURDINS_STAGE_TIMER_STOP() static_cast<void>(0)
+
+#endif
+
+}  // namespace sturdins
+
+#endif
@@ -0,0 +1,350 @@
+/**
+ * *kalman-update.hpp*
+ *
+ * =======  ========================================================================================
+ * @file    sturdins/kalman-update.hpp
+ * @brief   Fixed-capacity measurement workspace and Kalman update equations.
+ * @date    January 2025
+ * @author  Daniel Sturdivant <sturdivant20@gmail.com>
+ * @ref     1. "Principles of GNSS, Inertial, and Multisensor Integrated Navigation Systems", 2nd
+ *              Edition, 2013 - Groves
+ * =======  ========================================================================================
+ */
+
+#ifndef STURDINS_KALMAN_UPDATE_HPP
+#define STURDINS_KALMAN_UPDATE_HPP
+
+#include <Eigen/Dense>
+#include <cmath>
+
+#ifndef STURDINS_MAX_SV
+#define STURDINS_MAX_SV 32
+#endif
+
+namespace sturdins {
+
+/**
+ * @brief Maximum number of satellites in a single measurement block, epochs with more satellites
+ *        are processed as consecutive blocks
+ */
+inline constexpr int MAX_SV = STURDINS_MAX_SV;
+
+/**
+ * @brief Measurement update strategy
+ *  - BATCH:      joint update of the whole measurement block (factorizes the innovation covariance)
+ *  - SEQUENTIAL: one scalar measurement at a time (requires diagonal R, no factorization)
+ */
+enum class UpdateStrategy { BATCH, SEQUENTIAL };
+
+/**
+ * *=== KalmanWorkspace ===*
+ * @brief Measurement workspace with compile-time capacity, so the update never touches the heap
+ * @tparam NX   Number of error states
+ * @tparam MaxM Maximum number of measurements in a single block
+ * @tparam T    Scalar type of the covariance and measurement block
+ */
+template <int NX, int MaxM = 2 * MAX_SV, typename T = double>
+class KalmanWorkspace {
+ public:
+  static constexpr int MAX_M = MaxM;
+  using MatrixM =
+      Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, MaxM, MaxM>;
+  using VectorM = Eigen::Matrix<T, Eigen::Dynamic, 1, Eigen::ColMajor, MaxM, 1>;
+  using MatrixMX = Eigen::Matrix<T, Eigen::Dynamic, NX, Eigen::ColMajor, MaxM, NX>;
+  using MatrixXM = Eigen::Matrix<T, NX, Eigen::Dynamic, Eigen::ColMajor, NX, MaxM>;
+  using MaskM = Eigen::Matrix<bool, Eigen::Dynamic, 1, Eigen::ColMajor, MaxM, 1>;
+
+  KalmanWorkspace()
+      : L_{Eigen::Matrix<T, NX, NX>::Identity()},
+        gate_{0.0},
+        nis_{0.0},
+        dense_R_{false},
+        layout_{0} {
+  }
+
+  /**
+   * *=== Resize ===*
+   * @brief Resize the measurement block and clear the observation matrix and variances, the
+   *        measurement variance is assumed diagonal (r_) unless SetCovariance is called
+   * @param M   Number of measurements in the block (must not exceed MaxM)
+   */
+  void Resize(const int &M) {
+    eigen_assert(M <= MaxM && "measurement block exceeds workspace capacity");
+    H_.setZero(M, NX);
+    dy_.resize(M);
+    r_.setZero(M);
+    rejected_.setConstant(M, false);
+    dense_R_ = false;
+    layout_ = 0;
+  }
+
+  /**
+   * *=== Reshape ===*
+   * @brief Like Resize, but the observation matrix is kept when the block has the same size and
+   *        layout as the previous one, so its constant (e.g. clock) entries are only written once
+   * @param M       Number of measurements in the block (must not exceed MaxM)
+   * @param layout  Caller defined (non-zero) id of the rows/columns the caller overwrites
+   * @returns True if the observation matrix was kept
+   */
+  bool Reshape(const int &M, const int &layout) {
+    if (layout != 0 && layout == layout_ && M == H_.rows() && !dense_R_) {
+      rejected_.setConstant(false);
+      return true;
+    }
+    Resize(M);
+    layout_ = layout;
+    return false;
+  }
+
+  /**
+   * *=== SetCovariance ===*
+   * @brief Use a full (correlated) measurement covariance for the current block
+   * @param R   Measurement covariance (size must match the current block)
+   */
+  void SetCovariance(const Eigen::Ref<const Eigen::MatrixXd> &R) {
+    R_ = R.template cast<T>();
+    dense_R_ = true;
+  }
+
+  /**
+   * *=== SetGate ===*
+   * @brief Reject measurements whose normalized innovation |dy| / sqrt(S_ii) exceeds the gate
+   * @param gate  Innovation gate [sigma] (0 disables gating)
+   */
+  void SetGate(const double &gate) {
+    gate_ = gate;
+  }
+
+  /**
+   * *=== GetGate ===*
+   * @brief Innovation gate [sigma] (0 if gating is disabled)
+   */
+  double GetGate() const {
+    return gate_;
+  }
+
+  /**
+   * *=== Nis ===*
+   * @brief Normalized innovation squared dy'*inv(S)*dy of the measurements accepted in the most
+   *        recent gated block (chi-square with as many degrees of freedom as accepted rows)
+   */
+  T Nis() const {
+    return nis_;
+  }
+
+  /**
+   * *=== ComputeGain ===*
+   * @brief Calculate the Kalman gain of the current measurement block, the innovation covariance
+   *        is factored with LLT (LDLT if it is not positive definite) instead of being inverted.
+   *        Measurements failing the gate are removed in place (their rows of H and dy are zeroed
+   *        and they are decoupled in S), so they receive no gain and one factorization suffices
+   * @param P   Error state covariance
+   * @param x   Error state vector (corrections of previous blocks of the same epoch)
+   * @returns True if the innovation covariance could be factored
+   */
+  bool ComputeGain(const Eigen::Matrix<T, NX, NX> &P, const Eigen::Vector<T, NX> &x) {
+    PHt_.noalias() = P * H_.transpose();
+    S_.noalias() = H_ * PHt_;
+    if (dense_R_) {
+      S_ += R_;
+    } else {
+      S_.diagonal() += r_;
+    }
+    if (gate_ > 0.0) {
+      Gate(x);
+    }
+
+    // K = P*H'*inv(S) -> S*K' = H*P
+    KT_ = PHt_.transpose();
+    llt_.compute(S_);
+    if (llt_.info() == Eigen::Success) {
+      llt_.solveInPlace(KT_);
+      if (gate_ > 0.0) {
+        llt_.matrixL().solveInPlace(v_);
+        nis_ = v_.squaredNorm();
+      }
+    } else {
+      ldlt_.compute(S_);
+      if (ldlt_.info() != Eigen::Success) {
+        return false;
+      }
+      ldlt_.solveInPlace(KT_);
+      if (gate_ > 0.0) {
+        nis_ = v_.dot(ldlt_.solve(v_));
+      }
+    }
+    K_ = KT_.transpose();
+    L_.setIdentity();
+    L_.noalias() -= K_ * H_;
+    return true;
+  }
+
+  /**
+   * *=== UpdateCovariance ===*
+   * @brief Joseph form covariance update with the most recent Kalman gain
+   * @param P   Error state covariance
+   */
+  void UpdateCovariance(Eigen::Matrix<T, NX, NX> &P) {
+    LP_.noalias() = L_ * P;
+    P.noalias() = LP_ * L_.transpose();
+    if (dense_R_) {
+      KR_.noalias() = K_ * R_;
+    } else {
+      KR_ = K_ * r_.asDiagonal();
+    }
+    P.noalias() += KR_ * K_.transpose();
+  }
+
+  /**
+   * *=== UpdateState ===*
+   * @brief Accumulate the error state correction, corrections from previous blocks of the same
+   *        epoch are removed from the innovation first
+   * @param x   Error state vector
+   */
+  void UpdateState(Eigen::Vector<T, NX> &x) {
+    dy_.noalias() -= H_ * x;
+    x.noalias() += K_ * dy_;
+  }
+
+  /**
+   * *=== SequentialUpdate ===*
+   * @brief Process the measurement block one row at a time with rank-1 Joseph form covariance
+   *        updates, falls back to the batch update when R is not diagonal
+   * @param P   Error state covariance
+   * @param x   Error state vector
+   */
+  void SequentialUpdate(Eigen::Matrix<T, NX, NX> &P, Eigen::Vector<T, NX> &x) {
+    if (dense_R_) {
+      if (ComputeGain(P, x)) {
+        UpdateCovariance(P);
+        UpdateState(x);
+      }
+      return;
+    }
+
+    T s, v;
+    for (int i = 0; i < H_.rows(); i++) {
+      h_ = H_.row(i).transpose();
+      c_.noalias() = P * h_;
+      s = h_.dot(c_) + r_(i);
+      if (!(s > 0.0)) {
+        continue;
+      }
+      v = dy_(i) - h_.dot(x);
+      if (gate_ > 0.0 && v * v > gate_ * gate_ * s) {
+        rejected_(i) = true;
+        continue;
+      }
+      k_ = c_ / s;
+      x += k_ * v;
+
+      // P = (I - k*h') * P * (I - k*h')' + k*r*k' = P - k*c' - c*k' + (h'*c + r)*k*k'
+      P.noalias() -= k_ * c_.transpose();
+      P.noalias() -= c_ * k_.transpose();
+      P.noalias() += s * k_ * k_.transpose();
+    }
+  }
+
+  /**
+   * *=== SquareRootUpdate ===*
+   * @brief Process the measurement block one row at a time on a square root S of the covariance
+   *        (P = S*S') with Potter's rank-1 downdate, so P stays symmetric positive semi-definite
+   *        without the Joseph form. A full R is whitened with its Cholesky factor first
+   * @param S   Square root of the error state covariance
+   * @param x   Error state vector
+   */
+  void SquareRootUpdate(Eigen::Matrix<T, NX, NX> &S, Eigen::Vector<T, NX> &x) {
+    if (dense_R_) {
+      // R = Lr*Lr' -> inv(Lr)*y has unit, uncorrelated noise
+      llt_.compute(R_);
+      if (llt_.info() != Eigen::Success) {
+        return;
+      }
+      llt_.matrixL().solveInPlace(H_);
+      llt_.matrixL().solveInPlace(dy_);
+      r_.setOnes(H_.rows());
+      layout_ = 0;
+    }
+
+    T s, v, g;
+    for (int i = 0; i < H_.rows(); i++) {
+      h_ = H_.row(i).transpose();
+      k_.noalias() = S.transpose() * h_;  // phi = S'*h
+      s = k_.squaredNorm() + r_(i);
+      if (!(s > 0.0)) {
+        continue;
+      }
+      v = dy_(i) - h_.dot(x);
+      if (gate_ > 0.0 && v * v > gate_ * gate_ * s) {
+        rejected_(i) = true;
+        continue;
+      }
+      c_.noalias() = S * k_;  // P*h
+      x += c_ * (v / s);
+
+      // S = S * (I - g/s * phi*phi'), g = 1 / (1 + sqrt(r/s))
+      g = 1.0 / (1.0 + std::sqrt(r_(i) / s));
+      S.noalias() -= (g / s) * c_ * k_.transpose();
+    }
+  }
+
+  /**
+   * @brief Measurement block
+   */
+  MatrixMX H_;      // observation matrix
+  VectorM dy_;      // innovation
+  VectorM r_;       // measurement variance (diagonal of R)
+  MaskM rejected_;  // measurements removed by the innovation gate
+
+ private:
+  /**
+   * *=== Gate ===*
+   * @brief Remove the measurements whose normalized innovation exceeds the gate from the block
+   * @param x   Error state vector
+   */
+  void Gate(const Eigen::Vector<T, NX> &x) {
+    v_ = dy_;
+    v_.noalias() -= H_ * x;
+    const T gsq = gate_ * gate_;
+    for (int i = 0; i < H_.rows(); i++) {
+      if (v_(i) * v_(i) > gsq * S_(i, i)) {
+        // a zero row of H (and PHt, with S_ii = 1) decouples the measurement from the update
+        H_.row(i).setZero();
+        PHt_.col(i).setZero();
+        S_.row(i).setZero();
+        S_.col(i).setZero();
+        S_(i, i) = 1.0;
+        dy_(i) = 0.0;
+        v_(i) = 0.0;
+        rejected_(i) = true;
+        layout_ = 0;
+      }
+    }
+  }
+
+  /**
+   * @brief Update scratch
+   */
+  MatrixM R_;  // full measurement covariance (only if dense_R_)
+  MatrixXM PHt_;
+  MatrixXM K_;
+  MatrixXM KR_;
+  MatrixMX KT_;
+  MatrixM S_;
+  VectorM v_;  // corrected innovation (gating)
+  Eigen::LLT<MatrixM> llt_;
+  Eigen::LDLT<MatrixM> ldlt_;
+  Eigen::Matrix<T, NX, NX> L_;
+  Eigen::Matrix<T, NX, NX> LP_;
+  Eigen::Vector<T, NX> h_;
+  Eigen::Vector<T, NX> c_;
+  Eigen::Vector<T, NX> k_;
+  T gate_;
+  T nis_;
+  bool dense_R_;
+  int layout_;
+};
+
+}  // namespace sturdins
+
+#endif
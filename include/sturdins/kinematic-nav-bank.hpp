@@ -0,0 +1,274 @@
+/**
+ * *kinematic-nav-bank.hpp*
+ *
+ * =======  ========================================================================================
+ * @file    sturdins/kinematic-nav-bank.hpp
+ * @brief   Structure-of-arrays bank of kinematic navigation Kalman Filters.
+ * @date    January 2025
+ * @author  Daniel Sturdivant <sturdivant20@gmail.com>
+ * @ref     1. "Principles of GNSS, Inertial, and Multisensor Integrated Navigation Systems", 2nd
+ *              Edition, 2013 - Groves
+ * =======  ========================================================================================
+ */
+
+#ifndef STURDINS_KNS_BANK_HPP
+#define STURDINS_KNS_BANK_HPP
+
+#include <Eigen/Dense>
+
+#include "sturdins/kinematic-nav.hpp"
+
+namespace sturdins {
+
+class KinematicNavBank;
+
+/**
+ * *=== KinematicNavView ===*
+ * @brief State access to a single filter (lane) of a KinematicNavBank, the states and covariance
+ *        reference the bank storage. This is not the KinematicNav API: the view only sets and
+ *        reads the states, Propagate and GnssUpdate run on every lane through the bank, and any
+ *        other KinematicNav method (attitude updates, GetStateVector, noise models, ...) needs the
+ *        lane copied out with KinematicNavBank::Get and back in with KinematicNavBank::Set
+ */
+class KinematicNavView {
+ public:
+  KinematicNavView(KinematicNavBank &bank, const int &i);
+
+  /**
+   * *=== SetPosition ===*
+   * @brief Set the position of the filter
+   * @param lat Latitude [rad]
+   * @param lon Longitude [rad]
+   * @param alt Altitude [m]
+   */
+  void SetPosition(const double &lat, const double &lon, const double &alt);
+
+  /**
+   * *=== SetVelocity ===*
+   * @brief Set the velocity of the filter
+   * @param veln   North Velocity [m/s]
+   * @param vele   East Velocity [m/s]
+   * @param veld   Down Velocity [m/s]
+   */
+  void SetVelocity(const double &veln, const double &vele, const double &veld);
+
+  /**
+   * *=== SetAttitude ===*
+   * @brief Set the attitude of the filter
+   * @param roll   Roll [rad]
+   * @param pitch  Pitch [rad]
+   * @param yaw    Yaw (heading) [rad]
+   */
+  void SetAttitude(const double &roll, const double &pitch, const double &yaw);
+  void SetAttitude(const Eigen::Ref<const Eigen::Matrix3d> &C);
+
+  /**
+   * *=== SetClock ===*
+   * @brief Set the clock states of the filter
+   * @param cb    Clock bias [m]
+   * @param cd    Clock drift [m/s]
+   */
+  void SetClock(const double &cb, const double &cd);
+
+  /**
+   * *=== P ===*
+   * @brief Element of the error state covariance (symmetric, P(i,j) and P(j,i) are the same entry)
+   * @param i   Row
+   * @param j   Column
+   */
+  double &P(const int &i, const int &j);
+
+  /**
+   * @brief states
+   */
+  double &phi_;  // Latitude [rad]
+  double &lam_;  // Longitude [rad]
+  double &h_;    // Altitude [m]
+  double &vn_;   // North velocity [m/s]
+  double &ve_;   // East velocity [m/s]
+  double &vd_;   // Down velocity [m/s]
+  double &cb_;   // clock bias [m]
+  double &cd_;   // clock drift [m/s]
+  Eigen::Map<Eigen::Vector4d> q_b_l_;
+  Eigen::Map<Eigen::Matrix3d> C_b_l_;
+
+ private:
+  KinematicNavBank &bank_;
+  int i_;
+};
+
+/**
+ * *=== KinematicNavBank ===*
+ * @brief N kinematic navigation filters stored as structure-of-arrays so Propagate and GnssUpdate
+ *        vectorize across filters. Each covariance element is a contiguous column over the lanes
+ *        (upper triangle only), measurements are processed sequentially (diagonal R).
+ */
+class KinematicNavBank {
+  friend class KinematicNavView;
+
+ public:
+  static constexpr int NX = 11;                 // error states per filter
+  static constexpr int NP = NX * (NX + 1) / 2;  // unique covariance elements per filter
+
+  /**
+   * *=== KinematicNavBank ===*
+   * @brief constructor, every lane is initialized as a default KinematicNav
+   * @param n   Number of filters (lanes)
+   */
+  KinematicNavBank(const int &n);
+
+  /**
+   * *=== Size ===*
+   * @brief Number of filters in the bank
+   */
+  int Size() const;
+
+  /**
+   * *=== operator[] ===*
+   * @brief Access a single filter of the bank
+   * @param i   Lane index
+   */
+  KinematicNavView operator[](const int &i);
+
+  /**
+   * *=== Set ===*
+   * @brief Copy the states, covariance, and noise parameters of a KinematicNav into a lane
+   * @param i     Lane index
+   * @param filt  Filter to copy
+   */
+  void Set(const int &i, const KinematicNav<> &filt);
+
+  /**
+   * *=== Get ===*
+   * @brief Copy a lane into a KinematicNav, the only route to the KinematicNav methods the bank
+   *        and KinematicNavView do not provide (copy the lane back with Set afterwards)
+   * @param i     Lane index
+   * @param filt  Filter to overwrite
+   */
+  void Get(const int &i, KinematicNav<> &filt) const;
+
+  /**
+   * * === SetClockSpec ===
+   * @brief Set the noise parameters of the Clock for every lane
+   * @param h0  white frequency modulation
+   * @param h1  flicker frequency modulation
+   * @param h2  random walk frequency modulation
+   */
+  void SetClockSpec(const double &h0, const double &h1, const double &h2);
+
+  /**
+   * * === SetProcessNoise ===
+   * @brief Set the noise parameter of the Kinematic (constant velocity) model for every lane
+   * @param Svel  PSD of expected acceleration white noise [(m/s^2)^2]
+   * @param Satt  PSD of expected angular rate white noise [(rad/s)^2]
+   */
+  void SetProcessNoise(const double &Svel, const double &Satt);
+
+  /**
+   * *=== Propagate ===*
+   * @brief Propagate the states and error state covariance of every lane
+   * @param dt  Integration time [s]
+   */
+  void Propagate(const double &dt);
+
+  /**
+   * *=== GnssUpdate ===*
+   * @brief Correct every lane with GPS measurements of a common set of satellites, a satellite is
+   *        skipped in a lane when its variance there is not positive (or not finite)
+   * @param sv_pos      Satellite ECEF positions [m]
+   * @param sv_vel      Satellite ECEF velocities [m/s]
+   * @param psr         Pseudorange measurements (lanes x satellites) [m]
+   * @param psrdot      Pseudorange-rate measurements (lanes x satellites) [m/s]
+   * @param psr_var     Pseudorange measurement variance (lanes x satellites) [m^2]
+   * @param psrdot_var  Pseudorange-rate measurement variance (lanes x satellites) [(m/s)^2]
+   */
+  void GnssUpdate(
+      const Eigen::Ref<const Eigen::Matrix3Xd> &sv_pos,
+      const Eigen::Ref<const Eigen::Matrix3Xd> &sv_vel,
+      const Eigen::Ref<const Eigen::MatrixXd> &psr,
+      const Eigen::Ref<const Eigen::MatrixXd> &psrdot,
+      const Eigen::Ref<const Eigen::MatrixXd> &psr_var,
+      const Eigen::Ref<const Eigen::MatrixXd> &psrdot_var);
+
+  /**
+   * @brief states (one entry per lane)
+   */
+  Eigen::ArrayXd phi_;  // Latitude [rad]
+  Eigen::ArrayXd lam_;  // Longitude [rad]
+  Eigen::ArrayXd h_;    // Altitude [m]
+  Eigen::ArrayXd vn_;   // North velocity [m/s]
+  Eigen::ArrayXd ve_;   // East velocity [m/s]
+  Eigen::ArrayXd vd_;   // Down velocity [m/s]
+  Eigen::ArrayXd cb_;   // clock bias [m]
+  Eigen::ArrayXd cd_;   // clock drift [m/s]
+  Eigen::Matrix4Xd q_b_l_;
+  Eigen::Matrix<double, 9, Eigen::Dynamic> C_b_l_;  // column-major 3x3 per lane
+  Eigen::ArrayXXd P_;  // packed upper triangle of the error state covariance (lanes x NP)
+
+  /**
+   * *=== Idx ===*
+   * @brief Column of P_ holding covariance element (i,j)
+   */
+  static constexpr int Idx(const int i, const int j) {
+    return (i <= j) ? (i * NX - i * (i - 1) / 2 + (j - i)) : Idx(j, i);
+  }
+
+ private:
+  int n_;
+
+  /**
+   * @brief Process noise allan variance parameters (one entry per lane)
+   */
+  Eigen::ArrayXd Sb_;
+  Eigen::ArrayXd Sbd_;
+  Eigen::ArrayXd Sd_;
+  Eigen::ArrayXd Sv_;
+  Eigen::ArrayXd Sa_;
+  double X1ME2_;
+  double LS2_;
+
+  /**
+   * @brief Update scratch (one entry per lane)
+   */
+  Eigen::ArrayXXd x_;  // error state vector (lanes x NX)
+  Eigen::ArrayXXd c_;  // P*h
+  Eigen::ArrayXXd k_;  // Kalman gain
+  Eigen::ArrayXd s_;   // innovation variance
+  Eigen::ArrayXd dy_;  // innovation
+  Eigen::ArrayXd one_;
+  Eigen::ArrayXd sL_, cL_, sLam_, cLam_, t_, Re_, He_, Hn_;
+  Eigen::ArrayXd px_, py_, pz_, vx_, vy_, vz_;
+  Eigen::ArrayXd r_, rr_, sw_, cw_, dx_, dy3_, dz_, dvx_, dvy_, dvz_, ux_, uy_, uz_;
+  Eigen::ArrayXd un_, ue_, ud_, udn_, ude_, udd_;
+
+  /**
+   * *=== RadiiOfCurvature ===*
+   * @brief Functions of latitude and radii of curvature of every lane
+   */
+  void RadiiOfCurvature();
+
+  /**
+   * *=== ScalarUpdate ===*
+   * @brief Rank-1 Joseph form update of every lane with one measurement row, only the nonzero
+   *        columns of the row are given
+   * @param idx   Columns of the nonzero observation entries
+   * @param h     Observation entries for every lane
+   * @param n     Number of nonzero entries
+   * @param var   Measurement variance of every lane
+   */
+  void ScalarUpdate(
+      const int *idx,
+      const Eigen::ArrayXd *const *h,
+      const int &n,
+      const Eigen::Ref<const Eigen::ArrayXd> &var);
+
+  /**
+   * *=== ClosedLoopCorrection ===*
+   * @brief Feed the accumulated error state of every lane back into the navigation states
+   */
+  void ClosedLoopCorrection();
+};
+
+}  // namespace sturdins
+
+#endif
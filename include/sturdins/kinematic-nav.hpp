@@ -17,11 +17,34 @@
 #define STURDINS_KNS_HPP
 
 #include <Eigen/Dense>
+#include <memory>
+
+#include "sturdins/geodetic-cache.hpp"
+#include "sturdins/kalman-update.hpp"
+#include "sturdins/least-squares.hpp"
+#include "sturdins/nav-snapshot.hpp"
+#include "sturdins/process-noise.hpp"
+#include "sturdins/state-layout.hpp"
 
 namespace sturdins {
 
+/**
+ * @brief Constant velocity GNSS filter on scalar type T (float or double). The covariance, error
+ *        state, velocity and attitude are of type T, position, clock and ECEF states as well as the
+ *        measurement predictions are always double. The error state layout is KinematicStateLayout
+ *        (11 states) or PositionStateLayout (8 states, no attitude, the attitude updates are not
+ *        available and the attitude members are left as set)
+ */
+template <typename T = double, class Layout = KinematicStateLayout>
 class KinematicNav {
+  friend class KinematicNavBank;
+  static_assert(
+      !Layout::HAS_ACC_BIAS && !Layout::HAS_GYR_BIAS && Layout::HAS_CLK,
+      "KinematicNav estimates position, velocity, (attitude) and the clock");
+
  public:
+  static constexpr int NX = Layout::NX;
+
   /**
    * *=== KinematicNav ===*
    * @brief constructor
@@ -91,6 +114,22 @@ class KinematicNav {
    */
   void SetClock(const double &cb, const double &cd);
 
+  /**
+   * *=== SetUpdateStrategy ===*
+   * @brief Choose between batch and sequential (scalar) measurement updates, sequential updates
+   *        avoid factorizing the innovation covariance and are cheaper for large constellations
+   * @param strategy  UpdateStrategy::BATCH (default) or UpdateStrategy::SEQUENTIAL
+   */
+  void SetUpdateStrategy(const UpdateStrategy &strategy);
+
+  /**
+   * *=== SetInnovationGate ===*
+   * @brief Reject measurements whose normalized innovation |dy| / sqrt(HPH' + R)_ii exceeds the
+   *        gate, rejected measurements are removed from the update in place (see rejected_)
+   * @param gate  Innovation gate [sigma] (0 disables gating, default)
+   */
+  void SetInnovationGate(const double &gate);
+
   /**
    * * === SetClockSpec ===
    * @brief Set the noise parameters of the Clock
@@ -108,6 +147,21 @@ class KinematicNav {
    */
   void SetProcessNoise(const double &Svel, const double &Satt);
 
+  /**
+   * *=== SetProcessNoiseModel ===*
+   * @brief Use a (shared) process noise model instead of the one built by SetClockSpec and
+   *        SetProcessNoise, propagation looks up the blocks of dt in the model (the IMU parameters
+   *        of the model are unused and its clock has no 10% margin)
+   * @param model   Process noise model
+   */
+  void SetProcessNoiseModel(const std::shared_ptr<const ProcessNoiseModel> &model);
+
+  /**
+   * *=== GetProcessNoiseModel ===*
+   * @brief Process noise model used by the filter
+   */
+  const std::shared_ptr<const ProcessNoiseModel> &GetProcessNoiseModel() const;
+
   /**
    * *=== Propagate ===*
    * @brief Propagate the error state matrices
@@ -141,7 +195,8 @@ class KinematicNav {
 
   /**
    * *=== PhasedArrayUpdate ===*
-   * @brief Correct state with GPS measurements
+   * @brief Correct state with GPS measurements, at most 2*MAX_SV - 1 antennas (n_ant + 1 rows per
+   *        satellite must fit in a measurement block, otherwise nothing is updated)
    * @param sv_pos      Satellite ECEF positions [m]
    * @param sv_vel      Satellite ECEF velocities [m/s]
    * @param psr         Pseudorange measurements [m]
@@ -160,10 +215,65 @@ class KinematicNav {
       const Eigen::Ref<const Eigen::MatrixXd> &phase_var,
       const Eigen::Ref<const Eigen::Matrix3Xd> &ant_xyz,
       const int &n_ant,
-      const double &lamb);
+      const double &lamb)
+    requires Layout::HAS_ATT;
 
   void AttitudeUpdate(
-      const Eigen::Ref<const Eigen::Matrix3d> &C, const Eigen::Ref<const Eigen::Matrix3d> &R);
+      const Eigen::Ref<const Eigen::Matrix3d> &C, const Eigen::Ref<const Eigen::Matrix3d> &R)
+    requires Layout::HAS_ATT;
+
+  /**
+   * *=== SaveSnapshot ===*
+   * @brief Copy the navigation states, clock and covariance into a caller-provided snapshot
+   * @param snap  Output snapshot
+   */
+  void SaveSnapshot(KinematicNavSnapshot<T, NX> &snap) const;
+
+  /**
+   * *=== RestoreSnapshot ===*
+   * @brief Set the navigation states, clock and covariance from a snapshot
+   * @param snap  Snapshot from SaveSnapshot (of this or another filter with the same settings)
+   */
+  void RestoreSnapshot(const KinematicNavSnapshot<T, NX> &snap);
+
+  /**
+   * *=== GetStateVector ===*
+   * @brief Copy the navigation states into a caller-provided buffer (does not allocate)
+   *        [lat, lon, alt, vn, ve, vd, q0, q1, q2, q3, cb, cd] (without the quaternion if the
+   *        layout has no attitude)
+   * @param x   Output buffer (STATE_SIZE elements)
+   */
+  void GetStateVector(Eigen::Ref<Eigen::VectorXd> x) const;
+  static constexpr int STATE_SIZE = Layout::HAS_ATT ? 12 : 8;
+  static constexpr int ERROR_SIZE = NX;
+  using Snapshot = KinematicNavSnapshot<T, NX>;
+
+  /**
+   * *=== SetSmootherLog ===*
+   * @brief Log the transition, predicted covariance and corrections between calls to
+   *        TakeSmootherLog (see RtsSmoother), off by default
+   * @param enable  True to log
+   */
+  void SetSmootherLog(const bool &enable);
+
+  /**
+   * *=== TakeSmootherLog ===*
+   * @brief Copy out the log since the last call and restart it. Measurement updates must only
+   *        follow the last propagation of the interval (take the log after the updates of each
+   *        epoch)
+   * @param Phi     Transition since the last call (product of the propagations)
+   * @param P_pred  Covariance after the last propagation, before the updates
+   * @param dx      Corrections applied since the last propagation
+   */
+  void TakeSmootherLog(
+      Eigen::Matrix<T, NX, NX> &Phi, Eigen::Matrix<T, NX, NX> &P_pred, Eigen::Vector<T, NX> &dx);
+
+  /**
+   * *=== CorrectState ===*
+   * @brief Feed an error state back into the navigation states (as a measurement update does)
+   * @param dx  Error state [pos ned, vel ned, att ned, clock bias, clock drift] (see Layout)
+   */
+  void CorrectState(const Eigen::Ref<const Eigen::Vector<T, NX>> &dx);
 
   /**
    * @brief states
@@ -171,61 +281,78 @@ class KinematicNav {
   double phi_;  // Latitude [rad]
   double lam_;  // Longitude [rad]
   double h_;    // Altitude [m]
-  double vn_;   // North velocity [m/s]
-  double ve_;   // East velocity [m/s]
-  double vd_;   // Down velocity [m/s]
+  T vn_;        // North velocity [m/s]
+  T ve_;        // East velocity [m/s]
+  T vd_;        // Down velocity [m/s]
   double cb_;   // clock bias [m]
   double cd_;   // clock drift [m/s]
   Eigen::Vector3d ecef_p_;
   Eigen::Vector3d ecef_v_;
-  Eigen::Vector4d q_b_l_;
-  Eigen::Matrix3d C_b_l_;
-  Eigen::Matrix<double, 11, 11> P_;  // error state covariance
+  Eigen::Vector4<T> q_b_l_;
+  Eigen::Matrix3<T> C_b_l_;
+  Eigen::Matrix<T, NX, NX> P_;  // error state covariance
+
+  /**
+   * @brief Measurements rejected by the innovation gate in the most recent update, ordered as its
+   *        inputs [psr; psrdot; phase (n_ant - 1 per satellite)]
+   */
+  Eigen::VectorX<bool> rejected_;
 
  private:
   /**
-   * @brief Process noise allan variance parameters
+   * @brief Process noise allan variance parameters and their process noise model
    */
-  double Sb_;
-  double Sbd_;
-  double Sd_;
+  NavigationClock clock_;
   double Sv_;
   double Sa_;
-  double halfSv_;
-  double thirdSv_;
+  std::shared_ptr<const ProcessNoiseModel> noise_;
+  double q_dt_;  // integration time Q_ was filled for (0 if stale)
 
   /**
    * @brief Kalman Filter Matrices (these have constant size)
    */
-  Eigen::Vector<double, 11> x_;      // error state vector
-  Eigen::Matrix<double, 11, 11> F_;  // state transition matrix
-  Eigen::Matrix<double, 11, 11> Q_;  // process covariance matrix
-  Eigen::Matrix<double, 11, 11> I11_;
+  Eigen::Vector<T, NX> x_;                 // error state vector
+  Eigen::Matrix<T, NX, NX> F_;             // state transition matrix
+  Eigen::Matrix<T, NX, NX> Q_;             // process covariance matrix
+  KalmanWorkspace<NX, 2 * MAX_SV, T> ws_;  // measurement workspace
+  RangeAndRateBuffer<MAX_SV> pred_;        // measurement predictions
+  UpdateStrategy strategy_;
   bool is_init_;
+  PhaseDifferenceBuffer<MAX_SV, 2 * MAX_SV> phase_pred_;  // phased array predictions
+
+  /**
+   * @brief Functions of latitude, radii of curvature and the ECEF position/rotation
+   */
+  GeodeticCache geo_;
 
   /**
-   * @brief Functions of latitude
+   * @brief Smoother log (see SetSmootherLog)
    */
-  double sL_;    // sin(phi)
-  double cL_;    // cos(phi)
-  double sLsq_;  // sin(phi)^2
+  bool log_;
+  int n_log_;                         // propagations since the last TakeSmootherLog
+  Eigen::Matrix<T, NX, NX> Phi_log_;  // transition since the last TakeSmootherLog
+  Eigen::Matrix<T, NX, NX> P_log_;    // covariance after the last propagation
+  Eigen::Vector<T, NX> dx_log_;       // corrections since the last propagation
 
   /**
-   * @brief Radii of curvature
+   * *=== KalmanUpdate ===*
+   * @brief Update the error state and covariance with the measurement block in the workspace
    */
-  double X1ME2_;  // 1 - e^2
-  double Re_;     // Meridian radius
-  double Rn_;     // Transverse radius
-  double Hn_;     // Rn + h
-  double He_;     // Re + h
-  double LS2_;
+  void KalmanUpdate();
 
-  void KalmanUpdate(
-      const Eigen::Ref<const Eigen::MatrixXd> &R,
-      const Eigen::Ref<const Eigen::MatrixXd> &H,
-      const Eigen::Ref<const Eigen::VectorXd> &dy);
+  /**
+   * *=== ClosedLoopCorrection ===*
+   * @brief Feed the accumulated error state back into the navigation states
+   */
+  void ClosedLoopCorrection();
 };
 
+/**
+ * @brief KinematicNav without attitude (8 error states)
+ */
+template <typename T = double>
+using PositionNav = KinematicNav<T, PositionStateLayout>;
+
 }  // namespace sturdins
 
 #endif
\ No newline at end of file
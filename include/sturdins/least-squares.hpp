@@ -11,13 +11,14 @@
  * =======  ========================================================================================
  */
 
-// TODO: gradient descent, levenburg-marquardt
 // TODO: maybe a particle filter?
 
 #ifndef STURDINS_LEAST_SQUARES_HPP
 #define STURDINS_LEAST_SQUARES_HPP
 
 #include <Eigen/Dense>
+#include <cstddef>
+#include <navtools/constants.hpp>
 
 namespace sturdins {
 
@@ -47,6 +48,133 @@ void RangeAndRate(
     double &pred_psr,
     double &pred_psrdot);
 
+/**
+ * *=== BatchRangeAndRate ===*
+ * @brief predicts the ranges and rates of a set of satellites in one pass, vectorized across the
+ *        satellites (outputs are structure-of-arrays, one satellite per row)
+ * @param pos         3x1 User ECEF position [m]
+ * @param vel         3x1 User ECEF velocity [m/s]
+ * @param cb          User clock bias [m]
+ * @param cd          User clock drift [m/s]
+ * @param sv_pos      3xN Satellite ECEF positions [m]
+ * @param sv_vel      3xN Satellite ECEF velocities [m/s]
+ * @param u           Nx3 reference to unit vectors to satellites
+ * @param udot        Nx3 reference to unit vector rates of change to satellites
+ * @param pred_psr    Nx1 reference to pseudorange predictions
+ * @param pred_psrdot Nx1 reference to pseudorange-rate predictions
+ */
+void BatchRangeAndRate(
+    const Eigen::Ref<const Eigen::Vector3d> &pos,
+    const Eigen::Ref<const Eigen::Vector3d> &vel,
+    const double &cb,
+    const double &cd,
+    const Eigen::Ref<const Eigen::Matrix3Xd> &sv_pos,
+    const Eigen::Ref<const Eigen::Matrix3Xd> &sv_vel,
+    Eigen::Ref<Eigen::MatrixX3d> u,
+    Eigen::Ref<Eigen::MatrixX3d> udot,
+    Eigen::Ref<Eigen::VectorXd> pred_psr,
+    Eigen::Ref<Eigen::VectorXd> pred_psrdot);
+
+/**
+ * *=== RangeAndRateBuffer ===*
+ * @brief Caller-owned outputs of BatchRangeAndRate, with a compile-time capacity the prediction
+ *        never touches the heap
+ * @tparam MaxN Maximum number of satellites
+ */
+template <int MaxN = Eigen::Dynamic>
+struct RangeAndRateBuffer {
+  Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::ColMajor, MaxN, 3> u_;     // unit vectors
+  Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::ColMajor, MaxN, 3> udot_;  // unit vector rates
+  Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::ColMajor, MaxN, 1> psr_;     // pseudoranges
+  Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::ColMajor, MaxN, 1> psrdot_;  // pseudorange-rates
+
+  /**
+   * *=== Predict ===*
+   * @brief Resize to the number of satellites and run BatchRangeAndRate
+   */
+  void Predict(
+      const Eigen::Ref<const Eigen::Vector3d> &pos,
+      const Eigen::Ref<const Eigen::Vector3d> &vel,
+      const double &cb,
+      const double &cd,
+      const Eigen::Ref<const Eigen::Matrix3Xd> &sv_pos,
+      const Eigen::Ref<const Eigen::Matrix3Xd> &sv_vel) {
+    const int N = sv_pos.cols();
+    u_.resize(N, 3);
+    udot_.resize(N, 3);
+    psr_.resize(N);
+    psrdot_.resize(N);
+    BatchRangeAndRate(pos, vel, cb, cd, sv_pos, sv_vel, u_, udot_, psr_, psrdot_);
+  }
+};
+
+/**
+ * *=== BatchPhaseDifference ===*
+ * @brief predicts the differential phase of every satellite/antenna pair of an array in one pass,
+ *        the predictions are a single matrix product and the attitude jacobian is three rank-one
+ *        updates (outputs are satellite major, the antennas of a satellite are contiguous)
+ * @param ant_ned     3xA Antenna positions in the local-nav frame relative to the reference [m]
+ * @param u_ned       Nx3 Unit vectors to the satellites in the local-nav frame
+ * @param phase       AxN Measured differential phase [rad]
+ * @param lamb        Wavelength for the signal of interest [m/rad]
+ * @param jac_scale   Scale of the attitude jacobian (attitude error convention of the filter)
+ * @param dy          A*N reference to phase residuals, wrapped to [-pi, pi] [rad]
+ * @param H           A*Nx3 reference to attitude jacobian rows
+ */
+void BatchPhaseDifference(
+    const Eigen::Ref<const Eigen::Matrix3Xd> &ant_ned,
+    const Eigen::Ref<const Eigen::MatrixX3d> &u_ned,
+    const Eigen::Ref<const Eigen::MatrixXd> &phase,
+    const double &lamb,
+    const double &jac_scale,
+    Eigen::Ref<Eigen::VectorXd> dy,
+    Eigen::Ref<Eigen::MatrixX3d> H);
+
+/**
+ * *=== PhaseDifferenceBuffer ===*
+ * @brief Caller-owned inputs and outputs of BatchPhaseDifference, with a compile-time capacity the
+ *        prediction never touches the heap
+ * @tparam MaxN Maximum number of satellites
+ * @tparam MaxM Maximum number of antennas and of satellite/antenna pairs
+ */
+template <int MaxN = Eigen::Dynamic, int MaxM = Eigen::Dynamic>
+struct PhaseDifferenceBuffer {
+  Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::ColMajor, MaxN, 3> u_;    // unit vectors (ned)
+  Eigen::Matrix<double, 3, Eigen::Dynamic, Eigen::ColMajor, 3, MaxM> ant_;  // antennas (ned)
+  Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::ColMajor, MaxM, 1> dy_;   // phase residuals
+  Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::ColMajor, MaxM, 3> H_;    // attitude jacobian
+
+  /**
+   * *=== Predict ===*
+   * @brief Rotate the unit vectors and antennas into the local-nav frame, resize to the number of
+   *        pairs and run BatchPhaseDifference
+   * @param C_b_l       Body to local-nav frame attitude dcm
+   * @param C_l_e       Local-nav to ECEF frame dcm
+   * @param u_ecef      Nx3 ECEF unit vectors to the satellites (RangeAndRateBuffer::u_)
+   * @param phase       AxN Measured differential phase [rad]
+   * @param ant_xyz     3xA Antenna positions in the body frame relative to the reference [m]
+   * @param lamb        Wavelength for the signal of interest [m/rad]
+   * @param jac_scale   Scale of the attitude jacobian
+   */
+  void Predict(
+      const Eigen::Ref<const Eigen::Matrix3d> &C_b_l,
+      const Eigen::Ref<const Eigen::Matrix3d> &C_l_e,
+      const Eigen::Ref<const Eigen::MatrixX3d> &u_ecef,
+      const Eigen::Ref<const Eigen::MatrixXd> &phase,
+      const Eigen::Ref<const Eigen::Matrix3Xd> &ant_xyz,
+      const double &lamb,
+      const double &jac_scale) {
+    const int M = phase.size();
+    u_.resize(u_ecef.rows(), 3);
+    ant_.resize(3, ant_xyz.cols());
+    dy_.resize(M);
+    H_.resize(M, 3);
+    u_.noalias() = u_ecef * C_l_e;
+    ant_.noalias() = C_b_l * ant_xyz;
+    BatchPhaseDifference(ant_, u_, phase, lamb, jac_scale, dy_, H_);
+  }
+};
+
 /**
  * *=== GnssPVT ===*
  * @brief Least Squares solver for GNSS position, velocity, and timing terms
@@ -69,9 +197,275 @@ bool GnssPVT(
     const Eigen::Ref<const Eigen::VectorXd> &psr_var,
     const Eigen::Ref<const Eigen::VectorXd> &psrdot_var);
 
+/**
+ * @brief Loss applied to the normalized residuals by GnssPVTWorkspace::SolveRobust
+ */
+enum class RobustLoss { NONE, HUBER, TUKEY };
+
+/**
+ * *=== GnssPVTResult ===*
+ * @brief Convergence diagnostics of a GnssPVTWorkspace::SolveRobust, residuals are normalized by
+ *        their standard deviation
+ */
+struct GnssPVTResult {
+  bool converged_;    // step below the threshold within the iteration limit
+  int iterations_;    // linear solves (accepted and rejected steps)
+  double cost_;       // final loss, sum of rho(z) (z^2 / 2 without a robust loss)
+  double test_stat_;  // sum of z^2 over all measurements (chi-square with dof_ when fault free)
+  int dof_;           // redundancy, 2 * n_sv - 8
+  int n_outliers_;    // measurements with |z| > k
+};
+
+/**
+ * *=== GnssPVTWorkspace ===*
+ * @brief Persistent GnssPVT solver, the 8x8 normal equations are accumulated directly from the
+ *        unit vectors and weights (the clock columns of H are implicit), and a satellite's
+ *        contribution is only refreshed when its geometry moves beyond a tolerance, so iterations
+ *        (and calls) with unchanged geometry reuse the factorization
+ */
+class GnssPVTWorkspace {
+ public:
+  /**
+   * *=== GnssPVTWorkspace ===*
+   * @brief constructor
+   * @param tol   Largest change in a unit vector (or unit vector rate [1/s]) before the
+   *              satellite's rows of the normal equations are refreshed
+   */
+  GnssPVTWorkspace(const double &tol = 1e-6);
+
+  /**
+   * *=== Solve ===*
+   * @brief Least Squares solver for GNSS position, velocity, and timing terms (see GnssPVT)
+   * @param x           Initial state estimate
+   * @param P           Initial covariance estimate
+   * @param sv_pos      Satellite ECEF positions [m]
+   * @param sv_vel      Satellite ECEF velocities [m/s]
+   * @param psr         Pseudorange measurements [m]
+   * @param psrdot      Pseudorange-rate measurements [m/s]
+   * @param psr_var     Pseudorange measurement variance [m^2]
+   * @param psrdot_var  Pseudorange-rate measurement variance [(m/s)^2]
+   * @returns True if the solution converged
+   */
+  bool Solve(
+      Eigen::Ref<Eigen::VectorXd> x,
+      Eigen::Ref<Eigen::MatrixXd> P,
+      const Eigen::Ref<const Eigen::Matrix3Xd> &sv_pos,
+      const Eigen::Ref<const Eigen::Matrix3Xd> &sv_vel,
+      const Eigen::Ref<const Eigen::VectorXd> &psr,
+      const Eigen::Ref<const Eigen::VectorXd> &psrdot,
+      const Eigen::Ref<const Eigen::VectorXd> &psr_var,
+      const Eigen::Ref<const Eigen::VectorXd> &psrdot_var);
+
+  /**
+   * *=== SolveRobust ===*
+   * @brief Levenberg-Marquardt solver for GNSS position, velocity, and timing terms for cold
+   *        starts and measurement faults. Steps are damped by mu * diag(H'WH) with mu adapted
+   *        from the ratio of actual to predicted cost reduction, so steps that increase the cost
+   *        are rejected. Once the least squares fit settles (step below 1 m) the residuals are
+   *        reweighted (IRLS) with the robust loss, which bounds the pull of faulty measurements.
+   *        Tukey removes them entirely but needs a good start, it is run from a Huber fit
+   * @param x           Initial state estimate
+   * @param P           Covariance estimate (with the final robust weights)
+   * @param sv_pos      Satellite ECEF positions [m]
+   * @param sv_vel      Satellite ECEF velocities [m/s]
+   * @param psr         Pseudorange measurements [m]
+   * @param psrdot      Pseudorange-rate measurements [m/s]
+   * @param psr_var     Pseudorange measurement variance [m^2]
+   * @param psrdot_var  Pseudorange-rate measurement variance [(m/s)^2]
+   * @param loss        Robust loss
+   * @param k           Loss threshold on the normalized residual (1.345 Huber, 4.685 Tukey)
+   * @param max_iter    Iteration limit
+   * @returns Convergence diagnostics
+   */
+  GnssPVTResult SolveRobust(
+      Eigen::Ref<Eigen::VectorXd> x,
+      Eigen::Ref<Eigen::MatrixXd> P,
+      const Eigen::Ref<const Eigen::Matrix3Xd> &sv_pos,
+      const Eigen::Ref<const Eigen::Matrix3Xd> &sv_vel,
+      const Eigen::Ref<const Eigen::VectorXd> &psr,
+      const Eigen::Ref<const Eigen::VectorXd> &psrdot,
+      const Eigen::Ref<const Eigen::VectorXd> &psr_var,
+      const Eigen::Ref<const Eigen::VectorXd> &psrdot_var,
+      const RobustLoss &loss = RobustLoss::HUBER,
+      const double &k = 1.345,
+      const int &max_iter = 20);
+
+  /**
+   * *=== RowsRefreshed ===*
+   * @brief Number of satellite contributions (re)built during the last Solve
+   */
+  int RowsRefreshed() const;
+
+  /**
+   * *=== Iterations ===*
+   * @brief Number of iterations of the last Solve
+   */
+  int Iterations() const;
+
+  /**
+   * *=== Reset ===*
+   * @brief Forget the stored geometry, the next Solve rebuilds the normal equations (as GnssPVT
+   *        does) without releasing the buffers
+   */
+  void Reset();
+
+ private:
+  /**
+   * *=== Accumulate ===*
+   * @brief Add (sign = 1) or remove (sign = -1) satellite i from the normal equations
+   */
+  void Accumulate(const int &i, const double &sign);
+
+  /**
+   * *=== Rebuild ===*
+   * @brief Rebuild the normal equations and H'*W*dy from the stored geometry, weights and
+   *        weighted residuals
+   */
+  void Rebuild();
+
+  /**
+   * *=== Evaluate ===*
+   * @brief Loss of the residuals to a prediction, storing the (robust) weights and weighted
+   *        residuals
+   */
+  double Evaluate(
+      const RangeAndRateBuffer<> &pred,
+      const Eigen::Ref<const Eigen::VectorXd> &psr,
+      const Eigen::Ref<const Eigen::VectorXd> &psrdot,
+      const Eigen::Ref<const Eigen::VectorXd> &psr_var,
+      const Eigen::Ref<const Eigen::VectorXd> &psrdot_var,
+      const RobustLoss &loss,
+      const double &k);
+
+  double tol_;
+  int refreshed_;
+  int iterations_;
+  int n_incremental_;  // incremental refreshes since the normal equations were rebuilt
+  bool stale_;
+
+  // geometry currently in the normal equations (one satellite per row)
+  RangeAndRateBuffer<> pred_;
+  RangeAndRateBuffer<> trial_;  // prediction at a Levenberg-Marquardt trial step
+  Eigen::MatrixX3d u_;
+  Eigen::MatrixX3d udot_;
+  Eigen::VectorXd wp_;  // pseudorange weights
+  Eigen::VectorXd wd_;  // pseudorange-rate weights
+  Eigen::VectorXd dyp_;
+  Eigen::VectorXd dyd_;
+
+  // normal equations
+  Eigen::Matrix<double, 8, 8> HtWH_;
+  Eigen::Vector<double, 8> HtWdy_;
+  Eigen::Vector<double, 8> dx_;
+  Eigen::LLT<Eigen::Matrix<double, 8, 8>> llt_;
+  Eigen::LDLT<Eigen::Matrix<double, 8, 8>> ldlt_;
+  bool use_ldlt_;
+};
+
+/**
+ * *=== BatchGnssPVT ===*
+ * @brief Solve many independent GnssPVT problems (e.g. from different receivers) in parallel,
+ *        epochs are handed to the workers in small chunks and each worker keeps its own
+ *        GnssPVTWorkspace. Every epoch is solved from its own initial state, so the results are
+ *        identical to GnssPVT and do not depend on the number of threads
+ * @param x           8xE initial state estimates, one epoch per column (solutions on return)
+ * @param P           8x8E covariance estimates, epoch e in columns 8e to 8e+7
+ * @param converged   E convergence flags
+ * @param offsets     First satellite column of each epoch (size E + 1)
+ * @param sv_pos      Satellite ECEF positions of all epochs [m]
+ * @param sv_vel      Satellite ECEF velocities of all epochs [m/s]
+ * @param psr         Pseudorange measurements of all epochs [m]
+ * @param psrdot      Pseudorange-rate measurements of all epochs [m/s]
+ * @param psr_var     Pseudorange measurement variance of all epochs [m^2]
+ * @param psrdot_var  Pseudorange-rate measurement variance of all epochs [(m/s)^2]
+ * @param n_threads   Worker threads (0 uses every core)
+ * @returns Number of converged epochs
+ */
+int BatchGnssPVT(
+    Eigen::Ref<Eigen::MatrixXd> x,
+    Eigen::Ref<Eigen::MatrixXd> P,
+    Eigen::Ref<Eigen::Vector<bool, Eigen::Dynamic>> converged,
+    const Eigen::Ref<const Eigen::VectorXi> &offsets,
+    const Eigen::Ref<const Eigen::Matrix3Xd> &sv_pos,
+    const Eigen::Ref<const Eigen::Matrix3Xd> &sv_vel,
+    const Eigen::Ref<const Eigen::VectorXd> &psr,
+    const Eigen::Ref<const Eigen::VectorXd> &psrdot,
+    const Eigen::Ref<const Eigen::VectorXd> &psr_var,
+    const Eigen::Ref<const Eigen::VectorXd> &psrdot_var,
+    const int &n_threads = 0);
+
+/**
+ * *=== PhasedArrayResult ===*
+ * @brief Outcome of a PhasedArrayAttitudeSolver::Solve
+ */
+struct PhasedArrayResult {
+  bool converged_;  // step below the threshold within the iteration limit
+  int iterations_;  // Gauss-Newton iterations run
+  double step_;     // squared norm of the last attitude correction [rad^2]
+};
+
+/**
+ * *=== PhasedArrayAttitudeSolver ===*
+ * @brief Persistent PhasedArrayAttitude solver for calling once per epoch (per array). The phase
+ *        weights are kept as a vector and the 3x3 normal equations are accumulated per antenna
+ *        from sums over the satellites formed once per call, the attitude correction is applied in
+ *        closed form (Rodrigues) and the buffers are only resized when the array or constellation
+ *        grows. The phase residuals are wrapped to [-pi, pi], so near a warm start (the previous
+ *        epoch's solution) whole cycle ambiguities of long baselines resolve to the nearest cycle
+ */
+class PhasedArrayAttitudeSolver {
+ public:
+  /**
+   * *=== PhasedArrayAttitudeSolver ===*
+   * @brief constructor
+   * @param thresh    Convergence threshold on the squared attitude correction [rad^2]
+   * @param max_iter  Iteration limit
+   */
+  PhasedArrayAttitudeSolver(const double &thresh = 1e-6, const int &max_iter = 10);
+
+  /**
+   * *=== Solve ===*
+   * @brief Iterative attitude estimate based on the known spatial phase of an antenna array
+   * @param C_b_l           Initial estimate of the body to local-nav frame attitude dcm (solution
+   *                        on return)
+   * @param u_ned           3 x n_sv Ephemeris based unit vectors in the local-nav frame
+   * @param meas_phase      n_ant x n_sv matrix of measured differential gnss phase values
+   * @param meas_phase_var  Variance of each phase measurement
+   * @param ant_xyz         Known antenna positions in the body frame
+   * @param n_ant           Known number of antennas in the array
+   * @param lambda          Wavelength for the signal of interest [m/rad]
+   * @param warm_start      Start from the previous solution instead of C_b_l (if there is one)
+   * @returns Convergence and iteration count
+   */
+  PhasedArrayResult Solve(
+      Eigen::Ref<Eigen::Matrix3d> C_b_l,
+      const Eigen::Ref<const Eigen::Matrix3Xd> &u_ned,
+      const Eigen::Ref<const Eigen::MatrixXd> &meas_phase,
+      const Eigen::Ref<const Eigen::MatrixXd> &meas_phase_var,
+      const Eigen::Ref<const Eigen::MatrixXd> &ant_xyz,
+      const int &n_ant,
+      const double &lambda,
+      const bool &warm_start = false);
+
+  /**
+   * *=== Reset ===*
+   * @brief Forget the previous solution (the next warm start uses the caller's C_b_l)
+   */
+  void Reset();
+
+ private:
+  double thresh_;
+  int max_iter_;
+  bool has_prev_;
+  Eigen::Matrix3d C_prev_;
+  Eigen::VectorXd w_;   // n_ant x n_sv phase weights
+  Eigen::Matrix3Xd G_;  // per antenna 3x3 sums of the weighted unit vector outer products
+};
+
 /**
  * *=== PhasedArrayAttitude ===*
- * @brief Iterative attitude estimate based on the known spatial phase of an antenna array
+ * @brief Iterative attitude estimate based on the known spatial phase of an antenna array (a
+ *        single cold PhasedArrayAttitudeSolver::Solve)
  * @param C_b_l           Initial estimate of the body to local-nav frame attitude dcm
  * @param u_ned           3 x n_sv Ephemeris based unit vectors in the local-nav frame
  * @param meas_phase      n_ant x n_sv matrix of measured differential gnss phase values
@@ -80,6 +474,7 @@ bool GnssPVT(
  * @param n_ant           Known number of antennas in the array
  * @param lambda          Wavelength for the signal of interest [m/rad]
  * @param thresh          Desired threshold of convergence
+ * @returns True if the solution converged
  */
 bool PhasedArrayAttitude(
     Eigen::Ref<Eigen::Matrix3d> C_b_l,
@@ -107,7 +502,8 @@ void Wahba(
 
 /**
  * *=== MUSIC ===*
- * @brief MUSIC estimator using Prompt correlators (I & Q)
+ * @brief MUSIC estimator using Prompt correlators (I & Q), the spectrum is searched on a 1 deg
+ *        grid which is refined by 10x around the peak until the resolution reaches thresh
  * @param az_mean   Azimuth estimates [rad]
  * @param el_mean   Elevation estimates [rad]
  * @param P         Measured prompt correlators
@@ -115,6 +511,7 @@ void Wahba(
  * @param n_ant     Known number of antennas in the array
  * @param lambda    Wavelength for the signal of interest [m/rad]
  * @param thresh    Desired threshold of convergence
+ * @param n_threads Threads used for the coarse grid (0 uses every core)
  */
 void MUSIC(
     double &az_mean,
@@ -123,7 +520,81 @@ void MUSIC(
     const Eigen::Ref<const Eigen::Matrix3Xd> &ant_xyz,
     const int &n_ant,
     const double &lambda,
-    const double &thresh = 1e-4);
+    const double &thresh = 1e-4,
+    const int &n_threads = 0);
+
+/**
+ * *=== MusicManifold ===*
+ * @brief MUSIC estimator for a fixed antenna array, the cos/sin of every baseline phase on the
+ *        coarse grid (az = [-180, 180] deg, el = [-90, 0] deg) is cached at construction so the
+ *        coarse search of each call is a single matrix-vector product
+ */
+class MusicManifold {
+ public:
+  /**
+   * *=== MusicManifold ===*
+   * @brief constructor
+   * @param ant_xyz   Known antenna positions in the body frame
+   * @param n_ant     Known number of antennas in the array
+   * @param lambda    Wavelength for the signal of interest [m/rad]
+   * @param res       Resolution of the cached coarse grid [rad]
+   */
+  MusicManifold(
+      const Eigen::Ref<const Eigen::Matrix3Xd> &ant_xyz,
+      const int &n_ant,
+      const double &lambda,
+      const double &res = navtools::DEG2RAD<>);
+
+  /**
+   * *=== Estimate ===*
+   * @brief MUSIC estimate using Prompt correlators (I & Q), the cached grid is refined by 10x
+   *        around the peak until the resolution reaches thresh
+   * @param az_mean   Azimuth estimates [rad]
+   * @param el_mean   Elevation estimates [rad]
+   * @param P         Measured prompt correlators
+   * @param thresh    Desired threshold of convergence
+   */
+  void Estimate(
+      double &az_mean,
+      double &el_mean,
+      const Eigen::Ref<const Eigen::VectorXcd> &P,
+      const double &thresh = 1e-4);
+
+  /**
+   * *=== GridSize ===*
+   * @brief Number of (az, el) points in the cached coarse grid
+   */
+  int GridSize() const;
+
+  /**
+   * *=== MemoryFootprint ===*
+   * @brief Memory held by the cached manifold and the estimator buffers [bytes]
+   */
+  std::size_t MemoryFootprint() const;
+
+ private:
+  int n_ant_;
+  int n_base_;
+  double res_;
+  int na_;
+  int ne_;
+
+  // antenna baselines (scaled by 1/lambda) and coarse grid
+  Eigen::Matrix3Xd base_;
+  Eigen::ArrayXd az_;
+  Eigen::ArrayXd el_;
+
+  // cached manifold, [cos(phase) sin(phase)] of every baseline, one grid point (az major) per row
+  Eigen::MatrixXd manifold_;
+
+  // per call buffers
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXcd> eig_;
+  Eigen::MatrixXcd S_;
+  Eigen::VectorXd w_;
+  Eigen::VectorXd d_;
+  Eigen::ArrayXXd grid_;
+  Eigen::ArrayXXd work_;
+};
 
 }  // namespace sturdins
 
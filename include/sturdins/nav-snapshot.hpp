@@ -0,0 +1,136 @@
+/**
+ * *nav-snapshot.hpp*
+ *
+ * =======  ========================================================================================
+ * @file    sturdins/nav-snapshot.hpp
+ * @brief   Fixed-size snapshots of the navigation filter states and covariance.
+ * @date    January 2025
+ * @author  Daniel Sturdivant <sturdivant20@gmail.com>
+ * =======  ========================================================================================
+ */
+
+#ifndef STURDINS_NAV_SNAPSHOT_HPP
+#define STURDINS_NAV_SNAPSHOT_HPP
+
+#include <Eigen/Dense>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace sturdins {
+
+/**
+ * @brief Number of elements in the packed upper triangle of an N x N matrix
+ */
+template <int N>
+inline constexpr int PACKED_SIZE = N * (N + 1) / 2;
+
+/**
+ * *=== PackUpper ===*
+ * @brief Copy the upper triangle of a symmetric matrix column by column into a packed array
+ * @param out Packed array of PACKED_SIZE<N> elements
+ * @param P   Symmetric matrix
+ */
+template <typename T, int N>
+inline void PackUpper(T *out, const Eigen::Matrix<T, N, N> &P) {
+  for (int j = 0, k = 0; j < N; j++) {
+    std::memcpy(out + k, P.col(j).data(), (j + 1) * sizeof(T));
+    k += j + 1;
+  }
+}
+
+/**
+ * *=== UnpackUpper ===*
+ * @brief Fill a symmetric matrix from its packed upper triangle (the lower triangle is mirrored)
+ * @param P   Output symmetric matrix
+ * @param in  Packed array of PACKED_SIZE<N> elements
+ */
+template <typename T, int N>
+inline void UnpackUpper(Eigen::Matrix<T, N, N> &P, const T *in) {
+  for (int j = 0, k = 0; j < N; j++) {
+    std::memcpy(P.col(j).data(), in + k, (j + 1) * sizeof(T));
+    k += j + 1;
+  }
+  P.template triangularView<Eigen::StrictlyLower>() = P.transpose();
+}
+
+/**
+ * *=== InertialNavSnapshot ===*
+ * @brief Navigation states, biases, clock and packed covariance of an InertialNav. Plain data of a
+ *        fixed size, so snapshots can live in preallocated arrays and be copied as bytes (filter
+ *        settings and workspaces are not included)
+ */
+template <typename T = double>
+struct InertialNavSnapshot {
+  double pos_[3];         // latitude [rad], longitude [rad], altitude [m]
+  T vel_[3];              // ned velocity [m/s]
+  T q_b_l_[4];            // body-to-ned quaternion
+  T C_b_l_[9];            // body-to-ned rotation (column major)
+  T bg_[3];               // gyroscope bias [rad/s]
+  T ba_[3];               // accelerometer bias [m/s^2]
+  double clk_[2];         // clock bias [m], clock drift [m/s]
+  T P_[PACKED_SIZE<17>];  // error state covariance (packed upper triangle)
+  bool is_init_;
+};
+
+/**
+ * *=== KinematicNavSnapshot ===*
+ * @brief Navigation states, clock and packed covariance of a KinematicNav with NX error states
+ *        (see InertialNavSnapshot)
+ */
+template <typename T = double, int NX = 11>
+struct KinematicNavSnapshot {
+  double pos_[3];         // latitude [rad], longitude [rad], altitude [m]
+  T vel_[3];              // ned velocity [m/s]
+  T q_b_l_[4];            // body-to-ned quaternion
+  T C_b_l_[9];            // body-to-ned rotation (column major)
+  double clk_[2];         // clock bias [m], clock drift [m/s]
+  T P_[PACKED_SIZE<NX>];  // error state covariance (packed upper triangle)
+  bool is_init_;
+};
+
+static_assert(std::is_trivially_copyable_v<InertialNavSnapshot<double>>);
+static_assert(std::is_trivially_copyable_v<KinematicNavSnapshot<double>>);
+
+/**
+ * *=== SerializeSnapshot ===*
+ * @brief Copy a snapshot into a byte buffer (native byte order, sizeof(Snapshot) bytes)
+ * @param out   Output buffer
+ * @param size  Size of the output buffer [bytes]
+ * @param snap  Snapshot
+ * @return Number of bytes written, 0 if the buffer is too small
+ */
+template <typename Snapshot>
+inline std::size_t SerializeSnapshot(
+    std::uint8_t *out, const std::size_t &size, const Snapshot &snap) {
+  static_assert(std::is_trivially_copyable_v<Snapshot>);
+  if (size < sizeof(Snapshot)) {
+    return 0;
+  }
+  std::memcpy(out, &snap, sizeof(Snapshot));
+  return sizeof(Snapshot);
+}
+
+/**
+ * *=== DeserializeSnapshot ===*
+ * @brief Copy a snapshot out of a byte buffer written by SerializeSnapshot
+ * @param snap  Output snapshot
+ * @param in    Input buffer
+ * @param size  Size of the input buffer [bytes]
+ * @return False if the buffer is not the size of the snapshot (e.g. written for another scalar
+ *         type)
+ */
+template <typename Snapshot>
+inline bool DeserializeSnapshot(Snapshot &snap, const std::uint8_t *in, const std::size_t &size) {
+  static_assert(std::is_trivially_copyable_v<Snapshot>);
+  if (size != sizeof(Snapshot)) {
+    return false;
+  }
+  std::memcpy(&snap, in, sizeof(Snapshot));
+  return true;
+}
+
+}  // namespace sturdins
+
+#endif
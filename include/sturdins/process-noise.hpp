@@ -0,0 +1,133 @@
+/**
+ * *process-noise.hpp*
+ *
+ * =======  ========================================================================================
+ * @file    sturdins/process-noise.hpp
+ * @brief   Discretized process noise of the navigation filters, cached per integration period.
+ * @date    January 2025
+ * @author  Daniel Sturdivant <sturdivant20@gmail.com>
+ * =======  ========================================================================================
+ */
+
+#ifndef STURDINS_PROCESS_NOISE_HPP
+#define STURDINS_PROCESS_NOISE_HPP
+
+#include <Eigen/Dense>
+#include <vector>
+
+#include "sturdins/nav-clock.hpp"
+#include "sturdins/nav-imu.hpp"
+
+namespace sturdins {
+
+/**
+ * *=== ProcessNoiseBlocks ===*
+ * @brief Non-zero blocks of the filter process covariances over one integration period
+ */
+struct ProcessNoiseBlocks {
+  double dt_;                      // integration period [s]
+  Eigen::Matrix2d clock_;          // clock bias/drift block (NavClockProcessCov)
+  Eigen::Matrix2d ins_clock_;      // InertialNav clock block (h0 and h1 cross terms halved)
+  Eigen::Vector<double, 15> ins_;  // InertialNav diagonal of the navigation and bias states
+  Eigen::Vector4d kns_;            // KinematicNav Sv/3*T^3, Sv/2*T^2, Sv*T, Sa*T
+};
+
+/**
+ * *=== ProcessNoiseModel ===*
+ * @brief Process noise of InertialNav and KinematicNav built from the clock and IMU Allan variance
+ *        parameters. The blocks of the listed integration periods are discretized once, the model
+ *        is immutable afterwards and can be shared (read-only, from any thread) by many filters
+ */
+class ProcessNoiseModel {
+ public:
+  /**
+   * *=== ProcessNoiseModel ===*
+   * @brief Constructor
+   * @param clock Navigation clock Allan variance parameters
+   * @param imu   Navigation IMU Allan variance parameters (units of the NavigationIMU presets)
+   * @param dt    Integration periods to discretize [s]
+   * @param Svel  KinematicNav velocity process noise PSD
+   * @param Satt  KinematicNav attitude process noise PSD
+   */
+  ProcessNoiseModel(
+      const NavigationClock &clock,
+      const NavigationIMU &imu,
+      const std::vector<double> &dt = {},
+      const double &Svel = 0.0,
+      const double &Satt = 0.0);
+
+  /**
+   * *=== Blocks ===*
+   * @brief Process noise blocks of an integration period, periods that were not discretized by
+   *        the constructor are evaluated into the scratch blocks
+   * @param dt      Integration period [s]
+   * @param scratch Blocks for periods that are not cached
+   * @return Cached blocks of dt or the scratch blocks
+   */
+  const ProcessNoiseBlocks &Blocks(const double &dt, ProcessNoiseBlocks &scratch) const;
+
+  /**
+   * *=== IsCached ===*
+   * @brief True if the blocks of an integration period were discretized by the constructor
+   * @param dt  Integration period [s]
+   */
+  bool IsCached(const double &dt) const;
+
+  /**
+   * *=== Clock ===*
+   * @brief Navigation clock Allan variance parameters of the model
+   */
+  const NavigationClock &Clock() const;
+
+  /**
+   * *=== Imu ===*
+   * @brief Navigation IMU Allan variance parameters of the model
+   */
+  const NavigationIMU &Imu() const;
+
+  /**
+   * *=== Svel ===*
+   * @brief KinematicNav velocity process noise PSD of the model
+   */
+  double Svel() const;
+
+  /**
+   * *=== Satt ===*
+   * @brief KinematicNav attitude process noise PSD of the model
+   */
+  double Satt() const;
+
+ private:
+  NavigationClock clock_;
+  NavigationIMU imu_;
+  double Sv_;
+  double Sa_;
+
+  /**
+   * @brief IMU PSDs (1.21 to account for 10% stochastic noise)
+   */
+  double Sra_;   // accelerometer measurement noise PSD
+  double Sbad_;  // accelerometer bias variation PSD
+  double Srg_;   // gyroscope measurement noise PSD
+  double Sbgd_;  // gyroscope bias variation PSD
+
+  std::vector<ProcessNoiseBlocks> cache_;  // sorted by dt
+
+  /**
+   * *=== Discretize ===*
+   * @brief Evaluate the process noise blocks of an integration period
+   * @param q   Process noise blocks
+   * @param dt  Integration period [s]
+   */
+  void Discretize(ProcessNoiseBlocks &q, const double &dt) const;
+
+  /**
+   * *=== Find ===*
+   * @brief Cached blocks of an integration period, nullptr if not cached
+   */
+  const ProcessNoiseBlocks *Find(const double &dt) const;
+};
+
+}  // namespace sturdins
+
+#endif
@@ -0,0 +1,559 @@
+/**
+ * *replay.hpp*
+ *
+ * =======  ========================================================================================
+ * @file    sturdins/replay.hpp
+ * @brief   Streaming replay of truth/IMU/GNSS binary logs through the navigation filters.
+ * @date    January 2025
+ * @author  Daniel Sturdivant <sturdivant20@gmail.com>
+ * =======  ========================================================================================
+ */
+
+#ifndef STURDINS_REPLAY_HPP
+#define STURDINS_REPLAY_HPP
+
+#include <Eigen/Dense>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <satutils/ephemeris.hpp>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "sturdins/kalman-update.hpp"
+#include "sturdins/least-squares.hpp"
+
+namespace sturdins {
+
+/**
+ * @brief Record of the truth/IMU binary logs (degrees for angles)
+ */
+template <typename T = double>
+struct NavData {
+  T t;
+  T lat;
+  T lon;
+  T h;
+  T vn;
+  T ve;
+  T vd;
+  T roll;
+  T pitch;
+  T yaw;
+  T fx;
+  T fy;
+  T fz;
+  T wx;
+  T wy;
+  T wz;
+};
+
+/**
+ * @brief Record of the navigation result binary logs (degrees for angles)
+ */
+template <typename T = double>
+struct NavResult {
+  T t;
+  T lat;
+  T lon;
+  T h;
+  T vn;
+  T ve;
+  T vd;
+  T roll;
+  T pitch;
+  T yaw;
+  T cb;
+  T cd;
+};
+
+/**
+ * *=== MappedFile ===*
+ * @brief Read-only memory map of an entire file, the kernel is told the file is read sequentially
+ *        so pages are read ahead of the reader
+ */
+class MappedFile {
+ public:
+  /**
+   * *=== MappedFile ===*
+   * @brief constructor
+   * @param filename  File to map
+   */
+  MappedFile();
+  explicit MappedFile(const std::string &filename);
+
+  /**
+   * *=== ~MappedFile ===*
+   * @brief Destructor, unmaps the file
+   */
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  /**
+   * *=== Open ===*
+   * @brief Map a file (any previously mapped file is unmapped)
+   * @param filename  File to map
+   * @return True if the file was mapped
+   */
+  bool Open(const std::string &filename);
+
+  /**
+   * *=== Close ===*
+   * @brief Unmap the file
+   */
+  void Close();
+
+  /**
+   * *=== IsOpen ===*
+   * @brief True if a file is mapped (empty files are never mapped)
+   */
+  bool IsOpen() const;
+
+  /**
+   * *=== Data ===*
+   * @brief Start of the mapped bytes (page aligned)
+   */
+  const char *Data() const;
+
+  /**
+   * *=== Size ===*
+   * @brief Number of mapped bytes
+   */
+  std::size_t Size() const;
+
+ private:
+  const char *data_;
+  std::size_t size_;
+#ifdef _WIN32
+  std::vector<char> buffer_;  // no mmap, the file is read into memory once
+#endif
+};
+
+/**
+ * *=== RecordReader ===*
+ * @brief Memory mapped array of fixed-size binary records (e.g. NavData or KeplerElements), a
+ *        trailing partial record is ignored
+ * @tparam Record  Trivially copyable record type
+ */
+template <typename Record>
+class RecordReader {
+  static_assert(std::is_trivially_copyable_v<Record>, "records must be trivially copyable");
+
+ public:
+  /**
+   * *=== RecordReader ===*
+   * @brief constructor
+   * @param filename  Binary file of records
+   */
+  explicit RecordReader(const std::string &filename) : file_{filename} {};
+
+  /**
+   * *=== IsOpen ===*
+   * @brief True if the file is mapped
+   */
+  bool IsOpen() const {
+    return file_.IsOpen();
+  };
+
+  /**
+   * *=== Size ===*
+   * @brief Number of complete records
+   */
+  std::size_t Size() const {
+    return file_.Size() / sizeof(Record);
+  };
+
+  /**
+   * *=== Data ===*
+   * @brief First record (the mapping is page aligned, so records of doubles are aligned)
+   */
+  const Record *Data() const {
+    return reinterpret_cast<const Record *>(file_.Data());
+  };
+
+  const Record &operator[](const std::size_t &i) const {
+    return Data()[i];
+  };
+  const Record *begin() const {
+    return Data();
+  };
+  const Record *end() const {
+    return Data() + Size();
+  };
+
+ private:
+  MappedFile file_;
+};
+
+/**
+ * *=== RecordWriter ===*
+ * @brief Buffered writer of fixed-size binary records (e.g. NavResult), records are written to disk
+ *        a buffer at a time
+ * @tparam Record  Trivially copyable record type
+ */
+template <typename Record>
+class RecordWriter {
+  static_assert(std::is_trivially_copyable_v<Record>, "records must be trivially copyable");
+
+ public:
+  /**
+   * *=== RecordWriter ===*
+   * @brief constructor, truncates the file
+   * @param filename  Binary file of records
+   * @param capacity  Number of records buffered between writes
+   */
+  explicit RecordWriter(const std::string &filename, const std::size_t &capacity = 4096)
+      : fid_{std::fopen(filename.c_str(), "wb")}, buffer_(capacity > 0 ? capacity : 1), n_{0} {};
+
+  /**
+   * *=== ~RecordWriter ===*
+   * @brief Destructor, flushes and closes the file
+   */
+  ~RecordWriter() {
+    Close();
+  };
+
+  RecordWriter(const RecordWriter &) = delete;
+  RecordWriter &operator=(const RecordWriter &) = delete;
+
+  /**
+   * *=== IsOpen ===*
+   * @brief True if the file is open and no write has failed
+   */
+  bool IsOpen() const {
+    return fid_ != nullptr;
+  };
+
+  /**
+   * *=== Write ===*
+   * @brief Append a record
+   * @param record  Record to write
+   * @return False if the file is not open or a write failed
+   */
+  bool Write(const Record &record) {
+    if (fid_ == nullptr) {
+      return false;
+    }
+    buffer_[n_++] = record;
+    return (n_ < buffer_.size()) || Flush();
+  };
+
+  /**
+   * *=== Flush ===*
+   * @brief Write the buffered records to disk
+   * @return False if the file is not open or the write failed (the file is closed)
+   */
+  bool Flush() {
+    if (fid_ == nullptr) {
+      return false;
+    }
+    bool ok = (std::fwrite(buffer_.data(), sizeof(Record), n_, fid_) == n_);
+    n_ = 0;
+    if (!ok) {
+      std::fclose(fid_);
+      fid_ = nullptr;
+    }
+    return ok;
+  };
+
+  /**
+   * *=== Close ===*
+   * @brief Flush and close the file
+   * @return False if the final write failed
+   */
+  bool Close() {
+    if (fid_ == nullptr) {
+      return false;
+    }
+    bool ok = Flush();
+    if (fid_ != nullptr) {
+      ok = (std::fclose(fid_) == 0) && ok;
+      fid_ = nullptr;
+    }
+    return ok;
+  };
+
+ private:
+  std::FILE *fid_;
+  std::vector<Record> buffer_;
+  std::size_t n_;
+};
+
+/**
+ * *=== SpscRing ===*
+ * @brief Lock-free single producer, single consumer ring of preallocated slots. Slots are written
+ *        and read in place (BeginPush/EndPush and Front/Pop) so large messages are never copied or
+ *        allocated while streaming.
+ * @tparam T  Message type
+ */
+template <typename T>
+class SpscRing {
+ public:
+  /**
+   * *=== SpscRing ===*
+   * @brief constructor
+   * @param capacity  Minimum number of slots (rounded up to a power of two)
+   */
+  explicit SpscRing(const std::size_t &capacity) : head_{0}, tail_{0}, closed_{false} {
+    std::size_t n = 2;
+    while (n < capacity) {
+      n <<= 1;
+    }
+    mask_ = n - 1;
+    slots_ = std::make_unique<T[]>(n);
+    head_cache_ = 0;
+    tail_cache_ = 0;
+  };
+
+  /**
+   * *=== BeginPush ===*
+   * @brief (producer) Next free slot, or nullptr if the ring is full
+   */
+  T *BeginPush() {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_cache_ > mask_) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if (head - tail_cache_ > mask_) {
+        return nullptr;
+      }
+    }
+    return &slots_[head & mask_];
+  };
+
+  /**
+   * *=== EndPush ===*
+   * @brief (producer) Publish the slot returned by BeginPush
+   */
+  void EndPush() {
+    head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  };
+
+  /**
+   * *=== Front ===*
+   * @brief (consumer) Oldest published slot, or nullptr if the ring is empty
+   */
+  T *Front() {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_cache_) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      if (tail == head_cache_) {
+        return nullptr;
+      }
+    }
+    return &slots_[tail & mask_];
+  };
+
+  /**
+   * *=== Pop ===*
+   * @brief (consumer) Release the slot returned by Front
+   */
+  void Pop() {
+    tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  };
+
+  /**
+   * *=== Close ===*
+   * @brief (producer) No more slots will be published
+   */
+  void Close() {
+    closed_.store(true, std::memory_order_release);
+  };
+
+  /**
+   * *=== Drained ===*
+   * @brief (consumer) True once the producer closed the ring and every slot was consumed
+   */
+  bool Drained() {
+    return closed_.load(std::memory_order_acquire) && (Front() == nullptr);
+  };
+
+  /**
+   * *=== Capacity ===*
+   * @brief Number of slots
+   */
+  std::size_t Capacity() const {
+    return mask_ + 1;
+  };
+
+ private:
+  alignas(64) std::atomic<std::size_t> head_;  // next slot to publish (written by the producer)
+  alignas(64) std::atomic<std::size_t> tail_;  // next slot to consume (written by the consumer)
+  alignas(64) std::atomic<bool> closed_;
+  alignas(64) std::size_t tail_cache_;  // producer's copy of tail_
+  alignas(64) std::size_t head_cache_;  // consumer's copy of head_
+  std::size_t mask_;
+  std::unique_ptr<T[]> slots_;
+};
+
+/**
+ * *=== GnssEpoch ===*
+ * @brief Satellite states and measurements of one GNSS epoch, stored inline with a compile-time
+ *        capacity of MAX_SV satellites
+ */
+struct GnssEpoch {
+  double ToW_;                                                                   // [s]
+  Eigen::Matrix<double, 3, Eigen::Dynamic, Eigen::ColMajor, 3, MAX_SV> sv_pos_;  // ECEF [m]
+  Eigen::Matrix<double, 3, Eigen::Dynamic, Eigen::ColMajor, 3, MAX_SV> sv_vel_;  // ECEF [m/s]
+  Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::ColMajor, MAX_SV, 1> psr_;     // [m]
+  Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::ColMajor, MAX_SV, 1> psrdot_;  // [m/s]
+
+  /**
+   * *=== Resize ===*
+   * @brief Set the number of satellites (at most MAX_SV)
+   */
+  void Resize(const int &N) {
+    sv_pos_.resize(3, N);
+    sv_vel_.resize(3, N);
+    psr_.resize(N);
+    psrdot_.resize(N);
+  };
+};
+
+/**
+ * *=== MeasurementGenerator ===*
+ * @brief Noise-free satellite states, pseudoranges and pseudorange-rates from a set of
+ *        ephemerides, written into a preallocated GnssEpoch
+ */
+class MeasurementGenerator {
+ public:
+  /**
+   * *=== MeasurementGenerator ===*
+   * @brief constructor, at most MAX_SV ephemerides are kept
+   * @param elems   Kepler elements of each satellite (e.g. a RecordReader of KeplerElements)
+   */
+  MeasurementGenerator() = default;
+  explicit MeasurementGenerator(const RecordReader<satutils::KeplerElements<double>> &elems);
+
+  /**
+   * *=== Generate ===*
+   * @brief Satellite states at the transmit time and the measurements of a user
+   * @param epoch   Output epoch (resized to the number of satellites)
+   * @param ToW     Transmit time [s]
+   * @param pos     3x1 User ECEF position [m]
+   * @param vel     3x1 User ECEF velocity [m/s]
+   * @param cb      User clock bias [m]
+   * @param cd      User clock drift [m/s]
+   */
+  void Generate(
+      GnssEpoch &epoch,
+      const double &ToW,
+      const Eigen::Ref<const Eigen::Vector3d> &pos,
+      const Eigen::Ref<const Eigen::Vector3d> &vel,
+      const double &cb,
+      const double &cd);
+
+  /**
+   * *=== Size ===*
+   * @brief Number of satellites
+   */
+  int Size() const;
+
+  std::vector<satutils::KeplerEphem<double>> eph_;
+
+ private:
+  RangeAndRateBuffer<MAX_SV> pred_;
+};
+
+/**
+ * *=== ReplaySample ===*
+ * @brief Message passed from the measurement generation stage to the filtering stage
+ */
+struct ReplaySample {
+  std::size_t index_;      // record number in the truth log
+  NavData<double> truth_;  // truth/IMU record (the generation stage may corrupt the IMU terms)
+  bool has_gnss_;          // true if gnss_ holds an epoch for this record
+  GnssEpoch gnss_;         // GNSS epoch
+};
+
+/**
+ * *=== Replay ===*
+ * @brief Stream a truth/IMU log through three stages connected by lock-free rings: an I/O thread
+ *        walks the memory mapped records, a generation thread calls `generate(ReplaySample &)`
+ *        (which may corrupt the IMU terms and fills gnss_/has_gnss_, has_gnss_ starts false) and
+ *        the calling thread calls `consume(const ReplaySample &)`. Records reach both callbacks in
+ *        log order, and neither callback may throw.
+ * @param truth     Memory mapped truth/IMU log
+ * @param generate  Measurement generation callback (runs on its own thread)
+ * @param consume   Filtering callback (runs on the calling thread)
+ * @param capacity  Slots in each ring
+ * @return Number of records consumed
+ */
+template <typename Generate, typename Consume>
+std::size_t Replay(
+    const RecordReader<NavData<double>> &truth,
+    Generate &&generate,
+    Consume &&consume,
+    const std::size_t &capacity = 1024) {
+  const std::size_t N = truth.Size();
+  SpscRing<NavData<double>> io_ring(capacity);
+  SpscRing<ReplaySample> gen_ring(capacity);
+
+  // I/O stage, copying the records out faults the mapping in ahead of the other stages
+  std::thread io([&]() {
+    for (std::size_t i = 0; i < N; i++) {
+      NavData<double> *slot;
+      while ((slot = io_ring.BeginPush()) == nullptr) {
+        std::this_thread::yield();
+      }
+      *slot = truth[i];
+      io_ring.EndPush();
+    }
+    io_ring.Close();
+  });
+
+  // measurement generation stage
+  std::thread gen([&]() {
+    std::size_t i = 0;
+    while (true) {
+      NavData<double> *rec = io_ring.Front();
+      if (rec == nullptr) {
+        if (io_ring.Drained()) {
+          break;
+        }
+        std::this_thread::yield();
+        continue;
+      }
+      ReplaySample *slot;
+      while ((slot = gen_ring.BeginPush()) == nullptr) {
+        std::this_thread::yield();
+      }
+      slot->index_ = i++;
+      slot->truth_ = *rec;
+      slot->has_gnss_ = false;
+      io_ring.Pop();
+      generate(*slot);
+      gen_ring.EndPush();
+    }
+    gen_ring.Close();
+  });
+
+  // filtering stage
+  std::size_t n = 0;
+  while (true) {
+    const ReplaySample *sample = gen_ring.Front();
+    if (sample == nullptr) {
+      if (gen_ring.Drained()) {
+        break;
+      }
+      std::this_thread::yield();
+      continue;
+    }
+    consume(*sample);
+    gen_ring.Pop();
+    n++;
+  }
+  io.join();
+  gen.join();
+  return n;
+}
+
+}  // namespace sturdins
+
+#endif
@@ -0,0 +1,186 @@
+/**
+ * *rts-smoother.hpp*
+ *
+ * =======  ========================================================================================
+ * @file    sturdins/rts-smoother.hpp
+ * @brief   Fixed-interval Rauch-Tung-Striebel smoothing of recorded navigation filter runs.
+ * @date    January 2025
+ * @author  Daniel Sturdivant <sturdivant20@gmail.com>
+ * @ref     1. "Principles of GNSS, Inertial, and Multisensor Integrated Navigation Systems", 2nd
+ *              Edition, 2013 - Groves (Ch. 3.4.2)
+ * =======  ========================================================================================
+ */
+
+#ifndef STURDINS_RTS_SMOOTHER_HPP
+#define STURDINS_RTS_SMOOTHER_HPP
+
+#include <Eigen/Dense>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "sturdins/batch-run.hpp"
+#include "sturdins/nav-snapshot.hpp"
+#include "sturdins/replay.hpp"
+
+namespace sturdins {
+
+/**
+ * *=== RtsSmoother ===*
+ * @brief Fixed-interval RTS smoother over an InertialNav or KinematicNav run. Record stores the
+ *        forward pass of each epoch (time, snapshot with the updated covariance, transition from
+ *        the previous epoch, predicted covariance packed and the corrections) in a columnar store
+ *        of fixed size chunks, optionally spilled to a file as they fill. Smooth runs the backward
+ *        pass on the error state
+ *          A_k   = P_k+ Phi_k+1' inv(P_k+1-)
+ *          dx_k  = A_k (dx_k+1 + dz_k+1)               (dz: correction applied at the epoch)
+ *          Ps_k  = P_k+ + A_k (Ps_k+1 - P_k+1-) A_k'
+ *        and feeds dx_k into the recorded states. The recursion is affine in the smoothed values
+ *        of the following epoch, so the epochs can be split into segments that are reduced to a
+ *        composed gain in parallel, chained from the end, then smoothed in parallel.
+ */
+template <class Filter>
+class RtsSmoother {
+ public:
+  using T = typename decltype(Filter::P_)::Scalar;
+  using Snapshot = typename Filter::Snapshot;
+  using Matrix = Eigen::Matrix<T, Filter::ERROR_SIZE, Filter::ERROR_SIZE>;
+  using Vector = Eigen::Vector<T, Filter::ERROR_SIZE>;
+  static constexpr int N = Filter::ERROR_SIZE;
+
+  /**
+   * *=== RtsSmoother ===*
+   * @brief constructor
+   * @param chunk_size  Epochs per chunk of the store
+   * @param spill_file  File full chunks are written to (kept in memory if empty)
+   */
+  RtsSmoother(const std::size_t &chunk_size = 4096, const std::string &spill_file = "");
+
+  /**
+   * *=== ~RtsSmoother ===*
+   * @brief Destructor (removes the spill file)
+   */
+  ~RtsSmoother();
+
+  RtsSmoother(const RtsSmoother &) = delete;
+  RtsSmoother &operator=(const RtsSmoother &) = delete;
+
+  /**
+   * *=== Record ===*
+   * @brief Store the filter at the end of an epoch, after its measurement updates (the first call
+   *        starts the filter's smoother log, see SetSmootherLog)
+   * @param t     Epoch time [s]
+   * @param filt  Navigation filter
+   * @return False if the epoch could not be stored (spill file error or already smoothed spilled
+   *         store)
+   */
+  bool Record(const double &t, Filter &filt);
+
+  /**
+   * *=== Smooth ===*
+   * @brief Run the backward pass over all recorded epochs
+   * @param t         Output epoch times [s] (Size() elements)
+   * @param states    Output smoothed states, one row per epoch (Filter::STATE_SIZE columns)
+   * @param cov_diag  Output smoothed covariance diagonals, one row per epoch (ERROR_SIZE columns)
+   * @param n_seg     Number of segments smoothed in parallel
+   * @return False if the store could not be read back
+   */
+  bool Smooth(
+      Eigen::Ref<Eigen::VectorXd> t,
+      Eigen::Ref<RowMatrixXd> states,
+      Eigen::Ref<RowMatrixXd> cov_diag,
+      const int &n_seg = 1);
+
+  /**
+   * *=== Size ===*
+   * @brief Number of recorded epochs
+   */
+  std::size_t Size() const;
+
+  /**
+   * *=== BytesPerEpoch ===*
+   * @brief Storage per epoch [bytes]
+   */
+  std::size_t BytesPerEpoch() const;
+
+ private:
+  /**
+   * @brief Chunk layout, per column offsets of a chunk of chunk_size_ epochs [bytes]
+   */
+  std::size_t chunk_size_;
+  std::size_t off_t_;
+  std::size_t off_snap_;
+  std::size_t off_Pm_;
+  std::size_t off_Phi_;
+  std::size_t off_dz_;
+  std::size_t chunk_bytes_;
+
+  /**
+   * @brief Store, chunks in memory or full chunks in the spill file and the one being filled
+   */
+  std::size_t n_;
+  std::vector<std::vector<std::uint8_t>> chunks_;
+  std::string spill_file_;
+  std::FILE *fout_;
+  MappedFile spilled_;
+
+  /**
+   * @brief Forward pass scratch
+   */
+  Matrix Phi_;
+  Matrix Pm_;
+  Vector dz_;
+
+  /**
+   * *=== Chunk ===*
+   * @brief First byte of a chunk
+   */
+  const std::uint8_t *Chunk(const std::size_t &c) const;
+
+  /**
+   * *=== Load ===*
+   * @brief Read the stored epoch k
+   */
+  void Load(
+      const std::size_t &k,
+      const Snapshot *&snap,
+      Matrix &Pp,
+      Matrix &Pm,
+      Matrix &Phi,
+      Vector &dz) const;
+
+  /**
+   * *=== Backward ===*
+   * @brief Backward recursion from epoch k1 down to k0, given the smoothed error and covariance at
+   *        k1 (updated in place to those at k0). Composes the gain G = A_k0...A_k1-1 if G is not
+   *        null, otherwise writes the epochs [k0, k1)
+   */
+  void Backward(
+      const std::size_t &k0,
+      const std::size_t &k1,
+      Vector &dx,
+      Matrix &Ps,
+      Matrix *G,
+      Eigen::Ref<Eigen::VectorXd> t,
+      Eigen::Ref<RowMatrixXd> states,
+      Eigen::Ref<RowMatrixXd> cov_diag) const;
+
+  /**
+   * *=== Output ===*
+   * @brief Write the smoothed epoch k
+   */
+  void Output(
+      const std::size_t &k,
+      const Vector &dx,
+      const Matrix &Ps,
+      Filter &scratch,
+      Eigen::Ref<Eigen::VectorXd> t,
+      Eigen::Ref<RowMatrixXd> states,
+      Eigen::Ref<RowMatrixXd> cov_diag) const;
+};
+
+}  // namespace sturdins
+
+#endif
@@ -0,0 +1,60 @@
+/**
+ * *state-layout.hpp*
+ *
+ * =======  ========================================================================================
+ * @file    sturdins/state-layout.hpp
+ * @brief   Compile-time error state layouts of the navigation filters.
+ * @date    January 2025
+ * @author  Daniel Sturdivant <sturdivant20@gmail.com>
+ * =======  ========================================================================================
+ */
+
+#ifndef STURDINS_STATE_LAYOUT_HPP
+#define STURDINS_STATE_LAYOUT_HPP
+
+namespace sturdins {
+
+/**
+ * *=== StateLayout ===*
+ * @brief Error state layout [pos ned, vel ned, att ned, accel bias, gyro bias, clock bias, drift],
+ *        position and velocity are always estimated and every other block is a compile-time flag.
+ *        The offset of an absent block is -1
+ */
+template <bool Attitude, bool AccelBias, bool GyroBias, bool Clock>
+struct StateLayout {
+  static constexpr bool HAS_ATT = Attitude;
+  static constexpr bool HAS_ACC_BIAS = AccelBias;
+  static constexpr bool HAS_GYR_BIAS = GyroBias;
+  static constexpr bool HAS_CLK = Clock;
+
+  /**
+   * @brief First index of each block
+   */
+  static constexpr int POS = 0;
+  static constexpr int VEL = 3;
+  static constexpr int ATT = HAS_ATT ? 6 : -1;
+  static constexpr int ACC_BIAS = HAS_ACC_BIAS ? 6 + 3 * HAS_ATT : -1;
+  static constexpr int GYR_BIAS = HAS_GYR_BIAS ? 6 + 3 * (HAS_ATT + HAS_ACC_BIAS) : -1;
+  static constexpr int CLK = HAS_CLK ? 6 + 3 * (HAS_ATT + HAS_ACC_BIAS + HAS_GYR_BIAS) : -1;
+
+  /**
+   * @brief Number of error states
+   */
+  static constexpr int NX = 6 + 3 * (HAS_ATT + HAS_ACC_BIAS + HAS_GYR_BIAS) + 2 * HAS_CLK;
+};
+
+/**
+ * @brief Layouts of the filters: InertialNav (17 states), KinematicNav with attitude (11 states,
+ *        the default) and KinematicNav without attitude (8 states)
+ */
+using InertialStateLayout = StateLayout<true, true, true, true>;
+using KinematicStateLayout = StateLayout<true, false, false, true>;
+using PositionStateLayout = StateLayout<false, false, false, true>;
+
+static_assert(InertialStateLayout::NX == 17 && InertialStateLayout::CLK == 15);
+static_assert(KinematicStateLayout::NX == 11 && KinematicStateLayout::CLK == 9);
+static_assert(PositionStateLayout::NX == 8 && PositionStateLayout::CLK == 6);
+
+}  // namespace sturdins
+
+#endif
@@ -19,8 +19,16 @@
 #include <Eigen/Dense>
 #include <navtools/constants.hpp>
 
+#include "sturdins/geodetic-cache.hpp"
+
 namespace sturdins {
 
+/**
+ * @brief Strapdown mechanization on scalar type T (float or double). Position and the functions
+ *        of latitude are always double, a float latitude cannot resolve the position increment of
+ *        a single IMU sample (~1e-8 rad at 100 Hz)
+ */
+template <typename T = double>
 class Strapdown {
  public:
   /**
@@ -89,53 +97,72 @@ class Strapdown {
    * @param dt  Integration time [s]
    */
   void Mechanize(
-      const Eigen::Ref<const Eigen::Vector3d> &wb,
-      const Eigen::Ref<const Eigen::Vector3d> &fb,
+      const Eigen::Ref<const Eigen::Vector3<T>> &wb,
+      const Eigen::Ref<const Eigen::Vector3<T>> &fb,
+      const double &dt);
+
+  /**
+   * *=== MechanizeIncrements ===*
+   * @brief Integrate a burst of high rate IMU increments as a single navigation update. The body
+   *        frame increments are summed with second order coning and sculling corrections (Savage)
+   *        and the navigation frame terms (radii, gravity, earth and transport rate) are evaluated
+   *        once per burst, so e.g. a 1 kHz IMU can be consumed in 10 sample bursts at 100 Hz
+   * @param dtheta  Delta thetas in the body frame, one IMU sample per column [rad]
+   * @param dvel    Delta velocities in the body frame, one IMU sample per column [m/s]
+   * @param dt      IMU sample interval [s]
+   */
+  void MechanizeIncrements(
+      const Eigen::Ref<const Eigen::Matrix3X<T>> &dtheta,
+      const Eigen::Ref<const Eigen::Matrix3X<T>> &dvel,
       const double &dt);
 
   /**
    * @brief states
    */
-  double phi_;             // Latitude [rad]
-  double lam_;             // Longitude [rad]
-  double h_;               // Altitude [m]
-  double vn_;              // North velocity [m/s]
-  double ve_;              // East velocity [m/s]
-  double vd_;              // Down velocity [m/s]
-  Eigen::Vector4d q_b_l_;  // Body -> Local/Nav frame quaternion
-  Eigen::Matrix3d C_b_l_;  // Body -> Local/Nav frame DCM
+  double phi_;               // Latitude [rad]
+  double lam_;               // Longitude [rad]
+  double h_;                 // Altitude [m]
+  T vn_;                     // North velocity [m/s]
+  T ve_;                     // East velocity [m/s]
+  T vd_;                     // Down velocity [m/s]
+  Eigen::Vector4<T> q_b_l_;  // Body -> Local/Nav frame quaternion
+  Eigen::Matrix3<T> C_b_l_;  // Body -> Local/Nav frame DCM
 
  protected:
   /**
-   * @brief Functions of latitude
+   * @brief Functions of latitude and radii of curvature, evaluated at the start of the most recent
+   *        mechanization (Propagate linearizes about the same point)
    */
-  double sL_;    // sin(phi)
-  double cL_;    // cos(phi)
-  double tL_;    // tan(phi)
-  double sLsq_;  // sin(phi)^2
-  double cLsq_;  // cos(phi)^2
+  GeodeticCache geo_;
 
   /**
-   * @brief Radii of curvature
+   * @brief Coriolis and gravity
    */
-  double X1ME2_;    // 1 - e^2
-  double X1ME2sq_;  // (1 - e^2)^2
-  double Re_;       // Meridian radius
-  double Rn_;       // Transverse radius
-  double Rg_;       // Geocentric radius
-  double Hn_;       // Rn + h
-  double He_;       // Re + h
-  double Hnsq_;     // (Rn + h)^2
-  double Hesq_;     // (Re + h)^2
+  Eigen::Vector3<T> g_;       // Gravity vector in NED frame
+  Eigen::Vector3<T> w_en_n_;  // Rotation rate of the ECEF frame in the NED frame
+  Eigen::Vector3<T> w_ie_n_;  // Rotation rate of earth in the NED frame
+  double wR0sqRpMu_;          // (w_ie * R0)^2 * Rp / Mu
 
   /**
-   * @brief Coriolis and gravity
+   * @brief Compensated body frame increments of the most recent MechanizeIncrements burst, and the
+   *        last raw increments of that burst (the coning/sculling terms span bursts)
    */
-  double g0_;               // Somigliana model gravity
-  Eigen::Vector3d g_;       // Gravity vector in NED frame
-  Eigen::Vector3d w_en_n_;  // Rotation rate of the ECEF frame in the NED frame
-  Eigen::Vector3d w_ie_n_;  // Rotation rate of earth in the NED frame
-  double wR0sqRpMu_;        // (w_ie * R0)^2 * Rp / Mu
+  Eigen::Vector3<T> dtheta_b_;     // coning compensated attitude increment [rad]
+  Eigen::Vector3<T> dv_b_;         // sculling compensated velocity increment [m/s]
+  Eigen::Vector3<T> dtheta_prev_;  // last delta theta of the previous burst [rad]
+  Eigen::Vector3<T> dvel_prev_;    // last delta velocity of the previous burst [m/s]
+
+  /**
+   * @brief Evaluate the functions of latitude, radii of curvature, gravity, earth rate and
+   *        transport rate at the current position and velocity
+   */
+  void NavigationFrameTerms();
+
+  /**
+   * @brief Rotate the attitude by a body frame rotation vector (navigation frame rates removed)
+   * @param dTheta  Rotation vector [rad] (overwritten)
+   */
+  void IntegrateAttitude(Eigen::Vector3<T> &dTheta);
 
   /**
    * @brief Calculate gravity vector based on current LLA
@@ -151,20 +178,6 @@ class Strapdown {
    * @brief Calculate transport rate of ECEF frame based on current LLA
    */
   void TransportRateVector();
-
-  /**
-   * @brief Calculate radii of curvature
-   */
-  template <bool CalcGeocentricRadius = false>
-  void RadiiOfCurvature() {
-    double t = 1.0 - navtools::WGS84_E2<> * sLsq_;
-    double sqt = std::sqrt(t);
-    Re_ = navtools::WGS84_R0<> / sqt;
-    Rn_ = navtools::WGS84_R0<> * X1ME2_ / (t * t / sqt);
-    if constexpr (CalcGeocentricRadius) {
-      Rg_ = Re_ * std::sqrt(cLsq_ + sLsq_ * X1ME2sq_);
-    }
-  }
 };
 
 }  // namespace sturdins
@@ -0,0 +1,142 @@
+/**
+ * *sv-state-cache.hpp*
+ *
+ * =======  ========================================================================================
+ * @file    sturdins/sv-state-cache.hpp
+ * @brief   Satellite states shared by many filters, interpolated from cached ephemeris evaluations.
+ * @date    January 2025
+ * @author  Daniel Sturdivant <sturdivant20@gmail.com>
+ * =======  ========================================================================================
+ */
+
+#ifndef STURDINS_SV_STATE_CACHE_HPP
+#define STURDINS_SV_STATE_CACHE_HPP
+
+#include <Eigen/Dense>
+#include <atomic>
+#include <cstddef>
+#include <satutils/ephemeris.hpp>
+#include <shared_mutex>
+#include <vector>
+
+#include "sturdins/kalman-update.hpp"
+#include "sturdins/replay.hpp"
+
+namespace sturdins {
+
+/**
+ * *=== SvStateCache ===*
+ * @brief ECEF positions and velocities of a constellation at any transmit time. Time is split into
+ *        fixed segments, the first request inside a segment evaluates every ephemeris at the
+ *        Chebyshev nodes of the segment and later requests only sum the fitted series. The two
+ *        most recent segments (consecutive segments never share a slot) are kept, so filters a
+ *        few epochs apart do not refit. Evaluate may be called from any thread, N filters sharing
+ *        one cache pay for one constellation evaluation per segment instead of one per epoch each
+ */
+class SvStateCache {
+ public:
+  static constexpr int MAX_ORDER = 15;
+
+  /**
+   * *=== SvStateCache ===*
+   * @brief constructor, at most MAX_SV ephemerides are kept
+   * @param eph     Kepler ephemeris of each satellite
+   * @param span    Length of an interpolation segment [s]
+   * @param order   Order of the Chebyshev series (at most MAX_ORDER)
+   */
+  explicit SvStateCache(
+      const std::vector<satutils::KeplerEphem<double>> &eph,
+      const double &span = 60.0,
+      const int &order = 9);
+  explicit SvStateCache(
+      const RecordReader<satutils::KeplerElements<double>> &elems,
+      const double &span = 60.0,
+      const int &order = 9);
+
+  /**
+   * *=== Evaluate ===*
+   * @brief Satellite states at a transmit time, written directly into the update inputs
+   * @param t       Transmit time [s]
+   * @param sv_pos  3xN Satellite ECEF positions [m] (N = Size())
+   * @param sv_vel  3xN Satellite ECEF velocities [m/s]
+   */
+  void Evaluate(
+      const double &t, Eigen::Ref<Eigen::Matrix3Xd> sv_pos, Eigen::Ref<Eigen::Matrix3Xd> sv_vel);
+
+  /**
+   * *=== Evaluate ===*
+   * @brief Satellite states at a transmit time written into a preallocated GnssEpoch (the
+   *        measurements are left untouched)
+   * @param t       Transmit time [s]
+   * @param epoch   Output epoch (resized to the number of satellites)
+   */
+  void Evaluate(const double &t, GnssEpoch &epoch);
+
+  /**
+   * *=== Size ===*
+   * @brief Number of satellites
+   */
+  int Size() const;
+
+  /**
+   * *=== Evaluations ===*
+   * @brief Number of ephemeris (Kepler) evaluations performed so far
+   */
+  std::size_t Evaluations() const;
+
+ private:
+  using NodeMatrix = Eigen::
+      Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, MAX_ORDER + 1, MAX_ORDER + 1>;
+  using StateMatrix = Eigen::
+      Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, 6 * MAX_SV, MAX_ORDER + 1>;
+
+  /**
+   * @brief Fitted series of one segment, row 6*i + j is state j (position then velocity) of
+   *        satellite i and column k is the coefficient of T_k
+   */
+  struct Segment {
+    long index_;        // segment number (floor(t / span)), -1 if empty
+    StateMatrix coef_;  // fitted series
+  };
+
+  std::vector<satutils::KeplerEphem<double>> eph_;
+  double span_;
+  int n_;                // number of nodes (order + 1)
+  NodeMatrix fit_;       // node samples to coefficients
+  StateMatrix samples_;  // states at the nodes of the segment being fit
+  Segment seg_[2];
+  std::atomic<std::size_t> evaluations_;
+  std::shared_mutex mutex_;
+
+  /**
+   * *=== Fit ===*
+   * @brief Evaluate the ephemerides at the nodes of a segment and fit its series (exclusive lock)
+   * @param seg     Slot of the segment
+   * @param index   Segment number
+   */
+  void Fit(Segment &seg, const long &index);
+
+  /**
+   * *=== Sum ===*
+   * @brief Sum the series of a segment at a transmit time (Clenshaw recurrence)
+   * @param seg     Segment containing t
+   * @param t       Transmit time [s]
+   * @param sv_pos  3xN Satellite ECEF positions [m]
+   * @param sv_vel  3xN Satellite ECEF velocities [m/s]
+   */
+  void Sum(
+      const Segment &seg,
+      const double &t,
+      Eigen::Ref<Eigen::Matrix3Xd> sv_pos,
+      Eigen::Ref<Eigen::Matrix3Xd> sv_vel) const;
+
+  /**
+   * *=== Init ===*
+   * @brief Node to coefficient matrix and empty segments
+   */
+  void Init(const int &order);
+};
+
+}  // namespace sturdins
+
+#endif
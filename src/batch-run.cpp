@@ -0,0 +1,109 @@
+/**
+ * *batch-run.cpp*
+ *
+ * =======  ========================================================================================
+ * @file    sturdins/batch-run.cpp
+ * @brief   Run the navigation filters over entire IMU/GNSS logs.
+ * @date    January 2025
+ * @author  Daniel Sturdivant <sturdivant20@gmail.com>
+ * =======  ========================================================================================
+ */
+
+#include "sturdins/batch-run.hpp"
+
+namespace sturdins {
+
+// *=== RunInertialNav ===*
+void RunInertialNav(
+    InertialNav<> &filt,
+    const Eigen::Ref<const Eigen::VectorXd> &imu_t,
+    const Eigen::Ref<const RowMatrixX3d> &imu_wb,
+    const Eigen::Ref<const RowMatrixX3d> &imu_fb,
+    const Eigen::Ref<const Eigen::VectorXd> &gnss_t,
+    const Eigen::Ref<const Eigen::VectorXi> &offsets,
+    const Eigen::Ref<const RowMatrixX3d> &sv_pos,
+    const Eigen::Ref<const RowMatrixX3d> &sv_vel,
+    const Eigen::Ref<const Eigen::VectorXd> &psr,
+    const Eigen::Ref<const Eigen::VectorXd> &psrdot,
+    const Eigen::Ref<const Eigen::VectorXd> &psr_var,
+    const Eigen::Ref<const Eigen::VectorXd> &psrdot_var,
+    Eigen::Ref<RowMatrixXd> states,
+    Eigen::Ref<RowMatrixXd> cov_diag) {
+  const int N = imu_t.size();
+  const int E = gnss_t.size();
+  eigen_assert(offsets.size() == E + 1 && "offsets must have one entry per epoch plus one");
+  eigen_assert(states.rows() == N && states.cols() == INS_BATCH_STATES);
+  eigen_assert(cov_diag.rows() == N && cov_diag.cols() == 17);
+
+  Eigen::Vector3d wb, fb;
+  int e = 0;
+  for (int k = 0; k < N; k++) {
+    // the first sample only sets the time reference
+    if (k > 0) {
+      const double dt = imu_t(k) - imu_t(k - 1);
+      wb = imu_wb.row(k).transpose();
+      fb = imu_fb.row(k).transpose();
+      filt.Mechanize(wb, fb, dt);
+      filt.Propagate(wb, fb, dt);
+    }
+
+    // apply every epoch up to the current sample
+    for (; e < E && gnss_t(e) <= imu_t(k); e++) {
+      const int i0 = offsets(e);
+      const int n = offsets(e + 1) - i0;
+      if (n > 0) {
+        filt.GnssUpdate(
+            sv_pos.middleRows(i0, n).transpose(),
+            sv_vel.middleRows(i0, n).transpose(),
+            psr.segment(i0, n),
+            psrdot.segment(i0, n),
+            psr_var.segment(i0, n),
+            psrdot_var.segment(i0, n));
+      }
+    }
+
+    // log (with decimated propagation the covariance is as of the most recent flush)
+    filt.GetStateVector(states.row(k).transpose());
+    cov_diag.row(k) = filt.P_.diagonal().transpose();
+  }
+}
+
+// *=== RunKinematicNav ===*
+void RunKinematicNav(
+    KinematicNav<> &filt,
+    const Eigen::Ref<const Eigen::VectorXd> &gnss_t,
+    const Eigen::Ref<const Eigen::VectorXi> &offsets,
+    const Eigen::Ref<const RowMatrixX3d> &sv_pos,
+    const Eigen::Ref<const RowMatrixX3d> &sv_vel,
+    const Eigen::Ref<const Eigen::VectorXd> &psr,
+    const Eigen::Ref<const Eigen::VectorXd> &psrdot,
+    const Eigen::Ref<const Eigen::VectorXd> &psr_var,
+    const Eigen::Ref<const Eigen::VectorXd> &psrdot_var,
+    Eigen::Ref<RowMatrixXd> states,
+    Eigen::Ref<RowMatrixXd> cov_diag) {
+  const int E = gnss_t.size();
+  eigen_assert(offsets.size() == E + 1 && "offsets must have one entry per epoch plus one");
+  eigen_assert(states.rows() == E && states.cols() == KNS_BATCH_STATES);
+  eigen_assert(cov_diag.rows() == E && cov_diag.cols() == 11);
+
+  for (int e = 0; e < E; e++) {
+    if (e > 0) {
+      filt.Propagate(gnss_t(e) - gnss_t(e - 1));
+    }
+    const int i0 = offsets(e);
+    const int n = offsets(e + 1) - i0;
+    if (n > 0) {
+      filt.GnssUpdate(
+          sv_pos.middleRows(i0, n).transpose(),
+          sv_vel.middleRows(i0, n).transpose(),
+          psr.segment(i0, n),
+          psrdot.segment(i0, n),
+          psr_var.segment(i0, n),
+          psrdot_var.segment(i0, n));
+    }
+    filt.GetStateVector(states.row(e).transpose());
+    cov_diag.row(e) = filt.P_.diagonal().transpose();
+  }
+}
+
+}  // namespace sturdins
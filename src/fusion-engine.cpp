@@ -0,0 +1,340 @@
+/**
+ * *fusion-engine.cpp*
+ *
+ * =======  ========================================================================================
+ * @file    sturdins/fusion-engine.cpp
+ * @brief   Time-tagged multi-rate fusion of IMU and GNSS measurements around InertialNav.
+ * @date    January 2025
+ * @author  Daniel Sturdivant <sturdivant20@gmail.com>
+ * =======  ========================================================================================
+ */
+
+#include "sturdins/fusion-engine.hpp"
+
+#include <algorithm>
+
+namespace sturdins {
+
+// *=== FusionEngine ===*
+template <typename T>
+FusionEngine<T>::FusionEngine(
+    const InertialNav<T> &filt,
+    const double &t0,
+    const double &lag,
+    const int &max_imu,
+    const int &ckpt_interval,
+    const int &max_meas)
+    : n_late_{0},
+      n_dropped_{0},
+      n_replays_{0},
+      filt_{filt},
+      t_{t0},
+      lag_{lag},
+      ckpt_interval_{
+          static_cast<std::size_t>(std::clamp(ckpt_interval, 1, std::max(max_imu / 2, 1)))},
+      imu_(std::max(max_imu, 2)),
+      imu_begin_{0},
+      imu_end_{0},
+      ckpt_(imu_.size() / ckpt_interval_ + 2),
+      ckpt_begin_{0},
+      ckpt_end_{1},
+      meas_(std::max(max_meas, 1)),
+      next_{0} {
+  order_.reserve(meas_.size());
+  free_.reserve(meas_.size());
+  for (int i = static_cast<int>(meas_.size()) - 1; i >= 0; i--) {
+    free_.push_back(i);
+  }
+
+  // the first checkpoint is the initial state
+  ckpt_[0].t_ = t0;
+  ckpt_[0].k_ = 0;
+  filt_.SaveSnapshot(ckpt_[0].state_);
+}
+
+// *=== ~FusionEngine ===*
+template <typename T>
+FusionEngine<T>::~FusionEngine() {
+}
+
+// *=== AddImu ===*
+template <typename T>
+bool FusionEngine<T>::AddImu(
+    const double &t,
+    const Eigen::Ref<const Eigen::Vector3<T>> &wb,
+    const Eigen::Ref<const Eigen::Vector3<T>> &fb) {
+  if (!(t > t_)) {
+    return false;
+  }
+
+  // a full IMU ring shortens the lag window
+  const std::size_t nc = ckpt_.size();
+  while (imu_end_ - imu_begin_ >= imu_.size() && ckpt_end_ - ckpt_begin_ > 1) {
+    ckpt_begin_++;
+    imu_begin_ = ckpt_[ckpt_begin_ % nc].k_;
+  }
+
+  ImuSample &s = imu_[imu_end_ % imu_.size()];
+  s.t_ = t;
+  s.wb_ = wb;
+  s.fb_ = fb;
+  Step(imu_end_++);
+  Retire();
+  return true;
+}
+
+// *=== AddGnss ===*
+template <typename T>
+bool FusionEngine<T>::AddGnss(
+    const double &t,
+    const Eigen::Ref<const Eigen::Matrix3Xd> &sv_pos,
+    const Eigen::Ref<const Eigen::Matrix3Xd> &sv_vel,
+    const Eigen::Ref<const Eigen::VectorXd> &psr,
+    const Eigen::Ref<const Eigen::VectorXd> &psrdot,
+    const Eigen::Ref<const Eigen::VectorXd> &psr_var,
+    const Eigen::Ref<const Eigen::VectorXd> &psrdot_var) {
+  if (psr.size() > MAX_SV) {
+    n_dropped_++;
+    return false;
+  }
+  const int slot = AcquireSlot(t);
+  if (slot < 0) {
+    return false;
+  }
+  FusionMeasurement &m = meas_[slot];
+  m.t_ = t;
+  m.type_ = MeasurementType::GNSS;
+  m.sv_pos_ = sv_pos;
+  m.sv_vel_ = sv_vel;
+  m.psr_ = psr;
+  m.psrdot_ = psrdot;
+  m.psr_var_ = psr_var;
+  m.psrdot_var_ = psrdot_var;
+  Insert(slot);
+  return true;
+}
+
+// *=== AddPhasedArray ===*
+template <typename T>
+bool FusionEngine<T>::AddPhasedArray(
+    const double &t,
+    const Eigen::Ref<const Eigen::Matrix3Xd> &sv_pos,
+    const Eigen::Ref<const Eigen::Matrix3Xd> &sv_vel,
+    const Eigen::Ref<const Eigen::VectorXd> &psr,
+    const Eigen::Ref<const Eigen::VectorXd> &psrdot,
+    const Eigen::Ref<const Eigen::MatrixXd> &phase,
+    const Eigen::Ref<const Eigen::VectorXd> &psr_var,
+    const Eigen::Ref<const Eigen::VectorXd> &psrdot_var,
+    const Eigen::Ref<const Eigen::MatrixXd> &phase_var,
+    const Eigen::Ref<const Eigen::Matrix3Xd> &ant_xyz,
+    const int &n_ant,
+    const double &lamb) {
+  if (psr.size() > MAX_SV || n_ant > MAX_ANT) {
+    n_dropped_++;
+    return false;
+  }
+  const int slot = AcquireSlot(t);
+  if (slot < 0) {
+    return false;
+  }
+  FusionMeasurement &m = meas_[slot];
+  m.t_ = t;
+  m.type_ = MeasurementType::PHASED_ARRAY;
+  m.sv_pos_ = sv_pos;
+  m.sv_vel_ = sv_vel;
+  m.psr_ = psr;
+  m.psrdot_ = psrdot;
+  m.phase_ = phase;
+  m.psr_var_ = psr_var;
+  m.psrdot_var_ = psrdot_var;
+  m.phase_var_ = phase_var;
+  m.ant_xyz_ = ant_xyz;
+  m.n_ant_ = n_ant;
+  m.lamb_ = lamb;
+  Insert(slot);
+  return true;
+}
+
+// *=== AddAttitude ===*
+template <typename T>
+bool FusionEngine<T>::AddAttitude(
+    const double &t,
+    const Eigen::Ref<const Eigen::Matrix3d> &C,
+    const Eigen::Ref<const Eigen::Matrix3d> &R) {
+  const int slot = AcquireSlot(t);
+  if (slot < 0) {
+    return false;
+  }
+  FusionMeasurement &m = meas_[slot];
+  m.t_ = t;
+  m.type_ = MeasurementType::ATTITUDE;
+  m.C_ = C;
+  m.R_ = R;
+  Insert(slot);
+  return true;
+}
+
+// *=== Filter ===*
+template <typename T>
+const InertialNav<T> &FusionEngine<T>::Filter() const {
+  return filt_;
+}
+
+// *=== Time ===*
+template <typename T>
+double FusionEngine<T>::Time() const {
+  return t_;
+}
+
+// *=== NumPending ===*
+template <typename T>
+int FusionEngine<T>::NumPending() const {
+  return static_cast<int>(order_.size() - next_);
+}
+
+// *=== AcquireSlot ===*
+template <typename T>
+int FusionEngine<T>::AcquireSlot(const double &t) {
+  // a late measurement needs a checkpoint strictly before it
+  if ((t < t_ && t <= ckpt_[ckpt_begin_ % ckpt_.size()].t_) || free_.empty()) {
+    n_dropped_++;
+    return -1;
+  }
+  const int slot = free_.back();
+  free_.pop_back();
+  return slot;
+}
+
+// *=== Insert ===*
+template <typename T>
+void FusionEngine<T>::Insert(const int &slot) {
+  // after any measurement of the same time, so replays keep the arrival order
+  const double t = meas_[slot].t_;
+  auto by_time = [this](const double &a, const int &i) { return a < meas_[i].t_; };
+  order_.insert(std::upper_bound(order_.begin(), order_.end(), t, by_time), slot);
+
+  // newer than the filter, applied once the IMU reaches it
+  if (t > t_) {
+    return;
+  }
+
+  // at the filter time, applied now (a checkpoint of the same time must include it)
+  const std::size_t nc = ckpt_.size();
+  if (t == t_) {
+    Apply(meas_[slot]);
+    next_++;
+    Checkpoint &last = ckpt_[(ckpt_end_ - 1) % nc];
+    if (last.t_ == t_) {
+      filt_.SaveSnapshot(last.state_);
+    }
+    return;
+  }
+
+  // late, roll back to the newest checkpoint before it and re-run the buffered IMU samples
+  std::size_t c = ckpt_end_ - 1;
+  while (ckpt_[c % nc].t_ >= t) {
+    c--;
+  }
+  const Checkpoint &ckpt = ckpt_[c % nc];
+  const std::size_t k0 = ckpt.k_;
+  filt_.RestoreSnapshot(ckpt.state_);
+  t_ = ckpt.t_;
+  ckpt_end_ = c + 1;
+  next_ = std::upper_bound(order_.begin(), order_.end(), t_, by_time) - order_.begin();
+  for (std::size_t k = k0; k < imu_end_; k++) {
+    Step(k);
+  }
+  n_late_++;
+  n_replays_ += static_cast<long>(imu_end_ - k0);
+}
+
+// *=== Step ===*
+template <typename T>
+void FusionEngine<T>::Step(const std::size_t &k) {
+  const ImuSample &s = imu_[k % imu_.size()];
+
+  // propagate to and apply each measurement inside the sample
+  while (next_ < order_.size() && meas_[order_[next_]].t_ <= s.t_) {
+    const FusionMeasurement &m = meas_[order_[next_]];
+    if (m.t_ > t_) {
+      filt_.Mechanize(s.wb_, s.fb_, m.t_ - t_);
+      filt_.Propagate(s.wb_, s.fb_, m.t_ - t_);
+      t_ = m.t_;
+    }
+    Apply(m);
+    next_++;
+  }
+  if (s.t_ > t_) {
+    filt_.Mechanize(s.wb_, s.fb_, s.t_ - t_);
+    filt_.Propagate(s.wb_, s.fb_, s.t_ - t_);
+  }
+  t_ = s.t_;
+
+  // checkpoint every ckpt_interval_ samples
+  const std::size_t nc = ckpt_.size();
+  if (k + 1 - ckpt_[(ckpt_end_ - 1) % nc].k_ >= ckpt_interval_) {
+    if (ckpt_end_ - ckpt_begin_ >= nc) {
+      ckpt_begin_++;
+      imu_begin_ = ckpt_[ckpt_begin_ % nc].k_;
+    }
+    Checkpoint &ckpt = ckpt_[ckpt_end_ % nc];
+    ckpt.t_ = t_;
+    ckpt.k_ = k + 1;
+    filt_.SaveSnapshot(ckpt.state_);
+    ckpt_end_++;
+  }
+}
+
+// *=== Apply ===*
+template <typename T>
+void FusionEngine<T>::Apply(const FusionMeasurement &m) {
+  switch (m.type_) {
+    case MeasurementType::GNSS:
+      filt_.GnssUpdate(m.sv_pos_, m.sv_vel_, m.psr_, m.psrdot_, m.psr_var_, m.psrdot_var_);
+      break;
+    case MeasurementType::PHASED_ARRAY:
+      filt_.PhasedArrayUpdate(
+          m.sv_pos_,
+          m.sv_vel_,
+          m.psr_,
+          m.psrdot_,
+          m.phase_,
+          m.psr_var_,
+          m.psrdot_var_,
+          m.phase_var_,
+          m.ant_xyz_,
+          m.n_ant_,
+          m.lamb_);
+      break;
+    case MeasurementType::ATTITUDE:
+      filt_.AttitudeUpdate(m.C_, m.R_);
+      break;
+  }
+}
+
+// *=== Retire ===*
+template <typename T>
+void FusionEngine<T>::Retire() {
+  // keep the newest checkpoint older than the lag window
+  const std::size_t nc = ckpt_.size();
+  while (ckpt_end_ - ckpt_begin_ > 1 && ckpt_[(ckpt_begin_ + 1) % nc].t_ < t_ - lag_) {
+    ckpt_begin_++;
+  }
+  const Checkpoint &oldest = ckpt_[ckpt_begin_ % nc];
+  imu_begin_ = oldest.k_;
+
+  // measurements included in the oldest checkpoint are never re-run
+  std::size_t n = 0;
+  while (n < next_ && meas_[order_[n]].t_ <= oldest.t_) {
+    free_.push_back(order_[n++]);
+  }
+  if (n > 0) {
+    order_.erase(order_.begin(), order_.begin() + n);
+    next_ -= n;
+  }
+}
+
+template class FusionEngine<float>;
+template class FusionEngine<double>;
+
+}  // namespace sturdins
@@ -0,0 +1,124 @@
+/**
+ * *geodetic-cache.cpp*
+ *
+ * =======  ========================================================================================
+ * @file    sturdins/geodetic-cache.cpp
+ * @brief   Cache of the position dependent WGS84 terms shared by the navigation filters.
+ * @date    January 2025
+ * @author  Daniel Sturdivant <sturdivant20@gmail.com>
+ * @ref     1. "Principles of GNSS, Inertial, and Multisensor Integrated Navigation Systems", 2nd
+ *              Edition, 2013 - Groves
+ * =======  ========================================================================================
+ */
+
+#include "sturdins/geodetic-cache.hpp"
+
+#include <cmath>
+#include <limits>
+#include <navtools/constants.hpp>
+
+namespace sturdins {
+
+// *=== GeodeticCache ===*
+GeodeticCache::GeodeticCache()
+    : sL_{0.0},
+      cL_{1.0},
+      tL_{0.0},
+      sLsq_{0.0},
+      cLsq_{1.0},
+      sLam_{0.0},
+      cLam_{1.0},
+      X1ME2_{1.0 - navtools::WGS84_E2<>},
+      X1ME2sq_{X1ME2_ * X1ME2_},
+      Re_{navtools::WGS84_R0<>},
+      Rn_{navtools::WGS84_R0<> * X1ME2_},
+      Rg_{navtools::WGS84_R0<>},
+      Hn_{Rn_},
+      He_{Re_},
+      Hnsq_{Hn_ * Hn_},
+      Hesq_{He_ * He_},
+      g0_{9.7803253359},
+      ecef_p_{Eigen::Vector3d::Zero()},
+      C_l_e_{Eigen::Matrix3d::Identity()} {
+  Invalidate();
+}
+
+// *=== ~GeodeticCache ===*
+GeodeticCache::~GeodeticCache() = default;
+
+// *=== Invalidate ===*
+void GeodeticCache::Invalidate() {
+  // NaN never compares equal, so every term is evaluated by the next Update
+  phi_ = std::numeric_limits<double>::quiet_NaN();
+  lam_ = std::numeric_limits<double>::quiet_NaN();
+  h_ = std::numeric_limits<double>::quiet_NaN();
+  ecef_valid_ = false;
+  dcm_valid_ = false;
+}
+
+// *=== Update ===*
+bool GeodeticCache::Update(const double &phi, const double &lam, const double &h) {
+  const bool new_lat = (phi != phi_);
+  const bool new_lon = (lam != lam_);
+  const bool new_h = (h != h_);
+  if (!(new_lat || new_lon || new_h)) {
+    return false;
+  }
+
+  if (new_lat) {
+    // Functions of latitude
+    phi_ = phi;
+    sL_ = std::sin(phi_);
+    cL_ = std::cos(phi_);
+    tL_ = sL_ / cL_;
+    sLsq_ = sL_ * sL_;
+    cLsq_ = cL_ * cL_;
+
+    // Radii of curvature
+    double t = 1.0 - navtools::WGS84_E2<> * sLsq_;
+    double sqt = std::sqrt(t);
+    Re_ = navtools::WGS84_R0<> / sqt;
+    Rn_ = navtools::WGS84_R0<> * X1ME2_ / (t * t / sqt);
+    Rg_ = Re_ * std::sqrt(cLsq_ + sLsq_ * X1ME2sq_);
+
+    // Somigliana model gravity
+    g0_ = 9.7803253359 * ((1.0 + 0.001931853 * sLsq_) / sqt);
+  }
+  if (new_lon) {
+    lam_ = lam;
+    sLam_ = std::sin(lam_);
+    cLam_ = std::cos(lam_);
+  }
+  if (new_lat || new_h) {
+    h_ = h;
+    He_ = Re_ + h_;
+    Hn_ = Rn_ + h_;
+    Hesq_ = He_ * He_;
+    Hnsq_ = Hn_ * Hn_;
+  }
+  ecef_valid_ = false;
+  if (new_lat || new_lon) {
+    dcm_valid_ = false;
+  }
+  return true;
+}
+
+// *=== EcefPosition ===*
+const Eigen::Vector3d &GeodeticCache::EcefPosition() {
+  if (!ecef_valid_) {
+    ecef_p_ << He_ * cL_ * cLam_, He_ * cL_ * sLam_, (Re_ * X1ME2_ + h_) * sL_;
+    ecef_valid_ = true;
+  }
+  return ecef_p_;
+}
+
+// *=== NedToEcef ===*
+const Eigen::Matrix3d &GeodeticCache::NedToEcef() {
+  if (!dcm_valid_) {
+    C_l_e_ << -sL_ * cLam_, -sLam_, -cL_ * cLam_, -sL_ * sLam_, cLam_, -cL_ * sLam_, cL_, 0.0, -sL_;
+    dcm_valid_ = true;
+  }
+  return C_l_e_;
+}
+
+}  // namespace sturdins
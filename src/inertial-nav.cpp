@@ -19,24 +19,43 @@
 #include <navtools/constants.hpp>
 #include <navtools/math.hpp>
 
+#include "sturdins/instrument.hpp"
 #include "sturdins/least-squares.hpp"
 #include "sturdins/strapdown.hpp"
 
 namespace sturdins {
 
+// KalmanWorkspace layout of the GnssUpdate blocks (H is kept between epochs of the same size)
+static constexpr int GNSS_LAYOUT = 1;
+
 // *=== InertialNav ===*
-InertialNav::InertialNav()
-    : Strapdown(),
-      bg_{Eigen::Vector<double, 3>::Zero()},
-      ba_{Eigen::Vector<double, 3>::Zero()},
-      P_{Eigen::Matrix<double, 17, 17>::Zero()},
-      x_{Eigen::Vector<double, 17>::Zero()},
-      F_{Eigen::Matrix<double, 17, 17>::Zero()},
-      Q_{Eigen::Matrix<double, 17, 17>::Zero()},
-      I17_{Eigen::Matrix<double, 17, 17>::Identity()},
-      is_init_{false} {
-}
-InertialNav::InertialNav(
+template <typename T>
+InertialNav<T>::InertialNav()
+    : Strapdown<T>(),
+      bg_{Eigen::Vector3<T>::Zero()},
+      ba_{Eigen::Vector3<T>::Zero()},
+      P_{Eigen::Matrix<T, 17, 17>::Zero()},
+      x_{Eigen::Vector<T, 17>::Zero()},
+      F_{Eigen::Matrix<T, 17, 17>::Zero()},
+      Q_{Eigen::Matrix<T, 17, 17>::Zero()},
+      Phi_{Eigen::Matrix<T, 17, 17>::Identity()},
+      Qd_{Eigen::Matrix<T, 17, 17>::Zero()},
+      Tp_{0.0},
+      n_prop_{0},
+      prop_interval_{1},
+      strategy_{UpdateStrategy::BATCH},
+      dense_propagation_{false},
+      sqrt_form_{false},
+      is_init_{false},
+      log_{false},
+      n_log_{0},
+      imu_{},
+      clock_{},
+      noise_{std::make_shared<const ProcessNoiseModel>(clock_, imu_)},
+      q_dt_{0.0} {
+}
+template <typename T>
+InertialNav<T>::InertialNav(
     const double lat,
     const double lon,
     const double alt,
@@ -48,73 +67,167 @@ InertialNav::InertialNav(
     const double yaw,
     const double cb,
     const double cd)
-    : Strapdown(lat, lon, alt, veln, vele, veld, roll, pitch, yaw),
-      bg_{Eigen::Vector<double, 3>::Zero()},
-      ba_{Eigen::Vector<double, 3>::Zero()},
+    : Strapdown<T>(lat, lon, alt, veln, vele, veld, roll, pitch, yaw),
+      bg_{Eigen::Vector3<T>::Zero()},
+      ba_{Eigen::Vector3<T>::Zero()},
       cb_{cb},
       cd_{cd},
-      P_{Eigen::Matrix<double, 17, 17>::Zero()},
-      x_{Eigen::Vector<double, 17>::Zero()},
-      F_{Eigen::Matrix<double, 17, 17>::Zero()},
-      Q_{Eigen::Matrix<double, 17, 17>::Zero()},
-      I17_{Eigen::Matrix<double, 17, 17>::Identity()},
-      is_init_{false} {
+      P_{Eigen::Matrix<T, 17, 17>::Zero()},
+      x_{Eigen::Vector<T, 17>::Zero()},
+      F_{Eigen::Matrix<T, 17, 17>::Zero()},
+      Q_{Eigen::Matrix<T, 17, 17>::Zero()},
+      Phi_{Eigen::Matrix<T, 17, 17>::Identity()},
+      Qd_{Eigen::Matrix<T, 17, 17>::Zero()},
+      Tp_{0.0},
+      n_prop_{0},
+      prop_interval_{1},
+      strategy_{UpdateStrategy::BATCH},
+      dense_propagation_{false},
+      sqrt_form_{false},
+      is_init_{false},
+      log_{false},
+      n_log_{0},
+      imu_{},
+      clock_{},
+      noise_{std::make_shared<const ProcessNoiseModel>(clock_, imu_)},
+      q_dt_{0.0} {
 }
 
 // *=== ~InertialNav ===*
-InertialNav::~InertialNav() {
+template <typename T>
+InertialNav<T>::~InertialNav() {
 }
 
 // *=== SetImuSpec ===*
-void InertialNav::SetImuSpec(
+template <typename T>
+void InertialNav<T>::SetImuSpec(
     const double &Ba, const double &Na, const double &Bg, const double &Ng) {
-  double B_acc = Ba * 9.80665 / 1000.0;                // [mg] -> [(m/s)/s]
-  double N_acc = Na / 60.0;                            // [(m/s)/√hr] -> [(m/s)/√s]
-  double B_gyr = navtools::DEG2RAD<> * (Bg / 3600.0);  // [deg/hr] ->  [rad/s]
-  double N_gyr = navtools::DEG2RAD<> * (Ng / 60.0);    // [deg/√hr]  ->  [rad/√s]
+  imu_ = NavigationIMU{Ba, 0.0, Na, 0.0, Bg, 0.0, Ng, 0.0};
+  noise_ = std::make_shared<const ProcessNoiseModel>(clock_, imu_);
+  q_dt_ = 0.0;
+}
 
-  // 1.21 to account for 10% stochastic noise
-  Sra_ = 1.21 * N_acc * N_acc;
-  Sbad_ = 1.21 * B_acc * B_acc;
-  Srg_ = 1.21 * N_gyr * N_gyr;
-  Sbgd_ = 1.21 * B_gyr * B_gyr;
+// *=== SetClockSpec ===*
+template <typename T>
+void InertialNav<T>::SetClockSpec(const double &h0, const double &h1, const double &h2) {
+  clock_ = NavigationClock{h0, h1, h2};
+  noise_ = std::make_shared<const ProcessNoiseModel>(clock_, imu_);
+  q_dt_ = 0.0;
+}
 
-  // FOR DYNAMIC BIASES
-  // double K_acc = Ka / std::pow(3600, 1.5);             // [(m/s)/(hr*√hr] -> [(m/s)/(s*√s)]
-  // double K_gyr =
-  //     navtools::DEG2RAD<> * (Kg / std::pow(3600.0, 1.5));  // [deg/(hr*√hr)] ->  [rad/(s*√s)]
+// *=== SetProcessNoiseModel ===*
+template <typename T>
+void InertialNav<T>::SetProcessNoiseModel(const std::shared_ptr<const ProcessNoiseModel> &model) {
+  FlushPropagation();
+  imu_ = model->Imu();
+  clock_ = model->Clock();
+  noise_ = model;
+  q_dt_ = 0.0;
 }
 
-// *=== SetClockSpec ===*
-void InertialNav::SetClockSpec(const double &h0, const double &h1, const double &h2) {
-  double LS2 = navtools::LIGHT_SPEED<> * navtools::LIGHT_SPEED<>;
-  h0_ = LS2 * h0 / 2.0;
-  h1_ = LS2 * 2.0 * h1;
-  h2_ = LS2 * navtools::PI_SQU<> * h2;
+// *=== GetProcessNoiseModel ===*
+template <typename T>
+const std::shared_ptr<const ProcessNoiseModel> &InertialNav<T>::GetProcessNoiseModel() const {
+  return noise_;
 }
 
 // *=== SetClock ===*
-void InertialNav::SetClock(const double &cb, const double &cd) {
+template <typename T>
+void InertialNav<T>::SetClock(const double &cb, const double &cd) {
   cb_ = cb;
   cd_ = cd;
 }
 
+// *=== SetUpdateStrategy ===*
+template <typename T>
+void InertialNav<T>::SetUpdateStrategy(const UpdateStrategy &strategy) {
+  strategy_ = strategy;
+}
+
+// *=== SetInnovationGate ===*
+template <typename T>
+void InertialNav<T>::SetInnovationGate(const double &gate) {
+  ws_.SetGate(gate);
+}
+
+// *=== SetDensePropagation ===*
+template <typename T>
+void InertialNav<T>::SetDensePropagation(const bool &dense) {
+  dense_propagation_ = dense;
+}
+
+// *=== SetSquareRoot ===*
+template <typename T>
+void InertialNav<T>::SetSquareRoot(const bool &sqrt_form) {
+  FlushPropagation();
+  sqrt_form_ = sqrt_form;
+  if (sqrt_form_) {
+    FactorSquareRoot();
+    P_.noalias() = S_ * S_.transpose();
+    is_init_ = true;
+  }
+}
+
+// *=== FactorSquareRoot ===*
+template <typename T>
+void InertialNav<T>::FactorSquareRoot() {
+  // P = T'*L*D*L'*T -> S = T'*L*sqrt(D) (LDLT also covers a singular initial covariance)
+  Eigen::LDLT<Eigen::Matrix<T, 17, 17>> ldlt(P_);
+  S_ = ldlt.matrixL();
+  S_ *= ldlt.vectorD().cwiseMax(0.0).cwiseSqrt().asDiagonal();
+  S_ = ldlt.transpositionsP().transpose() * S_;
+}
+
+// *=== SetPropagationInterval ===*
+template <typename T>
+void InertialNav<T>::SetPropagationInterval(const int &n) {
+  FlushPropagation();
+  prop_interval_ = std::max(n, 1);
+}
+
+// *=== FlushPropagation ===*
+template <typename T>
+void InertialNav<T>::FlushPropagation() {
+  if (n_prop_ == 0) {
+    return;
+  }
+
+  // second order transition Phi = I + A + A^2/2 with A = sum(F_k*dt_k), bias rows of A are zero
+  // and the clock block of A^2 vanishes, so only the navigation rows are affected
+  Eigen::Matrix<T, 9, 9> Ann = Phi_.template topLeftCorner<9, 9>();
+  Ann.diagonal().array() -= 1.0;
+  Eigen::Matrix<T, 9, 15> A2;
+  A2.noalias() = Ann * Phi_.template topLeftCorner<9, 15>();  // Ann * [I + Ann, Anb]
+  A2.template leftCols<9>() -= Ann;
+  Phi_.template topLeftCorner<9, 15>() += 0.5 * A2;
+
+  // clock process noise is exact for the whole interval
+  ClockProcessCov(Qd_, Tp_);
+  PropagateCovariance(Phi_, Qd_, Tp_, true);
+  if (log_) {
+    LogPropagation(Phi_);
+  }
+  n_prop_ = 0;
+  Tp_ = 0.0;
+}
+
 // *=== Propagate ===*
-void InertialNav::Propagate(
-    const Eigen::Ref<const Eigen::Vector3d> &wb,
-    const Eigen::Ref<const Eigen::Vector3d> &fb,
+template <typename T>
+void InertialNav<T>::Propagate(
+    const Eigen::Ref<const Eigen::Vector3<T>> &wb,
+    const Eigen::Ref<const Eigen::Vector3<T>> &fb,
     const double &dt) {
-  Rg_ = Re_ * std::sqrt(1.0 - sLsq_ * navtools::WGS84_E<> * (2.0 - navtools::WGS84_E<>));
-  cLsq_ = cL_ * cL_;
-  Hnsq_ = Hn_ * Hn_;
-  Hesq_ = He_ * He_;
+  STURDINS_STAGE_TIMER(Stage::PROPAGATE);
+
+  // geodetic terms of the preceding Mechanize
+  const GeodeticCache &geo = geo_;
   double vnve_ = vn_ * ve_;
   double vn_Hn_ = -w_en_n_(1);
   double ve_He_ = w_en_n_(0);
-  double ve_Hn_ = ve_ / Hn_;
+  double ve_Hn_ = ve_ / geo.Hn_;
   double vnsq_ = vn_ * vn_;
   double vesq_ = ve_ * ve_;
-  double HnHe_ = Hn_ * He_;
+  double HnHe_ = geo.Hn_ * geo.He_;
   double vewie = ve_ * navtools::WGS84_OMEGA<>;
   double vnwie = vn_ * navtools::WGS84_OMEGA<>;
   double two_wie = 2.0 * navtools::WGS84_OMEGA<>;
@@ -129,13 +242,13 @@ void InertialNav::Propagate(
    * |      Z3          Z3         Z3       Z3   I3 |
    * --                                            --
    */
-  Eigen::Vector3d wn = C_b_l_ * wb - (w_ie_n_ + w_en_n_);
-  Eigen::Vector3d fn = C_b_l_ * fb;
+  Eigen::Vector3<T> wn = C_b_l_ * wb - (w_ie_n_ + w_en_n_);
+  Eigen::Vector3<T> fn = C_b_l_ * fb;
 
   // F33
   F_(0, 0) = 1.0;
   F_(0, 2) = vn_Hn_ * dt;
-  F_(1, 0) = ve_Hn_ * tL_ * dt;
+  F_(1, 0) = ve_Hn_ * geo.tL_ * dt;
   F_(1, 1) = 1.0;
   F_(1, 2) = ve_He_ * dt;
   F_(2, 2) = 1.0;
@@ -146,22 +259,22 @@ void InertialNav::Propagate(
   F_(2, 5) = dt;
 
   // F23*T
-  F_(3, 0) = -(vesq_ / HnHe_ / cLsq_ + 2.0 * vewie * cL_ / Hn_) * dt;
-  F_(3, 2) = (-vesq_ * tL_ / Hesq_ + vn_ * vd_ / Hnsq_) * dt;
-  F_(4, 0) = (vnve_ / HnHe_ / cLsq_ + 2.0 * (vnwie * cL_ - vd_ * sL_) / Hn_) * dt;
-  F_(4, 2) = ((vnve_ * tL_ + ve_ * vd_) / Hesq_) * dt;
-  F_(5, 0) = (2.0 * vewie * sL_ / Hn_) * dt;
-  F_(5, 2) = (-vesq_ / Hesq_ - vnsq_ / Hnsq_ + 2.0 * g0_ / Rg_) * dt;
+  F_(3, 0) = -(vesq_ / HnHe_ / geo.cLsq_ + 2.0 * vewie * geo.cL_ / geo.Hn_) * dt;
+  F_(3, 2) = (-vesq_ * geo.tL_ / geo.Hesq_ + vn_ * vd_ / geo.Hnsq_) * dt;
+  F_(4, 0) = (vnve_ / HnHe_ / geo.cLsq_ + 2.0 * (vnwie * geo.cL_ - vd_ * geo.sL_) / geo.Hn_) * dt;
+  F_(4, 2) = ((vnve_ * geo.tL_ + ve_ * vd_) / geo.Hesq_) * dt;
+  F_(5, 0) = (2.0 * vewie * geo.sL_ / geo.Hn_) * dt;
+  F_(5, 2) = (-vesq_ / geo.Hesq_ - vnsq_ / geo.Hnsq_ + 2.0 * geo.g0_ / geo.Rg_) * dt;
 
   // I3 + F22 * T
-  F_(3, 3) = 1.0 + (vd_ / Hn_) * dt;
-  F_(3, 4) = -(2.0 * ve_He_ * tL_ + two_wie * sL_) * dt;
+  F_(3, 3) = 1.0 + (vd_ / geo.Hn_) * dt;
+  F_(3, 4) = -(2.0 * ve_He_ * geo.tL_ + two_wie * geo.sL_) * dt;
   F_(3, 5) = vn_Hn_ * dt;
-  F_(4, 3) = (ve_He_ * tL_ + 2.0 * two_wie * sL_) * dt;
-  F_(4, 4) = 1.0 + ((vn_ * tL_ + vd_) / He_) * dt;
-  F_(4, 5) = (ve_He_ + two_wie * cL_) * dt;
+  F_(4, 3) = (ve_He_ * geo.tL_ + 2.0 * two_wie * geo.sL_) * dt;
+  F_(4, 4) = 1.0 + ((vn_ * geo.tL_ + vd_) / geo.He_) * dt;
+  F_(4, 5) = (ve_He_ + two_wie * geo.cL_) * dt;
   F_(5, 3) = -2.0 * vn_Hn_ * dt;
-  F_(5, 4) = -(2.0 * ve_He_ + two_wie * cL_) * dt;
+  F_(5, 4) = -(2.0 * ve_He_ + two_wie * geo.cL_) * dt;
   F_(5, 5) = 1.0;
 
   // F21*T
@@ -184,16 +297,16 @@ void InertialNav::Propagate(
   F_(5, 11) = C_b_l_(2, 2) * dt;
 
   // F13*T
-  F_(6, 0) = (navtools::WGS84_OMEGA<> * sL_ / Hn_) * dt;
-  F_(6, 2) = (-ve_ / Hesq_) * dt;
-  F_(7, 2) = (vn_ / Hnsq_) * dt;
-  F_(8, 0) = ((navtools::WGS84_OMEGA<> * cL_ + ve_He_ / cLsq_) / Hn_) * dt;
-  F_(8, 2) = (ve_ * tL_ / Hesq_) * dt;
+  F_(6, 0) = (navtools::WGS84_OMEGA<> * geo.sL_ / geo.Hn_) * dt;
+  F_(6, 2) = (-ve_ / geo.Hesq_) * dt;
+  F_(7, 2) = (vn_ / geo.Hnsq_) * dt;
+  F_(8, 0) = ((navtools::WGS84_OMEGA<> * geo.cL_ + ve_He_ / geo.cLsq_) / geo.Hn_) * dt;
+  F_(8, 2) = (ve_ * geo.tL_ / geo.Hesq_) * dt;
 
   // F12*T
-  F_(6, 4) = -dt / He_;
-  F_(7, 3) = dt / Hn_;
-  F_(8, 4) = dt * tL_ / He_;
+  F_(6, 4) = -dt / geo.He_;
+  F_(7, 3) = dt / geo.Hn_;
+  F_(8, 4) = dt * geo.tL_ / geo.He_;
 
   // I3 + F11*T
   F_(6, 6) = 1.0;
@@ -233,7 +346,8 @@ void InertialNav::Propagate(
   F_(16, 16) = 1.0;
 
   /**
-   * @brief First order simplified Q matrix from Groves Ch.14
+   * @brief First order simplified Q matrix from Groves Ch.14, looked up in the process noise model
+   *        (Q_ is only refilled when dt changes)
    * --                                   --
    * | Srg*I3    Z3    Z3     Z3      Z3   |
    * |  Z3     Sra*I3  Z3     Z3      Z3   |
@@ -242,94 +356,218 @@ void InertialNav::Propagate(
    * |  Z3       Z3    Z3     Z3    Sgd*I3 |
    * --                                   --
    */
-  double dtsq = dt * dt;
-  double dtcb = dtsq * dt;
-  Q_(0, 0) = 0.5 * Srg_ * dt;
-  Q_(1, 1) = Q_(0, 0);
-  Q_(2, 2) = Q_(0, 0);
-  Q_(3, 3) = 0.5 * Sra_ * dt;
-  Q_(4, 4) = Q_(3, 3);
-  Q_(5, 5) = Q_(3, 3);
-  Q_(9, 9) = 0.5 * Sbad_ * dt;
-  Q_(10, 10) = Q_(9, 9);
-  Q_(11, 11) = Q_(9, 9);
-  Q_(12, 12) = 0.5 * Sbgd_ * dt;
-  Q_(13, 13) = Q_(12, 12);
-  Q_(14, 14) = Q_(12, 12);
-
-  // Clock Q
-  Q_(15, 15) = 0.5 * (h0_ * dt) + (h1_ * dtsq) + (2.0 / 3.0 * h2_ * dtcb);
-  Q_(15, 16) = 0.5 * (h1_ * dt) + (h2_ * dtsq);
-  Q_(16, 15) = Q_(6, 7);
-  Q_(16, 16) = 0.5 * (h0_ / dt) + h1_ + (8.0 / 3.0 * h2_ * dt);
+  if (dt != q_dt_) {
+    ProcessNoiseBlocks scratch;
+    const ProcessNoiseBlocks &q = noise_->Blocks(dt, scratch);
+    Q_.diagonal().template head<15>() = q.ins_.template cast<T>();
+    Q_.template block<2, 2>(15, 15) = q.ins_clock_.template cast<T>();
+    q_dt_ = dt;
+  }
 
   // === Kalman Propagation ===
-  P_ = F_ * (P_ + Q_) * F_.transpose() + Q_;
+  if (prop_interval_ == 1) {
+    PropagateCovariance(F_, Q_, dt, false);
+    if (log_) {
+      LogPropagation(F_);
+    }
+  } else {
+    // accumulate the first order transition (I + sum(F_k*dt_k)) and process noise
+    if (n_prop_ == 0) {
+      Phi_ = F_;
+      Qd_ = Q_;
+    } else {
+      // only the navigation rows and the clock drift term of F vary, Q is diagonal (the clock
+      // block is evaluated over the whole interval)
+      Phi_.template topLeftCorner<9, 15>() += F_.template topLeftCorner<9, 15>();
+      Phi_.diagonal().template head<9>().array() -= 1.0;
+      Phi_(15, 16) += dt;
+      Qd_.diagonal().template head<15>() += Q_.diagonal().template head<15>();
+    }
+    Tp_ += dt;
+    if (++n_prop_ >= prop_interval_) {
+      FlushPropagation();
+    }
+  }
   // x_ = F_ * x_;
 }
 
+// *=== PropagateIncrements ===*
+template <typename T>
+void InertialNav<T>::PropagateIncrements(
+    const Eigen::Ref<const Eigen::Matrix3X<T>> &dtheta,
+    const Eigen::Ref<const Eigen::Matrix3X<T>> &dvel,
+    const double &dt) {
+  if (dtheta.cols() == 0) {
+    return;
+  }
+  this->MechanizeIncrements(dtheta, dvel, dt);
+  const double Tb = dtheta.cols() * dt;
+  Propagate(dtheta_b_ / Tb, dv_b_ / Tb, Tb);
+}
+
+// *=== ClockProcessCov ===*
+template <typename T>
+void InertialNav<T>::ClockProcessCov(Eigen::Matrix<T, 17, 17> &Q, const double &dt) {
+  ProcessNoiseBlocks scratch;
+  Q.template block<2, 2>(15, 15) = noise_->Blocks(dt, scratch).ins_clock_.template cast<T>();
+}
+
+// *=== PropagateCovariance ===*
+template <typename T>
+void InertialNav<T>::PropagateCovariance(
+    const Eigen::Matrix<T, 17, 17> &F,
+    const Eigen::Matrix<T, 17, 17> &Q,
+    const double &dt,
+    const bool &dense_Fnb) {
+  if (sqrt_form_) {
+    PropagateSquareRoot(F, Q);
+    return;
+  }
+  if (dense_propagation_) {
+    P_ = F * (P_ + Q) * F.transpose() + Q;
+    return;
+  }
+
+  /**
+   * @brief With M = P + Q and the state split into navigation (n, 9), bias (b, 6) and clock (c, 2)
+   * --             --
+   * | Fnn  Fnb   Z  |
+   * |  Z   I6    Z  |    G = [Fnn Fnb],  GM = G * M(n+b,:)
+   * |  Z    Z   Fcc |
+   * --             --
+   *    P_nn = GM_n * Fnn' + GM_b * Fnb'    P_nb = GM_b     P_nc = GM_c * Fcc'
+   *    P_bb = M_bb                         P_bc = M_bc * Fcc'
+   *    P_cc = Fcc * M_cc * Fcc'
+   * where a single step Fnb only contains the two C_b_l*dt blocks (velocity/accel bias,
+   * attitude/gyro bias), an accumulated transition has a full Fnb
+   */
+  P_ += Q;
+  auto Fnn = F.template topLeftCorner<9, 9>();
+  auto Fnb = F.template block<9, 6>(0, 9);
+  auto Cdt = F.template block<3, 3>(3, 9);
+
+  // GM = G * M(n+b,:)
+  Eigen::Matrix<T, 9, 17> GM;
+  GM.noalias() = Fnn * P_.template topRows<9>();
+  if (dense_Fnb) {
+    GM.noalias() += Fnb * P_.template middleRows<6>(9);
+  } else {
+    GM.template middleRows<3>(3).noalias() += Cdt * P_.template middleRows<3>(9);
+    GM.template middleRows<3>(6).noalias() += Cdt * P_.template middleRows<3>(12);
+  }
+
+  // navigation/navigation
+  Eigen::Matrix<T, 9, 9> Pnn;
+  Pnn.noalias() = GM.template leftCols<9>() * Fnn.transpose();
+  if (dense_Fnb) {
+    Pnn.noalias() += GM.template middleCols<6>(9) * Fnb.transpose();
+  } else {
+    Pnn.template middleCols<3>(3).noalias() += GM.template middleCols<3>(9) * Cdt.transpose();
+    Pnn.template middleCols<3>(6).noalias() += GM.template middleCols<3>(12) * Cdt.transpose();
+  }
+  P_.template topLeftCorner<9, 9>() = Pnn;
+
+  // navigation/bias
+  P_.template block<9, 6>(0, 9) = GM.template middleCols<6>(9);
+  P_.template block<6, 9>(9, 0) = GM.template middleCols<6>(9).transpose();
+
+  // clock (Fcc = [1 dt; 0 1], right multiplication by Fcc' adds dt * column 16 to column 15)
+  P_.template block<9, 2>(0, 15) = GM.template rightCols<2>();
+  P_.col(15).template head<15>() += dt * P_.col(16).template head<15>();
+  P_.template block<2, 15>(15, 0) = P_.template block<15, 2>(0, 15).transpose();
+  P_(15, 15) += dt * (P_(15, 16) + P_(16, 15) + dt * P_(16, 16));
+  P_(15, 16) += dt * P_(16, 16);
+  P_(16, 15) = P_(15, 16);
+
+  P_ += Q;
+}
+
+// *=== PropagateSquareRoot ===*
+template <typename T>
+void InertialNav<T>::PropagateSquareRoot(
+    const Eigen::Matrix<T, 17, 17> &F, const Eigen::Matrix<T, 17, 17> &Q) {
+  // Q = Lq*Lq', Q is diagonal except for the 2x2 clock block
+  Eigen::Matrix<T, 17, 17> Lq = Eigen::Matrix<T, 17, 17>::Zero();
+  Lq.diagonal().template head<15>() = Q.diagonal().template head<15>().cwiseSqrt();
+  Lq(15, 15) = std::sqrt(Q(15, 15));
+  Lq(16, 15) = (Lq(15, 15) > 0.0) ? Q(16, 15) / Lq(15, 15) : 0.0;
+  Lq(16, 16) = std::sqrt(std::max<T>(Q(16, 16) - Lq(16, 15) * Lq(16, 15), 0.0));
+
+  // F*(P+Q)*F' + Q = A'*A with A = [S'*F'; Lq'*F'; Lq'], so A = Q*R gives the new S = R' (rows
+  // 6-8 (attitude) of Lq' are zero, the attitude has no process noise, and are left out of A)
+  constexpr int ATT = 6;             // first zero row of Lq'
+  constexpr int NA = 3;              // number of zero rows
+  constexpr int NB = 17 - ATT - NA;  // rows after the zero rows
+  constexpr int NQ = ATT + NB;       // rows of Lq' kept in A
+  static_assert(decltype(A_)::RowsAtCompileTime == 17 + 2 * NQ);
+  eigen_assert(
+      Q.diagonal().template segment<NA>(ATT).isZero(0) &&
+      "the rows of Lq' left out of the square root propagation must be zero");
+  Eigen::Matrix<T, 17, 17> LqtFt;
+  LqtFt.noalias() = Lq.transpose() * F.transpose();
+  A_.template topRows<17>().noalias() = S_.transpose() * F.transpose();
+  A_.template middleRows<ATT>(17) = LqtFt.template topRows<ATT>();
+  A_.template middleRows<NB>(17 + ATT) = LqtFt.template bottomRows<NB>();
+  A_.template middleRows<ATT>(17 + NQ) = Lq.transpose().template topRows<ATT>();
+  A_.template bottomRows<NB>() = Lq.transpose().template bottomRows<NB>();
+  qr_.compute(A_);
+  S_.setZero();
+  S_.template triangularView<Eigen::Lower>() = qr_.matrixQR().template topRows<17>().transpose();
+  P_.noalias() = S_ * S_.transpose();
+}
+
 // *=== GnssUpdate ===*
-void InertialNav::GnssUpdate(
+template <typename T>
+void InertialNav<T>::GnssUpdate(
     const Eigen::Ref<const Eigen::MatrixXd> &sv_pos,
     const Eigen::Ref<const Eigen::MatrixXd> &sv_vel,
     const Eigen::Ref<const Eigen::VectorXd> &psr,
     const Eigen::Ref<const Eigen::VectorXd> &psrdot,
     const Eigen::Ref<const Eigen::VectorXd> &psr_var,
     const Eigen::Ref<const Eigen::VectorXd> &psrdot_var) {
+  // apply any pending covariance propagation
+  FlushPropagation();
+
   // Initialize
   const int N = psr.size();
-  const int M = 2 * N;
-  Eigen::VectorXd dy(M);
-  Eigen::MatrixXd H = Eigen::MatrixXd::Zero(M, 17);
-  for (int i = 0; i < N; i++) {
-    H(i, 15) = 1.0;
-    H(N + i, 16) = 1.0;
-  }
-  Eigen::MatrixXd R = Eigen::MatrixXd::Zero(M, M);
-  R.diagonal() << psr_var, psrdot_var;
+  rejected_.resize(2 * N);
 
   // Functions of current position
-  double sLam = std::sin(lam_);
-  double cLam = std::cos(lam_);
-  sL_ = std::sin(phi_);
-  cL_ = std::cos(phi_);
-  RadiiOfCurvature<false>();  // Re_ and Rn_
-  Hn_ = Rn_ + h_;
-  He_ = Re_ + h_;
-  Eigen::Matrix3d C_l_e{
-      {-sL_ * cLam, -sLam, -cL_ * cLam}, {-sL_ * sLam, cLam, -cL_ * sLam}, {cL_, 0.0, -sL_}};
-  Eigen::Matrix3d C_e_l = C_l_e.transpose();
+  geo_.Update(phi_, lam_, h_);
+  const Eigen::Matrix3d &C_l_e = geo_.NedToEcef();
 
-  // Generate observation predictions
-  Eigen::Vector3d u, udot;
-  Eigen::Vector3d ecef_p{He_ * cL_ * cLam, He_ * cL_ * sLam, (Re_ * X1ME2_ + h_) * sL_};
+  // Generate observation predictions (in blocks of at most MAX_SV satellites)
+  const Eigen::Vector3d &ecef_p = geo_.EcefPosition();
   Eigen::Vector3d ecef_v{vn_, ve_, vd_};
   ecef_v = C_l_e * ecef_v;
-  double pred_psr, pred_psrdot;
-  for (int i = 0; i < N; i++) {
-    RangeAndRate(
-        ecef_p, ecef_v, cb_, cd_, sv_pos.col(i), sv_vel.col(i), u, udot, pred_psr, pred_psrdot);
-    u = C_e_l * u;
-    udot = C_e_l * udot;
-    H(i, 0) = u(0);
-    H(i, 1) = u(1);
-    H(i, 2) = u(2);
-    H(N + i, 0) = udot(0);
-    H(N + i, 1) = udot(1);
-    H(N + i, 2) = udot(2);
-    H(N + i, 3) = u(0);
-    H(N + i, 4) = u(1);
-    H(N + i, 5) = u(2);
-    dy(i) = psr(i) - pred_psr;
-    dy(N + i) = psrdot(i) - pred_psrdot;
+  for (int i0 = 0; i0 < N; i0 += MAX_SV) {
+    STURDINS_STAGE_TIMER(Stage::MEASUREMENT_MODEL);
+    const int Nb = std::min(MAX_SV, N - i0);
+    if (!ws_.Reshape(2 * Nb, GNSS_LAYOUT)) {
+      ws_.H_.col(15).head(Nb).setOnes();
+      ws_.H_.col(16).segment(Nb, Nb).setOnes();
+    }
+    pred_.Predict(ecef_p, ecef_v, cb_, cd_, sv_pos.middleCols(i0, Nb), sv_vel.middleCols(i0, Nb));
+    ws_.H_.block(0, 0, Nb, 3).noalias() = (pred_.u_ * C_l_e).template cast<T>();
+    ws_.H_.block(Nb, 0, Nb, 3).noalias() = (pred_.udot_ * C_l_e).template cast<T>();
+    ws_.H_.block(Nb, 3, Nb, 3) = ws_.H_.block(0, 0, Nb, 3);
+    ws_.dy_.head(Nb) = (psr.segment(i0, Nb) - pred_.psr_).template cast<T>();
+    ws_.dy_.segment(Nb, Nb) = (psrdot.segment(i0, Nb) - pred_.psrdot_).template cast<T>();
+    ws_.r_.head(Nb) = psr_var.segment(i0, Nb).template cast<T>();
+    ws_.r_.segment(Nb, Nb) = psrdot_var.segment(i0, Nb).template cast<T>();
+    STURDINS_STAGE_TIMER_STOP();
+
+    // === Kalman Update ===
+    KalmanUpdate();
+    rejected_.segment(i0, Nb) = ws_.rejected_.head(Nb);
+    rejected_.segment(N + i0, Nb) = ws_.rejected_.segment(Nb, Nb);
   }
-
-  // === Kalman Update ===
-  KalmanUpdate(R, H, dy);
+  ClosedLoopCorrection();
 }
 
 // *=== PhasedArrayUpdate ===*
-void InertialNav::PhasedArrayUpdate(
+template <typename T>
+void InertialNav<T>::PhasedArrayUpdate(
     const Eigen::Ref<const Eigen::Matrix3Xd> &sv_pos,
     const Eigen::Ref<const Eigen::Matrix3Xd> &sv_vel,
     const Eigen::Ref<const Eigen::VectorXd> &psr,
@@ -341,173 +579,252 @@ void InertialNav::PhasedArrayUpdate(
     const Eigen::Ref<const Eigen::Matrix3Xd> &ant_xyz,
     const int &n_ant,
     const double &lamb) {
-  // Initialize
-  const int N = psr.size();
-  const int M = 2 * N;
-  const int MM = M + (n_ant - 1) * N;
-  Eigen::VectorXd dy(MM);
-  Eigen::MatrixXd H = Eigen::MatrixXd::Zero(MM, 17);
-  for (int ii = 0; ii < N; ii++) {
-    H(ii, 15) = 1.0;
-    H(N + ii, 16) = 1.0;
-  }
+  // apply any pending covariance propagation
+  FlushPropagation();
 
-  // measurement variance
-  int k1, k2;
-  Eigen::MatrixXd R = Eigen::MatrixXd::Zero(MM, MM);
-  for (int ii = 0; ii < N; ii++) {
-    k1 = N + ii;
-    R(ii, ii) = psr_var(ii);
-    R(k1, k1) = psrdot_var(ii);
-    for (int jj = 1; jj < n_ant; jj++) {
-      k2 = M + (n_ant - 1) * ii + jj - 1;
-      R(k2, k2) = phase_var(jj, ii);
-    }
+  // Initialize (each satellite adds a psr, psrdot, and n_ant-1 phase measurements to a block)
+  const int N = psr.size();
+  rejected_.resize((n_ant + 1) * N);
+  const int Nmax = KalmanWorkspace<17, 2 * MAX_SV, T>::MAX_M / (n_ant + 1);
+  eigen_assert(Nmax > 0 && "too many antennas for the measurement workspace");
+  if (Nmax == 0) {
+    // not even one satellite fits in a block, leave the state untouched
+    rejected_.setConstant(true);
+    return;
   }
 
   // Functions of current position
-  double sLam = std::sin(lam_);
-  double cLam = std::cos(lam_);
-  sL_ = std::sin(phi_);
-  cL_ = std::cos(phi_);
-  sLsq_ = sL_ * sL_;
-  Eigen::Matrix3d C_l_e{
-      {-sL_ * cLam, -sLam, -cL_ * cLam}, {-sL_ * sLam, cLam, -cL_ * sLam}, {cL_, 0.0, -sL_}};
-  Eigen::Matrix3d C_e_l = C_l_e.transpose();
-
-  // radii of curvature
-  double t = 1.0 - navtools::WGS84_E2<> * sLsq_;
-  double sqt = std::sqrt(t);
-  Re_ = navtools::WGS84_R0<> / sqt;
-  Rn_ = navtools::WGS84_R0<> * X1ME2_ / (t * t / sqt);
-  He_ = Re_ + h_;
-  Hn_ = Rn_ + h_;
+  geo_.Update(phi_, lam_, h_);
+  const Eigen::Matrix3d &C_l_e = geo_.NedToEcef();
 
   // Generate observation predictions
-  Eigen::Vector3d u, udot, hp;
-  ecef_p_ << He_ * cL_ * cLam, He_ * cL_ * sLam, (Re_ * X1ME2_ + h_) * sL_;
+  const int A = n_ant - 1;
+  ecef_p_ = geo_.EcefPosition();
   ecef_v_ << vn_, ve_, vd_;
   ecef_v_ = C_l_e * ecef_v_;
-  double pred_psr, pred_psrdot, pred_phase;
-  Eigen::Matrix3Xd ant_ned = C_b_l_ * ant_xyz;
-  // std::cout << "C_b_l = \n" << C_b_l_ << "\n";
-  for (int ii = 0; ii < N; ii++) {
-    RangeAndRate(
-        ecef_p_, ecef_v_, cb_, cd_, sv_pos.col(ii), sv_vel.col(ii), u, udot, pred_psr, pred_psrdot);
-    u = C_e_l * u;
-    udot = C_e_l * udot;
-
-    for (int jj = 1; jj < n_ant; jj++) {
-      k2 = M + (n_ant - 1) * ii + jj - 1;
-      pred_phase = -(ant_ned.col(jj).transpose() * u)(0) / lamb;
-      pred_phase = std::fmod(pred_phase + navtools::PI<>, navtools::TWO_PI<>) - navtools::PI<>;
-      if (pred_phase < -navtools::PI<>) {
-        pred_phase += navtools::TWO_PI<>;
-      } else if (pred_phase > navtools::PI<>) {
-        pred_phase -= navtools::TWO_PI<>;
-      }
-      // hp = -(navtools::Skew<double>(ant_ned.col(j)).transpose() * u) / lamb;
-      hp = 2.0 * (navtools::Skew(ant_ned.col(jj)).transpose() * u) / lamb;
-
-      H(k2, 6) = hp(0);
-      H(k2, 7) = hp(1);
-      H(k2, 8) = hp(2);
-      dy(k2) = phase(jj, ii) - pred_phase;
-      dy(k2) = std::fmod(dy(k2) + navtools::PI<>, navtools::TWO_PI<>) - navtools::PI<>;
-      if (dy(k2) < -navtools::PI<>) {
-        dy(k2) += navtools::TWO_PI<>;
-      } else if (dy(k2) > navtools::PI<>) {
-        dy(k2) -= navtools::TWO_PI<>;
-      }
-      // std::cout << "meas_phase(" << k2 << "): " << phase(jj, ii) << " | est_phase(" << k2
-      //           << "): " << pred_phase << " | dy(" << k2 << "): " << dy(k2) << "\n";
-    }
-
-    H(ii, 0) = u(0);
-    H(ii, 1) = u(1);
-    H(ii, 2) = u(2);
-    H(N + ii, 0) = udot(0);
-    H(N + ii, 1) = udot(1);
-    H(N + ii, 2) = udot(2);
-    H(N + ii, 3) = u(0);
-    H(N + ii, 4) = u(1);
-    H(N + ii, 5) = u(2);
-    dy(ii) = psr(ii) - pred_psr;
-    dy(N + ii) = psrdot(ii) - pred_psrdot;
+  for (int i0 = 0; i0 < N; i0 += Nmax) {
+    STURDINS_STAGE_TIMER(Stage::MEASUREMENT_MODEL);
+    const int Nb = std::min(Nmax, N - i0);
+    const int M = 2 * Nb;
+    ws_.Resize(M + A * Nb);
+    pred_.Predict(
+        ecef_p_, ecef_v_, cb_, cd_, sv_pos.middleCols(i0, Nb), sv_vel.middleCols(i0, Nb));
+    ws_.H_.block(0, 0, Nb, 3).noalias() = (pred_.u_ * C_l_e).template cast<T>();
+    ws_.H_.block(Nb, 0, Nb, 3).noalias() = (pred_.udot_ * C_l_e).template cast<T>();
+    ws_.H_.block(Nb, 3, Nb, 3) = ws_.H_.block(0, 0, Nb, 3);
+    ws_.H_.col(15).head(Nb).setOnes();
+    ws_.H_.col(16).segment(Nb, Nb).setOnes();
+    ws_.dy_.head(Nb) = (psr.segment(i0, Nb) - pred_.psr_).template cast<T>();
+    ws_.dy_.segment(Nb, Nb) = (psrdot.segment(i0, Nb) - pred_.psrdot_).template cast<T>();
+    ws_.r_.head(Nb) = psr_var.segment(i0, Nb).template cast<T>();
+    ws_.r_.segment(Nb, Nb) = psrdot_var.segment(i0, Nb).template cast<T>();
+
+    // phase of antennas 1..n_ant-1 relative to antenna 0, all satellite/antenna pairs at once
+    phase_pred_.Predict(
+        C_b_l_.template cast<double>(),
+        C_l_e,
+        pred_.u_,
+        phase.block(1, i0, A, Nb),
+        ant_xyz.middleCols(1, A),
+        lamb,
+        2.0);
+    ws_.H_.block(M, 6, A * Nb, 3) = phase_pred_.H_.template cast<T>();
+    ws_.dy_.segment(M, A * Nb) = phase_pred_.dy_.template cast<T>();
+    ws_.r_.segment(M, A * Nb) = phase_var.block(1, i0, A, Nb).reshaped().template cast<T>();
+    STURDINS_STAGE_TIMER_STOP();
+
+    // === Kalman Update ===
+    KalmanUpdate();
+    rejected_.segment(i0, Nb) = ws_.rejected_.head(Nb);
+    rejected_.segment(N + i0, Nb) = ws_.rejected_.segment(Nb, Nb);
+    rejected_.segment(2 * N + (n_ant - 1) * i0, (n_ant - 1) * Nb) =
+        ws_.rejected_.segment(M, (n_ant - 1) * Nb);
   }
+  ClosedLoopCorrection();
+}
+
+// *=== AttitudeUpdate ===*
+template <typename T>
+void InertialNav<T>::AttitudeUpdate(
+    const Eigen::Ref<const Eigen::Matrix3d> &C, const Eigen::Ref<const Eigen::Matrix3d> &R) {
+  // apply any pending covariance propagation
+  FlushPropagation();
+
+  Eigen::Matrix3d C_err = C * C_b_l_.transpose().template cast<double>();
+  ws_.Resize(3);
+  ws_.dy_ = navtools::DeSkew<double>(C_err).template cast<T>();
+  ws_.H_(0, 6) = 1.0;
+  ws_.H_(1, 7) = 1.0;
+  ws_.H_(2, 8) = 1.0;
+  ws_.SetCovariance(R);
 
   // === Kalman Update ===
-  KalmanUpdate(R, H, dy);
-}
-
-void InertialNav::KalmanUpdate(
-    const Eigen::Ref<const Eigen::MatrixXd> &R,
-    const Eigen::Ref<const Eigen::MatrixXd> &H,
-    const Eigen::Ref<const Eigen::VectorXd> &dy) {
-  // // innovation filter
-  // Eigen::MatrixXd PHt = P_ * H.transpose();
-  // Eigen::VectorXd sqrt_S = (H * PHt + R).diagonal().cwiseSqrt();
-  // Eigen::VectorX<bool> mask = (dy.array().abs() / sqrt_S.array()) < 3.0;
-  // const int new_M = (mask).count();
-  // if (new_M < M) {
-  //   if (new_M > 0) {
-  //     Eigen::MatrixXd new_H(new_M, 8);
-  //     Eigen::MatrixXd new_R(new_M, new_M);
-  //     Eigen::VectorXd new_dy(new_M);
-  //     int k = 0;
-  //     for (int i = 0; i < M; i++) {
-  //       if (mask(i)) {
-  //         new_H.row(k) = H.row(i);
-  //         new_R(k, k) = R(i, i);
-  //         new_dy(k) = dy(i);
-  //         k++;
-  //       }
-  //     }
-
-  //     // === Kalman Update ===
-  //     Eigen::MatrixXd PHt = P_ * new_H.transpose();
-  //     Eigen::MatrixXd K = PHt * (new_H * PHt + new_R).inverse();
-  //     Eigen::MatrixXd L = I17_ - K * new_H;
-  //     P_ = L * P_ * L.transpose() + K * new_R * K.transpose();
-  //     x_ += K * new_dy;
-  //   }
-  // } else {
-  //   // === Kalman Update ===
-  //   Eigen::MatrixXd PHt = P_ * H.transpose();
-  //   Eigen::MatrixXd K = PHt * (H * PHt + R).inverse();
-  //   Eigen::MatrixXd L = I17_ - K * H;
-  //   P_ = L * P_ * L.transpose() + K * R * K.transpose();
-  //   x_ += K * dy;
-  // }
-
-  Eigen::MatrixXd PHt = P_ * H.transpose();
-  Eigen::MatrixXd K = PHt * (H * PHt + R).inverse();
-  Eigen::MatrixXd L = I17_ - K * H;
+  KalmanUpdate();
+  rejected_ = ws_.rejected_;
+  ClosedLoopCorrection();
+}
+
+// *=== SaveSnapshot ===*
+template <typename T>
+void InertialNav<T>::SaveSnapshot(InertialNavSnapshot<T> &snap) {
+  FlushPropagation();
+  snap.pos_[0] = phi_;
+  snap.pos_[1] = lam_;
+  snap.pos_[2] = h_;
+  snap.vel_[0] = vn_;
+  snap.vel_[1] = ve_;
+  snap.vel_[2] = vd_;
+  Eigen::Map<Eigen::Vector4<T>>(snap.q_b_l_) = q_b_l_;
+  Eigen::Map<Eigen::Matrix3<T>>(snap.C_b_l_) = C_b_l_;
+  Eigen::Map<Eigen::Vector3<T>>(snap.bg_) = bg_;
+  Eigen::Map<Eigen::Vector3<T>>(snap.ba_) = ba_;
+  snap.clk_[0] = cb_;
+  snap.clk_[1] = cd_;
+  PackUpper(snap.P_, P_);
+  snap.is_init_ = is_init_;
+}
+
+// *=== RestoreSnapshot ===*
+template <typename T>
+void InertialNav<T>::RestoreSnapshot(const InertialNavSnapshot<T> &snap) {
+  phi_ = snap.pos_[0];
+  lam_ = snap.pos_[1];
+  h_ = snap.pos_[2];
+  vn_ = snap.vel_[0];
+  ve_ = snap.vel_[1];
+  vd_ = snap.vel_[2];
+  q_b_l_ = Eigen::Map<const Eigen::Vector4<T>>(snap.q_b_l_);
+  C_b_l_ = Eigen::Map<const Eigen::Matrix3<T>>(snap.C_b_l_);
+  bg_ = Eigen::Map<const Eigen::Vector3<T>>(snap.bg_);
+  ba_ = Eigen::Map<const Eigen::Vector3<T>>(snap.ba_);
+  cb_ = snap.clk_[0];
+  cd_ = snap.clk_[1];
+  UnpackUpper(P_, snap.P_);
+  is_init_ = snap.is_init_;
+
+  // drop any propagation accumulated since the snapshot
+  x_.setZero();
+  n_prop_ = 0;
+  Tp_ = 0.0;
+  if (sqrt_form_) {
+    FactorSquareRoot();
+  }
+}
+
+// *=== SetSmootherLog ===*
+template <typename T>
+void InertialNav<T>::SetSmootherLog(const bool &enable) {
+  FlushPropagation();
+  log_ = enable;
+  n_log_ = 0;
+  P_log_ = P_;
+  dx_log_.setZero();
+}
+
+// *=== TakeSmootherLog ===*
+template <typename T>
+void InertialNav<T>::TakeSmootherLog(
+    Eigen::Matrix<T, 17, 17> &Phi, Eigen::Matrix<T, 17, 17> &P_pred, Eigen::Vector<T, 17> &dx) {
+  FlushPropagation();
+  if (n_log_ == 0) {
+    Phi.setIdentity();
+  } else {
+    Phi = Phi_log_;
+  }
+  P_pred = P_log_;
+  dx = dx_log_;
+
+  // without a propagation before the next call, the prediction is the current covariance
+  n_log_ = 0;
+  P_log_ = P_;
+  dx_log_.setZero();
+}
+
+// *=== CorrectState ===*
+template <typename T>
+void InertialNav<T>::CorrectState(const Eigen::Ref<const Eigen::Vector<T, 17>> &dx) {
+  x_ = dx;
+  ClosedLoopCorrection();
+}
+
+// *=== GetStateVector ===*
+template <typename T>
+void InertialNav<T>::GetStateVector(Eigen::Ref<Eigen::VectorXd> x) const {
+  eigen_assert(x.size() == STATE_SIZE && "state buffer has the wrong size");
+  x << phi_, lam_, h_, vn_, ve_, vd_, q_b_l_.template cast<double>(), bg_.template cast<double>(),
+      ba_.template cast<double>(), cb_, cd_;
+}
+
+// *=== KalmanUpdate ===*
+template <typename T>
+void InertialNav<T>::KalmanUpdate() {
+  STURDINS_STAGE_TIMER(Stage::KALMAN_UPDATE);
+
+  // the square root form needs no settling iterations
+  if (sqrt_form_) {
+    ws_.SquareRootUpdate(S_, x_);
+    P_.noalias() = S_ * S_.transpose();
+    return;
+  }
+
+  // the initial settling iterations always use the batch gain
+  if (strategy_ == UpdateStrategy::SEQUENTIAL && is_init_) {
+    ws_.SequentialUpdate(P_, x_);
+    return;
+  }
+
+  // skip the block if the innovation covariance is singular
+  if (!ws_.ComputeGain(P_, x_)) {
+    return;
+  }
   if (!is_init_) {
+    // the gate was applied with the S of the initial covariance, re-testing the same innovations
+    // against the S of the settling covariance would reject (nearly) every measurement
+    const double gate = ws_.GetGate();
+    ws_.SetGate(0.0);
     for (int i = 0; i < 100; i++) {
-      P_ = L * P_ * L.transpose() + K * R * K.transpose();
+      ws_.UpdateCovariance(P_);
       P_ = F_ * P_ * F_.transpose() + Q_;
-      PHt = P_ * H.transpose();
-      K = PHt * (H * PHt + R).inverse();
-      L = I17_ - K * H;
+      if (!ws_.ComputeGain(P_, x_)) {
+        ws_.SetGate(gate);
+        return;
+      }
     }
+    ws_.SetGate(gate);
     is_init_ = true;
   } else {
-    P_ = L * P_ * L.transpose() + K * R * K.transpose();
+    ws_.UpdateCovariance(P_);
   }
-  x_ += K * dy;
+  ws_.UpdateState(x_);
+}
 
-  // Closed loop error corrections
-  phi_ += x_(0) / Hn_;
-  lam_ += x_(1) / (He_ * cL_);
+// *=== LogPropagation ===*
+template <typename T>
+void InertialNav<T>::LogPropagation(const Eigen::Matrix<T, 17, 17> &F) {
+  if (n_log_++ == 0) {
+    Phi_log_ = F;
+  } else {
+    Phi_log_ = F * Phi_log_;
+  }
+  P_log_ = P_;
+  dx_log_.setZero();
+}
+
+// *=== ClosedLoopCorrection ===*
+template <typename T>
+void InertialNav<T>::ClosedLoopCorrection() {
+  // Closed loop error corrections (about the position the update was linearized at)
+  geo_.Update(phi_, lam_, h_);
+  phi_ += x_(0) / geo_.Hn_;
+  lam_ += x_(1) / (geo_.He_ * geo_.cL_);
   h_ -= x_(2);
   vn_ += x_(3);
   ve_ += x_(4);
   vd_ += x_(5);
-  Eigen::Vector4d q_err{1.0, 0.5 * x_(6), 0.5 * x_(7), 0.5 * x_(8)};
-  q_b_l_ = navtools::quatdot<double>(q_err, q_b_l_);
+  Eigen::Vector4<T> q_err{1, x_(6) / 2, x_(7) / 2, x_(8) / 2};
+  q_b_l_ = navtools::quatdot<T>(q_err, q_b_l_);
   q_b_l_ /= q_b_l_.norm();
-  navtools::quat2dcm<double>(C_b_l_, q_b_l_);
+  navtools::quat2dcm<T>(C_b_l_, q_b_l_);
   ba_(0) += x_(9);
   ba_(1) += x_(10);
   ba_(2) += x_(11);
@@ -516,7 +833,13 @@ void InertialNav::KalmanUpdate(
   bg_(2) += x_(14);
   cb_ += x_(15);
   cd_ += x_(16);
+  if (log_) {
+    dx_log_ += x_;
+  }
   x_.setZero();
 }
 
+template class InertialNav<float>;
+template class InertialNav<double>;
+
 }  // namespace sturdins
\ No newline at end of file
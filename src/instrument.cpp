@@ -0,0 +1,122 @@
+/**
+ * *instrument.cpp*
+ *
+ * =======  ========================================================================================
+ * @file    sturdins/instrument.cpp
+ * @brief   Optional per-stage call and timing counters of the library hot paths.
+ * @date    January 2025
+ * @author  Daniel Sturdivant <sturdivant20@gmail.com>
+ * =======  ========================================================================================
+ */
+
+#include "sturdins/instrument.hpp"
+
+#ifdef STURDINS_INSTRUMENT
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#endif
+
+namespace sturdins {
+
+#ifdef STURDINS_INSTRUMENT
+
+// live thread counters, totals of exited threads and the totals at the last reset
+struct StageRegistry {
+  std::mutex mutex_;
+  std::vector<ThreadStageCounters *> live_;
+  StageCounters retired_[N_STAGES]{};
+  StageCounters base_[N_STAGES]{};
+};
+
+// constructed on first use so it outlives the thread_local counters of every thread
+static StageRegistry &Registry() {
+  static StageRegistry *registry = new StageRegistry;
+  return *registry;
+}
+
+// totals of a stage over the live and exited threads (registry locked)
+static StageCounters Totals(StageRegistry &reg, const int &i) {
+  StageCounters c = reg.retired_[i];
+  for (const ThreadStageCounters *t : reg.live_) {
+    c.calls_ += t->calls_[i].load(std::memory_order_relaxed);
+    c.nanoseconds_ += t->nanoseconds_[i].load(std::memory_order_relaxed);
+  }
+  return c;
+}
+
+// *=== ThreadStageCounters ===*
+ThreadStageCounters::ThreadStageCounters() {
+  for (int i = 0; i < N_STAGES; i++) {
+    calls_[i].store(0, std::memory_order_relaxed);
+    nanoseconds_[i].store(0, std::memory_order_relaxed);
+  }
+  StageRegistry &reg = Registry();
+  std::lock_guard<std::mutex> lock(reg.mutex_);
+  reg.live_.push_back(this);
+}
+
+// *=== ~ThreadStageCounters ===*
+ThreadStageCounters::~ThreadStageCounters() {
+  StageRegistry &reg = Registry();
+  std::lock_guard<std::mutex> lock(reg.mutex_);
+  for (int i = 0; i < N_STAGES; i++) {
+    reg.retired_[i].calls_ += calls_[i].load(std::memory_order_relaxed);
+    reg.retired_[i].nanoseconds_ += nanoseconds_[i].load(std::memory_order_relaxed);
+  }
+  reg.live_.erase(std::find(reg.live_.begin(), reg.live_.end(), this));
+}
+
+// *=== GetStageCounters ===*
+StageCounters GetStageCounters(const Stage &stage) {
+  const int i = static_cast<int>(stage);
+  StageRegistry &reg = Registry();
+  std::lock_guard<std::mutex> lock(reg.mutex_);
+  StageCounters c = Totals(reg, i);
+  c.calls_ -= reg.base_[i].calls_;
+  c.nanoseconds_ -= reg.base_[i].nanoseconds_;
+  return c;
+}
+
+// *=== ResetStageCounters ===*
+void ResetStageCounters() {
+  StageRegistry &reg = Registry();
+  std::lock_guard<std::mutex> lock(reg.mutex_);
+  for (int i = 0; i < N_STAGES; i++) {
+    reg.base_[i] = Totals(reg, i);
+  }
+}
+
+#else
+
+// *=== GetStageCounters ===*
+StageCounters GetStageCounters(const Stage &) {
+  return StageCounters{0, 0};
+}
+
+// *=== ResetStageCounters ===*
+void ResetStageCounters() {
+}
+
+#endif
+
+// *=== StageName ===*
+const char *StageName(const Stage &stage) {
+  switch (stage) {
+    case Stage::MECHANIZE:
+      return "Mechanize";
+    case Stage::PROPAGATE:
+      return "Propagate";
+    case Stage::MEASUREMENT_MODEL:
+      return "MeasurementModel";
+    case Stage::KALMAN_UPDATE:
+      return "KalmanUpdate";
+    case Stage::GNSS_PVT_ITERATION:
+      return "GnssPVTIteration";
+    case Stage::MUSIC_LEVEL:
+      return "MusicLevel";
+  }
+  return "";
+}
+
+}  // namespace sturdins
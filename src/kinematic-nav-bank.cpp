@@ -0,0 +1,370 @@
+/**
+ * *kinematic-nav-bank.cpp*
+ *
+ * =======  ========================================================================================
+ * @file    sturdins/kinematic-nav-bank.cpp
+ * @brief   Structure-of-arrays bank of kinematic navigation Kalman Filters.
+ * @date    January 2025
+ * @author  Daniel Sturdivant <sturdivant20@gmail.com>
+ * @ref     1. "Principles of GNSS, Inertial, and Multisensor Integrated Navigation Systems", 2nd
+ *              Edition, 2013 - Groves
+ * =======  ========================================================================================
+ */
+
+#include "sturdins/kinematic-nav-bank.hpp"
+
+#include <navtools/attitude.hpp>
+#include <navtools/constants.hpp>
+
+namespace sturdins {
+
+// *=== KinematicNavView ===*
+KinematicNavView::KinematicNavView(KinematicNavBank &bank, const int &i)
+    : phi_{bank.phi_(i)},
+      lam_{bank.lam_(i)},
+      h_{bank.h_(i)},
+      vn_{bank.vn_(i)},
+      ve_{bank.ve_(i)},
+      vd_{bank.vd_(i)},
+      cb_{bank.cb_(i)},
+      cd_{bank.cd_(i)},
+      q_b_l_{bank.q_b_l_.col(i).data()},
+      C_b_l_{bank.C_b_l_.col(i).data()},
+      bank_{bank},
+      i_{i} {
+}
+
+// *=== SetPosition ===*
+void KinematicNavView::SetPosition(const double &lat, const double &lon, const double &alt) {
+  phi_ = lat;
+  lam_ = lon;
+  h_ = alt;
+}
+
+// *=== SetVelocity ===*
+void KinematicNavView::SetVelocity(const double &veln, const double &vele, const double &veld) {
+  vn_ = veln;
+  ve_ = vele;
+  vd_ = veld;
+}
+
+// *=== SetAttitude ===*
+void KinematicNavView::SetAttitude(const double &roll, const double &pitch, const double &yaw) {
+  Eigen::Vector3d euler{roll, pitch, yaw};
+  navtools::euler2dcm<double>(C_b_l_, euler, true);
+  navtools::euler2quat<double>(q_b_l_, euler, true);
+}
+void KinematicNavView::SetAttitude(const Eigen::Ref<const Eigen::Matrix3d> &C) {
+  C_b_l_ = C;
+  navtools::dcm2quat<double>(q_b_l_, C_b_l_);
+}
+
+// *=== SetClock ===*
+void KinematicNavView::SetClock(const double &cb, const double &cd) {
+  cb_ = cb;
+  cd_ = cd;
+}
+
+// *=== P ===*
+double &KinematicNavView::P(const int &i, const int &j) {
+  return bank_.P_(i_, KinematicNavBank::Idx(i, j));
+}
+
+// *=== KinematicNavBank ===*
+KinematicNavBank::KinematicNavBank(const int &n)
+    : phi_{Eigen::ArrayXd::Zero(n)},
+      lam_{Eigen::ArrayXd::Zero(n)},
+      h_{Eigen::ArrayXd::Zero(n)},
+      vn_{Eigen::ArrayXd::Zero(n)},
+      ve_{Eigen::ArrayXd::Zero(n)},
+      vd_{Eigen::ArrayXd::Zero(n)},
+      cb_{Eigen::ArrayXd::Zero(n)},
+      cd_{Eigen::ArrayXd::Zero(n)},
+      q_b_l_{4, n},
+      C_b_l_{9, n},
+      P_{Eigen::ArrayXXd::Zero(n, NP)},
+      n_{n},
+      Sb_{Eigen::ArrayXd::Zero(n)},
+      Sbd_{Eigen::ArrayXd::Zero(n)},
+      Sd_{Eigen::ArrayXd::Zero(n)},
+      Sv_{Eigen::ArrayXd::Zero(n)},
+      Sa_{Eigen::ArrayXd::Zero(n)},
+      X1ME2_{1.0 - navtools::WGS84_E2<>},
+      LS2_{navtools::LIGHT_SPEED<> * navtools::LIGHT_SPEED<>},
+      x_{Eigen::ArrayXXd::Zero(n, NX)},
+      c_{n, NX},
+      k_{n, NX},
+      one_{Eigen::ArrayXd::Ones(n)} {
+  q_b_l_.colwise() = Eigen::Vector4d{1.0, 0.0, 0.0, 0.0};
+  C_b_l_.colwise() = Eigen::Matrix3d::Identity().reshaped();
+  Eigen::Vector<double, NX> p0;
+  p0 << 9.0, 9.0, 9.0, 0.05, 0.05, 0.05, 0.01, 0.01, 0.01, 3.0, 0.1;
+  for (int i = 0; i < NX; i++) {
+    P_.col(Idx(i, i)).setConstant(p0(i));
+  }
+
+  // scratch is sized once so the updates never reallocate
+  for (Eigen::ArrayXd *a :
+       {&s_,   &dy_,  &sL_, &cL_, &sLam_, &cLam_, &t_,  &Re_,  &He_,  &Hn_,  &px_,  &py_,
+        &pz_,  &vx_,  &vy_, &vz_, &r_,    &rr_,   &sw_, &cw_,  &dx_,  &dy3_, &dz_,  &dvx_,
+        &dvy_, &dvz_, &ux_, &uy_, &uz_,   &un_,   &ue_, &ud_,  &udn_, &ude_, &udd_}) {
+    a->resize(n);
+  }
+}
+
+// *=== Size ===*
+int KinematicNavBank::Size() const {
+  return n_;
+}
+
+// *=== operator[] ===*
+KinematicNavView KinematicNavBank::operator[](const int &i) {
+  return KinematicNavView(*this, i);
+}
+
+// *=== Set ===*
+void KinematicNavBank::Set(const int &i, const KinematicNav<> &filt) {
+  phi_(i) = filt.phi_;
+  lam_(i) = filt.lam_;
+  h_(i) = filt.h_;
+  vn_(i) = filt.vn_;
+  ve_(i) = filt.ve_;
+  vd_(i) = filt.vd_;
+  cb_(i) = filt.cb_;
+  cd_(i) = filt.cd_;
+  q_b_l_.col(i) = filt.q_b_l_;
+  C_b_l_.col(i) = filt.C_b_l_.reshaped();
+  for (int r = 0; r < NX; r++) {
+    for (int c = r; c < NX; c++) {
+      P_(i, Idx(r, c)) = filt.P_(r, c);
+    }
+  }
+  Sb_(i) = filt.clock_.h0 / 2.0;
+  Sbd_(i) = filt.clock_.h1 * 2.0;
+  Sd_(i) = filt.clock_.h2 * 2.0 * navtools::PI_SQU<>;
+  Sv_(i) = filt.Sv_;
+  Sa_(i) = filt.Sa_;
+}
+
+// *=== Get ===*
+void KinematicNavBank::Get(const int &i, KinematicNav<> &filt) const {
+  filt.phi_ = phi_(i);
+  filt.lam_ = lam_(i);
+  filt.h_ = h_(i);
+  filt.vn_ = vn_(i);
+  filt.ve_ = ve_(i);
+  filt.vd_ = vd_(i);
+  filt.cb_ = cb_(i);
+  filt.cd_ = cd_(i);
+  filt.q_b_l_ = q_b_l_.col(i);
+  filt.C_b_l_ = C_b_l_.col(i).reshaped(3, 3);
+  for (int r = 0; r < NX; r++) {
+    for (int c = r; c < NX; c++) {
+      filt.P_(r, c) = P_(i, Idx(r, c));
+      filt.P_(c, r) = filt.P_(r, c);
+    }
+  }
+  filt.clock_ = NavigationClock{Sb_(i) * 2.0, Sbd_(i) / 2.0, Sd_(i) / (2.0 * navtools::PI_SQU<>)};
+  filt.SetProcessNoise(Sv_(i), Sa_(i));
+  filt.x_.setZero();
+}
+
+// *=== SetClockSpec ===*
+void KinematicNavBank::SetClockSpec(const double &h0, const double &h1, const double &h2) {
+  Sb_.setConstant(1.1 * (h0 / 2.0));
+  Sd_.setConstant(1.1 * (h2 * 2.0 * navtools::PI_SQU<>));
+  Sbd_.setConstant(1.1 * (h1 * 2.0));
+}
+
+// *=== SetProcessNoise ===*
+void KinematicNavBank::SetProcessNoise(const double &Svel, const double &Satt) {
+  Sv_.setConstant(Svel);
+  Sa_.setConstant(Satt);
+}
+
+// *=== Propagate ===*
+void KinematicNavBank::Propagate(const double &dt) {
+  /**
+   * @brief F = I + T*(E(0,3) + E(1,4) + E(2,5) + E(9,10)) (see KinematicNav::Propagate), so
+   *        F*P*F' only changes the elements with a position/clock bias index. Elements with two of
+   *        these indices are updated first, they read elements that are updated afterwards.
+   */
+  static constexpr int pair[4][2] = {{0, 3}, {1, 4}, {2, 5}, {9, 10}};
+  static constexpr int other[7] = {3, 4, 5, 6, 7, 8, 10};
+  const double dtsq = dt * dt;
+  const double dtcb = dtsq * dt;
+  for (int a = 0; a < 4; a++) {
+    const int i = pair[a][0], pi = pair[a][1];
+    for (int b = a; b < 4; b++) {
+      const int j = pair[b][0], pj = pair[b][1];
+      P_.col(Idx(i, j)) +=
+          dt * (P_.col(Idx(pi, j)) + P_.col(Idx(i, pj))) + dtsq * P_.col(Idx(pi, pj));
+    }
+  }
+  for (int a = 0; a < 4; a++) {
+    const int i = pair[a][0], pi = pair[a][1];
+    for (const int j : other) {
+      P_.col(Idx(i, j)) += dt * P_.col(Idx(pi, j));
+    }
+  }
+
+  // process noise Groves Ch.9 (see KinematicNav::Propagate)
+  for (int i = 0; i < 3; i++) {
+    P_.col(Idx(i, i)) += Sv_ * (dtcb / 3.0);
+    P_.col(Idx(i, i + 3)) += Sv_ * (dtsq / 2.0);
+    P_.col(Idx(i + 3, i + 3)) += Sv_ * dt;
+    P_.col(Idx(i + 6, i + 6)) += Sa_ * dt;
+  }
+  P_.col(Idx(9, 9)) += LS2_ * ((Sb_ * dt) + (Sbd_ * dtsq) + (Sd_ * dtcb / 3.0));
+  P_.col(Idx(9, 10)) += LS2_ * ((Sbd_ * dt) + (Sd_ * dtsq / 2.0));
+  P_.col(Idx(10, 10)) += LS2_ * ((Sb_ / dt) + Sbd_ + (4.0 / 3.0 * Sd_ * dt));
+
+  // === State Propagation ===
+  RadiiOfCurvature();
+  phi_ += vn_ / Hn_ * dt;
+  lam_ += ve_ / (cL_ * He_) * dt;
+  h_ -= vd_ * dt;
+  cb_ += cd_ * dt;
+}
+
+// *=== GnssUpdate ===*
+void KinematicNavBank::GnssUpdate(
+    const Eigen::Ref<const Eigen::Matrix3Xd> &sv_pos,
+    const Eigen::Ref<const Eigen::Matrix3Xd> &sv_vel,
+    const Eigen::Ref<const Eigen::MatrixXd> &psr,
+    const Eigen::Ref<const Eigen::MatrixXd> &psrdot,
+    const Eigen::Ref<const Eigen::MatrixXd> &psr_var,
+    const Eigen::Ref<const Eigen::MatrixXd> &psrdot_var) {
+  static constexpr int psr_idx[4] = {0, 1, 2, 9};
+  static constexpr int psrdot_idx[7] = {0, 1, 2, 3, 4, 5, 10};
+  const Eigen::ArrayXd *psr_h[4] = {&un_, &ue_, &ud_, &one_};
+  const Eigen::ArrayXd *psrdot_h[7] = {&udn_, &ude_, &udd_, &un_, &ue_, &ud_, &one_};
+  const double w = navtools::WGS84_OMEGA<double>;
+  const double w_c = w / navtools::LIGHT_SPEED<double>;
+  const int N = sv_pos.cols();
+
+  // Functions of current position
+  RadiiOfCurvature();
+  sLam_ = lam_.sin();
+  cLam_ = lam_.cos();
+  px_ = He_ * cL_ * cLam_;
+  py_ = He_ * cL_ * sLam_;
+  pz_ = (Re_ * X1ME2_ + h_) * sL_;
+  vx_ = -sL_ * cLam_ * vn_ - sLam_ * ve_ - cL_ * cLam_ * vd_;
+  vy_ = -sL_ * sLam_ * vn_ + cLam_ * ve_ - cL_ * sLam_ * vd_;
+  vz_ = cL_ * vn_ - sL_ * vd_;
+
+  for (int k = 0; k < N; k++) {
+    const double sx = sv_pos(0, k), sy = sv_pos(1, k), sz = sv_pos(2, k);
+    const double ax = sv_vel(0, k) - w * sy, ay = sv_vel(1, k) + w * sx, az = sv_vel(2, k);
+
+    // predict approximate range and account for earth's rotation (see RangeAndRate)
+    dx_ = px_ - sx;
+    dy3_ = py_ - sy;
+    dz_ = pz_ - sz;
+    r_ = (dx_.square() + dy3_.square() + dz_.square()).sqrt();
+    sw_ = (w_c * r_).sin();
+    cw_ = (w_c * r_).cos();
+
+    // predict pseudorange and pseudorange-rate
+    dx_ = px_ - (cw_ * sx + sw_ * sy);
+    dy3_ = py_ - (cw_ * sy - sw_ * sx);
+    r_ = (dx_.square() + dy3_.square() + dz_.square()).sqrt();
+    ux_ = dx_ / r_;
+    uy_ = dy3_ / r_;
+    uz_ = dz_ / r_;
+    dvx_ = (vx_ - w * py_) - (cw_ * ax + sw_ * ay);
+    dvy_ = (vy_ + w * px_) - (cw_ * ay - sw_ * ax);
+    dvz_ = vz_ - az;
+    rr_ = ux_ * dvx_ + uy_ * dvy_ + uz_ * dvz_;
+    dvx_ = (dvx_ - ux_ * rr_) / r_;
+    dvy_ = (dvy_ - uy_ * rr_) / r_;
+    dvz_ = (dvz_ - uz_ * rr_) / r_;
+
+    // unit vector and its derivative in the local frame (C_e_l * u)
+    un_ = -sL_ * cLam_ * ux_ - sL_ * sLam_ * uy_ + cL_ * uz_;
+    ue_ = -sLam_ * ux_ + cLam_ * uy_;
+    ud_ = -cL_ * cLam_ * ux_ - cL_ * sLam_ * uy_ - sL_ * uz_;
+    udn_ = -sL_ * cLam_ * dvx_ - sL_ * sLam_ * dvy_ + cL_ * dvz_;
+    ude_ = -sLam_ * dvx_ + cLam_ * dvy_;
+    udd_ = -cL_ * cLam_ * dvx_ - cL_ * sLam_ * dvy_ - sL_ * dvz_;
+
+    // === Kalman Update ===
+    dy_ = psr.col(k).array() - (r_ + cb_);
+    ScalarUpdate(psr_idx, psr_h, 4, psr_var.col(k).array());
+    dy_ = psrdot.col(k).array() - (rr_ + cd_);
+    ScalarUpdate(psrdot_idx, psrdot_h, 7, psrdot_var.col(k).array());
+  }
+  ClosedLoopCorrection();
+}
+
+// *=== RadiiOfCurvature ===*
+void KinematicNavBank::RadiiOfCurvature() {
+  sL_ = phi_.sin();
+  cL_ = phi_.cos();
+  t_ = 1.0 - navtools::WGS84_E2<> * sL_.square();
+  Re_ = navtools::WGS84_R0<> / t_.sqrt();
+  He_ = Re_ + h_;
+  Hn_ = navtools::WGS84_R0<> * X1ME2_ / (t_ * t_ / t_.sqrt()) + h_;
+}
+
+// *=== ScalarUpdate ===*
+void KinematicNavBank::ScalarUpdate(
+    const int *idx,
+    const Eigen::ArrayXd *const *h,
+    const int &n,
+    const Eigen::Ref<const Eigen::ArrayXd> &var) {
+  // c = P*h, s = h'*c + r
+  for (int i = 0; i < NX; i++) {
+    c_.col(i) = P_.col(Idx(i, idx[0])) * *h[0];
+    for (int m = 1; m < n; m++) {
+      c_.col(i) += P_.col(Idx(i, idx[m])) * *h[m];
+    }
+  }
+  s_ = var;
+  for (int m = 0; m < n; m++) {
+    s_ += *h[m] * c_.col(idx[m]);
+    dy_ -= *h[m] * x_.col(idx[m]);
+  }
+
+  // lanes without a valid measurement get a zero gain
+  s_ = (var > 0.0 && var.isFinite() && s_ > 0.0).select(s_, 0.0);
+  for (int i = 0; i < NX; i++) {
+    k_.col(i) = (s_ > 0.0).select(c_.col(i) / s_, 0.0);
+    x_.col(i) += k_.col(i) * dy_;
+  }
+
+  // P = P - k*c' - c*k' + (h'*c + r)*k*k'
+  for (int i = 0; i < NX; i++) {
+    for (int j = i; j < NX; j++) {
+      P_.col(Idx(i, j)) +=
+          s_ * k_.col(i) * k_.col(j) - k_.col(i) * c_.col(j) - c_.col(i) * k_.col(j);
+    }
+  }
+}
+
+// *=== ClosedLoopCorrection ===*
+void KinematicNavBank::ClosedLoopCorrection() {
+  phi_ += x_.col(0) / Hn_;
+  lam_ += x_.col(1) / (He_ * cL_);
+  h_ -= x_.col(2);
+  vn_ += x_.col(3);
+  ve_ += x_.col(4);
+  vd_ += x_.col(5);
+  cb_ += x_.col(9);
+  cd_ += x_.col(10);
+
+  // attitude is only observable through its correlations, skip lanes without a correction
+  for (int i = 0; i < n_; i++) {
+    if (x_(i, 6) != 0.0 || x_(i, 7) != 0.0 || x_(i, 8) != 0.0) {
+      Eigen::Vector4d q_err{1.0, 0.5 * x_(i, 6), 0.5 * x_(i, 7), 0.5 * x_(i, 8)};
+      Eigen::Vector4d q_b_l = navtools::quatdot<double>(q_err, q_b_l_.col(i));
+      q_b_l_.col(i) = q_b_l / q_b_l.norm();
+      Eigen::Map<Eigen::Matrix3d> C_b_l(C_b_l_.col(i).data());
+      navtools::quat2dcm<double>(C_b_l, q_b_l_.col(i));
+    }
+  }
+  x_.setZero();
+}
+
+}  // namespace sturdins
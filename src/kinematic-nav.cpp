@@ -13,30 +13,46 @@
 
 #include "sturdins/kinematic-nav.hpp"
 
-#include <iostream>
 #include <navtools/attitude.hpp>
 #include <navtools/constants.hpp>
 #include <navtools/math.hpp>
 
+#include "sturdins/instrument.hpp"
 #include "sturdins/least-squares.hpp"
 
 namespace sturdins {
 
+// KalmanWorkspace layout of the GnssUpdate blocks (H is kept between epochs of the same size)
+static constexpr int GNSS_LAYOUT = 1;
+
 // *=== KinematicNav ===*
-KinematicNav::KinematicNav()
-    : q_b_l_{Eigen::Vector4d{1.0, 0.0, 0.0, 0.0}},
-      C_b_l_{Eigen::Matrix3d::Identity()},
-      P_{Eigen::Matrix<double, 11, 11>::Zero()},
-      x_{Eigen::Vector<double, 11>::Zero()},
-      F_{Eigen::Matrix<double, 11, 11>::Identity()},
-      Q_{Eigen::Matrix<double, 11, 11>::Zero()},
-      I11_{Eigen::Matrix<double, 11, 11>::Identity()},
+template <typename T, class Layout>
+KinematicNav<T, Layout>::KinematicNav()
+    : q_b_l_{Eigen::Vector4<T>{1.0, 0.0, 0.0, 0.0}},
+      C_b_l_{Eigen::Matrix3<T>::Identity()},
+      P_{Eigen::Matrix<T, NX, NX>::Zero()},
+      clock_{},
+      Sv_{0.0},
+      Sa_{0.0},
+      noise_{std::make_shared<const ProcessNoiseModel>(clock_, NavigationIMU{})},
+      q_dt_{0.0},
+      x_{Eigen::Vector<T, NX>::Zero()},
+      F_{Eigen::Matrix<T, NX, NX>::Identity()},
+      Q_{Eigen::Matrix<T, NX, NX>::Zero()},
+      strategy_{UpdateStrategy::BATCH},
       is_init_{false},
-      X1ME2_{1.0 - navtools::WGS84_E2<>},
-      LS2_{navtools::LIGHT_SPEED<> * navtools::LIGHT_SPEED<>} {
-  P_.diagonal() << 9.0, 9.0, 9.0, 0.05, 0.05, 0.05, 0.01, 0.01, 0.01, 3.0, 0.1;
+      log_{false},
+      n_log_{0} {
+  P_.diagonal().template segment<3>(Layout::POS).setConstant(9.0);
+  P_.diagonal().template segment<3>(Layout::VEL).setConstant(0.05);
+  if constexpr (Layout::HAS_ATT) {
+    P_.diagonal().template segment<3>(Layout::ATT).setConstant(0.01);
+  }
+  P_(Layout::CLK, Layout::CLK) = 3.0;
+  P_(Layout::CLK + 1, Layout::CLK + 1) = 0.1;
 }
-KinematicNav::KinematicNav(
+template <typename T, class Layout>
+KinematicNav<T, Layout>::KinematicNav(
     const double lat,
     const double lon,
     const double alt,
@@ -54,9 +70,12 @@ KinematicNav::KinematicNav(
   vd_ = veld;
   cb_ = cb;
   cd_ = cd;
-  P_.diagonal() << 9.0, 9.0, 9.0, 0.05, 0.05, 0.05, 0.1, 0.1, 0.1, 3.0, 0.1;
+  if constexpr (Layout::HAS_ATT) {
+    P_.diagonal().template segment<3>(Layout::ATT).setConstant(0.1);
+  }
 }
-KinematicNav::KinematicNav(
+template <typename T, class Layout>
+KinematicNav<T, Layout>::KinematicNav(
     const double lat,
     const double lon,
     const double alt,
@@ -73,55 +92,105 @@ KinematicNav::KinematicNav(
 }
 
 // *=== SetPosition ===*
-void KinematicNav::SetPosition(const double &lat, const double &lon, const double &alt) {
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::SetPosition(const double &lat, const double &lon, const double &alt) {
   phi_ = lat;
   lam_ = lon;
   h_ = alt;
 }
 
 // *=== SetVelocity ===*
-void KinematicNav::SetVelocity(const double &veln, const double &vele, const double &veld) {
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::SetVelocity(
+    const double &veln, const double &vele, const double &veld) {
   vn_ = veln;
   ve_ = vele;
   vd_ = veld;
 }
 
 // *=== SetAttitude ===*
-void KinematicNav::SetAttitude(const double &roll, const double &pitch, const double &yaw) {
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::SetAttitude(
+    const double &roll, const double &pitch, const double &yaw) {
   Eigen::Vector3d euler{roll, pitch, yaw};
-  navtools::euler2dcm<double>(C_b_l_, euler, true);
-  navtools::euler2quat<double>(q_b_l_, euler, true);
+  Eigen::Matrix3d C;
+  Eigen::Vector4d q;
+  navtools::euler2dcm<double>(C, euler, true);
+  navtools::euler2quat<double>(q, euler, true);
+  C_b_l_ = C.template cast<T>();
+  q_b_l_ = q.template cast<T>();
 }
-void KinematicNav::SetAttitude(const Eigen::Ref<const Eigen::Matrix3d> &C) {
-  C_b_l_ = C;
-  navtools::dcm2quat<double>(q_b_l_, C_b_l_);
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::SetAttitude(const Eigen::Ref<const Eigen::Matrix3d> &C) {
+  C_b_l_ = C.template cast<T>();
+  navtools::dcm2quat<T>(q_b_l_, C_b_l_);
 }
 
 // *=== SetClock ===*
-void KinematicNav::SetClock(const double &cb, const double &cd) {
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::SetClock(const double &cb, const double &cd) {
   cb_ = cb;
   cd_ = cd;
 }
 
+// *=== SetUpdateStrategy ===*
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::SetUpdateStrategy(const UpdateStrategy &strategy) {
+  strategy_ = strategy;
+}
+
+// *=== SetInnovationGate ===*
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::SetInnovationGate(const double &gate) {
+  ws_.SetGate(gate);
+}
+
 // *=== SetClockSpec ===*
-void KinematicNav::SetClockSpec(const double &h0, const double &h1, const double &h2) {
-  Sb_ = 1.1 * (h0 / 2.0);
-  Sd_ = 1.1 * (h2 * 2.0 * navtools::PI_SQU<>);
-  Sbd_ = 1.1 * (h1 * 2.0);
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::SetClockSpec(const double &h0, const double &h1, const double &h2) {
+  // 1.1 to account for 10% stochastic noise
+  clock_ = NavigationClock{1.1 * h0, 1.1 * h1, 1.1 * h2};
+  noise_ = std::make_shared<const ProcessNoiseModel>(
+      clock_, NavigationIMU{}, std::vector<double>{}, Sv_, Sa_);
+  q_dt_ = 0.0;
 }
 
 // *=== SetProcessNoise ===*
-void KinematicNav::SetProcessNoise(const double &Svel, const double &Satt) {
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::SetProcessNoise(const double &Svel, const double &Satt) {
   Sv_ = Svel;
-  halfSv_ = Sv_ / 2.0;
-  thirdSv_ = Sv_ / 3.0;
   Sa_ = Satt;
+  noise_ = std::make_shared<const ProcessNoiseModel>(
+      clock_, NavigationIMU{}, std::vector<double>{}, Sv_, Sa_);
+  q_dt_ = 0.0;
+}
+
+// *=== SetProcessNoiseModel ===*
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::SetProcessNoiseModel(
+    const std::shared_ptr<const ProcessNoiseModel> &model) {
+  clock_ = model->Clock();
+  Sv_ = model->Svel();
+  Sa_ = model->Satt();
+  noise_ = model;
+  q_dt_ = 0.0;
+}
+
+// *=== GetProcessNoiseModel ===*
+template <typename T, class Layout>
+const std::shared_ptr<const ProcessNoiseModel> &KinematicNav<T, Layout>::GetProcessNoiseModel()
+    const {
+  return noise_;
 }
 
 // *=== Propagate ===*
-void KinematicNav::Propagate(const double &dt) {
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::Propagate(const double &dt) {
+  STURDINS_STAGE_TIMER(Stage::PROPAGATE);
+
   /**
-   * @brief First order F/Phi matrix Groves Ch.9
+   * @brief First order F/Phi matrix Groves Ch.9 (the attitude rows/columns are left out of the
+   *        layouts without attitude)
    * --                      --
    * |  I3   I3*T    Z3   Z31   Z31 |
    * |  Z3    I3     Z3   Z31   Z31 |
@@ -130,13 +199,14 @@ void KinematicNav::Propagate(const double &dt) {
    * | Z13   Z13    Z13    0     1  |
    * --                      --
    */
-  F_(0, 3) = dt;
-  F_(1, 4) = dt;
-  F_(2, 5) = dt;
-  F_(9, 10) = dt;
+  F_(Layout::POS, Layout::VEL) = dt;
+  F_(Layout::POS + 1, Layout::VEL + 1) = dt;
+  F_(Layout::POS + 2, Layout::VEL + 2) = dt;
+  F_(Layout::CLK, Layout::CLK + 1) = dt;
 
   /**
-   * @brief Process noise matrix Groves Ch.9
+   * @brief Process noise matrix Groves Ch.9, looked up in the process noise model (Q_ is only
+   *        refilled when dt changes)
    * --                                                                --
    * | Sv/3*T^3*I3   Sv/2*T^2*I3      Z3           Z31           Z31    |
    * | Sv/2*T^2*I3     Sv*T*I3        Z3           Z31           Z31    |
@@ -145,81 +215,54 @@ void KinematicNav::Propagate(const double &dt) {
    * |     Z13           Z13         Z13         Sf/2*T^2        Sf*T   |
    * --                                                                --
    */
-  double dtsq = dt * dt;
-  double dtcb = dtsq * dt;
-  Q_(0, 0) = thirdSv_ * dtcb;
-  Q_(1, 1) = Q_(0, 0);
-  Q_(2, 2) = Q_(0, 0);
-  Q_(0, 3) = halfSv_ * dtsq;
-  Q_(1, 4) = Q_(0, 3);
-  Q_(2, 5) = Q_(0, 3);
-  Q_(3, 0) = Q_(0, 3);
-  Q_(4, 1) = Q_(0, 3);
-  Q_(5, 2) = Q_(0, 3);
-  Q_(3, 3) = Sv_ * dt;
-  Q_(4, 4) = Q_(3, 3);
-  Q_(5, 5) = Q_(3, 3);
-
-  Q_(6, 6) = Sa_ * dt;
-  Q_(7, 7) = Q_(6, 6);
-  Q_(8, 8) = Q_(6, 6);  // * 16.0;
-
-  Q_(9, 9) = LS2_ * ((Sb_ * dt) + (Sbd_ * dtsq) + (Sd_ * dtcb / 3.0));
-  Q_(9, 10) = LS2_ * ((Sbd_ * dt) + (Sd_ * dtsq / 2.0));
-  Q_(10, 9) = Q_(9, 10);
-  Q_(10, 10) = LS2_ * (((Sb_ / dt) + (Sbd_) + (4.0 / 3.0 * Sd_ * dt)));
-  // Q_(9, 9) = h0_ * dt + h2_ * dtcb / 3.0;
-  // Q_(9, 10) = h2_ * dtsq / 2.0;
-  // Q_(10, 9) = Q_(9, 10);
-  // Q_(10, 10) = h2_ * dt;
-
-  // std::cout << "F = \n" << F_ << "\n";
-  // std::cout << "Q = \n" << Q_ << "\n";
-
-  // Functions of latitude
-  sL_ = std::sin(phi_);
-  sLsq_ = sL_ * sL_;
-  cL_ = std::cos(phi_);
-
-  // radii of curvature
-  double t = 1.0 - navtools::WGS84_E2<> * sLsq_;
-  double sqt = std::sqrt(t);
-  Re_ = navtools::WGS84_R0<> / sqt;
-  Rn_ = navtools::WGS84_R0<> * X1ME2_ / (t * t / sqt);
-  He_ = Re_ + h_;
-  Hn_ = Rn_ + h_;
+  if (dt != q_dt_) {
+    ProcessNoiseBlocks scratch;
+    const ProcessNoiseBlocks &q = noise_->Blocks(dt, scratch);
+    for (int i = 0; i < 3; i++) {
+      Q_(Layout::POS + i, Layout::POS + i) = q.kns_(0);
+      Q_(Layout::POS + i, Layout::VEL + i) = q.kns_(1);
+      Q_(Layout::VEL + i, Layout::POS + i) = q.kns_(1);
+      Q_(Layout::VEL + i, Layout::VEL + i) = q.kns_(2);
+      if constexpr (Layout::HAS_ATT) {
+        Q_(Layout::ATT + i, Layout::ATT + i) = q.kns_(3);
+      }
+    }
+    Q_.template block<2, 2>(Layout::CLK, Layout::CLK) = q.clock_.template cast<T>();
+    q_dt_ = dt;
+  }
+
+  // Functions of latitude and radii of curvature
+  geo_.Update(phi_, lam_, h_);
 
   // === Kalman Propagation ===
   P_ = F_ * P_ * F_.transpose() + Q_;
-  phi_ += vn_ / Hn_ * dt;
-  lam_ += ve_ / (cL_ * He_) * dt;
+  if (log_) {
+    if (n_log_++ == 0) {
+      Phi_log_ = F_;
+    } else {
+      Phi_log_ = F_ * Phi_log_;
+    }
+    P_log_ = P_;
+    dx_log_.setZero();
+  }
+  phi_ += vn_ / geo_.Hn_ * dt;
+  lam_ += ve_ / (geo_.cL_ * geo_.He_) * dt;
   h_ -= vd_ * dt;
   cb_ += cd_ * dt;
 }
 
-void KinematicNav::FalsePropagateState(
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::FalsePropagateState(
     Eigen::Ref<Eigen::Vector3d> ecef_p,
     Eigen::Ref<Eigen::Vector3d> ecef_v,
     double &cb,
     double &cd,
     const double &dt) {
   // update ecef position
-  double sLam = std::sin(lam_);
-  double cLam = std::cos(lam_);
-  sL_ = std::sin(phi_);
-  cL_ = std::cos(phi_);
-  sLsq_ = sL_ * sL_;
-  Eigen::Matrix3d C_l_e{
-      {-sL_ * cLam, -sLam, -cL_ * cLam}, {-sL_ * sLam, cLam, -cL_ * sLam}, {cL_, 0.0, -sL_}};
-  double t = 1.0 - navtools::WGS84_E2<> * sLsq_;
-  double sqt = std::sqrt(t);
-  Re_ = navtools::WGS84_R0<> / sqt;
-  // Rn_ = navtools::WGS84_R0<> * X1ME2_ / (t * t / sqt);
-  He_ = Re_ + h_;
-  // Hn_ = Rn_ + h_;
-  ecef_p_ << He_ * cL_ * cLam, He_ * cL_ * sLam, (Re_ * X1ME2_ + h_) * sL_;
+  geo_.Update(phi_, lam_, h_);
+  ecef_p_ = geo_.EcefPosition();
   ecef_v_ << vn_, ve_, vd_;
-  ecef_v_ = C_l_e * ecef_v_;
+  ecef_v_ = geo_.NedToEcef() * ecef_v_;
 
   // fake-propagate state into provided vectors
   ecef_p = ecef_p_ + ecef_v_ * dt;
@@ -229,7 +272,8 @@ void KinematicNav::FalsePropagateState(
 }
 
 // *=== GnssUpdate ===*
-void KinematicNav::GnssUpdate(
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::GnssUpdate(
     const Eigen::Ref<const Eigen::Matrix3Xd> &sv_pos,
     const Eigen::Ref<const Eigen::Matrix3Xd> &sv_vel,
     const Eigen::Ref<const Eigen::VectorXd> &psr,
@@ -238,64 +282,45 @@ void KinematicNav::GnssUpdate(
     const Eigen::Ref<const Eigen::VectorXd> &psrdot_var) {
   // Initialize
   const int N = psr.size();
-  const int M = 2 * N;
-  Eigen::VectorXd dy(M);
-  Eigen::MatrixXd H = Eigen::MatrixXd::Zero(M, 11);
-  for (int i = 0; i < N; i++) {
-    H(i, 9) = 1.0;
-    H(N + i, 10) = 1.0;
-  }
-  Eigen::MatrixXd R = Eigen::MatrixXd::Zero(M, M);
-  R.diagonal() << psr_var, psrdot_var;
+  rejected_.resize(2 * N);
 
   // Functions of current position
-  double sLam = std::sin(lam_);
-  double cLam = std::cos(lam_);
-  sL_ = std::sin(phi_);
-  cL_ = std::cos(phi_);
-  sLsq_ = sL_ * sL_;
-  Eigen::Matrix3d C_l_e{
-      {-sL_ * cLam, -sLam, -cL_ * cLam}, {-sL_ * sLam, cLam, -cL_ * sLam}, {cL_, 0.0, -sL_}};
-  Eigen::Matrix3d C_e_l = C_l_e.transpose();
-
-  // radii of curvature
-  double t = 1.0 - navtools::WGS84_E2<> * sLsq_;
-  double sqt = std::sqrt(t);
-  Re_ = navtools::WGS84_R0<> / sqt;
-  Rn_ = navtools::WGS84_R0<> * X1ME2_ / (t * t / sqt);
-  He_ = Re_ + h_;
-  Hn_ = Rn_ + h_;
+  geo_.Update(phi_, lam_, h_);
+  const Eigen::Matrix3d &C_l_e = geo_.NedToEcef();
 
-  // Generate observation predictions
-  Eigen::Vector3d u, udot;
-  ecef_p_ << He_ * cL_ * cLam, He_ * cL_ * sLam, (Re_ * X1ME2_ + h_) * sL_;
+  // Generate observation predictions (in blocks of at most MAX_SV satellites)
+  ecef_p_ = geo_.EcefPosition();
   ecef_v_ << vn_, ve_, vd_;
   ecef_v_ = C_l_e * ecef_v_;
-  double pred_psr, pred_psrdot;
-  for (int i = 0; i < N; i++) {
-    RangeAndRate(
-        ecef_p_, ecef_v_, cb_, cd_, sv_pos.col(i), sv_vel.col(i), u, udot, pred_psr, pred_psrdot);
-    u = C_e_l * u;
-    udot = C_e_l * udot;
-    H(i, 0) = u(0);
-    H(i, 1) = u(1);
-    H(i, 2) = u(2);
-    H(N + i, 0) = udot(0);
-    H(N + i, 1) = udot(1);
-    H(N + i, 2) = udot(2);
-    H(N + i, 3) = u(0);
-    H(N + i, 4) = u(1);
-    H(N + i, 5) = u(2);
-    dy(i) = psr(i) - pred_psr;
-    dy(N + i) = psrdot(i) - pred_psrdot;
+  for (int i0 = 0; i0 < N; i0 += MAX_SV) {
+    STURDINS_STAGE_TIMER(Stage::MEASUREMENT_MODEL);
+    const int Nb = std::min(MAX_SV, N - i0);
+    if (!ws_.Reshape(2 * Nb, GNSS_LAYOUT)) {
+      ws_.H_.col(Layout::CLK).head(Nb).setOnes();
+      ws_.H_.col(Layout::CLK + 1).segment(Nb, Nb).setOnes();
+    }
+    pred_.Predict(
+        ecef_p_, ecef_v_, cb_, cd_, sv_pos.middleCols(i0, Nb), sv_vel.middleCols(i0, Nb));
+    ws_.H_.block(0, 0, Nb, 3).noalias() = (pred_.u_ * C_l_e).template cast<T>();
+    ws_.H_.block(Nb, 0, Nb, 3).noalias() = (pred_.udot_ * C_l_e).template cast<T>();
+    ws_.H_.block(Nb, 3, Nb, 3) = ws_.H_.block(0, 0, Nb, 3);
+    ws_.dy_.head(Nb) = (psr.segment(i0, Nb) - pred_.psr_).template cast<T>();
+    ws_.dy_.segment(Nb, Nb) = (psrdot.segment(i0, Nb) - pred_.psrdot_).template cast<T>();
+    ws_.r_.head(Nb) = psr_var.segment(i0, Nb).template cast<T>();
+    ws_.r_.segment(Nb, Nb) = psrdot_var.segment(i0, Nb).template cast<T>();
+    STURDINS_STAGE_TIMER_STOP();
+
+    // Kalman Update
+    KalmanUpdate();
+    rejected_.segment(i0, Nb) = ws_.rejected_.head(Nb);
+    rejected_.segment(N + i0, Nb) = ws_.rejected_.segment(Nb, Nb);
   }
-
-  // Kalman Update
-  KalmanUpdate(R, H, dy);
+  ClosedLoopCorrection();
 }
 
 // *=== PhasedArrayUpdate ===*
-void KinematicNav::PhasedArrayUpdate(
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::PhasedArrayUpdate(
     const Eigen::Ref<const Eigen::Matrix3Xd> &sv_pos,
     const Eigen::Ref<const Eigen::Matrix3Xd> &sv_vel,
     const Eigen::Ref<const Eigen::VectorXd> &psr,
@@ -306,166 +331,181 @@ void KinematicNav::PhasedArrayUpdate(
     const Eigen::Ref<const Eigen::MatrixXd> &phase_var,
     const Eigen::Ref<const Eigen::Matrix3Xd> &ant_xyz,
     const int &n_ant,
-    const double &lamb) {
-  // Initialize
+    const double &lamb)
+  requires Layout::HAS_ATT
+{
+  // Initialize (each satellite adds a psr, psrdot, and n_ant-1 phase measurements to a block)
   const int N = psr.size();
-  const int M = 2 * N;
-  const int MM = M + (n_ant - 1) * N;
-  Eigen::VectorXd dy(MM);
-  Eigen::MatrixXd H = Eigen::MatrixXd::Zero(MM, 11);
-  for (int ii = 0; ii < N; ii++) {
-    H(ii, 9) = 1.0;
-    H(N + ii, 10) = 1.0;
-  }
-  // std::cout << "psr_var = " << psr_var(0) << ", psrdot_var = " << psrdot_var(0) << "\n";
-
-  // measurement variance
-  int k1, k2;
-  Eigen::MatrixXd R = Eigen::MatrixXd::Zero(MM, MM);
-  for (int ii = 0; ii < N; ii++) {
-    k1 = N + ii;
-    R(ii, ii) = psr_var(ii);
-    R(k1, k1) = psrdot_var(ii);
-    for (int jj = 1; jj < n_ant; jj++) {
-      k2 = M + (n_ant - 1) * ii + jj - 1;
-      R(k2, k2) = phase_var(jj, ii);
-    }
+  rejected_.resize((n_ant + 1) * N);
+  const int Nmax = KalmanWorkspace<NX, 2 * MAX_SV, T>::MAX_M / (n_ant + 1);
+  eigen_assert(Nmax > 0 && "too many antennas for the measurement workspace");
+  if (Nmax == 0) {
+    // not even one satellite fits in a block, leave the state untouched
+    rejected_.setConstant(true);
+    return;
   }
 
   // Functions of current position
-  double sLam = std::sin(lam_);
-  double cLam = std::cos(lam_);
-  sL_ = std::sin(phi_);
-  cL_ = std::cos(phi_);
-  sLsq_ = sL_ * sL_;
-  Eigen::Matrix3d C_l_e{
-      {-sL_ * cLam, -sLam, -cL_ * cLam}, {-sL_ * sLam, cLam, -cL_ * sLam}, {cL_, 0.0, -sL_}};
-  Eigen::Matrix3d C_e_l = C_l_e.transpose();
-
-  // radii of curvature
-  double t = 1.0 - navtools::WGS84_E2<> * sLsq_;
-  double sqt = std::sqrt(t);
-  Re_ = navtools::WGS84_R0<> / sqt;
-  Rn_ = navtools::WGS84_R0<> * X1ME2_ / (t * t / sqt);
-  He_ = Re_ + h_;
-  Hn_ = Rn_ + h_;
+  geo_.Update(phi_, lam_, h_);
+  const Eigen::Matrix3d &C_l_e = geo_.NedToEcef();
 
   // Generate observation predictions
-  Eigen::Vector3d u, udot, hp;
-  ecef_p_ << He_ * cL_ * cLam, He_ * cL_ * sLam, (Re_ * X1ME2_ + h_) * sL_;
+  const int A = n_ant - 1;
+  ecef_p_ = geo_.EcefPosition();
   ecef_v_ << vn_, ve_, vd_;
   ecef_v_ = C_l_e * ecef_v_;
-  double pred_psr, pred_psrdot, pred_phase;
-  Eigen::Matrix3Xd ant_ned = C_b_l_ * ant_xyz;
-  // std::cout << "C_b_l = \n" << C_b_l_ << "\n";
-  for (int ii = 0; ii < N; ii++) {
-    RangeAndRate(
-        ecef_p_, ecef_v_, cb_, cd_, sv_pos.col(ii), sv_vel.col(ii), u, udot, pred_psr, pred_psrdot);
-    u = C_e_l * u;
-    udot = C_e_l * udot;
-    H(ii, 0) = u(0);
-    H(ii, 1) = u(1);
-    H(ii, 2) = u(2);
-    H(N + ii, 0) = udot(0);
-    H(N + ii, 1) = udot(1);
-    H(N + ii, 2) = udot(2);
-    H(N + ii, 3) = u(0);
-    H(N + ii, 4) = u(1);
-    H(N + ii, 5) = u(2);
-    dy(ii) = psr(ii) - pred_psr;
-    dy(N + ii) = psrdot(ii) - pred_psrdot;
-
-    for (int jj = 1; jj < n_ant; jj++) {
-      k2 = M + (n_ant - 1) * ii + jj - 1;
-      pred_phase = -(ant_ned.col(jj).transpose() * u)(0) / lamb;
-      pred_phase = std::fmod(pred_phase + navtools::PI<>, navtools::TWO_PI<>) - navtools::PI<>;
-      if (pred_phase < -navtools::PI<>) {
-        pred_phase += navtools::TWO_PI<>;
-      } else if (pred_phase > navtools::PI<>) {
-        pred_phase -= navtools::TWO_PI<>;
-      }
-      // hp = -(navtools::Skew<double>(ant_ned.col(j)).transpose() * u) / lamb;
-      hp = (navtools::Skew(ant_ned.col(jj)).transpose() * u) / lamb;
-
-      H(k2, 6) = hp(0);
-      H(k2, 7) = hp(1);
-      H(k2, 8) = hp(2);
-      dy(k2) = phase(jj, ii) - pred_phase;
-      dy(k2) = std::fmod(dy(k2) + navtools::PI<>, navtools::TWO_PI<>) - navtools::PI<>;
-      if (dy(k2) < -navtools::PI<>) {
-        dy(k2) += navtools::TWO_PI<>;
-      } else if (dy(k2) > navtools::PI<>) {
-        dy(k2) -= navtools::TWO_PI<>;
-      }
-      // std::cout << "meas_phase(" << k2 << "): " << phase(jj, ii) << " | est_phase(" << k2
-      //           << "): " << pred_phase << " | dy(" << k2 << "): " << dy(k2) << "\n";
-    }
+  for (int i0 = 0; i0 < N; i0 += Nmax) {
+    STURDINS_STAGE_TIMER(Stage::MEASUREMENT_MODEL);
+    const int Nb = std::min(Nmax, N - i0);
+    const int M = 2 * Nb;
+    ws_.Resize(M + A * Nb);
+    pred_.Predict(
+        ecef_p_, ecef_v_, cb_, cd_, sv_pos.middleCols(i0, Nb), sv_vel.middleCols(i0, Nb));
+    ws_.H_.block(0, 0, Nb, 3).noalias() = (pred_.u_ * C_l_e).template cast<T>();
+    ws_.H_.block(Nb, 0, Nb, 3).noalias() = (pred_.udot_ * C_l_e).template cast<T>();
+    ws_.H_.block(Nb, 3, Nb, 3) = ws_.H_.block(0, 0, Nb, 3);
+    ws_.H_.col(Layout::CLK).head(Nb).setOnes();
+    ws_.H_.col(Layout::CLK + 1).segment(Nb, Nb).setOnes();
+    ws_.dy_.head(Nb) = (psr.segment(i0, Nb) - pred_.psr_).template cast<T>();
+    ws_.dy_.segment(Nb, Nb) = (psrdot.segment(i0, Nb) - pred_.psrdot_).template cast<T>();
+    ws_.r_.head(Nb) = psr_var.segment(i0, Nb).template cast<T>();
+    ws_.r_.segment(Nb, Nb) = psrdot_var.segment(i0, Nb).template cast<T>();
+
+    // phase of antennas 1..n_ant-1 relative to antenna 0, all satellite/antenna pairs at once
+    phase_pred_.Predict(
+        C_b_l_.template cast<double>(),
+        C_l_e,
+        pred_.u_,
+        phase.block(1, i0, A, Nb),
+        ant_xyz.middleCols(1, A),
+        lamb,
+        1.0);
+    ws_.H_.block(M, Layout::ATT, A * Nb, 3) = phase_pred_.H_.template cast<T>();
+    ws_.dy_.segment(M, A * Nb) = phase_pred_.dy_.template cast<T>();
+    ws_.r_.segment(M, A * Nb) = phase_var.block(1, i0, A, Nb).reshaped().template cast<T>();
+    STURDINS_STAGE_TIMER_STOP();
+
+    // === Kalman Update ===
+    KalmanUpdate();
+    rejected_.segment(i0, Nb) = ws_.rejected_.head(Nb);
+    rejected_.segment(N + i0, Nb) = ws_.rejected_.segment(Nb, Nb);
+    rejected_.segment(2 * N + (n_ant - 1) * i0, (n_ant - 1) * Nb) =
+        ws_.rejected_.segment(M, (n_ant - 1) * Nb);
   }
+  ClosedLoopCorrection();
+}
 
-  // std::cout << "H: \n" << H << "\n";
-  // std::cout << "dy: \n" << dy.segment(M - 1, MM - M).transpose() << "\n";
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::AttitudeUpdate(
+    const Eigen::Ref<const Eigen::Matrix3d> &C, const Eigen::Ref<const Eigen::Matrix3d> &R)
+  requires Layout::HAS_ATT
+{
+  Eigen::Matrix3d C_err = C * C_b_l_.transpose().template cast<double>();
+  ws_.Resize(3);
+  ws_.dy_ = navtools::DeSkew<double>(C_err).template cast<T>();
+  ws_.H_(0, Layout::ATT) = 1.0;
+  ws_.H_(1, Layout::ATT + 1) = 1.0;
+  ws_.H_(2, Layout::ATT + 2) = 1.0;
+  ws_.SetCovariance(R);
+  // Eigen::Matrix3d R = Eigen::Matrix3d::Identity();
+  KalmanUpdate();
+  rejected_ = ws_.rejected_;
+  ClosedLoopCorrection();
+}
 
-  // === Kalman Update ===
-  KalmanUpdate(R, H, dy);
+// *=== SaveSnapshot ===*
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::SaveSnapshot(KinematicNavSnapshot<T, NX> &snap) const {
+  snap.pos_[0] = phi_;
+  snap.pos_[1] = lam_;
+  snap.pos_[2] = h_;
+  snap.vel_[0] = vn_;
+  snap.vel_[1] = ve_;
+  snap.vel_[2] = vd_;
+  Eigen::Map<Eigen::Vector4<T>>(snap.q_b_l_) = q_b_l_;
+  Eigen::Map<Eigen::Matrix3<T>>(snap.C_b_l_) = C_b_l_;
+  snap.clk_[0] = cb_;
+  snap.clk_[1] = cd_;
+  PackUpper(snap.P_, P_);
+  snap.is_init_ = is_init_;
 }
 
-void KinematicNav::AttitudeUpdate(
-    const Eigen::Ref<const Eigen::Matrix3d> &C, const Eigen::Ref<const Eigen::Matrix3d> &R) {
-  Eigen::Matrix3d C_err = C * C_b_l_.transpose();
-  // std::cout << "C_err = \n" << C_err << "\n";
-  Eigen::Vector3d dy = navtools::DeSkew<double>(C_err);
-  // std::cout << "dy = " << dy.transpose() << "\n";
-  Eigen::Matrix3Xd H{Eigen::Matrix<double, 3, 11>::Zero()};
-  H(0, 6) = 1.0;
-  H(1, 7) = 1.0;
-  H(2, 8) = 1.0;
-  // Eigen::Matrix3d R = Eigen::Matrix3d::Identity();
-  KalmanUpdate(R, H, dy);
+// *=== RestoreSnapshot ===*
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::RestoreSnapshot(const KinematicNavSnapshot<T, NX> &snap) {
+  phi_ = snap.pos_[0];
+  lam_ = snap.pos_[1];
+  h_ = snap.pos_[2];
+  vn_ = snap.vel_[0];
+  ve_ = snap.vel_[1];
+  vd_ = snap.vel_[2];
+  q_b_l_ = Eigen::Map<const Eigen::Vector4<T>>(snap.q_b_l_);
+  C_b_l_ = Eigen::Map<const Eigen::Matrix3<T>>(snap.C_b_l_);
+  cb_ = snap.clk_[0];
+  cd_ = snap.clk_[1];
+  UnpackUpper(P_, snap.P_);
+  is_init_ = snap.is_init_;
+  x_.setZero();
 }
 
-void KinematicNav::KalmanUpdate(
-    const Eigen::Ref<const Eigen::MatrixXd> &R,
-    const Eigen::Ref<const Eigen::MatrixXd> &H,
-    const Eigen::Ref<const Eigen::VectorXd> &dy) {
-  // // innovation filter
-  // Eigen::MatrixXd PHt = P_ * H.transpose();
-  // Eigen::VectorXd sqrt_S = (H * PHt + R).diagonal().cwiseSqrt();
-  // Eigen::VectorX<bool> mask = (dy.array().abs() / sqrt_S.array()) < 3.0;
-  // const int new_M = (mask).count();
-  // if (new_M < M) {
-  //   if (new_M > 0) {
-  //     Eigen::MatrixXd new_H(new_M, 8);
-  //     Eigen::MatrixXd new_R(new_M, new_M);
-  //     Eigen::VectorXd new_dy(new_M);
-  //     int k = 0;
-  //     for (int i = 0; i < M; i++) {
-  //       if (mask(i)) {
-  //         new_H.row(k) = H.row(i);
-  //         new_R(k, k) = R(i, i);
-  //         new_dy(k) = dy(i);
-  //         k++;
-  //       }
-  //     }
-
-  //     // === Kalman Update ===
-  //     Eigen::MatrixXd PHt = P_ * new_H.transpose();
-  //     Eigen::MatrixXd K = PHt * (new_H * PHt + new_R).inverse();
-  //     Eigen::MatrixXd L = I11_ - K * new_H;
-  //     P_ = L * P_ * L.transpose() + K * new_R * K.transpose();
-  //     x_ += K * new_dy;
-  //   }
-  // } else {
-  //   // === Kalman Update ===
-  //   Eigen::MatrixXd PHt = P_ * H.transpose();
-  //   Eigen::MatrixXd K = PHt * (H * PHt + R).inverse();
-  //   Eigen::MatrixXd L = I11_ - K * H;
-  //   P_ = L * P_ * L.transpose() + K * R * K.transpose();
-  //   x_ += K * dy;
-  // }
+// *=== SetSmootherLog ===*
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::SetSmootherLog(const bool &enable) {
+  log_ = enable;
+  n_log_ = 0;
+  P_log_ = P_;
+  dx_log_.setZero();
+}
+
+// *=== TakeSmootherLog ===*
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::TakeSmootherLog(
+    Eigen::Matrix<T, NX, NX> &Phi, Eigen::Matrix<T, NX, NX> &P_pred, Eigen::Vector<T, NX> &dx) {
+  if (n_log_ == 0) {
+    Phi.setIdentity();
+  } else {
+    Phi = Phi_log_;
+  }
+  P_pred = P_log_;
+  dx = dx_log_;
+
+  // without a propagation before the next call, the prediction is the current covariance
+  n_log_ = 0;
+  P_log_ = P_;
+  dx_log_.setZero();
+}
 
-  Eigen::MatrixXd PHt = P_ * H.transpose();
-  Eigen::MatrixXd K = PHt * (H * PHt + R).inverse();
-  Eigen::MatrixXd L = I11_ - K * H;
+// *=== CorrectState ===*
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::CorrectState(const Eigen::Ref<const Eigen::Vector<T, NX>> &dx) {
+  x_ = dx;
+  ClosedLoopCorrection();
+}
+
+// *=== GetStateVector ===*
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::GetStateVector(Eigen::Ref<Eigen::VectorXd> x) const {
+  eigen_assert(x.size() == STATE_SIZE && "state buffer has the wrong size");
+  if constexpr (Layout::HAS_ATT) {
+    x << phi_, lam_, h_, vn_, ve_, vd_, q_b_l_.template cast<double>(), cb_, cd_;
+  } else {
+    x << phi_, lam_, h_, vn_, ve_, vd_, cb_, cd_;
+  }
+}
+
+// *=== KalmanUpdate ===*
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::KalmanUpdate() {
+  STURDINS_STAGE_TIMER(Stage::KALMAN_UPDATE);
+  if (strategy_ == UpdateStrategy::SEQUENTIAL) {
+    ws_.SequentialUpdate(P_, x_);
+    return;
+  }
+
+  // skip the block if the innovation covariance is singular
+  if (!ws_.ComputeGain(P_, x_)) {
+    return;
+  }
   // if (!is_init_) {
   //   for (int i = 0; i < 100; i++) {
   //     P_ = L * P_ * L.transpose() + K * R * K.transpose();
@@ -476,29 +516,35 @@ void KinematicNav::KalmanUpdate(
   //   }
   //   is_init_ = true;
   // } else {
-  P_ = L * P_ * L.transpose() + K * R * K.transpose();
+  ws_.UpdateCovariance(P_);
   // }
-  x_ += K * dy;
-
-  // std::cout << "dy = \n" << dy.transpose() << "\ndx = \n" << x_.transpose() << "\n";
-  // std::cout << "H = \n" << H << "\n";
-
-  // Closed loop error corrections
-  phi_ += x_(0) / Hn_;
-  lam_ += x_(1) / (He_ * cL_);
-  h_ -= x_(2);
-  vn_ += x_(3);
-  ve_ += x_(4);
-  vd_ += x_(5);
-  Eigen::Vector4d q_err{1.0, 0.5 * x_(6), 0.5 * x_(7), 0.5 * x_(8)};
-  q_b_l_ = navtools::quatdot<double>(q_err, q_b_l_);
-  q_b_l_ /= q_b_l_.norm();
-  navtools::quat2dcm<double>(C_b_l_, q_b_l_);
-  cb_ += x_(9);
-  cd_ += x_(10);
-  x_.setZero();
+  ws_.UpdateState(x_);
+}
 
-  // std::cout << "P = \n" << P_.diagonal().transpose() << "\n";
+// *=== ClosedLoopCorrection ===*
+template <typename T, class Layout>
+void KinematicNav<T, Layout>::ClosedLoopCorrection() {
+  // Closed loop error corrections (about the position the update was linearized at)
+  geo_.Update(phi_, lam_, h_);
+  phi_ += x_(Layout::POS) / geo_.Hn_;
+  lam_ += x_(Layout::POS + 1) / (geo_.He_ * geo_.cL_);
+  h_ -= x_(Layout::POS + 2);
+  vn_ += x_(Layout::VEL);
+  ve_ += x_(Layout::VEL + 1);
+  vd_ += x_(Layout::VEL + 2);
+  if constexpr (Layout::HAS_ATT) {
+    Eigen::Vector4<T> q_err{
+        1, x_(Layout::ATT) / 2, x_(Layout::ATT + 1) / 2, x_(Layout::ATT + 2) / 2};
+    q_b_l_ = navtools::quatdot<T>(q_err, q_b_l_);
+    q_b_l_ /= q_b_l_.norm();
+    navtools::quat2dcm<T>(C_b_l_, q_b_l_);
+  }
+  cb_ += x_(Layout::CLK);
+  cd_ += x_(Layout::CLK + 1);
+  if (log_) {
+    dx_log_ += x_;
+  }
+  x_.setZero();
 }
 
 // //! ITERATIVE EKF
@@ -615,4 +661,9 @@ void KinematicNav::KalmanUpdate(
 // q_b_l_ = q_b_l;
 // C_b_l_ = C_b_l;
 
+template class KinematicNav<float>;
+template class KinematicNav<double>;
+template class KinematicNav<float, PositionStateLayout>;
+template class KinematicNav<double, PositionStateLayout>;
+
 }  // namespace sturdins
\ No newline at end of file
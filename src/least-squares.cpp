@@ -13,13 +13,19 @@
 
 #include "sturdins/least-squares.hpp"
 
-#include <unsupported/Eigen/MatrixFunctions>
-
 // #include <Eigen/Eigenvalues>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <complex>
-#include <iostream>
+#include <limits>
 #include <navtools/constants.hpp>
 #include <navtools/math.hpp>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "sturdins/instrument.hpp"
 
 namespace sturdins {
 
@@ -57,6 +63,100 @@ void RangeAndRate(
   pred_psrdot = u.dot(dv) + cd;
 }
 
+// *=== BatchRangeAndRate ===*
+void BatchRangeAndRate(
+    const Eigen::Ref<const Eigen::Vector3d> &pos,
+    const Eigen::Ref<const Eigen::Vector3d> &vel,
+    const double &cb,
+    const double &cd,
+    const Eigen::Ref<const Eigen::Matrix3Xd> &sv_pos,
+    const Eigen::Ref<const Eigen::Matrix3Xd> &sv_vel,
+    Eigen::Ref<Eigen::MatrixX3d> u,
+    Eigen::Ref<Eigen::MatrixX3d> udot,
+    Eigen::Ref<Eigen::VectorXd> pred_psr,
+    Eigen::Ref<Eigen::VectorXd> pred_psrdot) {
+  // the outputs double as scratch, every step below is a column operation across satellites
+  auto x = sv_pos.row(0).transpose().array();
+  auto y = sv_pos.row(1).transpose().array();
+  auto z = sv_pos.row(2).transpose().array();
+  auto ux = u.col(0).array();
+  auto uy = u.col(1).array();
+  auto uz = u.col(2).array();
+  auto r = pred_psr.array();
+  auto dvx = pred_psrdot.array();
+  auto swtau = udot.col(0).array();
+  auto cwtau = udot.col(1).array();
+  auto dvy = udot.col(1).array();
+  auto dvz = udot.col(2).array();
+
+  // predict approximate range and account for earth's rotation (Groves 8.34), w*tau < 1e-5 so
+  // the series sin = x - x^3/6 and cos = 1 - x^2/2 are exact to double precision
+  ux = pos(0) - x;
+  uy = pos(1) - y;
+  uz = pos(2) - z;
+  r = (ux.square() + uy.square() + uz.square()).sqrt();
+  swtau = (navtools::WGS84_OMEGA<double> / navtools::LIGHT_SPEED<double>) * r;
+  cwtau = 1.0 - 0.5 * swtau.square();
+  swtau *= 1.0 - swtau.square() / 6.0;
+
+  // predict pseudorange (Groves 8.35, 9.165)
+  ux = pos(0) - (cwtau * x + swtau * y);
+  uy = pos(1) - (cwtau * y - swtau * x);
+  r = (ux.square() + uy.square() + uz.square()).sqrt();
+
+  // relative velocity (Groves 8.44), w x r of the satellite is [-w*y, w*x, 0]
+  const double w = navtools::WGS84_OMEGA<double>;
+  const Eigen::Vector3d vr = vel + navtools::WGS84_OMEGA_SKEW<double> * pos;
+  auto vx = sv_vel.row(0).transpose().array() - w * y;
+  auto vy = sv_vel.row(1).transpose().array() + w * x;
+  dvx = vr(0) - (cwtau * vx + swtau * vy);
+  dvy = vr(1) - (cwtau * vy - swtau * vx);
+  dvz = vr(2) - sv_vel.row(2).transpose().array();
+
+  // unit vectors, udot = (dv - u * (u.dv)) / r and psrdot = u.dv (Groves 9.165)
+  ux /= r;
+  uy /= r;
+  uz /= r;
+  swtau = ux * dvx + uy * dvy + uz * dvz;
+  udot.col(1).array() = (dvy - uy * swtau) / r;
+  udot.col(2).array() = (dvz - uz * swtau) / r;
+  dvx = (dvx - ux * swtau) / r;
+  udot.col(0).swap(pred_psrdot);
+  pred_psrdot.array() += cd;
+  r += cb;
+}
+
+// *=== BatchPhaseDifference ===*
+void BatchPhaseDifference(
+    const Eigen::Ref<const Eigen::Matrix3Xd> &ant_ned,
+    const Eigen::Ref<const Eigen::MatrixX3d> &u_ned,
+    const Eigen::Ref<const Eigen::MatrixXd> &phase,
+    const double &lamb,
+    const double &jac_scale,
+    Eigen::Ref<Eigen::VectorXd> dy,
+    Eigen::Ref<Eigen::MatrixX3d> H) {
+  const int A = ant_ned.cols();
+  const int N = u_ned.rows();
+  constexpr double INV_TWO_PI = 1.0 / navtools::TWO_PI<>;
+
+  // residuals phase - pred with pred = -a.u / lamb, every pair at once (column i is satellite i),
+  // wrapped by removing the nearest whole cycle instead of fmod and branches
+  Eigen::Map<Eigen::MatrixXd> r(dy.data(), A, N);
+  r.noalias() = ant_ned.transpose() * u_ned.transpose();
+  r = phase + r / lamb;
+  dy.array() -= navtools::TWO_PI<> * (dy.array() * INV_TWO_PI).rint();
+
+  // jacobian rows Skew(a)' * u = u x a, each component over all pairs is a difference of two
+  // outer products of the antenna and unit vector components
+  for (int c = 0; c < 3; c++) {
+    const int c1 = (c + 1) % 3, c2 = (c + 2) % 3;
+    Eigen::Map<Eigen::MatrixXd> h(H.col(c).data(), A, N);
+    h.noalias() = ant_ned.row(c2).transpose() * u_ned.col(c1).transpose();
+    h.noalias() -= ant_ned.row(c1).transpose() * u_ned.col(c2).transpose();
+  }
+  H *= jac_scale / lamb;
+}
+
 // *=== GnssPVT ===*
 bool GnssPVT(
     Eigen::Ref<Eigen::VectorXd> x,
@@ -67,67 +167,406 @@ bool GnssPVT(
     const Eigen::Ref<const Eigen::VectorXd> &psrdot,
     const Eigen::Ref<const Eigen::VectorXd> &psr_var,
     const Eigen::Ref<const Eigen::VectorXd> &psrdot_var) {
-  // Initialize
+  GnssPVTWorkspace ws;
+  return ws.Solve(x, P, sv_pos, sv_vel, psr, psrdot, psr_var, psrdot_var);
+}
+
+// *=== GnssPVTWorkspace ===*
+GnssPVTWorkspace::GnssPVTWorkspace(const double &tol)
+    : tol_{tol},
+      refreshed_{0},
+      iterations_{0},
+      n_incremental_{0},
+      stale_{false},
+      use_ldlt_{false} {
+}
+
+// *=== Solve ===*
+bool GnssPVTWorkspace::Solve(
+    Eigen::Ref<Eigen::VectorXd> x,
+    Eigen::Ref<Eigen::MatrixXd> P,
+    const Eigen::Ref<const Eigen::Matrix3Xd> &sv_pos,
+    const Eigen::Ref<const Eigen::Matrix3Xd> &sv_vel,
+    const Eigen::Ref<const Eigen::VectorXd> &psr,
+    const Eigen::Ref<const Eigen::VectorXd> &psrdot,
+    const Eigen::Ref<const Eigen::VectorXd> &psr_var,
+    const Eigen::Ref<const Eigen::VectorXd> &psrdot_var) {
+  // Initialize (a new number of satellites always rebuilds the normal equations)
   const int N = psr.size();
-  const int M = 2 * N;
-  Eigen::VectorXd dy(M);
-  Eigen::MatrixXd H{Eigen::MatrixXd::Zero(M, 8)};
-  for (int i = 0; i < N; i++) {
-    H(i, 6) = 1.0;
-    H(N + i, 7) = 1.0;
+  bool rebuild = stale_ || (u_.rows() != N);
+  stale_ = false;
+  if (rebuild) {
+    u_.resize(N, 3);
+    udot_.resize(N, 3);
+    wp_.resize(N);
+    wd_.resize(N);
+    dyp_.resize(N);
+    dyd_.resize(N);
   }
-  Eigen::MatrixXd Ht(H.rows(), H.cols());
-  Eigen::MatrixXd W{Eigen::MatrixXd::Zero(M, M)};
-  W.diagonal() << 1.0 / psr_var.array(), 1.0 / psrdot_var.array();
+  refreshed_ = 0;
 
   // Recursive Estimation
-  Eigen::VectorXd dx(8);
-  Eigen::Vector3d u, udot;
-  double pred_psr, pred_psrdot;
+  bool factored = false;
   for (int k = 0; k < 10; k++) {  // should converge within 5 iterations
+    STURDINS_STAGE_TIMER(Stage::GNSS_PVT_ITERATION);
+    iterations_ = k + 1;
 
     // update predicted measurements based on updated state
-    for (int i = 0; i < N; i++) {
-      RangeAndRate(
-          x.segment(0, 3),
-          x.segment(3, 3),
-          x(6),
-          x(7),
-          sv_pos.col(i),
-          sv_vel.col(i),
-          u,
-          udot,
-          pred_psr,
-          pred_psrdot);
-      H(i, 0) = u(0);
-      H(i, 1) = u(1);
-      H(i, 2) = u(2);
-      H(N + i, 0) = udot(0);
-      H(N + i, 1) = udot(1);
-      H(N + i, 2) = udot(2);
-      H(N + i, 3) = u(0);
-      H(N + i, 4) = u(1);
-      H(N + i, 5) = u(2);
-      dy(i) = psr(i) - pred_psr;
-      dy(N + i) = psrdot(i) - pred_psrdot;
+    pred_.Predict(x.segment(0, 3), x.segment(3, 3), x(6), x(7), sv_pos, sv_vel);
+
+    // refresh the satellites whose geometry (or weight) changed, rebuild the normal equations
+    // when most of them did
+    int n_changed = 0;
+    if (!rebuild) {
+      for (int i = 0; i < N; i++) {
+        const bool changed =
+            ((pred_.u_.row(i) - u_.row(i)).cwiseAbs().maxCoeff() > tol_) ||
+            ((pred_.udot_.row(i) - udot_.row(i)).cwiseAbs().maxCoeff() > tol_) ||
+            (k == 0 && (wp_(i) != 1.0 / psr_var(i) || wd_(i) != 1.0 / psrdot_var(i)));
+        if (changed && 4 * (++n_changed) <= N && n_incremental_ < 100) {
+          Accumulate(i, -1.0);
+          u_.row(i) = pred_.u_.row(i);
+          udot_.row(i) = pred_.udot_.row(i);
+          wp_(i) = 1.0 / psr_var(i);
+          wd_(i) = 1.0 / psrdot_var(i);
+          Accumulate(i, 1.0);
+          n_incremental_++;
+        } else if (changed) {
+          rebuild = true;
+          break;
+        }
+      }
     }
+    if (rebuild) {
+      u_ = pred_.u_;
+      udot_ = pred_.udot_;
+      wp_ = psr_var.cwiseInverse();
+      wd_ = psrdot_var.cwiseInverse();
+      HtWH_.setZero();
+      for (int i = 0; i < N; i++) {
+        Accumulate(i, 1.0);
+      }
+      n_changed = N;
+      n_incremental_ = 0;
+      rebuild = false;
+    }
+    refreshed_ += n_changed;
 
-    // Gauss-Newton weighted least squares formula
-    Ht = H.transpose();
-    P = (Ht * W * H).inverse();
-    dx = P * Ht * W * dy;
-    x += dx;
-    if (dx.squaredNorm() < 1e-6) {
-      return true;
+    // factor the normal equations only when they changed (they are symmetric, solve with LLT and
+    // fall back to LDLT when they are not positive definite)
+    if (n_changed > 0 || !factored) {
+      llt_.compute(HtWH_);
+      use_ldlt_ = (llt_.info() != Eigen::Success);
+      if (use_ldlt_) {
+        ldlt_.compute(HtWH_);
+        if (ldlt_.info() != Eigen::Success) {
+          return false;
+        }
+      }
+      factored = true;
+    }
+
+    // Gauss-Newton weighted least squares formula H'*W*dy (see Accumulate for the layout of H)
+    dyp_ = (psr - pred_.psr_).cwiseProduct(wp_);
+    dyd_ = (psrdot - pred_.psrdot_).cwiseProduct(wd_);
+    HtWdy_.segment<3>(0).noalias() = u_.transpose() * dyp_;
+    HtWdy_.segment<3>(0).noalias() += udot_.transpose() * dyd_;
+    HtWdy_.segment<3>(3).noalias() = u_.transpose() * dyd_;
+    HtWdy_(6) = dyp_.sum();
+    HtWdy_(7) = dyd_.sum();
+    if (use_ldlt_) {
+      dx_ = ldlt_.solve(HtWdy_);
+    } else {
+      dx_ = llt_.solve(HtWdy_);
     }
+    x += dx_;
+    if (dx_.squaredNorm() < 1e-6) {
+      break;
+    }
+  }
+
+  if (use_ldlt_) {
+    P = ldlt_.solve(Eigen::Matrix<double, 8, 8>::Identity());
+  } else {
+    P = llt_.solve(Eigen::Matrix<double, 8, 8>::Identity());
   }
 
   // failed to converge in time!
-  return false;
+  return dx_.squaredNorm() < 1e-6;
 }
 
-// *=== PhasedArrayAttitude ===*
-bool PhasedArrayAttitude(
+// robust loss rho(z) of a normalized residual and its IRLS weight rho'(z) / z
+static double RobustRho(const RobustLoss &loss, const double &k, const double &z, double &w) {
+  const double a = std::abs(z);
+  if (loss == RobustLoss::HUBER && a > k) {
+    w = k / a;
+    return k * a - 0.5 * k * k;
+  }
+  if (loss == RobustLoss::TUKEY) {
+    if (a >= k) {
+      w = 0.0;
+      return k * k / 6.0;
+    }
+    const double t = 1.0 - (z / k) * (z / k);
+    w = t * t;
+    return k * k / 6.0 * (1.0 - t * t * t);
+  }
+  w = 1.0;
+  return 0.5 * z * z;
+}
+
+// *=== SolveRobust ===*
+GnssPVTResult GnssPVTWorkspace::SolveRobust(
+    Eigen::Ref<Eigen::VectorXd> x,
+    Eigen::Ref<Eigen::MatrixXd> P,
+    const Eigen::Ref<const Eigen::Matrix3Xd> &sv_pos,
+    const Eigen::Ref<const Eigen::Matrix3Xd> &sv_vel,
+    const Eigen::Ref<const Eigen::VectorXd> &psr,
+    const Eigen::Ref<const Eigen::VectorXd> &psrdot,
+    const Eigen::Ref<const Eigen::VectorXd> &psr_var,
+    const Eigen::Ref<const Eigen::VectorXd> &psrdot_var,
+    const RobustLoss &loss,
+    const double &k,
+    const int &max_iter) {
+  // the weights change every iteration, the next Solve rebuilds its normal equations
+  const int N = psr.size();
+  stale_ = true;
+  u_.resize(N, 3);
+  udot_.resize(N, 3);
+  wp_.resize(N);
+  wd_.resize(N);
+  dyp_.resize(N);
+  dyd_.resize(N);
+  refreshed_ = 0;
+
+  // least squares (quadratic loss) until the fit settles, then the robust loss
+  RobustLoss active = RobustLoss::NONE;
+  double k_active = k;
+  pred_.Predict(x.segment(0, 3), x.segment(3, 3), x(6), x(7), sv_pos, sv_vel);
+  double cost = Evaluate(pred_, psr, psrdot, psr_var, psrdot_var, active, k_active);
+  u_ = pred_.u_;
+  udot_ = pred_.udot_;
+  Rebuild();
+  double mu = 1e-3;
+  double nu = 2.0;
+
+  GnssPVTResult res{false, 0, 0.0, 0.0, 2 * N - 8, 0};
+  Eigen::Matrix<double, 8, 8> A;
+  Eigen::Vector<double, 8> x_trial;
+  for (int it = 0; it < max_iter; it++) {
+    STURDINS_STAGE_TIMER(Stage::GNSS_PVT_ITERATION);
+    res.iterations_ = it + 1;
+
+    // damped step (Marquardt scaling keeps the clock and position states comparable)
+    A = HtWH_;
+    A.diagonal() *= 1.0 + mu;
+    ldlt_.compute(A);
+    if (ldlt_.info() != Eigen::Success) {
+      break;
+    }
+    dx_ = ldlt_.solve(HtWdy_);
+    x_trial = x + dx_;
+    trial_.Predict(
+        x_trial.segment<3>(0), x_trial.segment<3>(3), x_trial(6), x_trial(7), sv_pos, sv_vel);
+    const double cost_trial =
+        Evaluate(trial_, psr, psrdot, psr_var, psrdot_var, active, k_active);
+
+    // gain ratio of the actual to the predicted reduction (Nielsen's update of mu)
+    const double predicted =
+        0.5 * dx_.dot(mu * HtWH_.diagonal().cwiseProduct(dx_) + HtWdy_);
+    const double rho = (cost - cost_trial) / predicted;
+    const double step = dx_.squaredNorm();
+    if (rho > 0.0) {
+      x = x_trial;
+      std::swap(pred_, trial_);
+      cost = cost_trial;
+      mu *= std::max(1.0 / 3.0, 1.0 - std::pow(2.0 * rho - 1.0, 3));
+      nu = 2.0;
+    } else if (step >= 1e-6) {
+      mu *= nu;
+      nu *= 2.0;
+      continue;
+    }
+
+    // a step below the threshold has converged (rejected only by rounding of the cost)
+    if (active != loss && step < 1.0) {
+      // Tukey starts from a Huber fit, it has no pull on residuals beyond k
+      const bool huber_first = active == RobustLoss::NONE && loss == RobustLoss::TUKEY;
+      active = huber_first ? RobustLoss::HUBER : loss;
+      k_active = huber_first ? 1.345 : k;
+      cost = Evaluate(pred_, psr, psrdot, psr_var, psrdot_var, active, k_active);
+    } else if (step < 1e-6) {
+      res.converged_ = true;
+      break;
+    }
+    u_ = pred_.u_;
+    udot_ = pred_.udot_;
+    Rebuild();
+  }
+
+  // covariance with the final weights and the RAIM residual test
+  ldlt_.compute(HtWH_);
+  P = ldlt_.solve(Eigen::Matrix<double, 8, 8>::Identity());
+  use_ldlt_ = true;
+  res.cost_ = cost;
+  for (int i = 0; i < N; i++) {
+    const double zp = (psr(i) - pred_.psr_(i)) / std::sqrt(psr_var(i));
+    const double zd = (psrdot(i) - pred_.psrdot_(i)) / std::sqrt(psrdot_var(i));
+    res.test_stat_ += zp * zp + zd * zd;
+    res.n_outliers_ += (std::abs(zp) > k) + (std::abs(zd) > k);
+  }
+  return res;
+}
+
+// *=== RowsRefreshed ===*
+int GnssPVTWorkspace::RowsRefreshed() const {
+  return refreshed_;
+}
+
+// *=== Iterations ===*
+int GnssPVTWorkspace::Iterations() const {
+  return iterations_;
+}
+
+// *=== Reset ===*
+void GnssPVTWorkspace::Reset() {
+  stale_ = true;
+}
+
+// *=== Accumulate ===*
+void GnssPVTWorkspace::Accumulate(const int &i, const double &sign) {
+  // pseudorange row [u 0 1 0] and pseudorange-rate row [udot u 0 1]
+  Eigen::Vector<double, 8> hp, hd;
+  hp << u_.row(i).transpose(), Eigen::Vector3d::Zero(), 1.0, 0.0;
+  hd << udot_.row(i).transpose(), u_.row(i).transpose(), 0.0, 1.0;
+  HtWH_.noalias() += (sign * wp_(i)) * hp * hp.transpose();
+  HtWH_.noalias() += (sign * wd_(i)) * hd * hd.transpose();
+}
+
+// *=== Rebuild ===*
+void GnssPVTWorkspace::Rebuild() {
+  HtWH_.setZero();
+  for (int i = 0; i < u_.rows(); i++) {
+    Accumulate(i, 1.0);
+  }
+  HtWdy_.segment<3>(0).noalias() = u_.transpose() * dyp_;
+  HtWdy_.segment<3>(0).noalias() += udot_.transpose() * dyd_;
+  HtWdy_.segment<3>(3).noalias() = u_.transpose() * dyd_;
+  HtWdy_(6) = dyp_.sum();
+  HtWdy_(7) = dyd_.sum();
+}
+
+// *=== Evaluate ===*
+double GnssPVTWorkspace::Evaluate(
+    const RangeAndRateBuffer<> &pred,
+    const Eigen::Ref<const Eigen::VectorXd> &psr,
+    const Eigen::Ref<const Eigen::VectorXd> &psrdot,
+    const Eigen::Ref<const Eigen::VectorXd> &psr_var,
+    const Eigen::Ref<const Eigen::VectorXd> &psrdot_var,
+    const RobustLoss &loss,
+    const double &k) {
+  double cost = 0.0, w, r, s;
+  for (int i = 0; i < psr.size(); i++) {
+    r = psr(i) - pred.psr_(i);
+    s = std::sqrt(psr_var(i));
+    cost += RobustRho(loss, k, r / s, w);
+    wp_(i) = w / psr_var(i);
+    dyp_(i) = r * wp_(i);
+    r = psrdot(i) - pred.psrdot_(i);
+    s = std::sqrt(psrdot_var(i));
+    cost += RobustRho(loss, k, r / s, w);
+    wd_(i) = w / psrdot_var(i);
+    dyd_(i) = r * wd_(i);
+  }
+  return cost;
+}
+
+// *=== BatchGnssPVT ===*
+int BatchGnssPVT(
+    Eigen::Ref<Eigen::MatrixXd> x,
+    Eigen::Ref<Eigen::MatrixXd> P,
+    Eigen::Ref<Eigen::Vector<bool, Eigen::Dynamic>> converged,
+    const Eigen::Ref<const Eigen::VectorXi> &offsets,
+    const Eigen::Ref<const Eigen::Matrix3Xd> &sv_pos,
+    const Eigen::Ref<const Eigen::Matrix3Xd> &sv_vel,
+    const Eigen::Ref<const Eigen::VectorXd> &psr,
+    const Eigen::Ref<const Eigen::VectorXd> &psrdot,
+    const Eigen::Ref<const Eigen::VectorXd> &psr_var,
+    const Eigen::Ref<const Eigen::VectorXd> &psrdot_var,
+    const int &n_threads) {
+  const int E = x.cols();
+  eigen_assert(offsets.size() == E + 1 && "offsets must have one entry per epoch plus one");
+  eigen_assert(x.rows() == 8 && P.rows() == 8 && P.cols() == 8 * E && converged.size() == E);
+
+  // workers pull chunks of epochs until none are left (small chunks keep the load balanced when
+  // the number of satellites varies between epochs)
+  constexpr int CHUNK = 16;
+  std::atomic<int> next{0};
+  auto worker = [&]() {
+    GnssPVTWorkspace ws;
+    for (int e0 = next.fetch_add(CHUNK); e0 < E; e0 = next.fetch_add(CHUNK)) {
+      for (int e = e0; e < std::min(E, e0 + CHUNK); e++) {
+        const int i0 = offsets(e);
+        const int n = offsets(e + 1) - i0;
+        if (n == 0) {
+          converged(e) = false;
+          continue;
+        }
+        ws.Reset();
+        converged(e) = ws.Solve(
+            x.col(e),
+            P.middleCols(8 * e, 8),
+            sv_pos.middleCols(i0, n),
+            sv_vel.middleCols(i0, n),
+            psr.segment(i0, n),
+            psrdot.segment(i0, n),
+            psr_var.segment(i0, n),
+            psrdot_var.segment(i0, n));
+      }
+    }
+  };
+
+  const int n_workers = (n_threads > 0)
+                            ? n_threads
+                            : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  const int nt = std::min(n_workers, (E + CHUNK - 1) / CHUNK);
+  std::vector<std::thread> pool;
+  for (int t = 1; t < nt; t++) {
+    pool.emplace_back(worker);
+  }
+  worker();
+  for (std::thread &th : pool) {
+    th.join();
+  }
+  return converged.count();
+}
+
+// closed form exp(Skew(v)) (Rodrigues), with the series expansion near zero
+static Eigen::Matrix3d Rodrigues(const Eigen::Vector3d &v) {
+  const double t2 = v.squaredNorm();
+  double a, b;
+  if (t2 < 1e-12) {
+    a = 1.0 - t2 / 6.0;
+    b = 0.5 - t2 / 24.0;
+  } else {
+    const double t = std::sqrt(t2);
+    a = std::sin(t) / t;
+    b = (1.0 - std::cos(t)) / t2;
+  }
+  const Eigen::Matrix3d K = navtools::Skew(v);
+  return Eigen::Matrix3d::Identity() + a * K + b * K * K;
+}
+
+// *=== PhasedArrayAttitudeSolver ===*
+PhasedArrayAttitudeSolver::PhasedArrayAttitudeSolver(const double &thresh, const int &max_iter)
+    : thresh_{thresh},
+      max_iter_{max_iter},
+      has_prev_{false},
+      C_prev_{Eigen::Matrix3d::Identity()} {
+}
+
+// *=== Solve ===*
+PhasedArrayResult PhasedArrayAttitudeSolver::Solve(
     Eigen::Ref<Eigen::Matrix3d> C_b_l,
     const Eigen::Ref<const Eigen::Matrix3Xd> &u_ned,
     const Eigen::Ref<const Eigen::MatrixXd> &meas_phase,
@@ -135,57 +574,92 @@ bool PhasedArrayAttitude(
     const Eigen::Ref<const Eigen::MatrixXd> &ant_xyz,
     const int &n_ant,
     const double &lambda,
-    const double &thresh) {
+    const bool &warm_start) {
   const int N = meas_phase.cols();  // number of satellites
   const int M = N * n_ant;
-  // std::cout << "M: " << M << "\n";
+  if (warm_start && has_prev_) {
+    C_b_l = C_prev_;
+  }
+
+  // buffers only grow
+  if (w_.size() < M) {
+    w_.resize(M);
+  }
+  if (G_.cols() < 3 * n_ant) {
+    G_.resize(3, 3 * n_ant);
+  }
+  Eigen::Map<Eigen::MatrixXd> W(w_.data(), n_ant, N);
 
-  int k;
-  Eigen::MatrixXd R{Eigen::MatrixXd::Zero(M, M)};
+  // the observation row of antenna j and satellite i is (ant_ned_j x u_i)' / lambda, so antenna
+  // j adds Skew(ant_ned_j) G_j Skew(ant_ned_j)' / lambda^2 to the normal matrix where
+  // G_j = sum_i w_ji u_i u_i' does not depend on the attitude (fixed size loops, the dynamic
+  // products cost more than the arithmetic at these sizes)
+  G_.leftCols(3 * n_ant).setZero();
+  Eigen::Matrix3d uu;
   for (int i = 0; i < N; i++) {
+    uu.noalias() = u_ned.col(i) * u_ned.col(i).transpose();
     for (int j = 0; j < n_ant; j++) {
-      k = n_ant * i + j;
-      R(k, k) = 1.0 / meas_phase_var(j, i);
+      W(j, i) = 1.0 / meas_phase_var(j, i);
+      G_.middleCols<3>(3 * j) += W(j, i) * uu;
     }
   }
 
-  Eigen::Vector3d dx{Eigen::Vector3d::Ones()};
-  Eigen::MatrixXd H{Eigen::MatrixXd::Zero(M, 3)};
-  Eigen::VectorXd dy{Eigen::VectorXd::Zero(M)};
-  Eigen::MatrixXd ant_ned(3, n_ant);
-  double est_phase;
-  for (int z = 0; z < 10; z++) {
-    // construct innovation and observation matrix
-    ant_ned = C_b_l * ant_xyz;
-    for (int i = 0; i < N; i++) {
-      for (int j = 0; j < n_ant; j++) {
-        k = n_ant * i + j;
-        // std::cout << "k: " << k << "\n";
-        est_phase = (ant_ned.col(j).transpose() * u_ned.col(i))(0) / lambda;
-        // std::cout << "meas_phase(" << k << "): " << meas_phase(j, i) << " | est_phase(" << k
-        //           << "): " << est_phase << "\n";
-        dy(k) = meas_phase(j, i) - est_phase;
-        navtools::WrapPiToPi<double>(dy(k));
-        // H.row(k) = -(navtools::Skew<double>(ant_ned.col(j)).transpose() * u_ned.col(i)) / lambda;
-        H.row(k) = -(navtools::Skew(ant_ned.col(j)).transpose() * u_ned.col(i)) / lambda;
+  constexpr double INV_TWO_PI = 1.0 / navtools::TWO_PI<>;
+  const double inv_lambda = 1.0 / lambda;
+  PhasedArrayResult res{false, 0, 0.0};
+  Eigen::Matrix3d HtWH, S;
+  Eigen::Vector3d HtWdy, a, g, dx;
+  double dy;
+  for (int z = 0; z < max_iter_; z++) {
+    // normal equations (scaled by lambda^2) from the phase residuals wrapped to [-pi, pi]
+    HtWH.setZero();
+    HtWdy.setZero();
+    for (int j = 0; j < n_ant; j++) {
+      a.noalias() = C_b_l * ant_xyz.col(j);
+      g.setZero();
+      for (int i = 0; i < N; i++) {
+        dy = meas_phase(j, i) - a.dot(u_ned.col(i)) * inv_lambda;
+        dy -= navtools::TWO_PI<> * std::nearbyint(dy * INV_TWO_PI);
+        g += (W(j, i) * dy) * u_ned.col(i);
       }
+      S = navtools::Skew(a);
+      HtWH.noalias() += S * G_.middleCols<3>(3 * j) * S.transpose();
+      HtWdy += a.cross(g);
     }
 
-    // recursive least squares
-    // std::cout << "\n";
-    // std::cout << "dy: " << dy.transpose() << "\n";
-    // std::cout << "H: \n" << H << "\n";
-    dx = (H.transpose() * R * H).inverse() * H.transpose() * R * dy;
-    // std::cout << "dx: " << dx.transpose() << "\n";
-    // C_b_l = navtools::Skew<double>(dx).exp() * C_b_l;
-    C_b_l = navtools::Skew(dx).exp() * C_b_l;
-
-    if (dx.squaredNorm() < thresh) {
-      std::cout << "z = " << z << "\n";
-      return true;
+    // weighted least squares step
+    dx = lambda * HtWH.ldlt().solve(HtWdy);
+    C_b_l = Rodrigues(dx) * C_b_l;
+    res.iterations_ = z + 1;
+    res.step_ = dx.squaredNorm();
+    if (res.step_ < thresh_) {
+      res.converged_ = true;
+      break;
     }
   }
-  return false;
+  C_prev_ = C_b_l;
+  has_prev_ = true;
+  return res;
+}
+
+// *=== Reset ===*
+void PhasedArrayAttitudeSolver::Reset() {
+  has_prev_ = false;
+}
+
+// *=== PhasedArrayAttitude ===*
+bool PhasedArrayAttitude(
+    Eigen::Ref<Eigen::Matrix3d> C_b_l,
+    const Eigen::Ref<const Eigen::Matrix3Xd> &u_ned,
+    const Eigen::Ref<const Eigen::MatrixXd> &meas_phase,
+    const Eigen::Ref<const Eigen::MatrixXd> &meas_phase_var,
+    const Eigen::Ref<const Eigen::MatrixXd> &ant_xyz,
+    const int &n_ant,
+    const double &lambda,
+    const double &thresh) {
+  PhasedArrayAttitudeSolver solver(thresh);
+  return solver.Solve(C_b_l, u_ned, meas_phase, meas_phase_var, ant_xyz, n_ant, lambda)
+      .converged_;
 }
 
 // *=== Wahba ===*
@@ -223,6 +697,181 @@ void Wahba(
   // std::cout << "C_l_b: \n" << C_l_b << "\n";
 }
 
+// *=== SinCos ===*
+// sin and cos of an array using only vectorizable arithmetic (Eigen does not vectorize the double
+// precision trig functions), the argument is reduced to [-pi/4, pi/4] and evaluated with the
+// Cephes kernels, the quadrant is applied without branches
+static void SinCos(
+    const Eigen::Ref<const Eigen::ArrayXd> &x,
+    Eigen::Ref<Eigen::ArrayXd> s,
+    Eigen::Ref<Eigen::ArrayXd> c,
+    Eigen::Ref<Eigen::ArrayXd> q,
+    Eigen::Ref<Eigen::ArrayXd> r) {
+  q = (x * (2.0 / navtools::PI<>)).round();
+  r = ((x - q * 1.57079625129699707031) - q * 7.54978941586159635335e-8) -
+      q * 5.39030285815811905290e-15;
+
+  // sin(r) and cos(r)
+  c = r * r;
+  s = r + r * c *
+              (((((1.58962301576546568060e-10 * c - 2.50507477628578072866e-8) * c +
+                  2.75573136213857245213e-6) *
+                     c -
+                 1.98412698295895385996e-4) *
+                    c +
+                8.33333333332211858878e-3) *
+                   c -
+               1.66666666666666307295e-1);
+  c = 1.0 - 0.5 * c +
+      c * c *
+          (((((-1.13585365213876817300e-11 * c + 2.08757008419747316778e-9) * c -
+              2.75573141792967388112e-7) *
+                 c +
+             2.48015872888517045348e-5) *
+                c -
+            1.38888888888730564116e-3) *
+               c +
+           4.16666666666665929218e-2);
+
+  // quadrant (q mod 4): sin = {s, c, -s, -c}, cos = {c, -s, -c, s}
+  q -= 4.0 * (0.25 * q).floor();
+  r = (q - 2.0 * (0.5 * q).floor()) * (c - s);
+  s = (1.0 - 2.0 * (0.5 * q).floor()) * (s + r);
+  c = (1.0 - 2.0 * ((0.5 * (q + 1.0)).floor() - 2.0 * (0.25 * (q + 1.0)).floor())) * (c - r);
+}
+
+// *=== MusicBaselines ===*
+// antenna baselines ant_k - ant_l (k < l) scaled by 1/lambda
+static void MusicBaselines(
+    Eigen::Matrix3Xd &base,
+    const Eigen::Ref<const Eigen::Matrix3Xd> &ant_xyz,
+    const int &n_ant,
+    const double &lambda) {
+  base.resize(3, n_ant * (n_ant - 1) / 2);
+  for (int k = 0, b = 0; k < n_ant; k++) {
+    for (int l = k + 1; l < n_ant; l++, b++) {
+      base.col(b) = (ant_xyz.col(k) - ant_xyz.col(l)) / lambda;
+    }
+  }
+}
+
+// *=== MusicProjector ===*
+// a'*U*U'*a with a_k = exp(-j*u.ant_k/lambda) is
+//    tr(UUh) + sum_{k<l} 2*Re(UUh(k,l) * exp(j*u.(ant_k - ant_l)/lambda))
+// so each grid point only needs the cos/sin of the baseline phases, the weights of
+// [cos(phase) sin(phase)] are written to w and the trace is returned
+static double MusicProjector(
+    Eigen::Ref<Eigen::VectorXd> w,
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXcd> &eig,
+    Eigen::MatrixXcd &S,
+    const Eigen::Ref<const Eigen::VectorXcd> &P,
+    const int &n_ant) {
+  // 1) calculate correlation/covariance
+  S.noalias() = P * P.adjoint();
+
+  // 2) calculate eigen-structure of S (hermitian)
+  eig.compute(S);
+  const Eigen::VectorXd &e = eig.eigenvalues();
+  const Eigen::MatrixXcd &v = eig.eigenvectors();
+
+  // 3) noise subspace projector U*U' (eigenvectors of the small eigenvalues)
+  S.setZero();
+  for (int i = 0; i < n_ant; i++) {
+    if (std::abs(e(i)) < 10.0) {
+      S.noalias() += v.col(i) * v.col(i).adjoint();
+    }
+  }
+  const int NB = n_ant * (n_ant - 1) / 2;
+  for (int k = 0, b = 0; k < n_ant; k++) {
+    for (int l = k + 1; l < n_ant; l++, b++) {
+      w(b) = 2.0 * S(k, l).real();
+      w(NB + b) = -2.0 * S(k, l).imag();
+    }
+  }
+  return S.diagonal().real().sum();
+}
+
+// *=== MusicPeak ===*
+// smallest denominator above 1e-8 (P_music = 1/|a'*U*U'*a|, or 0 if the denominator is below
+// 1e-8), the first occurrence wins
+static void MusicPeak(
+    double &d_min, int &idx, const Eigen::Ref<const Eigen::ArrayXd> &d, const int &offset) {
+  for (int j = 0; j < d.size(); j++) {
+    const double dj = std::abs(d(j));
+    if (dj > 1e-8 && dj < d_min) {
+      d_min = dj;
+      idx = offset + j;
+    }
+  }
+}
+
+// *=== MusicSearch ===*
+// searches az(i0:i1) x el for the MUSIC peak, grid holds [az el cos(el) sin(el)] and work holds
+// the [d phase sin cos q r] buffers, the peak is returned as i * ne + j
+static void MusicSearch(
+    double &d_min,
+    int &idx,
+    const Eigen::Ref<const Eigen::ArrayXXd> &grid,
+    const int &ne,
+    const int &i0,
+    const int &i1,
+    const Eigen::Ref<const Eigen::Matrix3Xd> &base,
+    const Eigen::Ref<const Eigen::VectorXd> &w,
+    const double &tr,
+    Eigen::Ref<Eigen::ArrayXXd> work) {
+  const int NB = base.cols();
+  Eigen::Map<const Eigen::ArrayXd> cos_el(grid.col(2).data(), ne);
+  Eigen::Map<const Eigen::ArrayXd> sin_el(grid.col(3).data(), ne);
+  Eigen::Map<Eigen::ArrayXd> d(work.col(0).data(), ne);
+  Eigen::Map<Eigen::ArrayXd> phase(work.col(1).data(), ne);
+  Eigen::Map<Eigen::ArrayXd> s(work.col(2).data(), ne);
+  Eigen::Map<Eigen::ArrayXd> c(work.col(3).data(), ne);
+  for (int i = i0; i < i1; i++) {
+    const double cos_az = std::cos(grid(i, 0));
+    const double sin_az = std::sin(grid(i, 0));
+    d.setConstant(tr);
+    for (int b = 0; b < NB; b++) {
+      phase = (base(0, b) * cos_az + base(1, b) * sin_az) * cos_el - base(2, b) * sin_el;
+      SinCos(phase, s, c, work.col(4).head(ne), work.col(5).head(ne));
+      d += w(b) * c + w(NB + b) * s;
+    }
+    MusicPeak(d_min, idx, d, i * ne);
+  }
+}
+
+// *=== MusicRefine ===*
+// recenters on the peak and increases the resolution by 10x (searching one full cell of the
+// previous level) until the resolution reaches thresh
+static void MusicRefine(
+    double &az_mean,
+    double &el_mean,
+    double res,
+    const double &thresh,
+    const Eigen::Ref<const Eigen::Matrix3Xd> &base,
+    const Eigen::Ref<const Eigen::VectorXd> &w,
+    const double &tr,
+    Eigen::Ref<Eigen::ArrayXXd> grid,
+    Eigen::Ref<Eigen::ArrayXXd> work) {
+  double span = res;
+  res /= 10.0;
+  while (res >= thresh) {
+    STURDINS_STAGE_TIMER(Stage::MUSIC_LEVEL);
+    const int n = 2 * static_cast<int>(std::round(span / res)) + 1;
+    grid.col(0).head(n) = Eigen::ArrayXd::LinSpaced(n, az_mean - span, az_mean + span);
+    grid.col(1).head(n) = Eigen::ArrayXd::LinSpaced(n, el_mean - span, el_mean + span);
+    grid.col(2).head(n) = grid.col(1).head(n).cos();
+    grid.col(3).head(n) = grid.col(1).head(n).sin();
+
+    double d_min = std::numeric_limits<double>::infinity();
+    int idx = 0;
+    MusicSearch(d_min, idx, grid, n, 0, n, base, w, tr, work);
+    az_mean = grid(idx / n, 0);
+    el_mean = grid(idx % n, 1);
+    span = res;
+    res /= 10.0;
+  }
+}
+
 // *=== MUSIC ===*
 void MUSIC(
     double &az_mean,
@@ -231,92 +880,141 @@ void MUSIC(
     const Eigen::Ref<const Eigen::Matrix3Xd> &ant_xyz,
     const int &n_ant,
     const double &lambda,
-    const double &thresh) {
-  // std::cout << "MUSIC inputs: \n\taz_mean: " << az_mean << "\n\tel_mean: " << el_mean
-  //           << "\n\tP: " << P.transpose() << "\n\tant_xyz: \n"
-  //           << ant_xyz << "\n\tn_ant: " << n_ant << "\n\tlambda: " << lambda
-  //           << "\n\tthresh: " << thresh << "\n\n";
+    const double &thresh,
+    const int &n_threads) {
+  // 1-3) noise subspace projector in terms of the antenna baselines
+  Eigen::Matrix3Xd base;
+  MusicBaselines(base, ant_xyz, n_ant, lambda);
+  Eigen::VectorXd w(2 * base.cols());
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXcd> eig(n_ant);
+  Eigen::MatrixXcd S(n_ant, n_ant);
+  const double tr = MusicProjector(w, eig, S, P, n_ant);
 
-  // 1) calculate correlation/covariance
-  Eigen::MatrixXcd S = (P * P.conjugate().transpose());
-  // std::cout << "S: \n" << S << "\n";
+  // 4) Find max power given arrival angles, buffers are sized for the coarse grid and reused by
+  //    the refinement levels
+  const double res = navtools::DEG2RAD<> * 1.0;
+  az_mean = navtools::DEG2RAD<> * 0.0;
+  el_mean = navtools::DEG2RAD<> * -45.0;
+  if (res < thresh) {
+    return;
+  }
+  STURDINS_STAGE_TIMER(Stage::MUSIC_LEVEL);
+  const int na = 2 * static_cast<int>(std::round(navtools::DEG2RAD<> * 180.0 / res)) + 1;
+  const int ne = 2 * static_cast<int>(std::round(navtools::DEG2RAD<> * 45.0 / res)) + 1;
+  // (the buffer columns are padded to 8 doubles so every column stays 64 byte aligned)
+  Eigen::ArrayXXd grid((na + 7) / 8 * 8, 4);
+  grid.col(0).head(na) = Eigen::ArrayXd::LinSpaced(na, -navtools::PI<>, navtools::PI<>);
+  grid.col(1).head(ne) = Eigen::ArrayXd::LinSpaced(ne, -navtools::HALF_PI<>, 0.0);
+  grid.col(2).head(ne) = grid.col(1).head(ne).cos();
+  grid.col(3).head(ne) = grid.col(1).head(ne).sin();
 
-  // 2) calculate eigen-structure of S
-  Eigen::ComplexEigenSolver<Eigen::MatrixXcd> eigen_solver(S, true);
-  Eigen::VectorXcd e = eigen_solver.eigenvalues();
-  Eigen::MatrixXcd v = eigen_solver.eigenvectors();
-  // std::cout << "e: \n" << e.transpose() << "\n";
-  // std::cout << "v: \n" << v << "\n";
-
-  // 3) determine number of incident signals
-  Eigen::VectorX<bool> idx = (e.array().abs()) < 10.0;
-  const int N = idx.count();
-  // const int D = n_ant - N
-  Eigen::MatrixXcd U(n_ant, N);
-  for (int i = 0; i < n_ant; i++) {
-    if (idx(i)) {
-      U.col(i) = v.col(i);
+  // coarse grid, each worker searches a range of azimuths (all elevations)
+  const int n_workers = (n_threads > 0)
+                            ? n_threads
+                            : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  const int nt = std::min(n_workers, na);
+  const int chunk = (na + nt - 1) / nt;
+  std::vector<Eigen::ArrayXXd> work(nt, Eigen::ArrayXXd((ne + 7) / 8 * 8, 6));
+  std::vector<double> d_min(nt, std::numeric_limits<double>::infinity());
+  std::vector<int> idx(nt, 0);
+  std::vector<std::thread> pool;
+  for (int t = 1; t < nt; t++) {
+    pool.emplace_back([&, t]() {
+      MusicSearch(
+          d_min[t], idx[t], grid, ne, t * chunk, std::min(na, (t + 1) * chunk), base, w, tr,
+          work[t]);
+    });
+  }
+  MusicSearch(d_min[0], idx[0], grid, ne, 0, std::min(na, chunk), base, w, tr, work[0]);
+  for (std::thread &th : pool) {
+    th.join();
+  }
+
+  // reduce in azimuth order, so the result does not depend on the number of threads
+  int best = 0;
+  for (int t = 1; t < nt; t++) {
+    if (d_min[t] < d_min[best]) {
+      best = t;
     }
   }
-  // std::cout << "U: \n" << U << "\n";
+  az_mean = grid(idx[best] / ne, 0);
+  el_mean = grid(idx[best] % ne, 1);
+  STURDINS_STAGE_TIMER_STOP();
 
-  // 4) Find max power given arrival angles
-  double az_span = navtools::DEG2RAD<> * 180.0;
-  double el_span = navtools::DEG2RAD<> * 45.0;
-  double res = navtools::DEG2RAD<> * 1.0;
-  az_mean = navtools::DEG2RAD<> * 0.0;
-  el_mean = navtools::DEG2RAD<> * -45.0;
-  Eigen::VectorXcd tmp(n_ant);
-  Eigen::Vector3d u;
-  double sin_az, cos_az, sin_el, cos_el;
-  int max_az_idx, max_el_idx;
-  // std::complex<double> xyz2phase = -navtools::COMPLEX_I<> * navtools::TWO_PI<> / lambda;
-  std::complex<double> xyz2phase = -navtools::COMPLEX_I<> / lambda;
-  while (res >= thresh) {
-    Eigen::VectorXd az{Eigen::VectorXd::LinSpaced(
-        2 * static_cast<int>(az_span / res) + 1, az_mean - az_span, az_mean + az_span)};
-    Eigen::VectorXd el{Eigen::VectorXd::LinSpaced(
-        2 * static_cast<int>(el_span / res) + 1, el_mean - el_span, el_mean + el_span)};
-    Eigen::MatrixXd P_music(az.size(), el.size());
-
-    for (int i = 0; i < az.size(); i++) {
-      // loop through azimuths
-      sin_az = std::sin(az(i));
-      cos_az = std::cos(az(i));
-
-      for (int j = 0; j < el.size(); j++) {
-        // loop through elevations
-        sin_el = std::sin(el(j));
-        cos_el = std::cos(el(j));
-
-        // calculate spatial phase
-        u << cos_az * cos_el, sin_az * cos_el, -sin_el;
-        for (int k = 0; k < n_ant; k++) {
-          tmp(k) = std::exp(xyz2phase * u.dot(ant_xyz.col(k)));
-        }
+  // refinement levels
+  MusicRefine(az_mean, el_mean, res, thresh, base, w, tr, grid, work[0]);
+}
 
-        // determine power based on input az & el
-        double d = std::abs((tmp.conjugate().transpose() * U * U.conjugate().transpose() * tmp)(0));
-        if (d > 1e-8) {
-          P_music(i, j) =
-              1.0 /
-              std::abs((tmp.conjugate().transpose() * U * U.conjugate().transpose() * tmp)(0));
-        } else {
-          P_music(i, j) = 0.0;
-        }
-      }
-    }
+// *=== MusicManifold ===*
+MusicManifold::MusicManifold(
+    const Eigen::Ref<const Eigen::Matrix3Xd> &ant_xyz,
+    const int &n_ant,
+    const double &lambda,
+    const double &res)
+    : n_ant_{n_ant},
+      n_base_{n_ant * (n_ant - 1) / 2},
+      res_{res},
+      na_{2 * static_cast<int>(std::round(navtools::PI<> / res)) + 1},
+      ne_{2 * static_cast<int>(std::round(0.5 * navtools::HALF_PI<> / res)) + 1},
+      eig_(n_ant),
+      S_(n_ant, n_ant),
+      w_(2 * n_base_),
+      d_(na_ * ne_),
+      grid_(24, 4),
+      work_(24, 6) {
+  MusicBaselines(base_, ant_xyz, n_ant_, lambda);
+  az_ = Eigen::ArrayXd::LinSpaced(na_, -navtools::PI<>, navtools::PI<>);
+  el_ = Eigen::ArrayXd::LinSpaced(ne_, -navtools::HALF_PI<>, 0.0);
 
-    // find peak, recenter, and increase resolution
-    P_music.maxCoeff(&max_az_idx, &max_el_idx);
-    az_mean = az(max_az_idx);
-    el_mean = el(max_el_idx);
-    az_span = res / 10.0;
-    el_span = res / 10.0;
-    res /= 10.0;
-    // std::cout << "az & el mean: " << az_mean * navtools::RAD2DEG<> << ", "
-    //           << el_mean * navtools::RAD2DEG<> << "\n";
+  // cache [cos(phase) sin(phase)] of every baseline at every grid point
+  manifold_.resize(na_ * ne_, 2 * n_base_);
+  const Eigen::ArrayXd cos_el = el_.cos();
+  const Eigen::ArrayXd sin_el = el_.sin();
+  Eigen::ArrayXd phase(ne_);
+  for (int i = 0; i < na_; i++) {
+    const double cos_az = std::cos(az_(i));
+    const double sin_az = std::sin(az_(i));
+    for (int b = 0; b < n_base_; b++) {
+      phase = (base_(0, b) * cos_az + base_(1, b) * sin_az) * cos_el - base_(2, b) * sin_el;
+      manifold_.col(b).segment(i * ne_, ne_) = phase.cos().matrix();
+      manifold_.col(n_base_ + b).segment(i * ne_, ne_) = phase.sin().matrix();
+    }
   }
 }
 
+// *=== Estimate ===*
+void MusicManifold::Estimate(
+    double &az_mean,
+    double &el_mean,
+    const Eigen::Ref<const Eigen::VectorXcd> &P,
+    const double &thresh) {
+  const double tr = MusicProjector(w_, eig_, S_, P, n_ant_);
+
+  // coarse grid, d = tr + [cos(phase) sin(phase)] * w
+  STURDINS_STAGE_TIMER(Stage::MUSIC_LEVEL);
+  d_.setConstant(tr);
+  d_.noalias() += manifold_ * w_;
+  double d_min = std::numeric_limits<double>::infinity();
+  int idx = 0;
+  MusicPeak(d_min, idx, d_.array(), 0);
+  az_mean = az_(idx / ne_);
+  el_mean = el_(idx % ne_);
+  STURDINS_STAGE_TIMER_STOP();
+
+  // refinement levels
+  MusicRefine(az_mean, el_mean, res_, thresh, base_, w_, tr, grid_, work_);
+}
+
+// *=== GridSize ===*
+int MusicManifold::GridSize() const {
+  return na_ * ne_;
+}
+
+// *=== MemoryFootprint ===*
+std::size_t MusicManifold::MemoryFootprint() const {
+  return sizeof(double) * (manifold_.size() + base_.size() + az_.size() + el_.size() +
+                           w_.size() + d_.size() + grid_.size() + work_.size()) +
+         sizeof(std::complex<double>) * S_.size() * 3 + sizeof(double) * n_ant_;
+}
+
 }  // namespace sturdins
\ No newline at end of file
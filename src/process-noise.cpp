@@ -0,0 +1,128 @@
+/**
+ * *process-noise.cpp*
+ *
+ * =======  ========================================================================================
+ * @file    sturdins/process-noise.cpp
+ * @brief   Discretized process noise of the navigation filters, cached per integration period.
+ * @date    January 2025
+ * @author  Daniel Sturdivant <sturdivant20@gmail.com>
+ * =======  ========================================================================================
+ */
+
+#include "sturdins/process-noise.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <navtools/constants.hpp>
+
+namespace sturdins {
+
+// periods within this relative tolerance share their cached blocks (accumulated sums of a fixed
+// step differ from the product in the last bits)
+static constexpr double DT_RTOL = 1e-9;
+
+// *=== ProcessNoiseModel ===*
+ProcessNoiseModel::ProcessNoiseModel(
+    const NavigationClock &clock,
+    const NavigationIMU &imu,
+    const std::vector<double> &dt,
+    const double &Svel,
+    const double &Satt)
+    : clock_{clock}, imu_{imu}, Sv_{Svel}, Sa_{Satt} {
+  NavigationIMU si = imu;
+  NavImuToSiUnits(si);
+  Sra_ = 1.21 * si.Na * si.Na;
+  Sbad_ = 1.21 * si.Ba * si.Ba;
+  Srg_ = 1.21 * si.Ng * si.Ng;
+  Sbgd_ = 1.21 * si.Bg * si.Bg;
+
+  std::vector<double> periods = dt;
+  std::sort(periods.begin(), periods.end());
+  cache_.reserve(periods.size());
+  for (const double &p : periods) {
+    if (p > 0.0 && Find(p) == nullptr) {
+      cache_.emplace_back();
+      Discretize(cache_.back(), p);
+    }
+  }
+}
+
+// *=== Blocks ===*
+const ProcessNoiseBlocks &ProcessNoiseModel::Blocks(
+    const double &dt, ProcessNoiseBlocks &scratch) const {
+  const ProcessNoiseBlocks *q = Find(dt);
+  if (q != nullptr) {
+    return *q;
+  }
+  Discretize(scratch, dt);
+  return scratch;
+}
+
+// *=== IsCached ===*
+bool ProcessNoiseModel::IsCached(const double &dt) const {
+  return Find(dt) != nullptr;
+}
+
+// *=== Clock ===*
+const NavigationClock &ProcessNoiseModel::Clock() const {
+  return clock_;
+}
+
+// *=== Imu ===*
+const NavigationIMU &ProcessNoiseModel::Imu() const {
+  return imu_;
+}
+
+// *=== Svel ===*
+double ProcessNoiseModel::Svel() const {
+  return Sv_;
+}
+
+// *=== Satt ===*
+double ProcessNoiseModel::Satt() const {
+  return Sa_;
+}
+
+// *=== Discretize ===*
+void ProcessNoiseModel::Discretize(ProcessNoiseBlocks &q, const double &dt) const {
+  q.dt_ = dt;
+  q.clock_ = NavClockProcessCov(clock_, dt);
+
+  /**
+   * @brief InertialNav applies Q twice per step (P = F*(P + Q)*F' + Q), so its clock block halves
+   *        the h0 terms and the h1 cross term of NavClockProcessCov
+   */
+  const double LS2 = navtools::LIGHT_SPEED<> * navtools::LIGHT_SPEED<>;
+  q.ins_clock_ = q.clock_;
+  q.ins_clock_(0, 0) -= LS2 * clock_.h0 / 4.0 * dt;
+  q.ins_clock_(0, 1) -= LS2 * clock_.h1 * dt;
+  q.ins_clock_(1, 0) = q.ins_clock_(0, 1);  // the baseline filter left this term at zero
+  q.ins_clock_(1, 1) -= LS2 * clock_.h0 / 4.0 / dt;
+
+  /**
+   * @brief First order simplified Q matrix from Groves Ch.14 (see InertialNav::Propagate)
+   */
+  q.ins_.segment<3>(0).setConstant(0.5 * Srg_ * dt);
+  q.ins_.segment<3>(3).setConstant(0.5 * Sra_ * dt);
+  q.ins_.segment<3>(6).setZero();
+  q.ins_.segment<3>(9).setConstant(0.5 * Sbad_ * dt);
+  q.ins_.segment<3>(12).setConstant(0.5 * Sbgd_ * dt);
+
+  /**
+   * @brief Process noise matrix Groves Ch.9 (see KinematicNav::Propagate)
+   */
+  const double dtsq = dt * dt;
+  q.kns_ << Sv_ / 3.0 * dtsq * dt, Sv_ / 2.0 * dtsq, Sv_ * dt, Sa_ * dt;
+}
+
+// *=== Find ===*
+const ProcessNoiseBlocks *ProcessNoiseModel::Find(const double &dt) const {
+  for (const ProcessNoiseBlocks &q : cache_) {
+    if (std::abs(q.dt_ - dt) <= DT_RTOL * q.dt_) {
+      return &q;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace sturdins
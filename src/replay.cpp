@@ -0,0 +1,161 @@
+/**
+ * *replay.cpp*
+ *
+ * =======  ========================================================================================
+ * @file    sturdins/replay.cpp
+ * @brief   Streaming replay of truth/IMU/GNSS binary logs through the navigation filters.
+ * @date    January 2025
+ * @author  Daniel Sturdivant <sturdivant20@gmail.com>
+ * =======  ========================================================================================
+ */
+
+#include "sturdins/replay.hpp"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sturdins {
+
+// *=== MappedFile ===*
+MappedFile::MappedFile() : data_{nullptr}, size_{0} {
+}
+MappedFile::MappedFile(const std::string &filename) : data_{nullptr}, size_{0} {
+  Open(filename);
+}
+
+// *=== ~MappedFile ===*
+MappedFile::~MappedFile() {
+  Close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept : data_{other.data_}, size_{other.size_} {
+#ifdef _WIN32
+  buffer_ = std::move(other.buffer_);
+#endif
+  other.data_ = nullptr;
+  other.size_ = 0;
+}
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    Close();
+    data_ = other.data_;
+    size_ = other.size_;
+#ifdef _WIN32
+    buffer_ = std::move(other.buffer_);
+#endif
+    other.data_ = nullptr;
+    other.size_ = 0;
+  }
+  return *this;
+}
+
+// *=== Open ===*
+bool MappedFile::Open(const std::string &filename) {
+  Close();
+#ifdef _WIN32
+  std::ifstream fid(filename, std::ios::binary | std::ios::ate);
+  if (!fid) {
+    return false;
+  }
+  buffer_.resize(static_cast<std::size_t>(fid.tellg()));
+  fid.seekg(0);
+  if (buffer_.empty() || !fid.read(buffer_.data(), buffer_.size())) {
+    buffer_.clear();
+    return false;
+  }
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+#else
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+    ::close(fd);
+    return false;
+  }
+  void *addr = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);  // the mapping keeps the file open
+  if (addr == MAP_FAILED) {
+    return false;
+  }
+  ::madvise(addr, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+  data_ = static_cast<const char *>(addr);
+  size_ = static_cast<std::size_t>(st.st_size);
+#endif
+  return true;
+}
+
+// *=== Close ===*
+void MappedFile::Close() {
+#ifdef _WIN32
+  buffer_.clear();
+#else
+  if (data_ != nullptr) {
+    ::munmap(const_cast<char *>(data_), size_);
+  }
+#endif
+  data_ = nullptr;
+  size_ = 0;
+}
+
+// *=== IsOpen ===*
+bool MappedFile::IsOpen() const {
+  return data_ != nullptr;
+}
+
+// *=== Data ===*
+const char *MappedFile::Data() const {
+  return data_;
+}
+
+// *=== Size ===*
+std::size_t MappedFile::Size() const {
+  return size_;
+}
+
+// *=== MeasurementGenerator ===*
+MeasurementGenerator::MeasurementGenerator(
+    const RecordReader<satutils::KeplerElements<double>> &elems) {
+  const std::size_t N = std::min<std::size_t>(elems.Size(), MAX_SV);
+  eph_.reserve(N);
+  for (std::size_t i = 0; i < N; i++) {
+    eph_.emplace_back(elems[i]);
+  }
+}
+
+// *=== Generate ===*
+void MeasurementGenerator::Generate(
+    GnssEpoch &epoch,
+    const double &ToW,
+    const Eigen::Ref<const Eigen::Vector3d> &pos,
+    const Eigen::Ref<const Eigen::Vector3d> &vel,
+    const double &cb,
+    const double &cd) {
+  const int N = Size();
+  epoch.ToW_ = ToW;
+  epoch.Resize(N);
+  Eigen::Vector3d sv_clk, sv_acc;
+  for (int i = 0; i < N; i++) {
+    eph_[i].CalcNavStates<false>(sv_clk, epoch.sv_pos_.col(i), epoch.sv_vel_.col(i), sv_acc, ToW);
+  }
+  pred_.Predict(pos, vel, cb, cd, epoch.sv_pos_, epoch.sv_vel_);
+  epoch.psr_ = pred_.psr_;
+  epoch.psrdot_ = pred_.psrdot_;
+}
+
+// *=== Size ===*
+int MeasurementGenerator::Size() const {
+  return std::min<int>(static_cast<int>(eph_.size()), MAX_SV);
+}
+
+}  // namespace sturdins
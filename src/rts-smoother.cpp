@@ -0,0 +1,298 @@
+/**
+ * *rts-smoother.cpp*
+ *
+ * =======  ========================================================================================
+ * @file    sturdins/rts-smoother.cpp
+ * @brief   Fixed-interval Rauch-Tung-Striebel smoothing of recorded navigation filter runs.
+ * @date    January 2025
+ * @author  Daniel Sturdivant <sturdivant20@gmail.com>
+ * @ref     1. "Principles of GNSS, Inertial, and Multisensor Integrated Navigation Systems", 2nd
+ *              Edition, 2013 - Groves (Ch. 3.4.2)
+ * =======  ========================================================================================
+ */
+
+#include "sturdins/rts-smoother.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#include "sturdins/inertial-nav.hpp"
+#include "sturdins/kinematic-nav.hpp"
+
+namespace sturdins {
+
+// columns start on a cache line
+static std::size_t AlignColumn(const std::size_t &n) {
+  return (n + 63) & ~static_cast<std::size_t>(63);
+}
+
+// run f(s) for s = 0...n-1, one thread per segment (s = 0 on the calling thread)
+template <typename F>
+static void ForEachSegment(const int &n, F &&f) {
+  std::vector<std::thread> workers;
+  workers.reserve(n - 1);
+  for (int s = 1; s < n; s++) {
+    workers.emplace_back(f, s);
+  }
+  f(0);
+  for (std::thread &w : workers) {
+    w.join();
+  }
+}
+
+// *=== RtsSmoother ===*
+template <class Filter>
+RtsSmoother<Filter>::RtsSmoother(const std::size_t &chunk_size, const std::string &spill_file)
+    : chunk_size_{std::max<std::size_t>(chunk_size, 1)},
+      n_{0},
+      spill_file_{spill_file},
+      fout_{nullptr} {
+  off_t_ = 0;
+  off_snap_ = AlignColumn(off_t_ + chunk_size_ * sizeof(double));
+  off_Pm_ = AlignColumn(off_snap_ + chunk_size_ * sizeof(Snapshot));
+  off_Phi_ = AlignColumn(off_Pm_ + chunk_size_ * PACKED_SIZE<N> * sizeof(T));
+  off_dz_ = AlignColumn(off_Phi_ + chunk_size_ * N * N * sizeof(T));
+  chunk_bytes_ = AlignColumn(off_dz_ + chunk_size_ * N * sizeof(T));
+  if (!spill_file_.empty()) {
+    fout_ = std::fopen(spill_file_.c_str(), "wb");
+  }
+}
+
+// *=== ~RtsSmoother ===*
+template <class Filter>
+RtsSmoother<Filter>::~RtsSmoother() {
+  if (fout_) {
+    std::fclose(fout_);
+  }
+  spilled_.Close();
+  if (!spill_file_.empty()) {
+    std::remove(spill_file_.c_str());
+  }
+}
+
+// *=== Record ===*
+template <class Filter>
+bool RtsSmoother<Filter>::Record(const double &t, Filter &filt) {
+  const bool spill = !spill_file_.empty();
+  if (spill && !fout_) {
+    return false;
+  }
+
+  // the forward pass quantities since the previous epoch
+  if (n_ == 0) {
+    filt.SetSmootherLog(true);
+  }
+  filt.TakeSmootherLog(Phi_, Pm_, dz_);
+
+  // a spilled store refills its one chunk
+  const std::size_t i = n_ % chunk_size_;
+  if (i == 0 && (!spill || chunks_.empty())) {
+    chunks_.emplace_back(chunk_bytes_);
+  }
+  std::uint8_t *chunk = chunks_.back().data();
+  std::memcpy(chunk + off_t_ + i * sizeof(double), &t, sizeof(double));
+  filt.SaveSnapshot(*reinterpret_cast<Snapshot *>(chunk + off_snap_ + i * sizeof(Snapshot)));
+  PackUpper(reinterpret_cast<T *>(chunk + off_Pm_) + i * PACKED_SIZE<N>, Pm_);
+  Eigen::Map<Matrix>(reinterpret_cast<T *>(chunk + off_Phi_) + i * N * N) = Phi_;
+  Eigen::Map<Vector>(reinterpret_cast<T *>(chunk + off_dz_) + i * N) = dz_;
+  n_++;
+
+  if (spill && i + 1 == chunk_size_ &&
+      std::fwrite(chunk, 1, chunk_bytes_, fout_) != chunk_bytes_) {
+    std::fclose(fout_);
+    fout_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+// *=== Smooth ===*
+template <class Filter>
+bool RtsSmoother<Filter>::Smooth(
+    Eigen::Ref<Eigen::VectorXd> t,
+    Eigen::Ref<RowMatrixXd> states,
+    Eigen::Ref<RowMatrixXd> cov_diag,
+    const int &n_seg) {
+  const std::size_t n = n_;
+  eigen_assert(static_cast<std::size_t>(t.size()) == n);
+  eigen_assert(static_cast<std::size_t>(states.rows()) == n && states.cols() == Filter::STATE_SIZE);
+  eigen_assert(static_cast<std::size_t>(cov_diag.rows()) == n && cov_diag.cols() == N);
+  if (n == 0) {
+    return true;
+  }
+
+  // finish the spill file (the partial last chunk is written whole) and map it
+  if (!spill_file_.empty() && !spilled_.IsOpen()) {
+    if (!fout_) {
+      return false;
+    }
+    bool ok = n % chunk_size_ == 0 ||
+              std::fwrite(chunks_.back().data(), 1, chunk_bytes_, fout_) == chunk_bytes_;
+    ok = (std::fclose(fout_) == 0) && ok;
+    fout_ = nullptr;
+    chunks_.clear();
+    chunks_.shrink_to_fit();
+    const std::size_t n_bytes = ((n - 1) / chunk_size_ + 1) * chunk_bytes_;
+    if (!ok || !spilled_.Open(spill_file_) || spilled_.Size() < n_bytes) {
+      return false;
+    }
+  }
+
+  // the last epoch is not changed by smoothing
+  Filter scratch;
+  const Snapshot *snap;
+  Matrix Pp, Pm, Phi;
+  Vector dz;
+  Vector dx{Vector::Zero()};
+  Load(n - 1, snap, Pp, Pm, Phi, dz);
+  Output(n - 1, dx, Pp, scratch, t, states, cov_diag);
+  if (n == 1) {
+    return true;
+  }
+  const int S = static_cast<int>(std::clamp<std::size_t>(std::max(n_seg, 1), 1, n - 1));
+  if (S == 1) {
+    Backward(0, n - 1, dx, Pp, nullptr, t, states, cov_diag);
+    return true;
+  }
+
+  // segment s spans [b_s, b_s+1), each reduced to dx_b = dl + G*dx_b+1, Ps_b = Pl + G*Ps_b+1*G'
+  std::vector<std::size_t> b(S + 1);
+  for (int s = 0; s <= S; s++) {
+    b[s] = (n - 1) * s / S;
+  }
+  std::vector<Vector> dx_b(S + 1);
+  std::vector<Matrix> Ps_b(S + 1), G(S);
+  dx_b[S] = dx;
+  Ps_b[S] = Pp;
+  ForEachSegment(S, [&](const int &s) {
+    if (s == S - 1) {
+      dx_b[s] = dx_b[S];
+      Ps_b[s] = Ps_b[S];
+    } else {
+      dx_b[s].setZero();
+      Ps_b[s].setZero();
+    }
+    G[s].setIdentity();
+    Backward(b[s], b[s + 1], dx_b[s], Ps_b[s], &G[s], t, states, cov_diag);
+  });
+  for (int s = S - 2; s >= 0; s--) {
+    dx_b[s].noalias() += G[s] * dx_b[s + 1];
+    Ps_b[s].noalias() += G[s] * Ps_b[s + 1] * G[s].transpose();
+  }
+
+  // smooth every segment from its end
+  ForEachSegment(S, [&](const int &s) {
+    Vector dx_s = dx_b[s + 1];
+    Matrix Ps_s = Ps_b[s + 1];
+    Backward(b[s], b[s + 1], dx_s, Ps_s, nullptr, t, states, cov_diag);
+  });
+  return true;
+}
+
+// *=== Size ===*
+template <class Filter>
+std::size_t RtsSmoother<Filter>::Size() const {
+  return n_;
+}
+
+// *=== BytesPerEpoch ===*
+template <class Filter>
+std::size_t RtsSmoother<Filter>::BytesPerEpoch() const {
+  return chunk_bytes_ / chunk_size_;
+}
+
+// *=== Chunk ===*
+template <class Filter>
+const std::uint8_t *RtsSmoother<Filter>::Chunk(const std::size_t &c) const {
+  if (spilled_.IsOpen()) {
+    return reinterpret_cast<const std::uint8_t *>(spilled_.Data()) + c * chunk_bytes_;
+  }
+  return chunks_[c].data();
+}
+
+// *=== Load ===*
+template <class Filter>
+void RtsSmoother<Filter>::Load(
+    const std::size_t &k,
+    const Snapshot *&snap,
+    Matrix &Pp,
+    Matrix &Pm,
+    Matrix &Phi,
+    Vector &dz) const {
+  const std::uint8_t *chunk = Chunk(k / chunk_size_);
+  const std::size_t i = k % chunk_size_;
+  snap = reinterpret_cast<const Snapshot *>(chunk + off_snap_ + i * sizeof(Snapshot));
+  UnpackUpper(Pp, snap->P_);
+  UnpackUpper(Pm, reinterpret_cast<const T *>(chunk + off_Pm_) + i * PACKED_SIZE<N>);
+  Phi = Eigen::Map<const Matrix>(reinterpret_cast<const T *>(chunk + off_Phi_) + i * N * N);
+  dz = Eigen::Map<const Vector>(reinterpret_cast<const T *>(chunk + off_dz_) + i * N);
+}
+
+// *=== Backward ===*
+template <class Filter>
+void RtsSmoother<Filter>::Backward(
+    const std::size_t &k0,
+    const std::size_t &k1,
+    Vector &dx,
+    Matrix &Ps,
+    Matrix *G,
+    Eigen::Ref<Eigen::VectorXd> t,
+    Eigen::Ref<RowMatrixXd> states,
+    Eigen::Ref<RowMatrixXd> cov_diag) const {
+  Filter scratch;
+  Eigen::LDLT<Matrix> ldlt;
+  const Snapshot *snap;
+  Matrix Pp, Pm, Phi, Pm_next, Phi_next, At;
+  Vector dz, dz_next;
+  Load(k1, snap, Pp, Pm_next, Phi_next, dz_next);
+  for (std::size_t k = k1; k-- > k0;) {
+    Load(k, snap, Pp, Pm, Phi, dz);
+
+    // A' = inv(P_k+1-) Phi_k+1 P_k+ (P- may be singular, LDLT zeroes its null space)
+    ldlt.compute(Pm_next);
+    At = ldlt.solve(Phi_next * Pp);
+    dz_next += dx;
+    dx.noalias() = At.transpose() * dz_next;
+    Ps -= Pm_next;
+    Pp.noalias() += At.transpose() * Ps * At;
+    Ps = Pp;
+    if (G) {
+      *G = At.transpose() * *G;
+    } else {
+      Output(k, dx, Ps, scratch, t, states, cov_diag);
+    }
+    Pm_next = Pm;
+    Phi_next = Phi;
+    dz_next = dz;
+  }
+}
+
+// *=== Output ===*
+template <class Filter>
+void RtsSmoother<Filter>::Output(
+    const std::size_t &k,
+    const Vector &dx,
+    const Matrix &Ps,
+    Filter &scratch,
+    Eigen::Ref<Eigen::VectorXd> t,
+    Eigen::Ref<RowMatrixXd> states,
+    Eigen::Ref<RowMatrixXd> cov_diag) const {
+  const std::uint8_t *chunk = Chunk(k / chunk_size_);
+  const std::size_t i = k % chunk_size_;
+  std::memcpy(&t(k), chunk + off_t_ + i * sizeof(double), sizeof(double));
+  scratch.RestoreSnapshot(
+      *reinterpret_cast<const Snapshot *>(chunk + off_snap_ + i * sizeof(Snapshot)));
+  scratch.CorrectState(dx);
+  scratch.GetStateVector(states.row(k).transpose());
+  cov_diag.row(k) = Ps.diagonal().transpose().template cast<double>();
+}
+
+template class RtsSmoother<InertialNav<float>>;
+template class RtsSmoother<InertialNav<double>>;
+template class RtsSmoother<KinematicNav<float>>;
+template class RtsSmoother<KinematicNav<double>>;
+template class RtsSmoother<PositionNav<float>>;
+template class RtsSmoother<PositionNav<double>>;
+
+}  // namespace sturdins
@@ -15,19 +15,26 @@
 
 #include <navtools/attitude.hpp>
 
+#include "sturdins/instrument.hpp"
+
 namespace sturdins {
 
 // *=== Strapdown ===*
-Strapdown::Strapdown()
-    : X1ME2_{1.0 - navtools::WGS84_E2<>},
-      g_{Eigen::Vector3d::Zero()},
-      w_en_n_{Eigen::Vector3d::Zero()},
-      w_ie_n_{Eigen::Vector3d::Zero()},
+template <typename T>
+Strapdown<T>::Strapdown()
+    : g_{Eigen::Vector3<T>::Zero()},
+      w_en_n_{Eigen::Vector3<T>::Zero()},
+      w_ie_n_{Eigen::Vector3<T>::Zero()},
       wR0sqRpMu_{
           navtools::WGS84_OMEGA<> * navtools::WGS84_OMEGA<> * navtools::WGS84_R0<> *
-          navtools::WGS84_R0<> * navtools::WGS84_RP<> / navtools::WGS84_MU<>} {
+          navtools::WGS84_R0<> * navtools::WGS84_RP<> / navtools::WGS84_MU<>},
+      dtheta_b_{Eigen::Vector3<T>::Zero()},
+      dv_b_{Eigen::Vector3<T>::Zero()},
+      dtheta_prev_{Eigen::Vector3<T>::Zero()},
+      dvel_prev_{Eigen::Vector3<T>::Zero()} {
 }
-Strapdown::Strapdown(
+template <typename T>
+Strapdown<T>::Strapdown(
     const double lat,
     const double lon,
     const double alt,
@@ -46,74 +53,175 @@ Strapdown::Strapdown(
   ve_ = vele;
   vd_ = veld;
   Eigen::Vector3d rpy{roll, pitch, yaw};
-  navtools::euler2quat<double>(q_b_l_, rpy, true);
-  navtools::quat2dcm<double>(C_b_l_, q_b_l_);
+  Eigen::Vector4d q;
+  navtools::euler2quat<double>(q, rpy, true);
+  q_b_l_ = q.template cast<T>();
+  navtools::quat2dcm<T>(C_b_l_, q_b_l_);
 }
 
 // *=== ~Strapdown ===*
-Strapdown::~Strapdown() {
+template <typename T>
+Strapdown<T>::~Strapdown() {
 }
 
 // *=== SetPosition ===*
-void Strapdown::SetPosition(const double &lat, const double &lon, const double &alt) {
+template <typename T>
+void Strapdown<T>::SetPosition(const double &lat, const double &lon, const double &alt) {
   phi_ = lat;
   lam_ = lon;
   h_ = alt;
 }
 
 // *=== SetVelocity ===*
-void Strapdown::SetVelocity(const double &veln, const double &vele, const double &veld) {
+template <typename T>
+void Strapdown<T>::SetVelocity(const double &veln, const double &vele, const double &veld) {
   vn_ = veln;
   ve_ = vele;
   vd_ = veld;
 }
 
 // *=== SetAttitude ===*
-void Strapdown::SetAttitude(const double &roll, const double &pitch, const double &yaw) {
+template <typename T>
+void Strapdown<T>::SetAttitude(const double &roll, const double &pitch, const double &yaw) {
   Eigen::Vector3d rpy{roll, pitch, yaw};
-  navtools::euler2quat<double>(q_b_l_, rpy, true);
-  navtools::quat2dcm<double>(C_b_l_, q_b_l_);
+  Eigen::Vector4d q;
+  navtools::euler2quat<double>(q, rpy, true);
+  q_b_l_ = q.template cast<T>();
+  navtools::quat2dcm<T>(C_b_l_, q_b_l_);
 }
-void Strapdown::SetAttitude(const Eigen::Ref<const Eigen::Matrix3d> &C) {
-  C_b_l_ = C;
-  navtools::dcm2quat<double>(q_b_l_, C_b_l_);
+template <typename T>
+void Strapdown<T>::SetAttitude(const Eigen::Ref<const Eigen::Matrix3d> &C) {
+  C_b_l_ = C.template cast<T>();
+  navtools::dcm2quat<T>(q_b_l_, C_b_l_);
 }
 
 // *=== Mechanize ===*
-void Strapdown::Mechanize(
-    const Eigen::Ref<const Eigen::Vector3d> &wb,
-    const Eigen::Ref<const Eigen::Vector3d> &fb,
+template <typename T>
+void Strapdown<T>::Mechanize(
+    const Eigen::Ref<const Eigen::Vector3<T>> &wb,
+    const Eigen::Ref<const Eigen::Vector3<T>> &fb,
+    const double &dt) {
+  STURDINS_STAGE_TIMER(Stage::MECHANIZE);
+  NavigationFrameTerms();
+
+  // --- Attitude Integration ---
+  Eigen::Vector3<T> dTheta = wb - C_b_l_.transpose() * (w_ie_n_ + w_en_n_);
+  dTheta *= static_cast<T>(dt);
+  IntegrateAttitude(dTheta);
+
+  // --- Velocity Integration ---
+  Eigen::Vector3<T> fn = C_b_l_ * fb;
+  Eigen::Vector3<T> wn = w_ie_n_ + 2.0 * w_en_n_;
+  double dv_n = (fn(0) + g_(0) - (wn(1) * vd_ - wn(2) * ve_)) * dt;
+  double dv_e = (fn(1) + g_(1) - (wn(0) * vd_ - wn(2) * vn_)) * dt;
+  double dv_d = (fn(2) + g_(2) - (wn(0) * ve_ - wn(1) * vn_)) * dt;
+
+  // --- Position Integration ---
+  phi_ += (vn_ + 0.5 * dv_n) / geo_.Hn_ * dt;
+  lam_ += (ve_ + 0.5 * dv_e) / (geo_.He_ * geo_.cL_) * dt;
+  h_ -= (vd_ + 0.5 * dv_d) * dt;
+
+  // Save integration result
+  navtools::quat2dcm<T>(C_b_l_, q_b_l_);
+  vn_ += dv_n;
+  ve_ += dv_e;
+  vd_ += dv_d;
+}
+
+// *=== MechanizeIncrements ===*
+template <typename T>
+void Strapdown<T>::MechanizeIncrements(
+    const Eigen::Ref<const Eigen::Matrix3X<T>> &dtheta,
+    const Eigen::Ref<const Eigen::Matrix3X<T>> &dvel,
     const double &dt) {
-  // Sine functions of latitude
-  sL_ = std::sin(phi_);
-  cL_ = std::cos(phi_);
-  tL_ = sL_ / cL_;
-  sLsq_ = sL_ * sL_;
-
-  // Radii of curvature
-  double t = 1.0 - navtools::WGS84_E2<> * sLsq_;
-  double sqt = std::sqrt(t);
-  Re_ = navtools::WGS84_R0<> / sqt;
-  Rn_ = navtools::WGS84_R0<> * X1ME2_ / (t * t / sqt);
-  He_ = Re_ + h_;
-  Hn_ = Rn_ + h_;
+  STURDINS_STAGE_TIMER(Stage::MECHANIZE);
+  const int N = dtheta.cols();
+  eigen_assert(dvel.cols() == N && "delta thetas and delta velocities must have the same size");
+  if (N == 0) {
+    return;
+  }
+  const double Tb = N * dt;
+
+  /**
+   * @brief Two sample recursive coning and sculling (Savage, Strapdown Analytics 7.1.1/7.2.2),
+   *        with alpha/nu the running sums of the delta thetas/velocities over the burst
+   *    beta_k  = beta_k-1  + 0.5 * (alpha_k-1 + dtheta_k-1 / 6) x dtheta_k
+   *    scul_k  = scul_k-1  + 0.5 * ((alpha_k-1 + dtheta_k-1 / 6) x dvel_k
+   *                                 + (nu_k-1 + dvel_k-1 / 6) x dtheta_k)
+   *    dtheta_b = alpha + beta
+   *    dv_b     = nu + 0.5 * alpha x nu + alpha x (alpha x nu) / 6 + scul
+   *        the alpha x (alpha x nu) term is the second order rotation compensation, without it the
+   *        vertical channel rectifies under sustained coning
+   */
+  Eigen::Vector3<T> alpha = Eigen::Vector3<T>::Zero();
+  Eigen::Vector3<T> nu = Eigen::Vector3<T>::Zero();
+  Eigen::Vector3<T> beta = Eigen::Vector3<T>::Zero();
+  Eigen::Vector3<T> scul = Eigen::Vector3<T>::Zero();
+  Eigen::Vector3<T> a, v;
+  for (int k = 0; k < N; k++) {
+    a = alpha + dtheta_prev_ / 6.0;
+    v = nu + dvel_prev_ / 6.0;
+    beta += 0.5 * a.cross(dtheta.col(k));
+    scul += 0.5 * (a.cross(dvel.col(k)) + v.cross(dtheta.col(k)));
+    alpha += dtheta.col(k);
+    nu += dvel.col(k);
+    dtheta_prev_ = dtheta.col(k);
+    dvel_prev_ = dvel.col(k);
+  }
+  dtheta_b_ = alpha + beta;
+  dv_b_ = nu + 0.5 * alpha.cross(nu) + alpha.cross(alpha.cross(nu)) / 6.0 + scul;
+
+  // navigation frame terms once per burst
+  NavigationFrameTerms();
+
+  // --- Attitude Integration ---
+  Eigen::Vector3<T> dTheta = dtheta_b_ - C_b_l_.transpose() * (w_ie_n_ + w_en_n_) * Tb;
+  IntegrateAttitude(dTheta);
+
+  // --- Velocity Integration ---
+  // navigation frame rotation over the burst, [I - 0.5 * zeta x] * C_b_l * dv_b
+  Eigen::Vector3<T> dvn = C_b_l_ * dv_b_;
+  dvn -= (0.5 * Tb) * (w_ie_n_ + w_en_n_).cross(dvn);
+  Eigen::Vector3<T> wn = w_ie_n_ + 2.0 * w_en_n_;
+  double dv_n = dvn(0) + (g_(0) - (wn(1) * vd_ - wn(2) * ve_)) * Tb;
+  double dv_e = dvn(1) + (g_(1) - (wn(0) * vd_ - wn(2) * vn_)) * Tb;
+  double dv_d = dvn(2) + (g_(2) - (wn(0) * ve_ - wn(1) * vn_)) * Tb;
+
+  // --- Position Integration ---
+  phi_ += (vn_ + 0.5 * dv_n) / geo_.Hn_ * Tb;
+  lam_ += (ve_ + 0.5 * dv_e) / (geo_.He_ * geo_.cL_) * Tb;
+  h_ -= (vd_ + 0.5 * dv_d) * Tb;
+
+  // Save integration result
+  navtools::quat2dcm<T>(C_b_l_, q_b_l_);
+  vn_ += dv_n;
+  ve_ += dv_e;
+  vd_ += dv_d;
+}
+
+// *=== NavigationFrameTerms ===*
+template <typename T>
+void Strapdown<T>::NavigationFrameTerms() {
+  // Functions of latitude and radii of curvature (only re-evaluated when the position moved)
+  geo_.Update(phi_, lam_, h_);
 
   // Gravity and coriolis
-  g0_ = 9.7803253359 * ((1.0 + 0.001931853 * sLsq_) / sqt);
   GravityVector();
   EarthRateVector();
   TransportRateVector();
+}
 
-  // --- Attitude Integration ---
-  Eigen::Vector3d dTheta = (wb - C_b_l_.transpose() * (w_ie_n_ + w_en_n_)) * dt;
-  double gamma = 0.5 * dTheta.norm();
-  double cgamma = std::cos(gamma);
+// *=== IntegrateAttitude ===*
+template <typename T>
+void Strapdown<T>::IntegrateAttitude(Eigen::Vector3<T> &dTheta) {
+  T gamma = 0.5 * dTheta.norm();
+  T cgamma = std::cos(gamma);
   if (gamma < 1e-5) {
     dTheta *= 0.5;
   } else {
     dTheta *= (0.5 * std::sin(gamma) / gamma);
   }
-  Eigen::Matrix4d qdot{
+  Eigen::Matrix4<T> qdot{
       // clang-format off
       {   cgamma, -dTheta(0), -dTheta(1), -dTheta(2)},
       {dTheta(0),     cgamma,  dTheta(2), -dTheta(1)},
@@ -123,50 +231,38 @@ void Strapdown::Mechanize(
   };
   q_b_l_ = qdot * q_b_l_;
   q_b_l_ /= q_b_l_.norm();
-
-  // --- Velocity Integration ---
-  Eigen::Vector3d fn = C_b_l_ * fb;
-  Eigen::Vector3d wn = w_ie_n_ + 2.0 * w_en_n_;
-  double dv_n = (fn(0) + g_(0) - (wn(1) * vd_ - wn(2) * ve_)) * dt;
-  double dv_e = (fn(1) + g_(1) - (wn(0) * vd_ - wn(2) * vn_)) * dt;
-  double dv_d = (fn(2) + g_(2) - (wn(0) * ve_ - wn(1) * vn_)) * dt;
-
-  // --- Position Integration ---
-  phi_ += (vn_ + 0.5 * dv_n) / Hn_ * dt;
-  lam_ += (ve_ + 0.5 * dv_e) / (He_ * cL_) * dt;
-  h_ -= (vd_ + 0.5 * dv_d) * dt;
-
-  // Save integration result
-  navtools::quat2dcm<double>(C_b_l_, q_b_l_);
-  vn_ += dv_n;
-  ve_ += dv_e;
-  vd_ += dv_d;
 }
 
 // *=== GravityVector ===*
-void Strapdown::GravityVector() {
+template <typename T>
+void Strapdown<T>::GravityVector() {
   double hR0sq = h_ / navtools::WGS84_R0<>;
   hR0sq *= hR0sq;
   g_(0) = -8.08e-9 * h_ * std::sin(2.0 * phi_);
   // g_(1) = 0.0;
-  g_(2) = g0_ * (1.0 -
+  g_(2) = geo_.g0_ * (1.0 -
                  (2.0 * h_ / navtools::WGS84_R0<>)*(
-                     1.0 + navtools::WGS84_F<> * (1.0 - 2.0 * sLsq_) + wR0sqRpMu_) +
+                     1.0 + navtools::WGS84_F<> * (1.0 - 2.0 * geo_.sLsq_) + wR0sqRpMu_) +
                  3.0 * hR0sq);
 }
 
 // *=== EarthRateVector ===*
-void Strapdown::EarthRateVector() {
-  w_ie_n_(0) = navtools::WGS84_OMEGA<> * cL_;
+template <typename T>
+void Strapdown<T>::EarthRateVector() {
+  w_ie_n_(0) = navtools::WGS84_OMEGA<> * geo_.cL_;
   // w_ie_n_(1) = 0.0;
-  w_ie_n_(2) = navtools::WGS84_OMEGA<> * sL_;
+  w_ie_n_(2) = navtools::WGS84_OMEGA<> * geo_.sL_;
 }
 
 // *=== TransportRateVector ===*
-void Strapdown::TransportRateVector() {
-  w_en_n_(0) = ve_ / He_;
-  w_en_n_(1) = -vn_ / Hn_;
-  w_en_n_(2) = -w_en_n_(0) * tL_;
+template <typename T>
+void Strapdown<T>::TransportRateVector() {
+  w_en_n_(0) = ve_ / geo_.He_;
+  w_en_n_(1) = -vn_ / geo_.Hn_;
+  w_en_n_(2) = -w_en_n_(0) * geo_.tL_;
 }
 
+template class Strapdown<float>;
+template class Strapdown<double>;
+
 }  // namespace sturdins
\ No newline at end of file
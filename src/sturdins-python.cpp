@@ -9,18 +9,44 @@
  */
 
 #include <pybind11/eigen.h>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
-
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "sturdins/batch-run.hpp"
+#include "sturdins/fusion-engine.hpp"
 #include "sturdins/inertial-nav.hpp"
+#include "sturdins/instrument.hpp"
+#include "sturdins/kalman-update.hpp"
 #include "sturdins/kinematic-nav.hpp"
 #include "sturdins/least-squares.hpp"
 #include "sturdins/nav-clock.hpp"
 #include "sturdins/nav-imu.hpp"
+#include "sturdins/nav-snapshot.hpp"
+#include "sturdins/process-noise.hpp"
+#include "sturdins/rts-smoother.hpp"
 #include "sturdins/strapdown.hpp"
 
 namespace py = pybind11;
 using namespace sturdins;
 
+/**
+ * @brief Eigen members are exposed as writable NumPy views of the C++ storage instead of copies,
+ *        pybind11 (reference_internal) keeps the owning object alive for as long as a view exists
+ */
+template <typename C, typename B, typename D>
+auto EigenView(D B::*pm) {
+  return [pm](C &self) -> D & { return self.*pm; };
+}
+template <typename C, typename B, typename D>
+auto EigenAssign(D B::*pm) {
+  return [pm](C &self, const D &value) { self.*pm = value; };
+}
+
 PYBIND11_MODULE(_sturdins_core, h) {
   h.doc() = R"pbdoc(
     SturdINS
@@ -30,9 +56,17 @@ PYBIND11_MODULE(_sturdins_core, h) {
     
     Contains the following classes:
     
-    1. `InertialNav`
-    2. `KinematicNav`
-    3. `Strapdown`
+    1. `FusionEngine`
+    2. `InertialNav`
+    3. `InertialNavSmoother`
+    4. `InertialNavSnapshot`
+    5. `KinematicNav`
+    6. `KinematicNavSmoother`
+    7. `KinematicNavSnapshot`
+    8. `Stage`
+    9. `StageCounters`
+    10. `Strapdown`
+    11. `UpdateStrategy`
 
     Contains the following modules:
 
@@ -42,8 +76,81 @@ PYBIND11_MODULE(_sturdins_core, h) {
     )pbdoc";
   h.attr("__version__") = "1.0.0";
 
+  // UpdateStrategy
+  py::enum_<UpdateStrategy>(h, "UpdateStrategy")
+      .value("BATCH", UpdateStrategy::BATCH)
+      .value("SEQUENTIAL", UpdateStrategy::SEQUENTIAL)
+      .doc() = R"pbdoc(
+               UpdateStrategy
+               ===
+
+               Measurement update strategy of the navigation filters.
+               )pbdoc";
+
+  // Stage
+  py::enum_<Stage>(h, "Stage")
+      .value("MECHANIZE", Stage::MECHANIZE)
+      .value("PROPAGATE", Stage::PROPAGATE)
+      .value("MEASUREMENT_MODEL", Stage::MEASUREMENT_MODEL)
+      .value("KALMAN_UPDATE", Stage::KALMAN_UPDATE)
+      .value("GNSS_PVT_ITERATION", Stage::GNSS_PVT_ITERATION)
+      .value("MUSIC_LEVEL", Stage::MUSIC_LEVEL)
+      .doc() = R"pbdoc(
+               Stage
+               =====
+
+               Instrumented stages of the library.
+               )pbdoc";
+
+  // StageCounters
+  py::class_<StageCounters>(h, "StageCounters")
+      .def_readonly("calls_", &StageCounters::calls_)
+      .def_readonly("nanoseconds_", &StageCounters::nanoseconds_)
+      .doc() = R"pbdoc(
+               StageCounters
+               =============
+
+               Totals of a stage over all threads since the last ResetStageCounters.
+               )pbdoc";
+
+  h.attr("INSTRUMENTATION_ENABLED") = INSTRUMENTATION_ENABLED;
+  h.def(
+      "GetStageCounters",
+      &GetStageCounters,
+      py::arg("stage"),
+      R"pbdoc(
+      GetStageCounters
+      ================
+
+      Totals of a stage over all threads, always zero unless the library was built with
+      STURDINS_INSTRUMENT
+
+      Parameters
+      ----------
+
+      stage : Stage
+
+          Instrumented stage
+
+      Returns
+      -------
+
+      counters : StageCounters
+
+          Call count and time [ns] of the stage
+      )pbdoc");
+  h.def(
+      "ResetStageCounters",
+      &ResetStageCounters,
+      R"pbdoc(
+      ResetStageCounters
+      ==================
+
+      Restart the totals of every stage from zero
+      )pbdoc");
+
   // Strapdown
-  py::class_<Strapdown>(h, "Strapdown")
+  py::class_<Strapdown<>>(h, "Strapdown")
       .def(py::init<>())
       .def(
           py::init<
@@ -67,7 +174,7 @@ PYBIND11_MODULE(_sturdins_core, h) {
           py::arg("y"))
       .def(
           "SetPosition",
-          &Strapdown::SetPosition,
+          &Strapdown<>::SetPosition,
           py::arg("lat"),
           py::arg("lon"),
           py::arg("alt"),
@@ -94,7 +201,7 @@ PYBIND11_MODULE(_sturdins_core, h) {
           )pbdoc")
       .def(
           "SetVelocity",
-          &Strapdown::SetVelocity,
+          &Strapdown<>::SetVelocity,
           py::arg("vn"),
           py::arg("ve"),
           py::arg("vd"),
@@ -121,7 +228,7 @@ PYBIND11_MODULE(_sturdins_core, h) {
           )pbdoc")
       .def(
           "SetAttitude",
-          py::overload_cast<const Eigen::Ref<const Eigen::Matrix3d> &>(&Strapdown::SetAttitude),
+          py::overload_cast<const Eigen::Ref<const Eigen::Matrix3d> &>(&Strapdown<>::SetAttitude),
           py::arg("C"),
           R"pbdoc(
           SetAttitude
@@ -139,7 +246,7 @@ PYBIND11_MODULE(_sturdins_core, h) {
       .def(
           "SetAttitude",
           py::overload_cast<const double &, const double &, const double &>(
-              &Strapdown::SetAttitude),
+              &Strapdown<>::SetAttitude),
           py::arg("r"),
           py::arg("p"),
           py::arg("y"),
@@ -166,7 +273,7 @@ PYBIND11_MODULE(_sturdins_core, h) {
           )pbdoc")
       .def(
           "Mechanize",
-          &Strapdown::Mechanize,
+          &Strapdown<>::Mechanize,
           py::arg("w_ib_b"),
           py::arg("f_ib_b"),
           py::arg("dt"),
@@ -191,14 +298,48 @@ PYBIND11_MODULE(_sturdins_core, h) {
           
               Integration time [s]
           )pbdoc")
-      .def_readwrite("phi_", &Strapdown::phi_)
-      .def_readwrite("lam_", &Strapdown::lam_)
-      .def_readwrite("h_", &Strapdown::h_)
-      .def_readwrite("vn_", &Strapdown::vn_)
-      .def_readwrite("ve_", &Strapdown::ve_)
-      .def_readwrite("vd_", &Strapdown::vd_)
-      .def_readwrite("q_b_l_", &Strapdown::q_b_l_)
-      .def_readwrite("C_b_l_", &Strapdown::C_b_l_)
+      .def(
+          "MechanizeIncrements",
+          &Strapdown<>::MechanizeIncrements,
+          py::arg("dtheta"),
+          py::arg("dvel"),
+          py::arg("dt"),
+          R"pbdoc(
+          MechanizeIncrements
+          ===================
+
+          Integrate a burst of high rate IMU increments as a single navigation update with coning
+          and sculling corrections, the navigation frame terms are evaluated once per burst
+
+          Parameters
+          ----------
+
+          dtheta : np.ndarray
+
+              Delta thetas in the body frame, one IMU sample per column (3xN) [rad]
+
+          dvel : np.ndarray
+
+              Delta velocities in the body frame, one IMU sample per column (3xN) [m/s]
+
+          dt : double
+
+              IMU sample interval [s]
+          )pbdoc")
+      .def_readwrite("phi_", &Strapdown<>::phi_)
+      .def_readwrite("lam_", &Strapdown<>::lam_)
+      .def_readwrite("h_", &Strapdown<>::h_)
+      .def_readwrite("vn_", &Strapdown<>::vn_)
+      .def_readwrite("ve_", &Strapdown<>::ve_)
+      .def_readwrite("vd_", &Strapdown<>::vd_)
+      .def_property(
+          "q_b_l_",
+          EigenView<Strapdown<>>(&Strapdown<>::q_b_l_),
+          EigenAssign<Strapdown<>>(&Strapdown<>::q_b_l_))
+      .def_property(
+          "C_b_l_",
+          EigenView<Strapdown<>>(&Strapdown<>::C_b_l_),
+          EigenAssign<Strapdown<>>(&Strapdown<>::C_b_l_))
       .doc() = R"pbdoc(
                Strapdown
                ========= 
@@ -206,8 +347,102 @@ PYBIND11_MODULE(_sturdins_core, h) {
                Inertial navigation strapdown integration equations.
                )pbdoc";
 
+  // InertialNavSnapshot
+  py::class_<InertialNavSnapshot<>>(h, "InertialNavSnapshot")
+      .def(py::init<>())
+      .def(
+          "ToBytes",
+          [](const InertialNavSnapshot<> &self) {
+            std::string bytes(sizeof(self), '\0');
+            SerializeSnapshot(reinterpret_cast<std::uint8_t *>(bytes.data()), bytes.size(), self);
+            return py::bytes(bytes);
+          },
+          R"pbdoc(
+          ToBytes
+          =======
+
+          Serialize the snapshot (native byte order)
+          )pbdoc")
+      .def(
+          "FromBytes",
+          [](InertialNavSnapshot<> &self, const py::bytes &b) {
+            std::string_view bytes(b);
+            if (!DeserializeSnapshot(
+                    self, reinterpret_cast<const std::uint8_t *>(bytes.data()), bytes.size())) {
+              throw std::invalid_argument("bytes are not a InertialNavSnapshot");
+            }
+          },
+          py::arg("b"),
+          R"pbdoc(
+          FromBytes
+          =========
+
+          Set the snapshot from bytes written by ToBytes
+
+          Parameters
+          ----------
+
+          b : bytes
+
+              Serialized snapshot
+          )pbdoc")
+      .def_readonly("is_init_", &InertialNavSnapshot<>::is_init_)
+      .doc() = R"pbdoc(
+               InertialNavSnapshot
+               ===
+
+               Fixed-size snapshot of the InertialNav states, clock and covariance.
+               )pbdoc";
+
+  // KinematicNavSnapshot
+  py::class_<KinematicNavSnapshot<>>(h, "KinematicNavSnapshot")
+      .def(py::init<>())
+      .def(
+          "ToBytes",
+          [](const KinematicNavSnapshot<> &self) {
+            std::string bytes(sizeof(self), '\0');
+            SerializeSnapshot(reinterpret_cast<std::uint8_t *>(bytes.data()), bytes.size(), self);
+            return py::bytes(bytes);
+          },
+          R"pbdoc(
+          ToBytes
+          =======
+
+          Serialize the snapshot (native byte order)
+          )pbdoc")
+      .def(
+          "FromBytes",
+          [](KinematicNavSnapshot<> &self, const py::bytes &b) {
+            std::string_view bytes(b);
+            if (!DeserializeSnapshot(
+                    self, reinterpret_cast<const std::uint8_t *>(bytes.data()), bytes.size())) {
+              throw std::invalid_argument("bytes are not a KinematicNavSnapshot");
+            }
+          },
+          py::arg("b"),
+          R"pbdoc(
+          FromBytes
+          =========
+
+          Set the snapshot from bytes written by ToBytes
+
+          Parameters
+          ----------
+
+          b : bytes
+
+              Serialized snapshot
+          )pbdoc")
+      .def_readonly("is_init_", &KinematicNavSnapshot<>::is_init_)
+      .doc() = R"pbdoc(
+               KinematicNavSnapshot
+               ===
+
+               Fixed-size snapshot of the KinematicNav states, clock and covariance.
+               )pbdoc";
+
   // InertialNav
-  py::class_<InertialNav>(h, "InertialNav")
+  py::class_<InertialNav<>>(h, "InertialNav")
       .def(py::init<>())
       .def(
           py::init<
@@ -235,7 +470,7 @@ PYBIND11_MODULE(_sturdins_core, h) {
           py::arg("cd"))
       .def(
           "SetImuSpec",
-          &InertialNav::SetImuSpec,
+          &InertialNav<>::SetImuSpec,
           py::arg("Ba"),
           py::arg("Na"),
           py::arg("Bg"),
@@ -267,7 +502,7 @@ PYBIND11_MODULE(_sturdins_core, h) {
           )pbdoc")
       .def(
           "SetClockSpec",
-          &InertialNav::SetClockSpec,
+          &InertialNav<>::SetClockSpec,
           py::arg("h0"),
           py::arg("h1"),
           py::arg("h2"),
@@ -292,9 +527,47 @@ PYBIND11_MODULE(_sturdins_core, h) {
           
               random walk frequency modulation
           )pbdoc")
+      .def(
+          "SetProcessNoiseModel",
+          [](InertialNav<> &self, const std::shared_ptr<ProcessNoiseModel> &model) {
+            self.SetProcessNoiseModel(model);
+          },
+          py::arg("model"),
+          R"pbdoc(
+          SetProcessNoiseModel
+          ====================
+
+          Use a (shared) process noise model instead of the one built by SetImuSpec and
+          SetClockSpec (the KinematicNav parameters of the model are unused)
+
+          Parameters
+          ----------
+
+          model : ProcessNoiseModel
+
+              Process noise model
+          )pbdoc")
+      .def(
+          "GetProcessNoiseModel",
+          [](const InertialNav<> &self) {
+            return std::const_pointer_cast<ProcessNoiseModel>(self.GetProcessNoiseModel());
+          },
+          R"pbdoc(
+          GetProcessNoiseModel
+          ====================
+
+          Process noise model used by the filter
+
+          Returns
+          -------
+
+          model : ProcessNoiseModel
+
+              Process noise model
+          )pbdoc")
       .def(
           "SetClock",
-          &InertialNav::SetClock,
+          &InertialNav<>::SetClock,
           py::arg("cb"),
           py::arg("cd"),
           R"pbdoc(
@@ -314,9 +587,90 @@ PYBIND11_MODULE(_sturdins_core, h) {
           
               Clock drift [m/s]
           )pbdoc")
+      .def(
+          "SetInnovationGate",
+          &InertialNav<>::SetInnovationGate,
+          py::arg("gate"),
+          R"pbdoc(
+          SetInnovationGate
+          =================
+
+          Reject measurements whose normalized innovation exceeds the gate, the rejected
+          measurements of the most recent update are listed in rejected_
+
+          Parameters
+          ----------
+
+          gate : double
+
+              Innovation gate [sigma] (0 disables gating, default)
+          )pbdoc")
+      .def(
+          "SetUpdateStrategy",
+          &InertialNav<>::SetUpdateStrategy,
+          py::arg("strategy"),
+          R"pbdoc(
+          SetUpdateStrategy
+          =================
+          
+          Choose between batch and sequential (scalar) measurement updates
+          
+          Parameters
+          ----------
+          
+          strategy : UpdateStrategy
+          
+              UpdateStrategy.BATCH (default) or UpdateStrategy.SEQUENTIAL
+          )pbdoc")
+      .def(
+          "SetSquareRoot",
+          &InertialNav<>::SetSquareRoot,
+          py::arg("sqrt_form"),
+          R"pbdoc(
+          SetSquareRoot
+          =============
+
+          Carry a square root of the covariance (P_ = S*S') with QR propagation and Potter's
+          measurement update, the current P_ is factored when enabled and no settling iterations
+          are run
+
+          Parameters
+          ----------
+
+          sqrt_form : bool
+
+              True to use the square root covariance form
+          )pbdoc")
+      .def(
+          "SetPropagationInterval",
+          &InertialNav<>::SetPropagationInterval,
+          py::arg("n"),
+          R"pbdoc(
+          SetPropagationInterval
+          ======================
+          
+          Propagate the covariance once every n calls to Propagate, the transition and process
+          noise are accumulated in between (updates always apply pending propagation first)
+          
+          Parameters
+          ----------
+          
+          n : int
+          
+              Number of Propagate calls per covariance propagation (1 propagates every call)
+          )pbdoc")
+      .def(
+          "FlushPropagation",
+          &InertialNav<>::FlushPropagation,
+          R"pbdoc(
+          FlushPropagation
+          ================
+          
+          Apply the accumulated covariance propagation so P_ is current
+          )pbdoc")
       .def(
           "SetPosition",
-          &InertialNav::SetPosition,
+          &InertialNav<>::SetPosition,
           py::arg("lat"),
           py::arg("lon"),
           py::arg("alt"),
@@ -343,7 +697,7 @@ PYBIND11_MODULE(_sturdins_core, h) {
           )pbdoc")
       .def(
           "SetVelocity",
-          &InertialNav::SetVelocity,
+          &InertialNav<>::SetVelocity,
           py::arg("vn"),
           py::arg("ve"),
           py::arg("vd"),
@@ -370,7 +724,7 @@ PYBIND11_MODULE(_sturdins_core, h) {
           )pbdoc")
       .def(
           "SetAttitude",
-          py::overload_cast<const Eigen::Ref<const Eigen::Matrix3d> &>(&InertialNav::SetAttitude),
+          py::overload_cast<const Eigen::Ref<const Eigen::Matrix3d> &>(&InertialNav<>::SetAttitude),
           py::arg("C"),
           R"pbdoc(
           SetAttitude
@@ -388,7 +742,7 @@ PYBIND11_MODULE(_sturdins_core, h) {
       .def(
           "SetAttitude",
           py::overload_cast<const double &, const double &, const double &>(
-              &InertialNav::SetAttitude),
+              &InertialNav<>::SetAttitude),
           py::arg("r"),
           py::arg("p"),
           py::arg("y"),
@@ -415,7 +769,7 @@ PYBIND11_MODULE(_sturdins_core, h) {
           )pbdoc")
       .def(
           "Mechanize",
-          &InertialNav::Mechanize,
+          &InertialNav<>::Mechanize,
           py::arg("w_ib_b"),
           py::arg("f_ib_b"),
           py::arg("dt"),
@@ -442,7 +796,7 @@ PYBIND11_MODULE(_sturdins_core, h) {
           )pbdoc")
       .def(
           "Propagate",
-          &InertialNav::Propagate,
+          &InertialNav<>::Propagate,
           py::arg("w_ib_b"),
           py::arg("f_ib_b"),
           py::arg("dt"),
@@ -467,9 +821,65 @@ PYBIND11_MODULE(_sturdins_core, h) {
           
               Integration time [s]
           )pbdoc")
+      .def(
+          "MechanizeIncrements",
+          &InertialNav<>::MechanizeIncrements,
+          py::arg("dtheta"),
+          py::arg("dvel"),
+          py::arg("dt"),
+          R"pbdoc(
+          MechanizeIncrements
+          ===================
+
+          Integrate a burst of high rate IMU increments as a single navigation update with coning
+          and sculling corrections, the navigation frame terms are evaluated once per burst
+
+          Parameters
+          ----------
+
+          dtheta : np.ndarray
+
+              Delta thetas in the body frame, one IMU sample per column (3xN) [rad]
+
+          dvel : np.ndarray
+
+              Delta velocities in the body frame, one IMU sample per column (3xN) [m/s]
+
+          dt : double
+
+              IMU sample interval [s]
+          )pbdoc")
+      .def(
+          "PropagateIncrements",
+          &InertialNav<>::PropagateIncrements,
+          py::arg("dtheta"),
+          py::arg("dvel"),
+          py::arg("dt"),
+          R"pbdoc(
+          PropagateIncrements
+          ===================
+
+          MechanizeIncrements followed by Propagate over the whole burst with its coning and
+          sculling compensated mean angular rate and specific force
+
+          Parameters
+          ----------
+
+          dtheta : np.ndarray
+
+              Delta thetas in the body frame, one IMU sample per column (3xN) [rad]
+
+          dvel : np.ndarray
+
+              Delta velocities in the body frame, one IMU sample per column (3xN) [m/s]
+
+          dt : double
+
+              IMU sample interval [s]
+          )pbdoc")
       .def(
           "GnssUpdate",
-          &InertialNav::GnssUpdate,
+          &InertialNav<>::GnssUpdate,
           py::arg("sv_pos"),
           py::arg("sv_vel"),
           py::arg("psr"),
@@ -511,7 +921,7 @@ PYBIND11_MODULE(_sturdins_core, h) {
           )pbdoc")
       .def(
           "PhasedArrayUpdate",
-          &InertialNav::PhasedArrayUpdate,
+          &InertialNav<>::PhasedArrayUpdate,
           py::arg("sv_pos"),
           py::arg("sv_vel"),
           py::arg("psr"),
@@ -576,96 +986,310 @@ PYBIND11_MODULE(_sturdins_core, h) {
 
               Wavelength for the signal of interest [m/rad]
           )pbdoc")
-      .def_readwrite("phi_", &InertialNav::phi_)
-      .def_readwrite("lam_", &InertialNav::lam_)
-      .def_readwrite("h_", &InertialNav::h_)
-      .def_readwrite("vn_", &InertialNav::vn_)
-      .def_readwrite("ve_", &InertialNav::ve_)
-      .def_readwrite("vd_", &InertialNav::vd_)
-      .def_readwrite("q_b_l_", &InertialNav::q_b_l_)
-      .def_readwrite("C_b_l_", &InertialNav::C_b_l_)
-      .def_readwrite("bg_", &InertialNav::bg_)
-      .def_readwrite("ba_", &InertialNav::ba_)
-      .def_readwrite("cb_", &InertialNav::cb_)
-      .def_readwrite("cd_", &InertialNav::cd_)
-      .def_readwrite("P_", &InertialNav::P_)
-      .doc() = R"pbdoc(
-               InertialNav
-               ===
-
-               Inertial navigation Kalman Filter equations.
-               )pbdoc";
-
-  // KinematicNav
-  py::class_<KinematicNav>(h, "KinematicNav")
-      .def(py::init<>())
-      .def(
-          py::init<
-              const double,
-              const double,
-              const double,
-              const double,
-              const double,
-              const double,
-              const double,
-              const double>(),
-          py::arg("lat"),
-          py::arg("lon"),
-          py::arg("alt"),
-          py::arg("vn"),
-          py::arg("ve"),
-          py::arg("vd"),
-          py::arg("cb"),
-          py::arg("cd"))
-      .def(
-          py::init<
-              const double,
-              const double,
-              const double,
-              const double,
-              const double,
-              const double,
-              const double,
-              const double,
-              const double,
-              const double,
-              const double>(),
-          py::arg("lat"),
-          py::arg("lon"),
-          py::arg("alt"),
-          py::arg("vn"),
-          py::arg("ve"),
-          py::arg("vd"),
-          py::arg("r"),
-          py::arg("p"),
-          py::arg("y"),
-          py::arg("cb"),
-          py::arg("cd"))
       .def(
-          "SetProcessNoise",
-          &KinematicNav::SetProcessNoise,
-          py::arg("Svel"),
-          py::arg("Satt"),
+          "AttitudeUpdate",
+          &InertialNav<>::AttitudeUpdate,
+          py::arg("C"),
+          py::arg("R"),
           R"pbdoc(
-          SetProcessNoise
-          ===============
-          
-          Set the noise parameters of the KinematicNav (constant velocity) model
-          
+          AttitudeUpdate
+          ==============
+
+          Update the navigator attitude with an attitude measurement
+
           Parameters
           ----------
-          
-          Svel : double
-          
-              PSD of expected acceleration white noise [(m/s^2)^2]
-          
-          Satt : double
-          
-              PSD of expected angular rate white noise [(rad/s)^2]
+
+          C : np.ndarray
+
+              Measured body-to-ned rotation matrix
+
+          R : np.ndarray
+
+              Attitude error covariance (small angles about the ned axes) [rad^2]
           )pbdoc")
       .def(
-          "SetClockSpec",
-          &KinematicNav::SetClockSpec,
+          "Run",
+          [](InertialNav<> &self,
+             const Eigen::Ref<const Eigen::VectorXd> &imu_t,
+             const Eigen::Ref<const RowMatrixX3d> &imu_wb,
+             const Eigen::Ref<const RowMatrixX3d> &imu_fb,
+             const Eigen::Ref<const Eigen::VectorXd> &gnss_t,
+             const Eigen::Ref<const Eigen::VectorXi> &offsets,
+             const Eigen::Ref<const RowMatrixX3d> &sv_pos,
+             const Eigen::Ref<const RowMatrixX3d> &sv_vel,
+             const Eigen::Ref<const Eigen::VectorXd> &psr,
+             const Eigen::Ref<const Eigen::VectorXd> &psrdot,
+             const Eigen::Ref<const Eigen::VectorXd> &psrvar,
+             const Eigen::Ref<const Eigen::VectorXd> &psrdotvar) {
+            if (offsets.size() != gnss_t.size() + 1) {
+              throw std::invalid_argument("offsets must have len(gnss_t) + 1 entries");
+            }
+            if (offsets.size() > 0 && offsets(offsets.size() - 1) > sv_pos.rows()) {
+              throw std::invalid_argument("offsets exceed the number of measurement rows");
+            }
+            const py::ssize_t N = imu_t.size();
+            py::array_t<double> states({N, static_cast<py::ssize_t>(INS_BATCH_STATES)});
+            py::array_t<double> cov_diag({N, static_cast<py::ssize_t>(17)});
+            Eigen::Map<RowMatrixXd> states_map(states.mutable_data(), N, INS_BATCH_STATES);
+            Eigen::Map<RowMatrixXd> cov_map(cov_diag.mutable_data(), N, 17);
+            {
+              py::gil_scoped_release release;
+              RunInertialNav(
+                  self, imu_t, imu_wb, imu_fb, gnss_t, offsets, sv_pos, sv_vel, psr, psrdot,
+                  psrvar, psrdotvar, states_map, cov_map);
+            }
+            return py::make_tuple(states, cov_diag);
+          },
+          py::arg("imu_t"),
+          py::arg("imu_wb"),
+          py::arg("imu_fb"),
+          py::arg("gnss_t"),
+          py::arg("offsets"),
+          py::arg("sv_pos"),
+          py::arg("sv_vel"),
+          py::arg("psr"),
+          py::arg("psrdot"),
+          py::arg("psrvar"),
+          py::arg("psrdotvar"),
+          R"pbdoc(
+          Run
+          ===
+
+          Process an entire IMU/GNSS log natively (the GIL is released). Every IMU sample is
+          mechanized and propagated, GNSS epochs are applied after the first IMU sample at or past
+          their time.
+
+          Parameters
+          ----------
+
+          imu_t : np.ndarray
+
+              IMU sample times [s]
+
+          imu_wb : np.ndarray
+
+              IMU angular rates, one sample per row [rad/s]
+
+          imu_fb : np.ndarray
+
+              IMU specific forces, one sample per row [m/s^2]
+
+          gnss_t : np.ndarray
+
+              GNSS epoch times [s]
+
+          offsets : np.ndarray
+
+              First measurement row of each epoch (len(gnss_t) + 1 entries)
+
+          sv_pos : np.ndarray
+
+              Satellite ECEF positions of all epochs, one satellite per row [m]
+
+          sv_vel : np.ndarray
+
+              Satellite ECEF velocities of all epochs, one satellite per row [m/s]
+
+          psr : np.ndarray
+
+              Pseudorange measurements of all epochs [m]
+
+          psrdot : np.ndarray
+
+              Pseudorange-rate measurements of all epochs [m/s]
+
+          psrvar : np.ndarray
+
+              Pseudorange measurement variance of all epochs [m^2]
+
+          psrdotvar : np.ndarray
+
+              Pseudorange-rate measurement variance of all epochs [(m/s)^2]
+
+          Returns
+          -------
+
+          states : np.ndarray
+
+              States per IMU sample (lat, lon, alt, vn, ve, vd, q0, q1, q2, q3, bgx, bgy, bgz,
+              bax, bay, baz, cb, cd)
+
+          cov_diag : np.ndarray
+
+              Error state covariance diagonal per IMU sample
+          )pbdoc")
+      .def(
+          "SaveSnapshot",
+          &InertialNav<>::SaveSnapshot,
+          py::arg("snap"),
+          R"pbdoc(
+          SaveSnapshot
+          ============
+
+          Copy the navigation states, clock and covariance into a snapshot
+
+          Parameters
+          ----------
+
+          snap : InertialNavSnapshot
+
+              Output snapshot
+          )pbdoc")
+      .def(
+          "RestoreSnapshot",
+          &InertialNav<>::RestoreSnapshot,
+          py::arg("snap"),
+          R"pbdoc(
+          RestoreSnapshot
+          ===============
+
+          Set the navigation states, clock and covariance from a snapshot
+
+          Parameters
+          ----------
+
+          snap : InertialNavSnapshot
+
+              Snapshot from SaveSnapshot
+          )pbdoc")
+      .def(
+          "GetStateVector",
+          [](const InertialNav<> &self, Eigen::Ref<Eigen::VectorXd> x) {
+            if (x.size() != InertialNav<>::STATE_SIZE) {
+              throw std::invalid_argument("state buffer has the wrong size");
+            }
+            self.GetStateVector(x);
+          },
+          py::arg("x"),
+          R"pbdoc(
+          GetStateVector
+          ==============
+
+          Copy the navigation states into a caller-provided buffer (does not allocate)
+
+          Parameters
+          ----------
+
+          x : np.ndarray
+
+              Writable, contiguous float64 buffer of 18 elements, filled with
+              [lat, lon, alt, vn, ve, vd, q0, q1, q2, q3, bgx, bgy, bgz, bax, bay, baz, cb, cd]
+          )pbdoc")
+      .def_readwrite("phi_", &InertialNav<>::phi_)
+      .def_readwrite("lam_", &InertialNav<>::lam_)
+      .def_readwrite("h_", &InertialNav<>::h_)
+      .def_readwrite("vn_", &InertialNav<>::vn_)
+      .def_readwrite("ve_", &InertialNav<>::ve_)
+      .def_readwrite("vd_", &InertialNav<>::vd_)
+      .def_property(
+          "q_b_l_",
+          EigenView<InertialNav<>>(&InertialNav<>::q_b_l_),
+          EigenAssign<InertialNav<>>(&InertialNav<>::q_b_l_))
+      .def_property(
+          "C_b_l_",
+          EigenView<InertialNav<>>(&InertialNav<>::C_b_l_),
+          EigenAssign<InertialNav<>>(&InertialNav<>::C_b_l_))
+      .def_property(
+          "bg_",
+          EigenView<InertialNav<>>(&InertialNav<>::bg_),
+          EigenAssign<InertialNav<>>(&InertialNav<>::bg_))
+      .def_property(
+          "ba_",
+          EigenView<InertialNav<>>(&InertialNav<>::ba_),
+          EigenAssign<InertialNav<>>(&InertialNav<>::ba_))
+      .def_readwrite("cb_", &InertialNav<>::cb_)
+      .def_readwrite("cd_", &InertialNav<>::cd_)
+      .def_property(
+          "ecef_p_",
+          EigenView<InertialNav<>>(&InertialNav<>::ecef_p_),
+          EigenAssign<InertialNav<>>(&InertialNav<>::ecef_p_))
+      .def_property(
+          "ecef_v_",
+          EigenView<InertialNav<>>(&InertialNav<>::ecef_v_),
+          EigenAssign<InertialNav<>>(&InertialNav<>::ecef_v_))
+      .def_property(
+          "P_",
+          EigenView<InertialNav<>>(&InertialNav<>::P_),
+          EigenAssign<InertialNav<>>(&InertialNav<>::P_))
+      .def_readonly("rejected_", &InertialNav<>::rejected_)
+      .doc() = R"pbdoc(
+               InertialNav
+               ===
+
+               Inertial navigation Kalman Filter equations.
+               )pbdoc";
+
+  // KinematicNav
+  py::class_<KinematicNav<>>(h, "KinematicNav")
+      .def(py::init<>())
+      .def(
+          py::init<
+              const double,
+              const double,
+              const double,
+              const double,
+              const double,
+              const double,
+              const double,
+              const double>(),
+          py::arg("lat"),
+          py::arg("lon"),
+          py::arg("alt"),
+          py::arg("vn"),
+          py::arg("ve"),
+          py::arg("vd"),
+          py::arg("cb"),
+          py::arg("cd"))
+      .def(
+          py::init<
+              const double,
+              const double,
+              const double,
+              const double,
+              const double,
+              const double,
+              const double,
+              const double,
+              const double,
+              const double,
+              const double>(),
+          py::arg("lat"),
+          py::arg("lon"),
+          py::arg("alt"),
+          py::arg("vn"),
+          py::arg("ve"),
+          py::arg("vd"),
+          py::arg("r"),
+          py::arg("p"),
+          py::arg("y"),
+          py::arg("cb"),
+          py::arg("cd"))
+      .def(
+          "SetProcessNoise",
+          &KinematicNav<>::SetProcessNoise,
+          py::arg("Svel"),
+          py::arg("Satt"),
+          R"pbdoc(
+          SetProcessNoise
+          ===============
+          
+          Set the noise parameters of the KinematicNav (constant velocity) model
+          
+          Parameters
+          ----------
+          
+          Svel : double
+          
+              PSD of expected acceleration white noise [(m/s^2)^2]
+          
+          Satt : double
+          
+              PSD of expected angular rate white noise [(rad/s)^2]
+          )pbdoc")
+      .def(
+          "SetClockSpec",
+          &KinematicNav<>::SetClockSpec,
           py::arg("h0"),
           py::arg("h1"),
           py::arg("h2"),
@@ -690,9 +1314,48 @@ PYBIND11_MODULE(_sturdins_core, h) {
           
               random walk frequency modulation
           )pbdoc")
+      .def(
+          "SetProcessNoiseModel",
+          [](KinematicNav<> &self, const std::shared_ptr<ProcessNoiseModel> &model) {
+            self.SetProcessNoiseModel(model);
+          },
+          py::arg("model"),
+          R"pbdoc(
+          SetProcessNoiseModel
+          ====================
+
+          Use a (shared) process noise model instead of the one built by SetClockSpec and
+          SetProcessNoise (the IMU parameters of the model are unused and its clock has no 10%
+          margin)
+
+          Parameters
+          ----------
+
+          model : ProcessNoiseModel
+
+              Process noise model
+          )pbdoc")
+      .def(
+          "GetProcessNoiseModel",
+          [](const KinematicNav<> &self) {
+            return std::const_pointer_cast<ProcessNoiseModel>(self.GetProcessNoiseModel());
+          },
+          R"pbdoc(
+          GetProcessNoiseModel
+          ====================
+
+          Process noise model used by the filter
+
+          Returns
+          -------
+
+          model : ProcessNoiseModel
+
+              Process noise model
+          )pbdoc")
       .def(
           "SetClock",
-          &KinematicNav::SetClock,
+          &KinematicNav<>::SetClock,
           py::arg("cb"),
           py::arg("cd"),
           R"pbdoc(
@@ -712,9 +1375,44 @@ PYBIND11_MODULE(_sturdins_core, h) {
           
               Clock drift [m/s]
           )pbdoc")
+      .def(
+          "SetInnovationGate",
+          &KinematicNav<>::SetInnovationGate,
+          py::arg("gate"),
+          R"pbdoc(
+          SetInnovationGate
+          =================
+
+          Reject measurements whose normalized innovation exceeds the gate, the rejected
+          measurements of the most recent update are listed in rejected_
+
+          Parameters
+          ----------
+
+          gate : double
+
+              Innovation gate [sigma] (0 disables gating, default)
+          )pbdoc")
+      .def(
+          "SetUpdateStrategy",
+          &KinematicNav<>::SetUpdateStrategy,
+          py::arg("strategy"),
+          R"pbdoc(
+          SetUpdateStrategy
+          =================
+          
+          Choose between batch and sequential (scalar) measurement updates
+          
+          Parameters
+          ----------
+          
+          strategy : UpdateStrategy
+          
+              UpdateStrategy.BATCH (default) or UpdateStrategy.SEQUENTIAL
+          )pbdoc")
       .def(
           "SetPosition",
-          &KinematicNav::SetPosition,
+          &KinematicNav<>::SetPosition,
           py::arg("lat"),
           py::arg("lon"),
           py::arg("alt"),
@@ -741,7 +1439,7 @@ PYBIND11_MODULE(_sturdins_core, h) {
           )pbdoc")
       .def(
           "SetVelocity",
-          &KinematicNav::SetVelocity,
+          &KinematicNav<>::SetVelocity,
           py::arg("vn"),
           py::arg("ve"),
           py::arg("vd"),
@@ -768,7 +1466,8 @@ PYBIND11_MODULE(_sturdins_core, h) {
           )pbdoc")
       .def(
           "SetAttitude",
-          py::overload_cast<const Eigen::Ref<const Eigen::Matrix3d> &>(&KinematicNav::SetAttitude),
+          py::overload_cast<const Eigen::Ref<const Eigen::Matrix3d> &>(
+              &KinematicNav<>::SetAttitude),
           py::arg("C"),
           R"pbdoc(
           SetAttitude
@@ -786,7 +1485,7 @@ PYBIND11_MODULE(_sturdins_core, h) {
       .def(
           "SetAttitude",
           py::overload_cast<const double &, const double &, const double &>(
-              &KinematicNav::SetAttitude),
+              &KinematicNav<>::SetAttitude),
           py::arg("r"),
           py::arg("p"),
           py::arg("y"),
@@ -813,7 +1512,7 @@ PYBIND11_MODULE(_sturdins_core, h) {
           )pbdoc")
       .def(
           "Propagate",
-          &KinematicNav::Propagate,
+          &KinematicNav<>::Propagate,
           py::arg("dt"),
           R"pbdoc(
           Propagate
@@ -830,7 +1529,7 @@ PYBIND11_MODULE(_sturdins_core, h) {
           )pbdoc")
       .def(
           "GnssUpdate",
-          &KinematicNav::GnssUpdate,
+          &KinematicNav<>::GnssUpdate,
           py::arg("sv_pos"),
           py::arg("sv_vel"),
           py::arg("psr"),
@@ -872,7 +1571,7 @@ PYBIND11_MODULE(_sturdins_core, h) {
           )pbdoc")
       .def(
           "PhasedArrayUpdate",
-          &KinematicNav::PhasedArrayUpdate,
+          &KinematicNav<>::PhasedArrayUpdate,
           py::arg("sv_pos"),
           py::arg("sv_vel"),
           py::arg("psr"),
@@ -939,7 +1638,7 @@ PYBIND11_MODULE(_sturdins_core, h) {
           )pbdoc")
       .def(
           "AttitudeUpdate",
-          &KinematicNav::AttitudeUpdate,
+          &KinematicNav<>::AttitudeUpdate,
           py::arg("C"),
           py::arg("R"),
           R"pbdoc(
@@ -959,155 +1658,983 @@ PYBIND11_MODULE(_sturdins_core, h) {
             
                 DCM variance
             )pbdoc")
-      .def_readwrite("phi_", &KinematicNav::phi_)
-      .def_readwrite("lam_", &KinematicNav::lam_)
-      .def_readwrite("h_", &KinematicNav::h_)
-      .def_readwrite("vn_", &KinematicNav::vn_)
-      .def_readwrite("ve_", &KinematicNav::ve_)
-      .def_readwrite("vd_", &KinematicNav::vd_)
-      .def_readwrite("q_b_l_", &KinematicNav::q_b_l_)
-      .def_readwrite("C_b_l_", &KinematicNav::C_b_l_)
-      .def_readwrite("cb_", &KinematicNav::cb_)
-      .def_readwrite("cd_", &KinematicNav::cd_)
-      .def_readwrite("P_", &KinematicNav::P_)
-      .doc() = R"pbdoc(
-               KinematicNav
-               === 
+      .def(
+          "Run",
+          [](KinematicNav<> &self,
+             const Eigen::Ref<const Eigen::VectorXd> &gnss_t,
+             const Eigen::Ref<const Eigen::VectorXi> &offsets,
+             const Eigen::Ref<const RowMatrixX3d> &sv_pos,
+             const Eigen::Ref<const RowMatrixX3d> &sv_vel,
+             const Eigen::Ref<const Eigen::VectorXd> &psr,
+             const Eigen::Ref<const Eigen::VectorXd> &psrdot,
+             const Eigen::Ref<const Eigen::VectorXd> &psrvar,
+             const Eigen::Ref<const Eigen::VectorXd> &psrdotvar) {
+            if (offsets.size() != gnss_t.size() + 1) {
+              throw std::invalid_argument("offsets must have len(gnss_t) + 1 entries");
+            }
+            if (offsets.size() > 0 && offsets(offsets.size() - 1) > sv_pos.rows()) {
+              throw std::invalid_argument("offsets exceed the number of measurement rows");
+            }
+            const py::ssize_t E = gnss_t.size();
+            py::array_t<double> states({E, static_cast<py::ssize_t>(KNS_BATCH_STATES)});
+            py::array_t<double> cov_diag({E, static_cast<py::ssize_t>(11)});
+            Eigen::Map<RowMatrixXd> states_map(states.mutable_data(), E, KNS_BATCH_STATES);
+            Eigen::Map<RowMatrixXd> cov_map(cov_diag.mutable_data(), E, 11);
+            {
+              py::gil_scoped_release release;
+              RunKinematicNav(
+                  self, gnss_t, offsets, sv_pos, sv_vel, psr, psrdot, psrvar, psrdotvar,
+                  states_map, cov_map);
+            }
+            return py::make_tuple(states, cov_diag);
+          },
+          py::arg("gnss_t"),
+          py::arg("offsets"),
+          py::arg("sv_pos"),
+          py::arg("sv_vel"),
+          py::arg("psr"),
+          py::arg("psrdot"),
+          py::arg("psrvar"),
+          py::arg("psrdotvar"),
+          R"pbdoc(
+          Run
+          ===
 
-               KinematicNav navigation Kalman Filter equations.
-               )pbdoc";
+          Process an entire GNSS log natively (the GIL is released). The filter is propagated to
+          and corrected with every epoch, the first epoch is not propagated.
 
-  // Least Squares
-  py::module_ ls = h.def_submodule("leastsquares", R"pbdoc(
-      Least Squares
-      =============
+          Parameters
+          ----------
 
-      Least squares algorithms for initializing the GNSS-InertialNav filter.)pbdoc");
+          gnss_t : np.ndarray
 
-  // RangeAndRate
-  ls.def(
-      "RangeAndRate",
-      &RangeAndRate,
-      py::arg("pos"),
-      py::arg("vel"),
-      py::arg("cb"),
-      py::arg("cd"),
-      py::arg("sv_pos"),
-      py::arg("sv_vel"),
-      py::arg("pred_u"),
-      py::arg("pred_udot"),
-      py::arg("pred_psr"),
-      py::arg("pred_psrdot"),
-      R"pbdoc(
-      RangeAndRate
-      ============
+              GNSS epoch times [s]
 
-      Predicts a range and rate based on a satellite location and velocity
+          offsets : np.ndarray
 
-      Parameters
-      ----------
+              First measurement row of each epoch (len(gnss_t) + 1 entries)
 
-      pos : np.ndarray
+          sv_pos : np.ndarray
 
-          3x1 User ECEF position [m]
+              Satellite ECEF positions of all epochs, one satellite per row [m]
 
-      vel : np.ndarray
+          sv_vel : np.ndarray
 
-          3x1 User ECEF velocity [m/s]
+              Satellite ECEF velocities of all epochs, one satellite per row [m/s]
 
-      cb : double
+          psr : np.ndarray
 
-          User clock bias [m]
+              Pseudorange measurements of all epochs [m]
 
-      cd : double
+          psrdot : np.ndarray
 
-          User clock drift [m/s]
+              Pseudorange-rate measurements of all epochs [m/s]
 
-      sv_pos : np.ndarray
+          psrvar : np.ndarray
 
-          3x1 Satellite ECEF positions [m]
+              Pseudorange measurement variance of all epochs [m^2]
 
-      sv_vel : np.ndarray
+          psrdotvar : np.ndarray
 
-          3x1 Satellite ECEF velocities [m/s]
+              Pseudorange-rate measurement variance of all epochs [(m/s)^2]
 
-      pred_u : np.ndarray
+          Returns
+          -------
 
-          3x1 reference to unit vector to satellite
+          states : np.ndarray
 
-      pred_udot : np.ndarray
+              States per epoch (lat, lon, alt, vn, ve, vd, q0, q1, q2, q3, cb, cd)
 
-          3x1 reference to unit vector rate of change to satellite
+          cov_diag : np.ndarray
 
-      pred_psr : double
+              Error state covariance diagonal per epoch
+          )pbdoc")
+      .def(
+          "SaveSnapshot",
+          &KinematicNav<>::SaveSnapshot,
+          py::arg("snap"),
+          R"pbdoc(
+          SaveSnapshot
+          ============
 
-          Reference to pseudorange prediction
+          Copy the navigation states, clock and covariance into a snapshot
 
-      pred_psrdot :double
+          Parameters
+          ----------
 
-          Reference to pseudorange-rate prediction
+          snap : KinematicNavSnapshot
+
+              Output snapshot
+          )pbdoc")
+      .def(
+          "RestoreSnapshot",
+          &KinematicNav<>::RestoreSnapshot,
+          py::arg("snap"),
+          R"pbdoc(
+          RestoreSnapshot
+          ===============
+
+          Set the navigation states, clock and covariance from a snapshot
+
+          Parameters
+          ----------
+
+          snap : KinematicNavSnapshot
+
+              Snapshot from SaveSnapshot
+          )pbdoc")
+      .def(
+          "GetStateVector",
+          [](const KinematicNav<> &self, Eigen::Ref<Eigen::VectorXd> x) {
+            if (x.size() != KinematicNav<>::STATE_SIZE) {
+              throw std::invalid_argument("state buffer has the wrong size");
+            }
+            self.GetStateVector(x);
+          },
+          py::arg("x"),
+          R"pbdoc(
+          GetStateVector
+          ==============
+
+          Copy the navigation states into a caller-provided buffer (does not allocate)
+
+          Parameters
+          ----------
+
+          x : np.ndarray
+
+              Writable, contiguous float64 buffer of 12 elements, filled with
+              [lat, lon, alt, vn, ve, vd, q0, q1, q2, q3, cb, cd]
+          )pbdoc")
+      .def_readwrite("phi_", &KinematicNav<>::phi_)
+      .def_readwrite("lam_", &KinematicNav<>::lam_)
+      .def_readwrite("h_", &KinematicNav<>::h_)
+      .def_readwrite("vn_", &KinematicNav<>::vn_)
+      .def_readwrite("ve_", &KinematicNav<>::ve_)
+      .def_readwrite("vd_", &KinematicNav<>::vd_)
+      .def_property(
+          "q_b_l_",
+          EigenView<KinematicNav<>>(&KinematicNav<>::q_b_l_),
+          EigenAssign<KinematicNav<>>(&KinematicNav<>::q_b_l_))
+      .def_property(
+          "C_b_l_",
+          EigenView<KinematicNav<>>(&KinematicNav<>::C_b_l_),
+          EigenAssign<KinematicNav<>>(&KinematicNav<>::C_b_l_))
+      .def_readwrite("cb_", &KinematicNav<>::cb_)
+      .def_readwrite("cd_", &KinematicNav<>::cd_)
+      .def_property(
+          "ecef_p_",
+          EigenView<KinematicNav<>>(&KinematicNav<>::ecef_p_),
+          EigenAssign<KinematicNav<>>(&KinematicNav<>::ecef_p_))
+      .def_property(
+          "ecef_v_",
+          EigenView<KinematicNav<>>(&KinematicNav<>::ecef_v_),
+          EigenAssign<KinematicNav<>>(&KinematicNav<>::ecef_v_))
+      .def_property(
+          "P_",
+          EigenView<KinematicNav<>>(&KinematicNav<>::P_),
+          EigenAssign<KinematicNav<>>(&KinematicNav<>::P_))
+      .def_readonly("rejected_", &KinematicNav<>::rejected_)
+      .doc() = R"pbdoc(
+               KinematicNav
+               === 
+
+               KinematicNav navigation Kalman Filter equations.
+               )pbdoc";
+
+  // FusionEngine
+  py::class_<FusionEngine<>>(h, "FusionEngine")
+      .def(
+          py::init<
+              const InertialNav<> &,
+              const double &,
+              const double &,
+              const int &,
+              const int &,
+              const int &>(),
+          py::arg("filt"),
+          py::arg("t0"),
+          py::arg("lag") = 0.5,
+          py::arg("max_imu") = 1024,
+          py::arg("ckpt_interval") = 10,
+          py::arg("max_meas") = 32)
+      .def(
+          "AddImu",
+          &FusionEngine<>::AddImu,
+          py::arg("t"),
+          py::arg("wb"),
+          py::arg("fb"),
+          R"pbdoc(
+          AddImu
+          ======
+
+          Mechanize and propagate through an IMU sample, applying the buffered measurements that
+          fall inside it
+
+          Parameters
+          ----------
+
+          t : double
+
+              Time at the end of the sample interval [s] (must increase)
+
+          wb : np.ndarray
+
+              Measured angular rates in the body frame [rad/s]
+
+          fb : np.ndarray
+
+              Measured specific forces in the body frame [m/s^2]
+
+          Returns
+          -------
+
+          accepted : bool
+
+              False if the sample is not newer than the filter time
+          )pbdoc")
+      .def(
+          "AddGnss",
+          &FusionEngine<>::AddGnss,
+          py::arg("t"),
+          py::arg("sv_pos"),
+          py::arg("sv_vel"),
+          py::arg("psr"),
+          py::arg("psrdot"),
+          py::arg("psr_var"),
+          py::arg("psrdot_var"),
+          R"pbdoc(
+          AddGnss
+          =======
+
+          Buffer a GNSS epoch, an epoch older than the filter time rolls the filter back to the
+          newest checkpoint before it and re-runs the buffered IMU samples
+
+          Parameters
+          ----------
+
+          t : double
+
+              Measurement time [s]
+
+          sv_pos : np.ndarray
+
+              Satellite ECEF positions, one satellite per column [m]
+
+          sv_vel : np.ndarray
+
+              Satellite ECEF velocities, one satellite per column [m/s]
+
+          psr : np.ndarray
+
+              Pseudorange measurements [m]
+
+          psrdot : np.ndarray
+
+              Pseudorange-rate measurements [m/s]
+
+          psr_var : np.ndarray
+
+              Pseudorange measurement variance [m^2]
+
+          psrdot_var : np.ndarray
+
+              Pseudorange-rate measurement variance [(m/s)^2]
+
+          Returns
+          -------
+
+          accepted : bool
+
+              False if the measurement was dropped
+          )pbdoc")
+      .def(
+          "AddPhasedArray",
+          &FusionEngine<>::AddPhasedArray,
+          py::arg("t"),
+          py::arg("sv_pos"),
+          py::arg("sv_vel"),
+          py::arg("psr"),
+          py::arg("psrdot"),
+          py::arg("phase"),
+          py::arg("psr_var"),
+          py::arg("psrdot_var"),
+          py::arg("phase_var"),
+          py::arg("ant_xyz"),
+          py::arg("n_ant"),
+          py::arg("lamb"),
+          R"pbdoc(
+          AddPhasedArray
+          ==============
+
+          Buffer a phased array GNSS epoch (see InertialNav.PhasedArrayUpdate)
+
+          Returns
+          -------
+
+          accepted : bool
+
+              False if the measurement was dropped
+          )pbdoc")
+      .def(
+          "AddAttitude",
+          &FusionEngine<>::AddAttitude,
+          py::arg("t"),
+          py::arg("C"),
+          py::arg("R"),
+          R"pbdoc(
+          AddAttitude
+          ===========
+
+          Buffer an attitude measurement (see InertialNav.AttitudeUpdate)
+
+          Parameters
+          ----------
+
+          t : double
+
+              Measurement time [s]
+
+          C : np.ndarray
+
+              Measured body-to-ned rotation matrix
+
+          R : np.ndarray
+
+              Attitude error covariance (small angles about the ned axes) [rad^2]
+
+          Returns
+          -------
+
+          accepted : bool
+
+              False if the measurement was dropped
+          )pbdoc")
+      .def(
+          "Filter",
+          &FusionEngine<>::Filter,
+          py::return_value_policy::reference_internal,
+          R"pbdoc(
+          Filter
+          ======
+
+          Navigation filter at the time of the latest IMU sample
+          )pbdoc")
+      .def("Time", &FusionEngine<>::Time)
+      .def("NumPending", &FusionEngine<>::NumPending)
+      .def_readonly("n_late_", &FusionEngine<>::n_late_)
+      .def_readonly("n_dropped_", &FusionEngine<>::n_dropped_)
+      .def_readonly("n_replays_", &FusionEngine<>::n_replays_)
+      .doc() = R"pbdoc(
+               FusionEngine
+               ===
+
+               Time-tagged multi-rate fusion of IMU and GNSS measurements with out-of-sequence
+               measurements handled by rolling back to checkpoints.
+               )pbdoc";
+
+  // InertialNavSmoother
+  py::class_<RtsSmoother<InertialNav<>>>(h, "InertialNavSmoother")
+      .def(
+          py::init<const std::size_t &, const std::string &>(),
+          py::arg("chunk_size") = 4096,
+          py::arg("spill_file") = "")
+      .def(
+          "Record",
+          &RtsSmoother<InertialNav<>>::Record,
+          py::arg("t"),
+          py::arg("filt"),
+          R"pbdoc(
+          Record
+          ======
+
+          Store the filter at the end of an epoch, after its measurement updates
+
+          Parameters
+          ----------
+
+          t : double
+
+              Epoch time [s]
+
+          filt : InertialNav
+
+              Navigation filter
+
+          Returns
+          -------
+
+          stored : bool
+
+              False if the epoch could not be stored
+          )pbdoc")
+      .def(
+          "Smooth",
+          [](RtsSmoother<InertialNav<>> &self, const int &n_seg) {
+            const py::ssize_t N = self.Size();
+            const py::ssize_t n_x = InertialNav<>::STATE_SIZE;
+            const py::ssize_t n_e = InertialNav<>::ERROR_SIZE;
+            py::array_t<double> t(N);
+            py::array_t<double> states({N, n_x});
+            py::array_t<double> cov_diag({N, n_e});
+            Eigen::Map<Eigen::VectorXd> t_map(t.mutable_data(), N);
+            Eigen::Map<RowMatrixXd> states_map(states.mutable_data(), N, n_x);
+            Eigen::Map<RowMatrixXd> cov_map(cov_diag.mutable_data(), N, n_e);
+            bool ok;
+            {
+              py::gil_scoped_release release;
+              ok = self.Smooth(t_map, states_map, cov_map, n_seg);
+            }
+            if (!ok) {
+              throw std::runtime_error("smoother store could not be read back");
+            }
+            return py::make_tuple(t, states, cov_diag);
+          },
+          py::arg("n_seg") = 1,
+          R"pbdoc(
+          Smooth
+          ======
+
+          Run the backward pass over all recorded epochs
+
+          Parameters
+          ----------
+
+          n_seg : int
+
+              Number of segments smoothed in parallel
+
+          Returns
+          -------
+
+          t : np.ndarray
+
+              Epoch times [s]
+
+          states : np.ndarray
+
+              Smoothed states per epoch (see GetStateVector)
+
+          cov_diag : np.ndarray
+
+              Smoothed error state covariance diagonal per epoch
+          )pbdoc")
+      .def("Size", &RtsSmoother<InertialNav<>>::Size)
+      .def("BytesPerEpoch", &RtsSmoother<InertialNav<>>::BytesPerEpoch)
+      .doc() = R"pbdoc(
+               InertialNavSmoother
+               ===
+
+               Fixed-interval RTS smoother over a recorded InertialNav run.
+               )pbdoc";
+
+  // KinematicNavSmoother
+  py::class_<RtsSmoother<KinematicNav<>>>(h, "KinematicNavSmoother")
+      .def(
+          py::init<const std::size_t &, const std::string &>(),
+          py::arg("chunk_size") = 4096,
+          py::arg("spill_file") = "")
+      .def(
+          "Record",
+          &RtsSmoother<KinematicNav<>>::Record,
+          py::arg("t"),
+          py::arg("filt"),
+          R"pbdoc(
+          Record
+          ======
+
+          Store the filter at the end of an epoch, after its measurement updates
+
+          Parameters
+          ----------
+
+          t : double
+
+              Epoch time [s]
+
+          filt : KinematicNav
+
+              Navigation filter
+
+          Returns
+          -------
+
+          stored : bool
+
+              False if the epoch could not be stored
+          )pbdoc")
+      .def(
+          "Smooth",
+          [](RtsSmoother<KinematicNav<>> &self, const int &n_seg) {
+            const py::ssize_t N = self.Size();
+            const py::ssize_t n_x = KinematicNav<>::STATE_SIZE;
+            const py::ssize_t n_e = KinematicNav<>::ERROR_SIZE;
+            py::array_t<double> t(N);
+            py::array_t<double> states({N, n_x});
+            py::array_t<double> cov_diag({N, n_e});
+            Eigen::Map<Eigen::VectorXd> t_map(t.mutable_data(), N);
+            Eigen::Map<RowMatrixXd> states_map(states.mutable_data(), N, n_x);
+            Eigen::Map<RowMatrixXd> cov_map(cov_diag.mutable_data(), N, n_e);
+            bool ok;
+            {
+              py::gil_scoped_release release;
+              ok = self.Smooth(t_map, states_map, cov_map, n_seg);
+            }
+            if (!ok) {
+              throw std::runtime_error("smoother store could not be read back");
+            }
+            return py::make_tuple(t, states, cov_diag);
+          },
+          py::arg("n_seg") = 1,
+          R"pbdoc(
+          Smooth
+          ======
+
+          Run the backward pass over all recorded epochs
+
+          Parameters
+          ----------
+
+          n_seg : int
+
+              Number of segments smoothed in parallel
+
+          Returns
+          -------
+
+          t : np.ndarray
+
+              Epoch times [s]
+
+          states : np.ndarray
+
+              Smoothed states per epoch (see GetStateVector)
+
+          cov_diag : np.ndarray
+
+              Smoothed error state covariance diagonal per epoch
+          )pbdoc")
+      .def("Size", &RtsSmoother<KinematicNav<>>::Size)
+      .def("BytesPerEpoch", &RtsSmoother<KinematicNav<>>::BytesPerEpoch)
+      .doc() = R"pbdoc(
+               KinematicNavSmoother
+               ===
+
+               Fixed-interval RTS smoother over a recorded KinematicNav run.
+               )pbdoc";
+
+  // Least Squares
+  py::module_ ls = h.def_submodule("leastsquares", R"pbdoc(
+      Least Squares
+      =============
+
+      Least squares algorithms for initializing the GNSS-InertialNav filter.)pbdoc");
+
+  // RangeAndRate
+  ls.def(
+      "RangeAndRate",
+      &RangeAndRate,
+      py::arg("pos"),
+      py::arg("vel"),
+      py::arg("cb"),
+      py::arg("cd"),
+      py::arg("sv_pos"),
+      py::arg("sv_vel"),
+      py::arg("pred_u"),
+      py::arg("pred_udot"),
+      py::arg("pred_psr"),
+      py::arg("pred_psrdot"),
+      R"pbdoc(
+      RangeAndRate
+      ============
+
+      Predicts a range and rate based on a satellite location and velocity
+
+      Parameters
+      ----------
+
+      pos : np.ndarray
+
+          3x1 User ECEF position [m]
+
+      vel : np.ndarray
+
+          3x1 User ECEF velocity [m/s]
+
+      cb : double
+
+          User clock bias [m]
+
+      cd : double
+
+          User clock drift [m/s]
+
+      sv_pos : np.ndarray
+
+          3x1 Satellite ECEF positions [m]
+
+      sv_vel : np.ndarray
+
+          3x1 Satellite ECEF velocities [m/s]
+
+      pred_u : np.ndarray
+
+          3x1 reference to unit vector to satellite
+
+      pred_udot : np.ndarray
+
+          3x1 reference to unit vector rate of change to satellite
+
+      pred_psr : double
+
+          Reference to pseudorange prediction
+
+      pred_psrdot :double
+
+          Reference to pseudorange-rate prediction
       )pbdoc");
 
-  // GnssPvt
-  ls.def(
-      "GnssPVT",
-      &GnssPVT,
-      py::arg("x"),
-      py::arg("P"),
-      py::arg("sv_pos"),
-      py::arg("sv_vel"),
-      py::arg("psr"),
-      py::arg("psrdot"),
-      py::arg("psrvar"),
-      py::arg("psrdotvar"),
-      R"pbdoc(
-      GnssPVT
-      =======
+  // GnssPvt
+  ls.def(
+      "GnssPVT",
+      &GnssPVT,
+      py::arg("x"),
+      py::arg("P"),
+      py::arg("sv_pos"),
+      py::arg("sv_vel"),
+      py::arg("psr"),
+      py::arg("psrdot"),
+      py::arg("psrvar"),
+      py::arg("psrdotvar"),
+      R"pbdoc(
+      GnssPVT
+      =======
+
+      Least Squares solver for GNSS position, velocity, and timing terms
+
+      Parameters
+      ----------
+
+      x : np.ndarray
+
+          Initial state estimate
+
+      P : np.ndarray
+
+          Initial covariance estimate
+
+      sv_pos : np.ndarray
+
+          Satellite ECEF positions [m]
+
+      sv_vel : np.ndarray
+
+          Satellite ECEF velocities [m/s]
+
+      psr : np.ndarray
+
+          Pseudorange measurements [m]
+
+      psrdot : np.ndarray
+
+          Pseudorange-rate measurements [m/s]
+
+      psrvar : np.ndarray
+
+          Pseudorange measurement variance [m^2]
+
+      psrdotvar : np.ndarray
+
+          Pseudorange-rate measurement variance [(m/s)^2]
+
+      Returns
+      -------
+
+      status : bool
+
+          Convergence success
+      )pbdoc");
+
+  // BatchGnssPVT
+  ls.def(
+      "BatchGnssPVT",
+      &BatchGnssPVT,
+      py::arg("x"),
+      py::arg("P"),
+      py::arg("converged"),
+      py::arg("offsets"),
+      py::arg("sv_pos"),
+      py::arg("sv_vel"),
+      py::arg("psr"),
+      py::arg("psrdot"),
+      py::arg("psrvar"),
+      py::arg("psrdotvar"),
+      py::arg("n_threads") = 0,
+      py::call_guard<py::gil_scoped_release>(),
+      R"pbdoc(
+      BatchGnssPVT
+      ============
+
+      Solve many independent GnssPVT problems in parallel, the results are identical to GnssPVT
+      and do not depend on the number of threads
+
+      Parameters
+      ----------
+
+      x : np.ndarray
+
+          8xE initial state estimates, one epoch per column (solutions on return)
+
+      P : np.ndarray
+
+          8x8E covariance estimates, epoch e in columns 8e to 8e+7
+
+      converged : np.ndarray
+
+          E convergence flags (bool)
+
+      offsets : np.ndarray
+
+          First satellite column of each epoch (size E + 1, int32)
+
+      sv_pos : np.ndarray
+
+          Satellite ECEF positions of all epochs [m]
+
+      sv_vel : np.ndarray
+
+          Satellite ECEF velocities of all epochs [m/s]
+
+      psr : np.ndarray
+
+          Pseudorange measurements of all epochs [m]
+
+      psrdot : np.ndarray
+
+          Pseudorange-rate measurements of all epochs [m/s]
+
+      psrvar : np.ndarray
+
+          Pseudorange measurement variance of all epochs [m^2]
+
+      psrdotvar : np.ndarray
+
+          Pseudorange-rate measurement variance of all epochs [(m/s)^2]
+
+      n_threads : int
+
+          Worker threads (0 uses every core)
+
+      Returns
+      -------
+
+      n_converged : int
+
+          Number of converged epochs
+      )pbdoc");
+
+  // RobustLoss
+  py::enum_<RobustLoss>(ls, "RobustLoss")
+      .value("NONE", RobustLoss::NONE)
+      .value("HUBER", RobustLoss::HUBER)
+      .value("TUKEY", RobustLoss::TUKEY)
+      .doc() = R"pbdoc(
+               RobustLoss
+               ==========
+
+               Loss applied to the normalized residuals by GnssPVTWorkspace.SolveRobust
+               )pbdoc";
+
+  // GnssPVTResult
+  py::class_<GnssPVTResult>(ls, "GnssPVTResult")
+      .def_readonly("converged_", &GnssPVTResult::converged_)
+      .def_readonly("iterations_", &GnssPVTResult::iterations_)
+      .def_readonly("cost_", &GnssPVTResult::cost_)
+      .def_readonly("test_stat_", &GnssPVTResult::test_stat_)
+      .def_readonly("dof_", &GnssPVTResult::dof_)
+      .def_readonly("n_outliers_", &GnssPVTResult::n_outliers_)
+      .doc() = R"pbdoc(
+               GnssPVTResult
+               =============
+
+               Outcome of a GnssPVTWorkspace.SolveRobust, test_stat_ is the sum of the squared
+               normalized residuals (chi-square with dof_ degrees of freedom when fault free)
+               )pbdoc";
+
+  // GnssPVTWorkspace
+  py::class_<GnssPVTWorkspace>(ls, "GnssPVTWorkspace")
+      .def(py::init<const double &>(), py::arg("tol") = 1e-6)
+      .def(
+          "Solve",
+          &GnssPVTWorkspace::Solve,
+          py::arg("x"),
+          py::arg("P"),
+          py::arg("sv_pos"),
+          py::arg("sv_vel"),
+          py::arg("psr"),
+          py::arg("psrdot"),
+          py::arg("psrvar"),
+          py::arg("psrdotvar"),
+          py::call_guard<py::gil_scoped_release>(),
+          R"pbdoc(
+          Solve
+          =====
+
+          Least Squares solver for GNSS position, velocity, and timing terms, the normal equations
+          of satellites whose geometry did not change are reused from the previous call
+
+          Parameters
+          ----------
+
+          x : np.ndarray
+
+              Initial state estimate
+
+          P : np.ndarray
+
+              Initial covariance estimate
+
+          sv_pos : np.ndarray
+
+              Satellite ECEF positions [m]
 
-      Least Squares solver for GNSS position, velocity, and timing terms
+          sv_vel : np.ndarray
 
-      Parameters
-      ----------
+              Satellite ECEF velocities [m/s]
 
-      x : np.ndarray
+          psr : np.ndarray
 
-          Initial state estimate
+              Pseudorange measurements [m]
 
-      P : np.ndarray
+          psrdot : np.ndarray
 
-          Initial covariance estimate
+              Pseudorange-rate measurements [m/s]
 
-      sv_pos : np.ndarray
+          psrvar : np.ndarray
 
-          Satellite ECEF positions [m]
+              Pseudorange measurement variance [m^2]
 
-      sv_vel : np.ndarray
+          psrdotvar : np.ndarray
 
-          Satellite ECEF velocities [m/s]
+              Pseudorange-rate measurement variance [(m/s)^2]
 
-      psr : np.ndarray
+          Returns
+          -------
 
-          Pseudorange measurements [m]
+          status : bool
 
-      psrdot : np.ndarray
+              Convergence success
+          )pbdoc")
+      .def(
+          "Reset",
+          &GnssPVTWorkspace::Reset,
+          R"pbdoc(
+          Reset
+          =====
 
-          Pseudorange-rate measurements [m/s]
+          Forget the stored geometry, the next Solve rebuilds the normal equations
+          )pbdoc")
+      .def(
+          "SolveRobust",
+          &GnssPVTWorkspace::SolveRobust,
+          py::arg("x"),
+          py::arg("P"),
+          py::arg("sv_pos"),
+          py::arg("sv_vel"),
+          py::arg("psr"),
+          py::arg("psrdot"),
+          py::arg("psrvar"),
+          py::arg("psrdotvar"),
+          py::arg("loss") = RobustLoss::HUBER,
+          py::arg("k") = 1.345,
+          py::arg("max_iter") = 20,
+          py::call_guard<py::gil_scoped_release>(),
+          R"pbdoc(
+          SolveRobust
+          ===========
 
-      psrvar : np.ndarray
+          Levenberg-Marquardt solver for GNSS position, velocity, and timing terms, the residuals
+          are reweighted with a robust loss once the least squares fit settles
 
-          Pseudorange measurement variance [m^2]
+          Parameters
+          ----------
 
-      psrdotvar : np.ndarray
+          x : np.ndarray
 
-          Pseudorange-rate measurement variance [(m/s)^2]
+              Initial state estimate
 
-      Returns
-      -------
+          P : np.ndarray
 
-      status : bool
+              Covariance estimate
 
-          Convergence success
-      )pbdoc");
+          sv_pos : np.ndarray
+
+              Satellite ECEF positions [m]
+
+          sv_vel : np.ndarray
+
+              Satellite ECEF velocities [m/s]
+
+          psr : np.ndarray
+
+              Pseudorange measurements [m]
+
+          psrdot : np.ndarray
+
+              Pseudorange-rate measurements [m/s]
+
+          psrvar : np.ndarray
+
+              Pseudorange measurement variance [m^2]
+
+          psrdotvar : np.ndarray
+
+              Pseudorange-rate measurement variance [(m/s)^2]
+
+          loss : RobustLoss
+
+              Robust loss
+
+          k : float
+
+              Loss threshold on the normalized residual (1.345 Huber, 4.685 Tukey)
+
+          max_iter : int
+
+              Iteration limit
+
+          Returns
+          -------
+
+          result : GnssPVTResult
+
+              Convergence, final cost and residual test statistic
+          )pbdoc")
+      .def(
+          "Iterations",
+          &GnssPVTWorkspace::Iterations,
+          R"pbdoc(
+          Iterations
+          ==========
+
+          Number of iterations of the last Solve
+          )pbdoc")
+      .def(
+          "RowsRefreshed",
+          &GnssPVTWorkspace::RowsRefreshed,
+          R"pbdoc(
+          RowsRefreshed
+          =============
+
+          Number of satellite contributions (re)built during the last Solve
+          )pbdoc")
+      .doc() = R"pbdoc(
+               GnssPVTWorkspace
+               ================
+
+               Persistent GnssPVT solver, the 8x8 normal equations are accumulated per satellite
+               and only refreshed for satellites whose geometry moved beyond tol
+               )pbdoc";
 
   // PhasedArrayAttitude
   ls.def(
@@ -1170,6 +2697,101 @@ PYBIND11_MODULE(_sturdins_core, h) {
           Convergence success
       )pbdoc");
 
+  // PhasedArrayResult
+  py::class_<PhasedArrayResult>(ls, "PhasedArrayResult")
+      .def_readonly("converged_", &PhasedArrayResult::converged_)
+      .def_readonly("iterations_", &PhasedArrayResult::iterations_)
+      .def_readonly("step_", &PhasedArrayResult::step_)
+      .doc() = R"pbdoc(
+               PhasedArrayResult
+               =================
+
+               Outcome of a PhasedArrayAttitudeSolver.Solve
+               )pbdoc";
+
+  // PhasedArrayAttitudeSolver
+  py::class_<PhasedArrayAttitudeSolver>(ls, "PhasedArrayAttitudeSolver")
+      .def(
+          py::init<const double &, const int &>(),
+          py::arg("thresh") = 1e-6,
+          py::arg("max_iter") = 10)
+      .def(
+          "Solve",
+          &PhasedArrayAttitudeSolver::Solve,
+          py::arg("C_b_l"),
+          py::arg("u_ned"),
+          py::arg("phase"),
+          py::arg("phasevar"),
+          py::arg("ant_xyz"),
+          py::arg("n_ant"),
+          py::arg("lamb"),
+          py::arg("warm_start") = false,
+          py::call_guard<py::gil_scoped_release>(),
+          R"pbdoc(
+          Solve
+          =====
+
+          Iterative attitude estimate based on the known spatial phase of an antenna array
+
+          Parameters
+          ----------
+
+          C_b_l : np.ndarray
+
+              Initial estimate of the body to local-nav frame attitude dcm (solution on return)
+
+          u_ned : np.ndarray
+
+              3 x n_sv Ephemeris based unit vectors in the local-nav frame
+
+          phase : np.ndarray
+
+              n_ant x n_sv matrix of measured differential gnss phase values
+
+          phasevar : np.ndarray
+
+              Variance of each phase measurement
+
+          ant_xyz : np.ndarray
+
+              Known antenna positions in the body frame
+
+          n_ant : int
+
+              Known number of antennas in the array
+
+          lamb : double
+
+              Wavelength for the signal of interest [m/rad]
+
+          warm_start : bool
+
+              Start from the previous solution instead of C_b_l (if there is one)
+
+          Returns
+          -------
+
+          result : PhasedArrayResult
+
+              Convergence and iteration count
+          )pbdoc")
+      .def(
+          "Reset",
+          &PhasedArrayAttitudeSolver::Reset,
+          R"pbdoc(
+          Reset
+          =====
+
+          Forget the previous solution
+          )pbdoc")
+      .doc() = R"pbdoc(
+               PhasedArrayAttitudeSolver
+               =========================
+
+               Persistent PhasedArrayAttitude solver for calling once per epoch, reports the
+               iterations through a PhasedArrayResult and can warm start from the previous solution
+               )pbdoc";
+
   // Wahba
   ls.def(
       "Wahba",
@@ -1213,8 +2835,12 @@ PYBIND11_MODULE(_sturdins_core, h) {
          const Eigen::Ref<const Eigen::Matrix3Xd> &ant_xyz,
          const int &n_ant,
          const double &lambda,
-         const double &thresh = 1e-4) {
-        MUSIC(az_mean, el_mean, P, ant_xyz, n_ant, lambda, thresh);
+         const double &thresh = 1e-4,
+         const int &n_threads = 0) {
+        {
+          py::gil_scoped_release release;
+          MUSIC(az_mean, el_mean, P, ant_xyz, n_ant, lambda, thresh, n_threads);
+        }
         return std::pair<double, double>(az_mean, el_mean);
       },
       py::arg("az_mean"),
@@ -1224,12 +2850,14 @@ PYBIND11_MODULE(_sturdins_core, h) {
       py::arg("n_ant"),
       py::arg("lamb"),
       py::arg("thresh") = 1e-4,
+      py::arg("n_threads") = 0,
       pybind11::return_value_policy::reference_internal,
       R"pbdoc(
       MUSIC
       ===================
 
-      MUSIC estimator using Prompt correlators (I & Q)
+      MUSIC estimator using Prompt correlators (I & Q), the spectrum is searched on a 1 deg grid
+      which is refined by 10x around the peak until the resolution reaches thresh
 
       Parameters
       ----------
@@ -1262,6 +2890,10 @@ PYBIND11_MODULE(_sturdins_core, h) {
 
           Desired threshold of convergence
 
+      n_threads : int
+
+          Threads used for the coarse grid (0 uses every core)
+
       Returns
       -------
 
@@ -1270,6 +2902,87 @@ PYBIND11_MODULE(_sturdins_core, h) {
           Convergence success
       )pbdoc");
 
+  // MusicManifold
+  py::class_<MusicManifold>(ls, "MusicManifold")
+      .def(
+          py::init<
+              const Eigen::Ref<const Eigen::Matrix3Xd> &,
+              const int &,
+              const double &,
+              const double &>(),
+          py::arg("ant_xyz"),
+          py::arg("n_ant"),
+          py::arg("lamb"),
+          py::arg("res") = navtools::DEG2RAD<>)
+      .def(
+          "Estimate",
+          [](MusicManifold &self,
+             const Eigen::Ref<const Eigen::VectorXcd> &P,
+             const double &thresh) {
+            double az_mean, el_mean;
+            {
+              py::gil_scoped_release release;
+              self.Estimate(az_mean, el_mean, P, thresh);
+            }
+            return std::pair<double, double>(az_mean, el_mean);
+          },
+          py::arg("P"),
+          py::arg("thresh") = 1e-4,
+          R"pbdoc(
+          Estimate
+          ========
+
+          MUSIC estimate using Prompt correlators (I & Q), the cached grid is refined by 10x around
+          the peak until the resolution reaches thresh
+
+          Parameters
+          ----------
+
+          P : np.ndarray
+
+              Measured prompt correlators
+
+          thresh : double
+
+              Desired threshold of convergence
+
+          Returns
+          -------
+
+          az_mean : double
+
+              Azimuth estimate [rad]
+
+          el_mean : double
+
+              Elevation estimate [rad]
+          )pbdoc")
+      .def(
+          "GridSize",
+          &MusicManifold::GridSize,
+          R"pbdoc(
+          GridSize
+          ========
+
+          Number of (az, el) points in the cached coarse grid
+          )pbdoc")
+      .def(
+          "MemoryFootprint",
+          &MusicManifold::MemoryFootprint,
+          R"pbdoc(
+          MemoryFootprint
+          ===============
+
+          Memory held by the cached manifold and the estimator buffers [bytes]
+          )pbdoc")
+      .doc() = R"pbdoc(
+               MusicManifold
+               =============
+
+               MUSIC estimator for a fixed antenna array, the cos/sin of every baseline phase on
+               the coarse grid is cached at construction
+               )pbdoc";
+
   // Nav sensors
   py::module_ ns = h.def_submodule("navsense", R"pbdoc(
       Nav Sensors
@@ -1281,6 +2994,7 @@ PYBIND11_MODULE(_sturdins_core, h) {
 
       1. `NavigationIMU`
       2. `NavigationClock`
+      3. `ProcessNoiseModel`
       )pbdoc");
 
   // NavigationIMU
@@ -1314,6 +3028,122 @@ PYBIND11_MODULE(_sturdins_core, h) {
                Struct of navigation clock Allan variance values
                )pbdoc";
 
+  // ProcessNoiseModel
+  py::class_<ProcessNoiseModel, std::shared_ptr<ProcessNoiseModel>>(ns, "ProcessNoiseModel")
+      .def(
+          py::init([](const NavigationClock &clock,
+                      const NavigationIMU &imu,
+                      const Eigen::Ref<const Eigen::VectorXd> &dt,
+                      const double &Svel,
+                      const double &Satt) {
+            return std::make_shared<ProcessNoiseModel>(
+                clock, imu, std::vector<double>(dt.begin(), dt.end()), Svel, Satt);
+          }),
+          py::arg("clock"),
+          py::arg("imu"),
+          py::arg("dt") = Eigen::VectorXd(),
+          py::arg("Svel") = 0.0,
+          py::arg("Satt") = 0.0,
+          R"pbdoc(
+          ProcessNoiseModel
+          =================
+
+          Constructor
+
+          Parameters
+          ----------
+
+          clock : NavigationClock
+
+              Navigation clock Allan variance parameters
+
+          imu : NavigationIMU
+
+              Navigation IMU Allan variance parameters (units of the NavigationIMU presets)
+
+          dt : np.ndarray
+
+              Integration periods to discretize [s]
+
+          Svel : double
+
+              KinematicNav velocity process noise PSD
+
+          Satt : double
+
+              KinematicNav attitude process noise PSD
+          )pbdoc")
+      .def(
+          "IsCached",
+          &ProcessNoiseModel::IsCached,
+          py::arg("dt"),
+          R"pbdoc(
+          IsCached
+          ========
+
+          True if the blocks of an integration period were discretized by the constructor
+
+          Parameters
+          ----------
+
+          dt : double
+
+              Integration period [s]
+
+          Returns
+          -------
+
+          cached : bool
+
+              True if dt is cached
+          )pbdoc")
+      .def(
+          "Clock",
+          &ProcessNoiseModel::Clock,
+          py::return_value_policy::copy,
+          R"pbdoc(
+          Clock
+          =====
+
+          Navigation clock Allan variance parameters of the model
+          )pbdoc")
+      .def(
+          "Imu",
+          &ProcessNoiseModel::Imu,
+          py::return_value_policy::copy,
+          R"pbdoc(
+          Imu
+          ===
+
+          Navigation IMU Allan variance parameters of the model
+          )pbdoc")
+      .def(
+          "Svel",
+          &ProcessNoiseModel::Svel,
+          R"pbdoc(
+          Svel
+          ====
+
+          KinematicNav velocity process noise PSD of the model
+          )pbdoc")
+      .def(
+          "Satt",
+          &ProcessNoiseModel::Satt,
+          R"pbdoc(
+          Satt
+          ====
+
+          KinematicNav attitude process noise PSD of the model
+          )pbdoc")
+      .doc() = R"pbdoc(
+               ProcessNoiseModel
+               =================
+
+               Process noise of InertialNav and KinematicNav built from the clock and IMU Allan
+               variance parameters, the listed integration periods are discretized once and the
+               model can be shared by many filters
+               )pbdoc";
+
   ns.attr("LOW_QUALTIY_TCXO") = LOW_QUALITY_TCXO;
   ns.attr("HIGH_QUALITY_TCXO") = HIGH_QUALITY_TCXO;
   ns.attr("OCXO") = OCXO;
@@ -4,6 +4,7 @@ from ._sturdins_core import (
     InertialNav,
     KinematicNav,
     Strapdown,
+    UpdateStrategy,
     leastsquares,
     navsense,
 )
@@ -14,6 +15,7 @@ __all__ = [
     "InertialNav",
     "KinematicNav",
     "Strapdown",
+    "UpdateStrategy",
     "leastsquares",
     "navsense",
 ]
@@ -10,6 +10,7 @@ Contains the following classes:
 1. `InertialNav`
 2. `KinematicNav`
 3. `Strapdown`
+4. `UpdateStrategy`
 
 Contains the following modules:
 
@@ -23,6 +24,7 @@ from __future__ import annotations
 from sturdins._sturdins_core import InertialNav
 from sturdins._sturdins_core import KinematicNav
 from sturdins._sturdins_core import Strapdown
+from sturdins._sturdins_core import UpdateStrategy
 from sturdins._sturdins_core import leastsquares
 from sturdins._sturdins_core import navsense
 from . import _sturdins_core
@@ -33,6 +35,7 @@ __all__: list = [
     "InertialNav",
     "KinematicNav",
     "Strapdown",
+    "UpdateStrategy",
     "leastsquares",
     "navsense",
 ]
@@ -7,9 +7,15 @@ Daniel Sturdivant's GNSS-INS Sofware.
 
 Contains the following classes:
 
-1. `InertialNav`
-2. `KinematicNav`
-3. `Strapdown`
+1. `FusionEngine`
+2. `InertialNav`
+3. `InertialNavSnapshot`
+4. `KinematicNav`
+5. `KinematicNavSnapshot`
+6. `Stage`
+7. `StageCounters`
+8. `Strapdown`
+9. `UpdateStrategy`
 
 Contains the following modules:
 
@@ -25,7 +31,214 @@ import typing
 from . import leastsquares
 from . import navsense
 
-__all__ = ["InertialNav", "KinematicNav", "Strapdown", "leastsquares", "navsense"]
+__all__ = [
+    "FusionEngine",
+    "GetStageCounters",
+    "INSTRUMENTATION_ENABLED",
+    "InertialNav",
+    "InertialNavSmoother",
+    "InertialNavSnapshot",
+    "KinematicNav",
+    "KinematicNavSmoother",
+    "KinematicNavSnapshot",
+    "ResetStageCounters",
+    "Stage",
+    "StageCounters",
+    "Strapdown",
+    "UpdateStrategy",
+    "leastsquares",
+    "navsense",
+]
+
+class FusionEngine:
+    """
+
+    FusionEngine
+    ===
+
+    Time-tagged multi-rate fusion of IMU and GNSS measurements with out-of-sequence
+    measurements handled by rolling back to checkpoints.
+
+    """
+
+    n_dropped_: int
+    n_late_: int
+    n_replays_: int
+    def AddAttitude(
+        self,
+        t: float,
+        C: numpy.ndarray[numpy.float64[3, 3], numpy.ndarray.flags.f_contiguous],
+        R: numpy.ndarray[numpy.float64[3, 3], numpy.ndarray.flags.f_contiguous],
+    ) -> bool:
+        """
+        AddAttitude
+        ===========
+
+        Buffer an attitude measurement (see InertialNav.AttitudeUpdate)
+
+        Parameters
+        ----------
+
+        t : double
+
+            Measurement time [s]
+
+        C : np.ndarray
+
+            Measured body-to-ned rotation matrix
+
+        R : np.ndarray
+
+            Attitude error covariance (small angles about the ned axes) [rad^2]
+
+        Returns
+        -------
+
+        accepted : bool
+
+            False if the measurement was dropped
+        """
+
+    def AddGnss(
+        self,
+        t: float,
+        sv_pos: numpy.ndarray[numpy.float64[3, n], numpy.ndarray.flags.f_contiguous],
+        sv_vel: numpy.ndarray[numpy.float64[3, n], numpy.ndarray.flags.f_contiguous],
+        psr: numpy.ndarray[numpy.float64[m, 1]],
+        psrdot: numpy.ndarray[numpy.float64[m, 1]],
+        psr_var: numpy.ndarray[numpy.float64[m, 1]],
+        psrdot_var: numpy.ndarray[numpy.float64[m, 1]],
+    ) -> bool:
+        """
+        AddGnss
+        =======
+
+        Buffer a GNSS epoch, an epoch older than the filter time rolls the filter back to the
+        newest checkpoint before it and re-runs the buffered IMU samples
+
+        Parameters
+        ----------
+
+        t : double
+
+            Measurement time [s]
+
+        sv_pos : np.ndarray
+
+            Satellite ECEF positions, one satellite per column [m]
+
+        sv_vel : np.ndarray
+
+            Satellite ECEF velocities, one satellite per column [m/s]
+
+        psr : np.ndarray
+
+            Pseudorange measurements [m]
+
+        psrdot : np.ndarray
+
+            Pseudorange-rate measurements [m/s]
+
+        psr_var : np.ndarray
+
+            Pseudorange measurement variance [m^2]
+
+        psrdot_var : np.ndarray
+
+            Pseudorange-rate measurement variance [(m/s)^2]
+
+        Returns
+        -------
+
+        accepted : bool
+
+            False if the measurement was dropped
+        """
+
+    def AddImu(
+        self,
+        t: float,
+        wb: numpy.ndarray[numpy.float64[3, 1]],
+        fb: numpy.ndarray[numpy.float64[3, 1]],
+    ) -> bool:
+        """
+        AddImu
+        ======
+
+        Mechanize and propagate through an IMU sample, applying the buffered measurements that
+        fall inside it
+
+        Parameters
+        ----------
+
+        t : double
+
+            Time at the end of the sample interval [s] (must increase)
+
+        wb : np.ndarray
+
+            Measured angular rates in the body frame [rad/s]
+
+        fb : np.ndarray
+
+            Measured specific forces in the body frame [m/s^2]
+
+        Returns
+        -------
+
+        accepted : bool
+
+            False if the sample is not newer than the filter time
+        """
+
+    def AddPhasedArray(
+        self,
+        t: float,
+        sv_pos: numpy.ndarray[numpy.float64[3, n], numpy.ndarray.flags.f_contiguous],
+        sv_vel: numpy.ndarray[numpy.float64[3, n], numpy.ndarray.flags.f_contiguous],
+        psr: numpy.ndarray[numpy.float64[m, 1]],
+        psrdot: numpy.ndarray[numpy.float64[m, 1]],
+        phase: numpy.ndarray[numpy.float64[m, n], numpy.ndarray.flags.f_contiguous],
+        psr_var: numpy.ndarray[numpy.float64[m, 1]],
+        psrdot_var: numpy.ndarray[numpy.float64[m, 1]],
+        phase_var: numpy.ndarray[numpy.float64[m, n], numpy.ndarray.flags.f_contiguous],
+        ant_xyz: numpy.ndarray[numpy.float64[3, n], numpy.ndarray.flags.f_contiguous],
+        n_ant: int,
+        lamb: float,
+    ) -> bool:
+        """
+        AddPhasedArray
+        ==============
+
+        Buffer a phased array GNSS epoch (see InertialNav.PhasedArrayUpdate)
+
+        Returns
+        -------
+
+        accepted : bool
+
+            False if the measurement was dropped
+        """
+
+    def Filter(self) -> InertialNav:
+        """
+        Filter
+        ======
+
+        Navigation filter at the time of the latest IMU sample
+        """
+
+    def NumPending(self) -> int: ...
+    def Time(self) -> float: ...
+    def __init__(
+        self,
+        filt: InertialNav,
+        t0: float,
+        lag: float = 0.5,
+        max_imu: int = 1024,
+        ckpt_interval: int = 10,
+        max_meas: int = 32,
+    ) -> None: ...
 
 class InertialNav:
     """
@@ -38,18 +251,85 @@ class InertialNav:
     """
 
     C_b_l_: numpy.ndarray[numpy.float64[3, 3]]
-    P_: numpy.ndarray[numpy.float64[m, n]]
+    P_: numpy.ndarray[numpy.float64[17, 17]]
     ba_: numpy.ndarray[numpy.float64[3, 1]]
     bg_: numpy.ndarray[numpy.float64[3, 1]]
     cb_: float
     cd_: float
+    ecef_p_: numpy.ndarray[numpy.float64[3, 1]]
+    ecef_v_: numpy.ndarray[numpy.float64[3, 1]]
     h_: float
     lam_: float
     phi_: float
     q_b_l_: numpy.ndarray[numpy.float64[4, 1]]
+    rejected_: numpy.ndarray[bool[m, 1]]
     vd_: float
     ve_: float
     vn_: float
+    def AttitudeUpdate(
+        self,
+        C: numpy.ndarray[numpy.float64[3, 3], numpy.ndarray.flags.f_contiguous],
+        R: numpy.ndarray[numpy.float64[3, 3], numpy.ndarray.flags.f_contiguous],
+    ) -> None:
+        """
+        AttitudeUpdate
+        ==============
+
+        Update the navigator attitude with an attitude measurement
+
+        Parameters
+        ----------
+
+        C : np.ndarray
+
+            Measured body-to-ned rotation matrix
+
+        R : np.ndarray
+
+            Attitude error covariance (small angles about the ned axes) [rad^2]
+        """
+
+    def FlushPropagation(self) -> None:
+        """
+        FlushPropagation
+        ================
+
+        Apply the accumulated covariance propagation so P_ is current
+        """
+
+    def GetProcessNoiseModel(self) -> navsense.ProcessNoiseModel:
+        """
+        GetProcessNoiseModel
+        ====================
+
+        Process noise model used by the filter
+
+        Returns
+        -------
+
+        model : ProcessNoiseModel
+
+            Process noise model
+        """
+
+    def GetStateVector(
+        self, x: numpy.ndarray[numpy.float64[m, 1], numpy.ndarray.flags.writeable]
+    ) -> None:
+        """
+        GetStateVector
+        ==============
+
+        Copy the navigation states into a caller-provided buffer (does not allocate)
+
+        Parameters
+        ----------
+
+        x : np.ndarray
+
+            Writable, contiguous float64 buffer of 18 elements, filled with
+            [lat, lon, alt, vn, ve, vd, q0, q1, q2, q3, bgx, bgy, bgz, bax, bay, baz, cb, cd]
+        """
+
     def GnssUpdate(
         self,
         sv_pos: numpy.ndarray[numpy.float64[m, n], numpy.ndarray.flags.f_contiguous],
@@ -121,6 +401,35 @@ class InertialNav:
             Integration time [s]
         """
 
+    def MechanizeIncrements(
+        self,
+        dtheta: numpy.ndarray[numpy.float64[3, n], numpy.ndarray.flags.f_contiguous],
+        dvel: numpy.ndarray[numpy.float64[3, n], numpy.ndarray.flags.f_contiguous],
+        dt: float,
+    ) -> None:
+        """
+        MechanizeIncrements
+        ===================
+
+        Integrate a burst of high rate IMU increments as a single navigation update with coning
+        and sculling corrections, the navigation frame terms are evaluated once per burst
+
+        Parameters
+        ----------
+
+        dtheta : np.ndarray
+
+            Delta thetas in the body frame, one IMU sample per column (3xN) [rad]
+
+        dvel : np.ndarray
+
+            Delta velocities in the body frame, one IMU sample per column (3xN) [m/s]
+
+        dt : double
+
+            IMU sample interval [s]
+        """
+
     def PhasedArrayUpdate(
         self,
         sv_pos: numpy.ndarray[numpy.float64[3, n], numpy.ndarray.flags.f_contiguous],
@@ -217,7 +526,148 @@ class InertialNav:
             Integration time [s]
         """
 
+    def PropagateIncrements(
+        self,
+        dtheta: numpy.ndarray[numpy.float64[3, n], numpy.ndarray.flags.f_contiguous],
+        dvel: numpy.ndarray[numpy.float64[3, n], numpy.ndarray.flags.f_contiguous],
+        dt: float,
+    ) -> None:
+        """
+        PropagateIncrements
+        ===================
+
+        MechanizeIncrements followed by Propagate over the whole burst with its coning and
+        sculling compensated mean angular rate and specific force
+
+        Parameters
+        ----------
+
+        dtheta : np.ndarray
+
+            Delta thetas in the body frame, one IMU sample per column (3xN) [rad]
+
+        dvel : np.ndarray
+
+            Delta velocities in the body frame, one IMU sample per column (3xN) [m/s]
+
+        dt : double
+
+            IMU sample interval [s]
+        """
+
+    def RestoreSnapshot(self, snap: InertialNavSnapshot) -> None:
+        """
+        RestoreSnapshot
+        ===============
+
+        Set the navigation states, clock and covariance from a snapshot
+
+        Parameters
+        ----------
+
+        snap : InertialNavSnapshot
+
+            Snapshot from SaveSnapshot
+        """
+
+    def Run(
+        self,
+        imu_t: numpy.ndarray[numpy.float64[m, 1]],
+        imu_wb: numpy.ndarray[numpy.float64[m, 3]],
+        imu_fb: numpy.ndarray[numpy.float64[m, 3]],
+        gnss_t: numpy.ndarray[numpy.float64[m, 1]],
+        offsets: numpy.ndarray[numpy.int32[m, 1]],
+        sv_pos: numpy.ndarray[numpy.float64[m, 3]],
+        sv_vel: numpy.ndarray[numpy.float64[m, 3]],
+        psr: numpy.ndarray[numpy.float64[m, 1]],
+        psrdot: numpy.ndarray[numpy.float64[m, 1]],
+        psrvar: numpy.ndarray[numpy.float64[m, 1]],
+        psrdotvar: numpy.ndarray[numpy.float64[m, 1]],
+    ) -> tuple:
+        """
+        Run
+        ===
+
+        Process an entire IMU/GNSS log natively (the GIL is released). Every IMU sample is
+        mechanized and propagated, GNSS epochs are applied after the first IMU sample at or past
+        their time.
+
+        Parameters
+        ----------
+
+        imu_t : np.ndarray
+
+            IMU sample times [s]
+
+        imu_wb : np.ndarray
+
+            IMU angular rates, one sample per row [rad/s]
+
+        imu_fb : np.ndarray
+
+            IMU specific forces, one sample per row [m/s^2]
+
+        gnss_t : np.ndarray
+
+            GNSS epoch times [s]
+
+        offsets : np.ndarray
+
+            First measurement row of each epoch (len(gnss_t) + 1 entries)
+
+        sv_pos : np.ndarray
+
+            Satellite ECEF positions of all epochs, one satellite per row [m]
+
+        sv_vel : np.ndarray
+
+            Satellite ECEF velocities of all epochs, one satellite per row [m/s]
+
+        psr : np.ndarray
+
+            Pseudorange measurements of all epochs [m]
+
+        psrdot : np.ndarray
+
+            Pseudorange-rate measurements of all epochs [m/s]
+
+        psrvar : np.ndarray
+
+            Pseudorange measurement variance of all epochs [m^2]
+
+        psrdotvar : np.ndarray
+
+            Pseudorange-rate measurement variance of all epochs [(m/s)^2]
+
+        Returns
+        -------
+
+        states : np.ndarray
+
+            States per IMU sample (lat, lon, alt, vn, ve, vd, q0, q1, q2, q3, bgx, bgy, bgz,
+            bax, bay, baz, cb, cd)
+
+        cov_diag : np.ndarray
+
+            Error state covariance diagonal per IMU sample
+        """
+
     @typing.overload
+    def SaveSnapshot(self, snap: InertialNavSnapshot) -> None:
+        """
+        SaveSnapshot
+        ============
+
+        Copy the navigation states, clock and covariance into a snapshot
+
+        Parameters
+        ----------
+
+        snap : InertialNavSnapshot
+
+            Output snapshot
+        """
+
     def SetAttitude(
         self, C: numpy.ndarray[numpy.float64[3, 3], numpy.ndarray.flags.f_contiguous]
     ) -> None:
@@ -328,6 +778,22 @@ class InertialNav:
             Gyroscope random walk [deg/sqrt(hr)]
         """
 
+    def SetInnovationGate(self, gate: float) -> None:
+        """
+        SetInnovationGate
+        =================
+
+        Reject measurements whose normalized innovation exceeds the gate, the rejected
+        measurements of the most recent update are listed in rejected_
+
+        Parameters
+        ----------
+
+        gate : double
+
+            Innovation gate [sigma] (0 disables gating, default)
+        """
+
     def SetPosition(self, lat: float, lon: float, alt: float) -> None:
         """
         SetPosition
@@ -351,46 +817,216 @@ class InertialNav:
             Altitude/Height [m]
         """
 
+    def SetProcessNoiseModel(self, model: navsense.ProcessNoiseModel) -> None:
+        """
+        SetProcessNoiseModel
+        ====================
+
+        Use a (shared) process noise model instead of the one built by SetImuSpec and
+        SetClockSpec (the KinematicNav parameters of the model are unused)
+
+        Parameters
+        ----------
+
+        model : ProcessNoiseModel
+
+            Process noise model
+        """
+
+    def SetPropagationInterval(self, n: int) -> None:
+        """
+        SetPropagationInterval
+        ======================
+
+        Propagate the covariance once every n calls to Propagate, the transition and process
+        noise are accumulated in between (updates always apply pending propagation first)
+
+        Parameters
+        ----------
+
+        n : int
+
+            Number of Propagate calls per covariance propagation (1 propagates every call)
+        """
+
+    def SetSquareRoot(self, sqrt_form: bool) -> None:
+        """
+        SetSquareRoot
+        =============
+
+        Carry a square root of the covariance (P_ = S*S') with QR propagation and Potter's
+        measurement update, the current P_ is factored when enabled and no settling iterations
+        are run
+
+        Parameters
+        ----------
+
+        sqrt_form : bool
+
+            True to use the square root covariance form
+        """
+
+    def SetUpdateStrategy(self, strategy: UpdateStrategy) -> None:
+        """
+        SetUpdateStrategy
+        =================
+
+        Choose between batch and sequential (scalar) measurement updates
+
+        Parameters
+        ----------
+
+        strategy : UpdateStrategy
+
+            UpdateStrategy.BATCH (default) or UpdateStrategy.SEQUENTIAL
+        """
+
     def SetVelocity(self, vn: float, ve: float, vd: float) -> None:
         """
-        SetVelocity
-        ===========
+        SetVelocity
+        ===========
+
+        Set the velocity of the navigator
+
+        Parameters
+        ----------
+
+        vn : double
+
+            north velocity [m/s]
+
+        ve : double
+
+            east velocity [m/s]
+
+        vd : double
+
+            down velocity [m/s]
+        """
+
+    @typing.overload
+    def __init__(self) -> None: ...
+    @typing.overload
+    def __init__(
+        self,
+        lat: float,
+        lon: float,
+        alt: float,
+        vn: float,
+        ve: float,
+        vd: float,
+        r: float,
+        p: float,
+        y: float,
+        cb: float,
+        cd: float,
+    ) -> None: ...
+
+class InertialNavSmoother:
+    """
+
+    InertialNavSmoother
+    ===
+
+    Fixed-interval RTS smoother over a recorded InertialNav run.
+
+    """
+
+    def BytesPerEpoch(self) -> int: ...
+    def Record(self, t: float, filt: InertialNav) -> bool:
+        """
+        Record
+        ======
+
+        Store the filter at the end of an epoch, after its measurement updates
+
+        Parameters
+        ----------
+
+        t : double
+
+            Epoch time [s]
+
+        filt : InertialNav
+
+            Navigation filter
+
+        Returns
+        -------
+
+        stored : bool
+
+            False if the epoch could not be stored
+        """
+
+    def Size(self) -> int: ...
+    def Smooth(self, n_seg: int = 1) -> tuple:
+        """
+        Smooth
+        ======
+
+        Run the backward pass over all recorded epochs
+
+        Parameters
+        ----------
+
+        n_seg : int
+
+            Number of segments smoothed in parallel
+
+        Returns
+        -------
+
+        t : np.ndarray
+
+            Epoch times [s]
+
+        states : np.ndarray
+
+            Smoothed states per epoch (see GetStateVector)
+
+        cov_diag : np.ndarray
+
+            Smoothed error state covariance diagonal per epoch
+        """
+
+    def __init__(self, chunk_size: int = 4096, spill_file: str = "") -> None: ...
+
+class InertialNavSnapshot:
+    """
+
+    InertialNavSnapshot
+    ===
+
+    Fixed-size snapshot of the InertialNav states, clock and covariance.
+
+    """
+
+    is_init_: bool
+    def FromBytes(self, b: bytes) -> None:
+        """
+        FromBytes
+        =========
 
-        Set the velocity of the navigator
+        Set the snapshot from bytes written by ToBytes
 
         Parameters
         ----------
 
-        vn : double
-
-            north velocity [m/s]
-
-        ve : double
+        b : bytes
 
-            east velocity [m/s]
+            Serialized snapshot
+        """
 
-        vd : double
+    def ToBytes(self) -> bytes:
+        """
+        ToBytes
+        =======
 
-            down velocity [m/s]
+        Serialize the snapshot (native byte order)
         """
 
-    @typing.overload
     def __init__(self) -> None: ...
-    @typing.overload
-    def __init__(
-        self,
-        lat: float,
-        lon: float,
-        alt: float,
-        vn: float,
-        ve: float,
-        vd: float,
-        r: float,
-        p: float,
-        y: float,
-        cb: float,
-        cd: float,
-    ) -> None: ...
 
 class KinematicNav:
     """
@@ -406,10 +1042,13 @@ class KinematicNav:
     P_: numpy.ndarray[numpy.float64[11, 11]]
     cb_: float
     cd_: float
+    ecef_p_: numpy.ndarray[numpy.float64[3, 1]]
+    ecef_v_: numpy.ndarray[numpy.float64[3, 1]]
     h_: float
     lam_: float
     phi_: float
     q_b_l_: numpy.ndarray[numpy.float64[4, 1]]
+    rejected_: numpy.ndarray[bool[m, 1]]
     vd_: float
     ve_: float
     vn_: float
@@ -436,6 +1075,39 @@ class KinematicNav:
             DCM variance
         """
 
+    def GetProcessNoiseModel(self) -> navsense.ProcessNoiseModel:
+        """
+        GetProcessNoiseModel
+        ====================
+
+        Process noise model used by the filter
+
+        Returns
+        -------
+
+        model : ProcessNoiseModel
+
+            Process noise model
+        """
+
+    def GetStateVector(
+        self, x: numpy.ndarray[numpy.float64[m, 1], numpy.ndarray.flags.writeable]
+    ) -> None:
+        """
+        GetStateVector
+        ==============
+
+        Copy the navigation states into a caller-provided buffer (does not allocate)
+
+        Parameters
+        ----------
+
+        x : np.ndarray
+
+            Writable, contiguous float64 buffer of 12 elements, filled with
+            [lat, lon, alt, vn, ve, vd, q0, q1, q2, q3, cb, cd]
+        """
+
     def GnssUpdate(
         self,
         sv_pos: numpy.ndarray[numpy.float64[3, n], numpy.ndarray.flags.f_contiguous],
@@ -562,7 +1234,102 @@ class KinematicNav:
             Integration time [s]
         """
 
+    def RestoreSnapshot(self, snap: KinematicNavSnapshot) -> None:
+        """
+        RestoreSnapshot
+        ===============
+
+        Set the navigation states, clock and covariance from a snapshot
+
+        Parameters
+        ----------
+
+        snap : KinematicNavSnapshot
+
+            Snapshot from SaveSnapshot
+        """
+
+    def Run(
+        self,
+        gnss_t: numpy.ndarray[numpy.float64[m, 1]],
+        offsets: numpy.ndarray[numpy.int32[m, 1]],
+        sv_pos: numpy.ndarray[numpy.float64[m, 3]],
+        sv_vel: numpy.ndarray[numpy.float64[m, 3]],
+        psr: numpy.ndarray[numpy.float64[m, 1]],
+        psrdot: numpy.ndarray[numpy.float64[m, 1]],
+        psrvar: numpy.ndarray[numpy.float64[m, 1]],
+        psrdotvar: numpy.ndarray[numpy.float64[m, 1]],
+    ) -> tuple:
+        """
+        Run
+        ===
+
+        Process an entire GNSS log natively (the GIL is released). The filter is propagated to
+        and corrected with every epoch, the first epoch is not propagated.
+
+        Parameters
+        ----------
+
+        gnss_t : np.ndarray
+
+            GNSS epoch times [s]
+
+        offsets : np.ndarray
+
+            First measurement row of each epoch (len(gnss_t) + 1 entries)
+
+        sv_pos : np.ndarray
+
+            Satellite ECEF positions of all epochs, one satellite per row [m]
+
+        sv_vel : np.ndarray
+
+            Satellite ECEF velocities of all epochs, one satellite per row [m/s]
+
+        psr : np.ndarray
+
+            Pseudorange measurements of all epochs [m]
+
+        psrdot : np.ndarray
+
+            Pseudorange-rate measurements of all epochs [m/s]
+
+        psrvar : np.ndarray
+
+            Pseudorange measurement variance of all epochs [m^2]
+
+        psrdotvar : np.ndarray
+
+            Pseudorange-rate measurement variance of all epochs [(m/s)^2]
+
+        Returns
+        -------
+
+        states : np.ndarray
+
+            States per epoch (lat, lon, alt, vn, ve, vd, q0, q1, q2, q3, cb, cd)
+
+        cov_diag : np.ndarray
+
+            Error state covariance diagonal per epoch
+        """
+
     @typing.overload
+    def SaveSnapshot(self, snap: KinematicNavSnapshot) -> None:
+        """
+        SaveSnapshot
+        ============
+
+        Copy the navigation states, clock and covariance into a snapshot
+
+        Parameters
+        ----------
+
+        snap : KinematicNavSnapshot
+
+            Output snapshot
+        """
+
     def SetAttitude(
         self, C: numpy.ndarray[numpy.float64[3, 3], numpy.ndarray.flags.f_contiguous]
     ) -> None:
@@ -646,6 +1413,22 @@ class KinematicNav:
             random walk frequency modulation
         """
 
+    def SetInnovationGate(self, gate: float) -> None:
+        """
+        SetInnovationGate
+        =================
+
+        Reject measurements whose normalized innovation exceeds the gate, the rejected
+        measurements of the most recent update are listed in rejected_
+
+        Parameters
+        ----------
+
+        gate : double
+
+            Innovation gate [sigma] (0 disables gating, default)
+        """
+
     def SetPosition(self, lat: float, lon: float, alt: float) -> None:
         """
         SetPosition
@@ -688,6 +1471,38 @@ class KinematicNav:
             PSD of expected angular rate white noise [(rad/s)^2]
         """
 
+    def SetProcessNoiseModel(self, model: navsense.ProcessNoiseModel) -> None:
+        """
+        SetProcessNoiseModel
+        ====================
+
+        Use a (shared) process noise model instead of the one built by SetClockSpec and
+        SetProcessNoise (the IMU parameters of the model are unused and its clock has no 10%
+        margin)
+
+        Parameters
+        ----------
+
+        model : ProcessNoiseModel
+
+            Process noise model
+        """
+
+    def SetUpdateStrategy(self, strategy: UpdateStrategy) -> None:
+        """
+        SetUpdateStrategy
+        =================
+
+        Choose between batch and sequential (scalar) measurement updates
+
+        Parameters
+        ----------
+
+        strategy : UpdateStrategy
+
+            UpdateStrategy.BATCH (default) or UpdateStrategy.SEQUENTIAL
+        """
+
     def SetVelocity(self, vn: float, ve: float, vd: float) -> None:
         """
         SetVelocity
@@ -741,6 +1556,172 @@ class KinematicNav:
         cd: float,
     ) -> None: ...
 
+class KinematicNavSmoother:
+    """
+
+    KinematicNavSmoother
+    ===
+
+    Fixed-interval RTS smoother over a recorded KinematicNav run.
+
+    """
+
+    def BytesPerEpoch(self) -> int: ...
+    def Record(self, t: float, filt: KinematicNav) -> bool:
+        """
+        Record
+        ======
+
+        Store the filter at the end of an epoch, after its measurement updates
+
+        Parameters
+        ----------
+
+        t : double
+
+            Epoch time [s]
+
+        filt : KinematicNav
+
+            Navigation filter
+
+        Returns
+        -------
+
+        stored : bool
+
+            False if the epoch could not be stored
+        """
+
+    def Size(self) -> int: ...
+    def Smooth(self, n_seg: int = 1) -> tuple:
+        """
+        Smooth
+        ======
+
+        Run the backward pass over all recorded epochs
+
+        Parameters
+        ----------
+
+        n_seg : int
+
+            Number of segments smoothed in parallel
+
+        Returns
+        -------
+
+        t : np.ndarray
+
+            Epoch times [s]
+
+        states : np.ndarray
+
+            Smoothed states per epoch (see GetStateVector)
+
+        cov_diag : np.ndarray
+
+            Smoothed error state covariance diagonal per epoch
+        """
+
+    def __init__(self, chunk_size: int = 4096, spill_file: str = "") -> None: ...
+
+class KinematicNavSnapshot:
+    """
+
+    KinematicNavSnapshot
+    ===
+
+    Fixed-size snapshot of the KinematicNav states, clock and covariance.
+
+    """
+
+    is_init_: bool
+    def FromBytes(self, b: bytes) -> None:
+        """
+        FromBytes
+        =========
+
+        Set the snapshot from bytes written by ToBytes
+
+        Parameters
+        ----------
+
+        b : bytes
+
+            Serialized snapshot
+        """
+
+    def ToBytes(self) -> bytes:
+        """
+        ToBytes
+        =======
+
+        Serialize the snapshot (native byte order)
+        """
+
+    def __init__(self) -> None: ...
+
+class Stage:
+    """
+
+    Stage
+    =====
+
+    Instrumented stages of the library.
+
+    Members:
+
+      MECHANIZE
+
+      PROPAGATE
+
+      MEASUREMENT_MODEL
+
+      KALMAN_UPDATE
+
+      GNSS_PVT_ITERATION
+
+      MUSIC_LEVEL
+    """
+
+    GNSS_PVT_ITERATION: typing.ClassVar[Stage]  # value = <Stage.GNSS_PVT_ITERATION: 4>
+    KALMAN_UPDATE: typing.ClassVar[Stage]  # value = <Stage.KALMAN_UPDATE: 3>
+    MEASUREMENT_MODEL: typing.ClassVar[Stage]  # value = <Stage.MEASUREMENT_MODEL: 2>
+    MECHANIZE: typing.ClassVar[Stage]  # value = <Stage.MECHANIZE: 0>
+    MUSIC_LEVEL: typing.ClassVar[Stage]  # value = <Stage.MUSIC_LEVEL: 5>
+    PROPAGATE: typing.ClassVar[Stage]  # value = <Stage.PROPAGATE: 1>
+    __members__: typing.ClassVar[
+        dict[str, Stage]
+    ]  # value = {'MECHANIZE': <Stage.MECHANIZE: 0>, 'PROPAGATE': <Stage.PROPAGATE: 1>, 'MEASUREMENT_MODEL': <Stage.MEASUREMENT_MODEL: 2>, 'KALMAN_UPDATE': <Stage.KALMAN_UPDATE: 3>, 'GNSS_PVT_ITERATION': <Stage.GNSS_PVT_ITERATION: 4>, 'MUSIC_LEVEL': <Stage.MUSIC_LEVEL: 5>}
+    def __eq__(self, other: typing.Any) -> bool: ...
+    def __getstate__(self) -> int: ...
+    def __hash__(self) -> int: ...
+    def __index__(self) -> int: ...
+    def __init__(self, value: int) -> None: ...
+    def __int__(self) -> int: ...
+    def __ne__(self, other: typing.Any) -> bool: ...
+    def __repr__(self) -> str: ...
+    def __setstate__(self, state: int) -> None: ...
+    def __str__(self) -> str: ...
+    @property
+    def name(self) -> str: ...
+    @property
+    def value(self) -> int: ...
+
+class StageCounters:
+    """
+
+    StageCounters
+    =============
+
+    Totals of a stage over all threads since the last ResetStageCounters.
+
+    """
+
+    calls_: int
+    nanoseconds_: int
+
 class Strapdown:
     """
 
@@ -788,6 +1769,35 @@ class Strapdown:
         """
 
     @typing.overload
+    def MechanizeIncrements(
+        self,
+        dtheta: numpy.ndarray[numpy.float64[3, n], numpy.ndarray.flags.f_contiguous],
+        dvel: numpy.ndarray[numpy.float64[3, n], numpy.ndarray.flags.f_contiguous],
+        dt: float,
+    ) -> None:
+        """
+        MechanizeIncrements
+        ===================
+
+        Integrate a burst of high rate IMU increments as a single navigation update with coning
+        and sculling corrections, the navigation frame terms are evaluated once per burst
+
+        Parameters
+        ----------
+
+        dtheta : np.ndarray
+
+            Delta thetas in the body frame, one IMU sample per column (3xN) [rad]
+
+        dvel : np.ndarray
+
+            Delta velocities in the body frame, one IMU sample per column (3xN) [m/s]
+
+        dt : double
+
+            IMU sample interval [s]
+        """
+
     def SetAttitude(
         self, C: numpy.ndarray[numpy.float64[3, 3], numpy.ndarray.flags.f_contiguous]
     ) -> None:
@@ -891,4 +1901,71 @@ class Strapdown:
         y: float,
     ) -> None: ...
 
+class UpdateStrategy:
+    """
+
+    UpdateStrategy
+    ===
+
+    Measurement update strategy of the navigation filters.
+
+    Members:
+
+      BATCH
+
+      SEQUENTIAL
+    """
+
+    BATCH: typing.ClassVar[UpdateStrategy]  # value = <UpdateStrategy.BATCH: 0>
+    SEQUENTIAL: typing.ClassVar[UpdateStrategy]  # value = <UpdateStrategy.SEQUENTIAL: 1>
+    __members__: typing.ClassVar[
+        dict[str, UpdateStrategy]
+    ]  # value = {'BATCH': <UpdateStrategy.BATCH: 0>, 'SEQUENTIAL': <UpdateStrategy.SEQUENTIAL: 1>}
+    def __eq__(self, other: typing.Any) -> bool: ...
+    def __getstate__(self) -> int: ...
+    def __hash__(self) -> int: ...
+    def __index__(self) -> int: ...
+    def __init__(self, value: int) -> None: ...
+    def __int__(self) -> int: ...
+    def __ne__(self, other: typing.Any) -> bool: ...
+    def __repr__(self) -> str: ...
+    def __setstate__(self, state: int) -> None: ...
+    def __str__(self) -> str: ...
+    @property
+    def name(self) -> str: ...
+    @property
+    def value(self) -> int: ...
+
+def GetStageCounters(stage: Stage) -> StageCounters:
+    """
+    GetStageCounters
+    ================
+
+    Totals of a stage over all threads, always zero unless the library was built with
+    STURDINS_INSTRUMENT
+
+    Parameters
+    ----------
+
+    stage : Stage
+
+        Instrumented stage
+
+    Returns
+    -------
+
+    counters : StageCounters
+
+        Call count and time [ns] of the stage
+    """
+
+def ResetStageCounters() -> None:
+    """
+    ResetStageCounters
+    ==================
+
+    Restart the totals of every stage from zero
+    """
+
+INSTRUMENTATION_ENABLED: bool = False
 __version__: str = "1.0.0"
@@ -8,8 +8,500 @@ Least squares algorithms for initializing the GNSS-InertialNav filter.
 
 from __future__ import annotations
 import numpy
+import typing
+
+__all__ = [
+    "BatchGnssPVT",
+    "GnssPVT",
+    "GnssPVTResult",
+    "GnssPVTWorkspace",
+    "MUSIC",
+    "MusicManifold",
+    "PhasedArrayAttitude",
+    "PhasedArrayAttitudeSolver",
+    "PhasedArrayResult",
+    "RangeAndRate",
+    "RobustLoss",
+    "Wahba",
+]
+
+class GnssPVTResult:
+    """
+
+    GnssPVTResult
+    =============
+
+    Outcome of a GnssPVTWorkspace.SolveRobust, test_stat_ is the sum of the squared
+    normalized residuals (chi-square with dof_ degrees of freedom when fault free)
+
+    """
+
+    converged_: bool
+    cost_: float
+    dof_: int
+    iterations_: int
+    n_outliers_: int
+    test_stat_: float
+
+class GnssPVTWorkspace:
+    """
+
+    GnssPVTWorkspace
+    ================
+
+    Persistent GnssPVT solver, the 8x8 normal equations are accumulated per satellite
+    and only refreshed for satellites whose geometry moved beyond tol
+
+    """
+
+    def Iterations(self) -> int:
+        """
+        Iterations
+        ==========
+
+        Number of iterations of the last Solve
+        """
+
+    def Reset(self) -> None:
+        """
+        Reset
+        =====
+
+        Forget the stored geometry, the next Solve rebuilds the normal equations
+        """
+
+    def RowsRefreshed(self) -> int:
+        """
+        RowsRefreshed
+        =============
+
+        Number of satellite contributions (re)built during the last Solve
+        """
+
+    def Solve(
+        self,
+        x: numpy.ndarray[numpy.float64[m, 1], numpy.ndarray.flags.writeable],
+        P: numpy.ndarray[
+            numpy.float64[m, n], numpy.ndarray.flags.writeable, numpy.ndarray.flags.f_contiguous
+        ],
+        sv_pos: numpy.ndarray[numpy.float64[3, n], numpy.ndarray.flags.f_contiguous],
+        sv_vel: numpy.ndarray[numpy.float64[3, n], numpy.ndarray.flags.f_contiguous],
+        psr: numpy.ndarray[numpy.float64[m, 1]],
+        psrdot: numpy.ndarray[numpy.float64[m, 1]],
+        psrvar: numpy.ndarray[numpy.float64[m, 1]],
+        psrdotvar: numpy.ndarray[numpy.float64[m, 1]],
+    ) -> bool:
+        """
+        Solve
+        =====
+
+        Least Squares solver for GNSS position, velocity, and timing terms, the normal equations
+        of satellites whose geometry did not change are reused from the previous call
+
+        Parameters
+        ----------
+
+        x : np.ndarray
+
+            Initial state estimate
+
+        P : np.ndarray
+
+            Initial covariance estimate
+
+        sv_pos : np.ndarray
+
+            Satellite ECEF positions [m]
+
+        sv_vel : np.ndarray
+
+            Satellite ECEF velocities [m/s]
+
+        psr : np.ndarray
+
+            Pseudorange measurements [m]
+
+        psrdot : np.ndarray
+
+            Pseudorange-rate measurements [m/s]
+
+        psrvar : np.ndarray
+
+            Pseudorange measurement variance [m^2]
+
+        psrdotvar : np.ndarray
+
+            Pseudorange-rate measurement variance [(m/s)^2]
+
+        Returns
+        -------
+
+        status : bool
+
+            Convergence success
+        """
+
+    def SolveRobust(
+        self,
+        x: numpy.ndarray[numpy.float64[m, 1], numpy.ndarray.flags.writeable],
+        P: numpy.ndarray[
+            numpy.float64[m, n], numpy.ndarray.flags.writeable, numpy.ndarray.flags.f_contiguous
+        ],
+        sv_pos: numpy.ndarray[numpy.float64[3, n], numpy.ndarray.flags.f_contiguous],
+        sv_vel: numpy.ndarray[numpy.float64[3, n], numpy.ndarray.flags.f_contiguous],
+        psr: numpy.ndarray[numpy.float64[m, 1]],
+        psrdot: numpy.ndarray[numpy.float64[m, 1]],
+        psrvar: numpy.ndarray[numpy.float64[m, 1]],
+        psrdotvar: numpy.ndarray[numpy.float64[m, 1]],
+        loss: RobustLoss = RobustLoss.HUBER,
+        k: float = 1.345,
+        max_iter: int = 20,
+    ) -> GnssPVTResult:
+        """
+        SolveRobust
+        ===========
+
+        Levenberg-Marquardt solver for GNSS position, velocity, and timing terms, the residuals
+        are reweighted with a robust loss once the least squares fit settles
+
+        Parameters
+        ----------
+
+        x : np.ndarray
+
+            Initial state estimate
+
+        P : np.ndarray
+
+            Covariance estimate
+
+        sv_pos : np.ndarray
+
+            Satellite ECEF positions [m]
+
+        sv_vel : np.ndarray
+
+            Satellite ECEF velocities [m/s]
+
+        psr : np.ndarray
+
+            Pseudorange measurements [m]
+
+        psrdot : np.ndarray
+
+            Pseudorange-rate measurements [m/s]
+
+        psrvar : np.ndarray
+
+            Pseudorange measurement variance [m^2]
+
+        psrdotvar : np.ndarray
+
+            Pseudorange-rate measurement variance [(m/s)^2]
+
+        loss : RobustLoss
+
+            Robust loss
+
+        k : float
+
+            Loss threshold on the normalized residual (1.345 Huber, 4.685 Tukey)
+
+        max_iter : int
+
+            Iteration limit
+
+        Returns
+        -------
+
+        result : GnssPVTResult
+
+            Convergence, final cost and residual test statistic
+        """
+
+    def __init__(self, tol: float = 1e-06) -> None: ...
+
+class MusicManifold:
+    """
+
+    MusicManifold
+    =============
+
+    MUSIC estimator for a fixed antenna array, the cos/sin of every baseline phase on
+    the coarse grid is cached at construction
+
+    """
+
+    def Estimate(
+        self, P: numpy.ndarray[numpy.complex128[m, 1]], thresh: float = 0.0001
+    ) -> tuple[float, float]:
+        """
+        Estimate
+        ========
+
+        MUSIC estimate using Prompt correlators (I & Q), the cached grid is refined by 10x around
+        the peak until the resolution reaches thresh
+
+        Parameters
+        ----------
+
+        P : np.ndarray
+
+            Measured prompt correlators
+
+        thresh : double
+
+            Desired threshold of convergence
+
+        Returns
+        -------
+
+        az_mean : double
+
+            Azimuth estimate [rad]
+
+        el_mean : double
+
+            Elevation estimate [rad]
+        """
+
+    def GridSize(self) -> int:
+        """
+        GridSize
+        ========
+
+        Number of (az, el) points in the cached coarse grid
+        """
+
+    def MemoryFootprint(self) -> int:
+        """
+        MemoryFootprint
+        ===============
+
+        Memory held by the cached manifold and the estimator buffers [bytes]
+        """
+
+    def __init__(
+        self,
+        ant_xyz: numpy.ndarray[numpy.float64[3, n], numpy.ndarray.flags.f_contiguous],
+        n_ant: int,
+        lamb: float,
+        res: float = 0.017453292519943295,
+    ) -> None: ...
+
+class PhasedArrayAttitudeSolver:
+    """
+
+    PhasedArrayAttitudeSolver
+    =========================
+
+    Persistent PhasedArrayAttitude solver for calling once per epoch, reports the
+    iterations through a PhasedArrayResult and can warm start from the previous solution
 
-__all__ = ["GnssPVT", "MUSIC", "PhasedArrayAttitude", "RangeAndRate", "Wahba"]
+    """
+
+    def Reset(self) -> None:
+        """
+        Reset
+        =====
+
+        Forget the previous solution
+        """
+
+    def Solve(
+        self,
+        C_b_l: numpy.ndarray[
+            numpy.float64[3, 3], numpy.ndarray.flags.writeable, numpy.ndarray.flags.f_contiguous
+        ],
+        u_ned: numpy.ndarray[numpy.float64[3, n], numpy.ndarray.flags.f_contiguous],
+        phase: numpy.ndarray[numpy.float64[m, n], numpy.ndarray.flags.f_contiguous],
+        phasevar: numpy.ndarray[numpy.float64[m, n], numpy.ndarray.flags.f_contiguous],
+        ant_xyz: numpy.ndarray[numpy.float64[m, n], numpy.ndarray.flags.f_contiguous],
+        n_ant: int,
+        lamb: float,
+        warm_start: bool = False,
+    ) -> PhasedArrayResult:
+        """
+        Solve
+        =====
+
+        Iterative attitude estimate based on the known spatial phase of an antenna array
+
+        Parameters
+        ----------
+
+        C_b_l : np.ndarray
+
+            Initial estimate of the body to local-nav frame attitude dcm (solution on return)
+
+        u_ned : np.ndarray
+
+            3 x n_sv Ephemeris based unit vectors in the local-nav frame
+
+        phase : np.ndarray
+
+            n_ant x n_sv matrix of measured differential gnss phase values
+
+        phasevar : np.ndarray
+
+            Variance of each phase measurement
+
+        ant_xyz : np.ndarray
+
+            Known antenna positions in the body frame
+
+        n_ant : int
+
+            Known number of antennas in the array
+
+        lamb : double
+
+            Wavelength for the signal of interest [m/rad]
+
+        warm_start : bool
+
+            Start from the previous solution instead of C_b_l (if there is one)
+
+        Returns
+        -------
+
+        result : PhasedArrayResult
+
+            Convergence and iteration count
+        """
+
+    def __init__(self, thresh: float = 1e-06, max_iter: int = 10) -> None: ...
+
+class PhasedArrayResult:
+    """
+
+    PhasedArrayResult
+    =================
+
+    Outcome of a PhasedArrayAttitudeSolver.Solve
+
+    """
+
+    converged_: bool
+    iterations_: int
+    step_: float
+
+class RobustLoss:
+    """
+
+    RobustLoss
+    ==========
+
+    Loss applied to the normalized residuals by GnssPVTWorkspace.SolveRobust
+
+    Members:
+
+      NONE
+
+      HUBER
+
+      TUKEY
+    """
+
+    HUBER: typing.ClassVar[RobustLoss]  # value = <RobustLoss.HUBER: 1>
+    NONE: typing.ClassVar[RobustLoss]  # value = <RobustLoss.NONE: 0>
+    TUKEY: typing.ClassVar[RobustLoss]  # value = <RobustLoss.TUKEY: 2>
+    __members__: typing.ClassVar[
+        dict[str, RobustLoss]
+    ]  # value = {'NONE': <RobustLoss.NONE: 0>, 'HUBER': <RobustLoss.HUBER: 1>, 'TUKEY': <RobustLoss.TUKEY: 2>}
+    def __eq__(self, other: typing.Any) -> bool: ...
+    def __getstate__(self) -> int: ...
+    def __hash__(self) -> int: ...
+    def __index__(self) -> int: ...
+    def __init__(self, value: int) -> None: ...
+    def __int__(self) -> int: ...
+    def __ne__(self, other: typing.Any) -> bool: ...
+    def __repr__(self) -> str: ...
+    def __setstate__(self, state: int) -> None: ...
+    def __str__(self) -> str: ...
+    @property
+    def name(self) -> str: ...
+    @property
+    def value(self) -> int: ...
+
+def BatchGnssPVT(
+    x: numpy.ndarray[
+        numpy.float64[8, n], numpy.ndarray.flags.writeable, numpy.ndarray.flags.f_contiguous
+    ],
+    P: numpy.ndarray[
+        numpy.float64[8, n], numpy.ndarray.flags.writeable, numpy.ndarray.flags.f_contiguous
+    ],
+    converged: numpy.ndarray[bool[m, 1], numpy.ndarray.flags.writeable],
+    offsets: numpy.ndarray[numpy.int32[m, 1]],
+    sv_pos: numpy.ndarray[numpy.float64[3, n], numpy.ndarray.flags.f_contiguous],
+    sv_vel: numpy.ndarray[numpy.float64[3, n], numpy.ndarray.flags.f_contiguous],
+    psr: numpy.ndarray[numpy.float64[m, 1]],
+    psrdot: numpy.ndarray[numpy.float64[m, 1]],
+    psrvar: numpy.ndarray[numpy.float64[m, 1]],
+    psrdotvar: numpy.ndarray[numpy.float64[m, 1]],
+    n_threads: int = 0,
+) -> int:
+    """
+    BatchGnssPVT
+    ============
+
+    Solve many independent GnssPVT problems in parallel, the results are identical to GnssPVT
+    and do not depend on the number of threads
+
+    Parameters
+    ----------
+
+    x : np.ndarray
+
+        8xE initial state estimates, one epoch per column (solutions on return)
+
+    P : np.ndarray
+
+        8x8E covariance estimates, epoch e in columns 8e to 8e+7
+
+    converged : np.ndarray
+
+        E convergence flags (bool)
+
+    offsets : np.ndarray
+
+        First satellite column of each epoch (size E + 1, int32)
+
+    sv_pos : np.ndarray
+
+        Satellite ECEF positions of all epochs [m]
+
+    sv_vel : np.ndarray
+
+        Satellite ECEF velocities of all epochs [m/s]
+
+    psr : np.ndarray
+
+        Pseudorange measurements of all epochs [m]
+
+    psrdot : np.ndarray
+
+        Pseudorange-rate measurements of all epochs [m/s]
+
+    psrvar : np.ndarray
+
+        Pseudorange measurement variance of all epochs [m^2]
+
+    psrdotvar : np.ndarray
+
+        Pseudorange-rate measurement variance of all epochs [(m/s)^2]
+
+    n_threads : int
+
+        Worker threads (0 uses every core)
+
+    Returns
+    -------
+
+    n_converged : int
+
+        Number of converged epochs
+    """
 
 def GnssPVT(
     x: numpy.ndarray[numpy.float64[m, 1], numpy.ndarray.flags.writeable],
@@ -80,12 +572,14 @@ def MUSIC(
     n_ant: int,
     lamb: float,
     thresh: float = 0.0001,
+    n_threads: int = 0,
 ) -> tuple[float, float]:
     """
     MUSIC
     ===================
 
-    MUSIC estimator using Prompt correlators (I & Q)
+    MUSIC estimator using Prompt correlators (I & Q), the spectrum is searched on a 1 deg grid
+    which is refined by 10x around the peak until the resolution reaches thresh
 
     Parameters
     ----------
@@ -118,6 +612,10 @@ def MUSIC(
 
         Desired threshold of convergence
 
+    n_threads : int
+
+        Threads used for the coarse grid (0 uses every core)
+
     Returns
     -------
 
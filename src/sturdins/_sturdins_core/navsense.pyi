@@ -9,10 +9,12 @@ Currently Contains the following sensors:
 
 1. `NavigationIMU`
 2. `NavigationClock`
+3. `ProcessNoiseModel`
 
 """
 
 from __future__ import annotations
+import numpy
 
 __all__ = [
     "AUTOMOTIVE",
@@ -26,6 +28,7 @@ __all__ = [
     "NavigationClock",
     "NavigationIMU",
     "OCXO",
+    "ProcessNoiseModel",
     "RUBIDIUM",
     "TACTICAL",
 ]
@@ -65,6 +68,110 @@ class NavigationIMU:
     Tg: float
     def __init__(self) -> None: ...
 
+class ProcessNoiseModel:
+    """
+
+    ProcessNoiseModel
+    =================
+
+    Process noise of InertialNav and KinematicNav built from the clock and IMU Allan
+    variance parameters, the listed integration periods are discretized once and the
+    model can be shared by many filters
+
+    """
+
+    def Clock(self) -> NavigationClock:
+        """
+        Clock
+        =====
+
+        Navigation clock Allan variance parameters of the model
+        """
+
+    def Imu(self) -> NavigationIMU:
+        """
+        Imu
+        ===
+
+        Navigation IMU Allan variance parameters of the model
+        """
+
+    def IsCached(self, dt: float) -> bool:
+        """
+        IsCached
+        ========
+
+        True if the blocks of an integration period were discretized by the constructor
+
+        Parameters
+        ----------
+
+        dt : double
+
+            Integration period [s]
+
+        Returns
+        -------
+
+        cached : bool
+
+            True if dt is cached
+        """
+
+    def Satt(self) -> float:
+        """
+        Satt
+        ====
+
+        KinematicNav attitude process noise PSD of the model
+        """
+
+    def Svel(self) -> float:
+        """
+        Svel
+        ====
+
+        KinematicNav velocity process noise PSD of the model
+        """
+
+    def __init__(
+        self,
+        clock: NavigationClock,
+        imu: NavigationIMU,
+        dt: numpy.ndarray[numpy.float64[m, 1]] = ...,
+        Svel: float = 0.0,
+        Satt: float = 0.0,
+    ) -> None:
+        """
+        ProcessNoiseModel
+        =================
+
+        Constructor
+
+        Parameters
+        ----------
+
+        clock : NavigationClock
+
+            Navigation clock Allan variance parameters
+
+        imu : NavigationIMU
+
+            Navigation IMU Allan variance parameters (units of the NavigationIMU presets)
+
+        dt : np.ndarray
+
+            Integration periods to discretize [s]
+
+        Svel : double
+
+            KinematicNav velocity process noise PSD
+
+        Satt : double
+
+            KinematicNav attitude process noise PSD
+        """
+
 def GetNavClock(clock_name: str) -> NavigationClock:
     """
     GetNavClock
@@ -0,0 +1,141 @@
+/**
+ * *sv-state-cache.cpp*
+ *
+ * =======  ========================================================================================
+ * @file    sturdins/sv-state-cache.cpp
+ * @brief   Satellite states shared by many filters, interpolated from cached ephemeris evaluations.
+ * @date    January 2025
+ * @author  Daniel Sturdivant <sturdivant20@gmail.com>
+ * =======  ========================================================================================
+ */
+
+#include "sturdins/sv-state-cache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <navtools/constants.hpp>
+
+namespace sturdins {
+
+// *=== SvStateCache ===*
+SvStateCache::SvStateCache(
+    const std::vector<satutils::KeplerEphem<double>> &eph, const double &span, const int &order)
+    : eph_(eph.begin(), eph.begin() + std::min<std::size_t>(eph.size(), MAX_SV)),
+      span_{span},
+      evaluations_{0} {
+  Init(order);
+}
+SvStateCache::SvStateCache(
+    const RecordReader<satutils::KeplerElements<double>> &elems,
+    const double &span,
+    const int &order)
+    : span_{span}, evaluations_{0} {
+  const std::size_t N = std::min<std::size_t>(elems.Size(), MAX_SV);
+  eph_.reserve(N);
+  for (std::size_t i = 0; i < N; i++) {
+    eph_.emplace_back(elems[i]);
+  }
+  Init(order);
+}
+
+// *=== Init ===*
+void SvStateCache::Init(const int &order) {
+  n_ = std::clamp(order, 1, MAX_ORDER) + 1;
+
+  // discrete cosine transform of the samples at the nodes x_j = cos(pi * (j + 0.5) / n)
+  fit_.resize(n_, n_);
+  for (int j = 0; j < n_; j++) {
+    for (int k = 0; k < n_; k++) {
+      fit_(j, k) = 2.0 / n_ * std::cos(navtools::PI<> * k * (j + 0.5) / n_);
+    }
+  }
+  fit_.col(0) *= 0.5;
+
+  const int N = Size();
+  samples_.resize(6 * N, n_);
+  for (Segment &seg : seg_) {
+    seg.index_ = -1;
+    seg.coef_.resize(6 * N, n_);
+  }
+}
+
+// *=== Evaluate ===*
+void SvStateCache::Evaluate(
+    const double &t, Eigen::Ref<Eigen::Matrix3Xd> sv_pos, Eigen::Ref<Eigen::Matrix3Xd> sv_vel) {
+  const long index = static_cast<long>(std::floor(t / span_));
+  Segment &seg = seg_[index & 1];
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (seg.index_ == index) {
+      Sum(seg, t, sv_pos, sv_vel);
+      return;
+    }
+  }
+
+  // another thread may have fit the segment between the two locks
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  if (seg.index_ != index) {
+    Fit(seg, index);
+  }
+  Sum(seg, t, sv_pos, sv_vel);
+}
+void SvStateCache::Evaluate(const double &t, GnssEpoch &epoch) {
+  epoch.ToW_ = t;
+  epoch.Resize(Size());
+  Evaluate(t, epoch.sv_pos_, epoch.sv_vel_);
+}
+
+// *=== Size ===*
+int SvStateCache::Size() const {
+  return static_cast<int>(eph_.size());
+}
+
+// *=== Evaluations ===*
+std::size_t SvStateCache::Evaluations() const {
+  return evaluations_.load(std::memory_order_relaxed);
+}
+
+// *=== Fit ===*
+void SvStateCache::Fit(Segment &seg, const long &index) {
+  const int N = Size();
+  const double t0 = index * span_;
+  Eigen::Vector3d sv_clk, sv_pos, sv_vel, sv_acc;
+  for (int j = 0; j < n_; j++) {
+    const double t = t0 + 0.5 * span_ * (1.0 + std::cos(navtools::PI<> * (j + 0.5) / n_));
+    for (int i = 0; i < N; i++) {
+      eph_[i].CalcNavStates<false>(sv_clk, sv_pos, sv_vel, sv_acc, t);
+      samples_.block<3, 1>(6 * i, j) = sv_pos;
+      samples_.block<3, 1>(6 * i + 3, j) = sv_vel;
+    }
+  }
+  evaluations_.fetch_add(static_cast<std::size_t>(n_ * N), std::memory_order_relaxed);
+  seg.coef_.noalias() = samples_ * fit_;
+  seg.index_ = index;
+}
+
+// *=== Sum ===*
+void SvStateCache::Sum(
+    const Segment &seg,
+    const double &t,
+    Eigen::Ref<Eigen::Matrix3Xd> sv_pos,
+    Eigen::Ref<Eigen::Matrix3Xd> sv_vel) const {
+  using Column = Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::ColMajor, 6 * MAX_SV, 1>;
+  const int N = Size();
+  const double x = 2.0 * (t - seg.index_ * span_) / span_ - 1.0;
+
+  // b_k = c_k + 2x * b_k+1 - b_k+2, f(x) = c_0 + x * b_1 - b_2 (every state at once)
+  Column b1{Column::Zero(6 * N)}, b2{Column::Zero(6 * N)}, b0(6 * N);
+  for (int k = n_ - 1; k > 0; k--) {
+    b0 = seg.coef_.col(k) + 2.0 * x * b1 - b2;
+    b2 = b1;
+    b1 = b0;
+  }
+  b0 = seg.coef_.col(0) + x * b1 - b2;
+
+  using States = Eigen::Map<const Eigen::Matrix3Xd, 0, Eigen::OuterStride<6>>;
+  sv_pos = States(b0.data(), 3, N);
+  sv_vel = States(b0.data() + 3, 3, N);
+}
+
+}  // namespace sturdins
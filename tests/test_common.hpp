@@ -8,6 +8,7 @@
 
 #include "navtools/constants.hpp"
 #include "sturdins/least-squares.hpp"
+#include "sturdins/replay.hpp"
 
 // normal distribution random number generator
 std::default_random_engine noise_gen;
@@ -43,73 +44,19 @@ inline constexpr double h0 = 2e-21;
 inline constexpr double h1 = 1e-22;
 inline constexpr double h2 = 2e-20;
 
-// navigation data structure of binary files
-template <typename T = double>
-struct NavData {
-  T t;
-  T lat;
-  T lon;
-  T h;
-  T vn;
-  T ve;
-  T vd;
-  T roll;
-  T pitch;
-  T yaw;
-  T fx;
-  T fy;
-  T fz;
-  T wx;
-  T wy;
-  T wz;
-};
-
-template <typename T = double>
-struct NavResult {
-  T t;
-  T lat;
-  T lon;
-  T h;
-  T vn;
-  T ve;
-  T vd;
-  T roll;
-  T pitch;
-  T yaw;
-  T cb;
-  T cd;
-};
+// navigation data structures of binary files
+using sturdins::NavData;
+using sturdins::NavResult;
 
 // function to parse ephemeris binary file
 template <typename T = double>
 std::vector<satutils::KeplerEphem<T>> ParseEphemeris(std::string filename) {
   // read ephemeris
-  std::ifstream fid(filename, std::ios::binary);
-  if (!fid) {
+  sturdins::RecordReader<satutils::KeplerElements<T>> elems(filename);
+  if (!elems.IsOpen()) {
     std::cerr << "Error opening file!\n";
   }
-  std::vector<satutils::KeplerEphem<T>> eph;
-  satutils::KeplerElements<T> elem;
-  while (fid.read(reinterpret_cast<char *>(&elem), sizeof(elem))) {
-    // std::cout << "Next ephemerides: ";
-    // std::cout << "\n\tiode     : " << elem.iode << "\n\tiodc     : " << elem.iodc
-    //           << "\n\ttoe      : " << elem.toe << "\n\ttoc      : " << elem.toc
-    //           << "\n\ttgd      : " << elem.tgd << "\n\toaf2     : " << elem.af2
-    //           << "\n\taf1      : " << elem.af1 << "\n\taf0      : " << elem.af0
-    //           << "\n\te        : " << elem.e << "\n\tsqrtA    : " << elem.sqrtA
-    //           << "\n\tdeltan   : " << elem.deltan << "\n\tm0       : " << elem.m0
-    //           << "\n\tomega0   : " << elem.omega0 << "\n\tomega    : " << elem.omega
-    //           << "\n\tomegaDot : " << elem.omegaDot << "\n\ti0       : " << elem.i0
-    //           << "\n\tiDot     : " << elem.iDot << "\n\tcuc      : " << elem.cuc
-    //           << "\n\tcus      : " << elem.cus << "\n\tcic      : " << elem.cic
-    //           << "\n\tcis      : " << elem.cis << "\n\tcrc      : " << elem.crc
-    //           << "\n\tcrs      : " << elem.crs << "\n\tura      : " << elem.ura
-    //           << "\n\thealth   : " << elem.health << "\n\n";
-    eph.push_back(satutils::KeplerEphem<T>(elem));
-  }
-  fid.close();
-
-  return eph;
+  return std::vector<satutils::KeplerEphem<T>>(elems.begin(), elems.end());
 };
 
 // measurement data structure
@@ -163,6 +110,15 @@ MeasurementData MeasurementModel(
   return data;
 };
 
+// awgn noise on a preallocated epoch (same draw order as MeasurementModel)
+void AddMeasurementNoise(
+    sturdins::GnssEpoch &epoch, const double &psr_std, const double &psrdot_std) {
+  for (int i = 0; i < epoch.psr_.size(); i++) {
+    epoch.psr_(i) += psr_std * noise_dist(noise_gen);
+    epoch.psrdot_(i) += psrdot_std * noise_dist(noise_gen);
+  }
+};
+
 // clock awgn model
 void ClockModel(Eigen::Vector2d &x, const double &T) {
   double T2 = T * T;
@@ -0,0 +1,174 @@
+#include <Eigen/Dense>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <navtools/attitude.hpp>
+#include <navtools/constants.hpp>
+#include <navtools/frames.hpp>
+#include <satutils/ephemeris.hpp>
+
+#include "sturdins/inertial-nav.hpp"
+#include "sturdins/kinematic-nav.hpp"
+#include "test_common.hpp"
+
+// Runs the float and double instantiations of InertialNav and KinematicNav side by side over
+// truth_data.bin (the same simulated IMU and GNSS samples are fed to both), checks the float
+// filters stay within fixed bounds of the double filters, and reports the cost of each.
+int main() {
+  std::cout << std::setprecision(6);
+
+  // parse ephemeris
+  std::vector<satutils::KeplerEphem<double>> eph =
+      ParseEphemeris<double>("src/sturdins/tests/sv_ephem.bin");
+  std::ifstream fin("src/sturdins/tests/truth_data.bin", std::ios::binary);
+  if (!fin) {
+    std::cerr << "Error opening file!\n";
+    return 1;
+  }
+
+  sturdins::InertialNav<double> ins_d;
+  sturdins::InertialNav<float> ins_f;
+  sturdins::KinematicNav<double> kns_d;
+  sturdins::KinematicNav<float> kns_f;
+  NavData<double> truth;
+  Eigen::Vector3d lla, ned_v, ecef_p, ecef_v, wb, fb;
+  Eigen::Vector3d drift_a{Eigen::Vector3d::Zero()};
+  Eigen::Vector3d drift_g{Eigen::Vector3d::Zero()};
+  Eigen::Vector2d clock_sim_state{Eigen::Vector2d::Zero()};
+
+  // position difference [m] of two filters
+  auto pos_diff = [](const auto &a, const auto &b) {
+    Eigen::Vector3d pa, pb;
+    navtools::lla2ecef<double>(pa, Eigen::Vector3d{a.phi_, a.lam_, a.h_});
+    navtools::lla2ecef<double>(pb, Eigen::Vector3d{b.phi_, b.lam_, b.h_});
+    return (pa - pb).norm();
+  };
+  auto vel_diff = [](const auto &a, const auto &b) {
+    return Eigen::Vector3d(a.vn_ - b.vn_, a.ve_ - b.ve_, a.vd_ - b.vd_).norm();
+  };
+  auto att_diff = [](const auto &a, const auto &b) {
+    Eigen::Matrix3d dC = a.C_b_l_.template cast<double>().transpose() *
+                         b.C_b_l_.template cast<double>();
+    return navtools::RAD2DEG<> * Eigen::AngleAxisd(dC).angle();
+  };
+
+  const double T = 0.01;
+  double ToW = 521400;
+  Eigen::VectorXd psr_var = 30.0 * Eigen::VectorXd::Ones(eph.size());
+  Eigen::VectorXd psrdot_var = 0.01 * Eigen::VectorXd::Ones(eph.size());
+  double ins_pos = 0.0, ins_vel = 0.0, ins_att = 0.0, kns_pos = 0.0, kns_vel = 0.0;
+  double t_ins_d = 0.0, t_ins_f = 0.0, t_kns_d = 0.0, t_kns_f = 0.0;
+  int i = 0, n_epochs = 0;
+  auto time_it = [](double &total, auto &&step) {
+    auto t0 = std::chrono::steady_clock::now();
+    step();
+    auto t1 = std::chrono::steady_clock::now();
+    total += std::chrono::duration<double, std::micro>(t1 - t0).count();
+  };
+  while (fin.read(reinterpret_cast<char *>(&truth), sizeof(truth))) {
+    lla << navtools::DEG2RAD<> * truth.lat, navtools::DEG2RAD<> * truth.lon, truth.h;
+    ned_v << truth.vn, truth.ve, truth.vd;
+    wb << truth.wx, truth.wy, truth.wz;
+    fb << truth.fx, truth.fy, truth.fz;
+    navtools::lla2ecef<double>(ecef_p, lla);
+    navtools::ned2ecefv<double>(ecef_v, ned_v, lla);
+
+    if (i == 0) {
+      // initialize all filters to truth
+      auto init = [&](auto &filt) {
+        filt.SetPosition(lla(0), lla(1), lla(2));
+        filt.SetVelocity(truth.vn, truth.ve, truth.vd);
+        filt.SetAttitude(
+            navtools::DEG2RAD<> * truth.roll,
+            navtools::DEG2RAD<> * truth.pitch,
+            navtools::DEG2RAD<> * truth.yaw);
+        filt.SetClock(clock_sim_state(0), clock_sim_state(1));
+      };
+      init(ins_d);
+      init(ins_f);
+      init(kns_d);
+      init(kns_f);
+      ins_d.SetClockSpec(h0, h1, h2);
+      ins_f.SetClockSpec(h0, h1, h2);
+      ins_d.SetImuSpec(Ba, Na, Bg, Ng);
+      ins_f.SetImuSpec(Ba, Na, Bg, Ng);
+      kns_d.SetClockSpec(h0, h1, h2);
+      kns_f.SetClockSpec(h0, h1, h2);
+      kns_d.SetProcessNoise(1.0, 0.01);
+      kns_f.SetProcessNoise(1.0, 0.01);
+    }
+
+    // simulate imu and clock
+    ImuModel(wb, fb, drift_g, drift_a);
+    ClockModel(clock_sim_state, T);
+    Eigen::Vector3f wbf = wb.cast<float>(), fbf = fb.cast<float>();
+
+    // propagate
+    time_it(t_ins_d, [&] {
+      ins_d.Mechanize(wb, fb, T);
+      ins_d.Propagate(wb, fb, T);
+    });
+    time_it(t_ins_f, [&] {
+      ins_f.Mechanize(wbf, fbf, T);
+      ins_f.Propagate(wbf, fbf, T);
+    });
+
+    // correct at 5 Hz
+    if (i % 20 == 0) {
+      MeasurementData meas = MeasurementModel(
+          ToW, 5.48, 0.1, ecef_p, ecef_v, clock_sim_state(0), clock_sim_state(1), eph);
+      time_it(t_ins_d, [&] {
+        ins_d.GnssUpdate(meas.sv_pos, meas.sv_vel, meas.psr, meas.psrdot, psr_var, psrdot_var);
+      });
+      time_it(t_ins_f, [&] {
+        ins_f.GnssUpdate(meas.sv_pos, meas.sv_vel, meas.psr, meas.psrdot, psr_var, psrdot_var);
+      });
+      time_it(t_kns_d, [&] {
+        if (i > 0) {
+          kns_d.Propagate(20.0 * T);
+        }
+        kns_d.GnssUpdate(meas.sv_pos, meas.sv_vel, meas.psr, meas.psrdot, psr_var, psrdot_var);
+      });
+      time_it(t_kns_f, [&] {
+        if (i > 0) {
+          kns_f.Propagate(20.0 * T);
+        }
+        kns_f.GnssUpdate(meas.sv_pos, meas.sv_vel, meas.psr, meas.psrdot, psr_var, psrdot_var);
+      });
+      n_epochs++;
+
+      ins_pos = std::max(ins_pos, pos_diff(ins_d, ins_f));
+      ins_vel = std::max(ins_vel, vel_diff(ins_d, ins_f));
+      ins_att = std::max(ins_att, att_diff(ins_d, ins_f));
+      kns_pos = std::max(kns_pos, pos_diff(kns_d, kns_f));
+      kns_vel = std::max(kns_vel, vel_diff(kns_d, kns_f));
+    }
+
+    ToW += T;
+    i++;
+  }
+  fin.close();
+  if (i == 0) {
+    std::cerr << "No truth data!\n";
+    return 1;
+  }
+
+  std::cout << "InertialNav float vs double:  max position " << ins_pos << " m, velocity "
+            << ins_vel << " m/s, attitude " << ins_att << " deg\n";
+  std::cout << "KinematicNav float vs double: max position " << kns_pos << " m, velocity "
+            << kns_vel << " m/s\n";
+  std::cout << "InertialNav<double>:  " << t_ins_d / i << " us per IMU sample\n";
+  std::cout << "InertialNav<float>:   " << t_ins_f / i << " us per IMU sample\n";
+  std::cout << "KinematicNav<double>: " << t_kns_d / n_epochs << " us per epoch\n";
+  std::cout << "KinematicNav<float>:  " << t_kns_f / n_epochs << " us per epoch\n";
+  if (ins_pos > 0.1 || ins_vel > 1e-3 || ins_att > 0.01) {
+    std::cerr << "InertialNav<float> does not track InertialNav<double>!\n";
+    return 1;
+  }
+  if (kns_pos > 0.01 || kns_vel > 1e-3) {
+    std::cerr << "KinematicNav<float> does not track KinematicNav<double>!\n";
+    return 1;
+  }
+  return 0;
+}
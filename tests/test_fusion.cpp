@@ -0,0 +1,208 @@
+#include <Eigen/Dense>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <navtools/attitude.hpp>
+#include <navtools/constants.hpp>
+#include <navtools/frames.hpp>
+#include <satutils/ephemeris.hpp>
+#include <vector>
+
+#include "sturdins/fusion-engine.hpp"
+#include "sturdins/inertial-nav.hpp"
+#include "test_common.hpp"
+
+// Runs InertialNav over truth_data.bin (100 Hz IMU, 5 Hz GNSS) by hand and through FusionEngine
+// with the GNSS epochs delivered on time and 300 ms late. Checks the on time engine matches the
+// hand ordered filter, the late engine ends in the same state (to rounding) by rolling back to its
+// checkpoints, epochs older than the lag window are dropped and attitude measurements between IMU
+// samples reduce the attitude error, and reports the cost of each.
+int main() {
+  std::cout << std::setprecision(6);
+
+  // --- simulate the sensors ---
+  std::vector<satutils::KeplerEphem<double>> eph =
+      ParseEphemeris<double>("src/sturdins/tests/sv_ephem.bin");
+  std::ifstream fin("src/sturdins/tests/truth_data.bin", std::ios::binary);
+  if (!fin) {
+    std::cerr << "Error opening file!\n";
+    return 1;
+  }
+  const double T = 0.01;
+  const int delay = 30;  // IMU samples
+  double ToW = 521400;
+  NavData<double> truth, init;
+  std::vector<double> imu_t;
+  std::vector<Eigen::Vector3d> imu_wb, imu_fb;
+  std::vector<int> gnss_k;
+  std::vector<MeasurementData> gnss;
+  std::vector<Eigen::Matrix3d> att_true;
+  Eigen::Vector3d lla, ned_v, ecef_p, ecef_v, wb, fb;
+  Eigen::Vector3d drift_a{Eigen::Vector3d::Zero()};
+  Eigen::Vector3d drift_g{Eigen::Vector3d::Zero()};
+  Eigen::Vector2d clock_sim_state{Eigen::Vector2d::Zero()};
+  int i = 0;
+  while (fin.read(reinterpret_cast<char *>(&truth), sizeof(truth))) {
+    if (i == 0) {
+      init = truth;
+    }
+    lla << navtools::DEG2RAD<> * truth.lat, navtools::DEG2RAD<> * truth.lon, truth.h;
+    ned_v << truth.vn, truth.ve, truth.vd;
+    wb << truth.wx, truth.wy, truth.wz;
+    fb << truth.fx, truth.fy, truth.fz;
+    navtools::lla2ecef<double>(ecef_p, lla);
+    navtools::ned2ecefv<double>(ecef_v, ned_v, lla);
+    ImuModel(wb, fb, drift_g, drift_a);
+    ClockModel(clock_sim_state, T);
+    imu_t.push_back((i + 1) * T);
+    imu_wb.push_back(wb);
+    imu_fb.push_back(fb);
+    if (i % 20 == 0) {
+      gnss_k.push_back(i);
+      gnss.push_back(MeasurementModel(
+          ToW, 5.48, 0.1, ecef_p, ecef_v, clock_sim_state(0), clock_sim_state(1), eph));
+    }
+    Eigen::Vector3d rpy{truth.roll, truth.pitch, truth.yaw};
+    Eigen::Matrix3d C;
+    navtools::euler2dcm<double>(C, navtools::DEG2RAD<> * rpy, true);
+    att_true.push_back(C);
+    ToW += T;
+    i++;
+  }
+  fin.close();
+  const int N = imu_t.size();
+  if (N < 2 * delay) {
+    std::cerr << "No truth data!\n";
+    return 1;
+  }
+
+  sturdins::InertialNav<> filt0;
+  filt0.SetPosition(navtools::DEG2RAD<> * init.lat, navtools::DEG2RAD<> * init.lon, init.h);
+  filt0.SetVelocity(init.vn, init.ve, init.vd);
+  filt0.SetAttitude(
+      navtools::DEG2RAD<> * init.roll,
+      navtools::DEG2RAD<> * init.pitch,
+      navtools::DEG2RAD<> * init.yaw);
+  filt0.SetClock(0.0, 0.0);
+  filt0.SetClockSpec(h0, h1, h2);
+  filt0.SetImuSpec(Ba, Na, Bg, Ng);
+  Eigen::VectorXd psr_var = 30.0 * Eigen::VectorXd::Ones(eph.size());
+  Eigen::VectorXd psrdot_var = 0.01 * Eigen::VectorXd::Ones(eph.size());
+  auto add_gnss = [&](sturdins::FusionEngine<> &fe, const int &j) {
+    return fe.AddGnss(
+        imu_t[gnss_k[j]],
+        gnss[j].sv_pos,
+        gnss[j].sv_vel,
+        gnss[j].psr,
+        gnss[j].psrdot,
+        psr_var,
+        psrdot_var);
+  };
+  auto state_diff = [](const sturdins::InertialNav<> &a, const sturdins::InertialNav<> &b) {
+    const int n = sturdins::InertialNav<>::STATE_SIZE;
+    Eigen::VectorXd xa(n), xb(n);
+    a.GetStateVector(xa);
+    b.GetStateVector(xb);
+    return std::max((xa - xb).cwiseAbs().maxCoeff(), (a.P_ - b.P_).cwiseAbs().maxCoeff());
+  };
+  auto att_err = [&](const sturdins::InertialNav<> &a) {
+    Eigen::Matrix3d dC = att_true.back().transpose() * a.C_b_l_;
+    return navtools::RAD2DEG<> * Eigen::AngleAxisd(dC).angle();
+  };
+
+  // --- hand ordered ---
+  sturdins::InertialNav<> ref(filt0);
+  auto t0 = std::chrono::steady_clock::now();
+  for (int k = 0, j = 0; k < N; k++) {
+    const double dt = imu_t[k] - ((k > 0) ? imu_t[k - 1] : 0.0);  // as the engine sees it
+    ref.Mechanize(imu_wb[k], imu_fb[k], dt);
+    ref.Propagate(imu_wb[k], imu_fb[k], dt);
+    if (j < static_cast<int>(gnss.size()) && gnss_k[j] == k) {
+      ref.GnssUpdate(
+          gnss[j].sv_pos, gnss[j].sv_vel, gnss[j].psr, gnss[j].psrdot, psr_var, psrdot_var);
+      j++;
+    }
+  }
+  auto t1 = std::chrono::steady_clock::now();
+
+  // --- on time ---
+  sturdins::FusionEngine<> on_time(filt0, 0.0);
+  for (int k = 0, j = 0; k < N; k++) {
+    on_time.AddImu(imu_t[k], imu_wb[k], imu_fb[k]);
+    if (j < static_cast<int>(gnss.size()) && gnss_k[j] == k) {
+      add_gnss(on_time, j++);
+    }
+  }
+  auto t2 = std::chrono::steady_clock::now();
+
+  // --- late ---
+  sturdins::FusionEngine<> late(filt0, 0.0);
+  int j_late = 0;
+  for (int k = 0; k < N; k++) {
+    late.AddImu(imu_t[k], imu_wb[k], imu_fb[k]);
+    if (j_late < static_cast<int>(gnss.size()) && gnss_k[j_late] + delay == k) {
+      add_gnss(late, j_late++);
+    }
+  }
+  while (j_late < static_cast<int>(gnss.size())) {
+    add_gnss(late, j_late++);
+  }
+  auto t3 = std::chrono::steady_clock::now();
+  const bool dropped = !late.AddGnss(
+      imu_t[N - 1] - 1.0,
+      gnss[0].sv_pos,
+      gnss[0].sv_vel,
+      gnss[0].psr,
+      gnss[0].psrdot,
+      psr_var,
+      psrdot_var);
+
+  // --- on time with 1 Hz attitude between IMU samples ---
+  sturdins::FusionEngine<> with_att(filt0, 0.0);
+  const double att_std = navtools::DEG2RAD<> * 0.1;
+  const Eigen::Matrix3d att_cov = att_std * att_std * Eigen::Matrix3d::Identity();
+  for (int k = 0, j = 0; k < N; k++) {
+    if (k % 100 == 50) {
+      with_att.AddAttitude(imu_t[k] - 0.5 * T, att_true[k - 1], att_cov);
+    }
+    with_att.AddImu(imu_t[k], imu_wb[k], imu_fb[k]);
+    if (j < static_cast<int>(gnss.size()) && gnss_k[j] == k) {
+      add_gnss(with_att, j++);
+    }
+  }
+
+  double d_on_time = state_diff(ref, on_time.Filter());
+  double d_late = state_diff(on_time.Filter(), late.Filter());
+  double t_ref = std::chrono::duration<double, std::micro>(t1 - t0).count();
+  double t_on_time = std::chrono::duration<double, std::micro>(t2 - t1).count();
+  double t_late = std::chrono::duration<double, std::micro>(t3 - t2).count();
+  std::cout << "On time engine vs hand ordered: " << d_on_time << "\n";
+  std::cout << "Late engine vs on time engine:  " << d_late << " (" << late.n_late_
+            << " late epochs, " << late.n_replays_ << " IMU samples re-run)\n";
+  std::cout << "Attitude error without/with attitude measurements: " << att_err(on_time.Filter())
+            << " / " << att_err(with_att.Filter()) << " deg\n";
+  std::cout << "Hand ordered: " << t_ref / N << " us per IMU sample\n";
+  std::cout << "On time:      " << t_on_time / N << " us per IMU sample\n";
+  std::cout << "Late:         " << t_late / N << " us per IMU sample, "
+            << (t_late - t_on_time) / late.n_late_ << " us per late epoch (re-running from the "
+            << "start would cost " << t_ref / 2 << " us on average)\n";
+  if (d_on_time != 0.0) {
+    std::cerr << "FusionEngine does not match the hand ordered filter!\n";
+    return 1;
+  }
+  // checkpoints keep the upper triangle of P, a roll back rounds away its asymmetry
+  if (late.n_late_ != static_cast<int>(gnss.size()) || d_late > 1e-9) {
+    std::cerr << "Late measurements did not reproduce the on time filter!\n";
+    return 1;
+  }
+  if (!dropped || late.n_dropped_ != 1) {
+    std::cerr << "Measurement older than the lag window was not dropped!\n";
+    return 1;
+  }
+  if (att_err(with_att.Filter()) >= att_err(on_time.Filter())) {
+    std::cerr << "Attitude measurements did not reduce the attitude error!\n";
+    return 1;
+  }
+  return 0;
+}
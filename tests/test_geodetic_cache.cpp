@@ -0,0 +1,75 @@
+#include <Eigen/Dense>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <navtools/constants.hpp>
+#include <navtools/frames.hpp>
+
+#include "sturdins/geodetic-cache.hpp"
+
+// Checks the GeodeticCache ECEF position and NED to ECEF rotation against navtools over a grid of
+// positions, checks partial updates (longitude or height only) match a full evaluation, and
+// reports the cost of an Update that hits and one that misses the cache.
+int main() {
+  std::cout << std::setprecision(6);
+
+  // --- validation ---
+  sturdins::GeodeticCache geo;
+  double max_pos = 0.0, max_rot = 0.0, max_partial = 0.0;
+  Eigen::Vector3d lla, ecef_p, ecef_v;
+  for (int i = -8; i <= 8; i++) {
+    for (int j = -8; j <= 8; j++) {
+      lla << navtools::DEG2RAD<> * 10.0 * i, navtools::DEG2RAD<> * 22.0 * j, 100.0 * (i + j);
+      geo.Update(lla(0), lla(1), lla(2));
+      navtools::lla2ecef<double>(ecef_p, lla);
+      max_pos = std::max(max_pos, (geo.EcefPosition() - ecef_p).norm());
+      for (int k = 0; k < 3; k++) {
+        navtools::ned2ecefv<double>(ecef_v, Eigen::Vector3d::Unit(k), lla);
+        max_rot = std::max(max_rot, (geo.NedToEcef().col(k) - ecef_v).norm());
+      }
+
+      // move only the longitude and then only the height, compare to a fresh cache
+      sturdins::GeodeticCache fresh;
+      geo.Update(lla(0), lla(1) + 1e-3, lla(2));
+      fresh.Update(lla(0), lla(1) + 1e-3, lla(2));
+      max_partial = std::max(max_partial, (geo.EcefPosition() - fresh.EcefPosition()).norm());
+      max_partial = std::max(max_partial, (geo.NedToEcef() - fresh.NedToEcef()).norm());
+      geo.Update(lla(0), lla(1) + 1e-3, lla(2) + 10.0);
+      fresh.Update(lla(0), lla(1) + 1e-3, lla(2) + 10.0);
+      max_partial = std::max(max_partial, (geo.EcefPosition() - fresh.EcefPosition()).norm());
+      max_partial = std::max(max_partial, std::abs(geo.Hn_ - fresh.Hn_));
+    }
+  }
+  std::cout << "max ECEF position difference (vs navtools): " << max_pos << " m\n";
+  std::cout << "max NED to ECEF rotation difference (vs navtools): " << max_rot << "\n";
+  std::cout << "max partial update difference: " << max_partial << "\n";
+  if (max_pos > 1e-6 || max_rot > 1e-12) {
+    std::cerr << "GeodeticCache does not match navtools!\n";
+    return 1;
+  }
+  if (max_partial != 0.0) {
+    std::cerr << "Partial GeodeticCache update does not match a full evaluation!\n";
+    return 1;
+  }
+
+  // --- benchmark ---
+  const int N = 1000000;
+  double sink = 0.0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < N; i++) {
+    geo.Update(0.5, -1.5, 190.0);
+    sink += geo.Hn_;
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  for (int i = 0; i < N; i++) {
+    geo.Update(0.5 + 1e-9 * i, -1.5, 190.0);
+    sink += geo.Hn_;
+  }
+  auto t2 = std::chrono::steady_clock::now();
+  std::cout << "Update (hit):  " << std::chrono::duration<double, std::nano>(t1 - t0).count() / N
+            << " ns\n";
+  std::cout << "Update (miss): " << std::chrono::duration<double, std::nano>(t2 - t1).count() / N
+            << " ns\n";
+  return sink > 0.0 ? 0 : 1;
+}
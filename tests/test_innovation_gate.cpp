@@ -0,0 +1,82 @@
+#include <Eigen/Dense>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <navtools/constants.hpp>
+#include <navtools/frames.hpp>
+#include <satutils/ephemeris.hpp>
+#include <vector>
+
+#include "sturdins/inertial-nav.hpp"
+#include "test_common.hpp"
+
+// Runs a gated first InertialNav update from a cold covariance (50 m north/east error, 100 m
+// position and clock sigmas) with a 1 km outlier on one pseudorange. The gate must reject only the
+// outlier with the innovation covariance of the cold covariance, the settling iterations of the
+// first update collapse P and must not re-test the same innovations against it.
+int main() {
+  std::cout << std::setprecision(6);
+  std::vector<satutils::KeplerEphem<double>> eph =
+      ParseEphemeris<double>("src/sturdins/tests/sv_ephem.bin");
+  std::ifstream fin("src/sturdins/tests/truth_data.bin", std::ios::binary);
+  NavData<double> truth;
+  if (!fin || !fin.read(reinterpret_cast<char *>(&truth), sizeof(truth))) {
+    std::cerr << "Error opening file!\n";
+    return 1;
+  }
+  const int N = eph.size();
+  const double T = 0.01;
+  const double ToW = 521400;
+  Eigen::Vector3d lla, ned_v, ecef_p, ecef_v, wb, fb;
+  lla << navtools::DEG2RAD<> * truth.lat, navtools::DEG2RAD<> * truth.lon, truth.h;
+  ned_v << truth.vn, truth.ve, truth.vd;
+  wb << truth.wx, truth.wy, truth.wz;
+  fb << truth.fx, truth.fy, truth.fz;
+  navtools::lla2ecef<double>(ecef_p, lla);
+  navtools::ned2ecefv<double>(ecef_v, ned_v, lla);
+
+  // cold start 50 m north and east of the truth
+  const double Rn = navtools::WGS84_R0<>;
+  sturdins::InertialNav<> filt;
+  filt.SetPosition(lla(0) + 50.0 / Rn, lla(1) + 50.0 / (Rn * std::cos(lla(0))), lla(2));
+  filt.SetVelocity(truth.vn, truth.ve, truth.vd);
+  filt.SetAttitude(
+      navtools::DEG2RAD<> * truth.roll,
+      navtools::DEG2RAD<> * truth.pitch,
+      navtools::DEG2RAD<> * truth.yaw);
+  filt.SetClock(0.0, 0.0);
+  filt.SetClockSpec(h0, h1, h2);
+  filt.SetImuSpec(Ba, Na, Bg, Ng);
+  filt.SetInnovationGate(3.0);
+  Eigen::Vector<double, 17> p0;
+  p0 << 1e4, 1e4, 1e4, 1.0, 1.0, 1.0, 1e-4, 1e-4, 1e-4, 1e-6, 1e-6, 1e-6, 1e-2, 1e-2, 1e-2, 1e4,
+      1.0;
+  filt.P_ = p0.asDiagonal();
+  filt.Mechanize(wb, fb, T);
+  filt.Propagate(wb, fb, T);
+
+  // gated first update with an outlier on the first pseudorange
+  MeasurementData meas = MeasurementModel(ToW, 1.0, 0.01, ecef_p, ecef_v, 0.0, 0.0, eph);
+  meas.psr(0) += 1000.0;
+  Eigen::VectorXd psr_var = 30.0 * Eigen::VectorXd::Ones(N);
+  Eigen::VectorXd psrdot_var = 0.01 * Eigen::VectorXd::Ones(N);
+  filt.GnssUpdate(meas.sv_pos, meas.sv_vel, meas.psr, meas.psrdot, psr_var, psrdot_var);
+
+  const int n_rejected = filt.rejected_.count();
+  const Eigen::Vector3d err{
+      (filt.phi_ - lla(0)) * Rn,
+      (filt.lam_ - lla(1)) * Rn * std::cos(lla(0)),
+      filt.h_ - lla(2)};
+  std::cout << "Gated first update: " << n_rejected << " of " << 2 * N
+            << " measurements rejected (outlier " << (filt.rejected_(0) ? "rejected" : "accepted")
+            << "), position error " << err.norm() << " m\n";
+  if (!filt.rejected_(0) || n_rejected != 1) {
+    std::cerr << "The gate of the first update did not reject only the outlier!\n";
+    return 1;
+  }
+  if (err.norm() > 10.0) {
+    std::cerr << "The gated first update did not remove the initial position error!\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,162 @@
+#include <Eigen/Dense>
+#include <chrono>
+#include <complex>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <navtools/constants.hpp>
+#include <navtools/frames.hpp>
+#include <satutils/ephemeris.hpp>
+#include <thread>
+#include <vector>
+
+#include "sturdins/inertial-nav.hpp"
+#include "sturdins/instrument.hpp"
+#include "sturdins/least-squares.hpp"
+#include "test_common.hpp"
+
+// Runs 10 s of InertialNav over truth_data.bin, a GnssPVT, a MUSIC search and a worker thread
+// mechanizing its own Strapdown, then checks the stage counters count every call (including those
+// of the exited thread) and restart from zero after ResetStageCounters. Without STURDINS_INSTRUMENT
+// the counters must stay at zero.
+int main() {
+  std::cout << std::setprecision(6);
+  sturdins::ResetStageCounters();
+
+  // --- InertialNav, 100 Hz IMU and 5 Hz GNSS ---
+  std::vector<satutils::KeplerEphem<double>> eph =
+      ParseEphemeris<double>("src/sturdins/tests/sv_ephem.bin");
+  std::ifstream fin("src/sturdins/tests/truth_data.bin", std::ios::binary);
+  if (!fin) {
+    std::cerr << "Error opening file!\n";
+    return 1;
+  }
+  const double T = 0.01;
+  const int n_imu = 1000;
+  double ToW = 521400;
+  NavData<double> truth;
+  Eigen::Vector3d lla, ned_v, ecef_p, ecef_v, wb, fb;
+  Eigen::Vector3d drift_a{Eigen::Vector3d::Zero()};
+  Eigen::Vector3d drift_g{Eigen::Vector3d::Zero()};
+  Eigen::Vector2d clock_sim_state{Eigen::Vector2d::Zero()};
+  Eigen::VectorXd psr_var = 30.0 * Eigen::VectorXd::Ones(eph.size());
+  Eigen::VectorXd psrdot_var = 0.01 * Eigen::VectorXd::Ones(eph.size());
+  sturdins::InertialNav<> ins;
+  std::vector<MeasurementData> gnss;
+  int i = 0, n_gnss = 0;
+  while (i < n_imu && fin.read(reinterpret_cast<char *>(&truth), sizeof(truth))) {
+    lla << navtools::DEG2RAD<> * truth.lat, navtools::DEG2RAD<> * truth.lon, truth.h;
+    ned_v << truth.vn, truth.ve, truth.vd;
+    wb << truth.wx, truth.wy, truth.wz;
+    fb << truth.fx, truth.fy, truth.fz;
+    navtools::lla2ecef<double>(ecef_p, lla);
+    navtools::ned2ecefv<double>(ecef_v, ned_v, lla);
+    ImuModel(wb, fb, drift_g, drift_a);
+    ClockModel(clock_sim_state, T);
+    if (i == 0) {
+      ins.SetPosition(lla(0), lla(1), lla(2));
+      ins.SetVelocity(truth.vn, truth.ve, truth.vd);
+      ins.SetAttitude(
+          navtools::DEG2RAD<> * truth.roll,
+          navtools::DEG2RAD<> * truth.pitch,
+          navtools::DEG2RAD<> * truth.yaw);
+      ins.SetClock(0.0, 0.0);
+      ins.SetClockSpec(h0, h1, h2);
+      ins.SetImuSpec(Ba, Na, Bg, Ng);
+    }
+    ins.Mechanize(wb, fb, T);
+    ins.Propagate(wb, fb, T);
+    if (i % 20 == 0) {
+      gnss.push_back(MeasurementModel(
+          ToW, 5.48, 0.1, ecef_p, ecef_v, clock_sim_state(0), clock_sim_state(1), eph));
+      const MeasurementData &m = gnss.back();
+      ins.GnssUpdate(m.sv_pos, m.sv_vel, m.psr, m.psrdot, psr_var, psrdot_var);
+      n_gnss++;
+    }
+    ToW += T;
+    i++;
+  }
+  fin.close();
+  if (i < n_imu) {
+    std::cerr << "No truth data!\n";
+    return 1;
+  }
+
+  // --- least squares ---
+  const MeasurementData &m = gnss.back();
+  sturdins::GnssPVTWorkspace ws;
+  Eigen::VectorXd x{Eigen::VectorXd::Zero(8)};
+  Eigen::MatrixXd P(8, 8);
+  ws.Solve(x, P, m.sv_pos, m.sv_vel, m.psr, m.psrdot, psr_var, psrdot_var);
+  const int n_iter = ws.Iterations();
+
+  // 1 deg coarse grid refined to 0.1 and 0.01 deg
+  const double lamb = navtools::LIGHT_SPEED<> / 1575.42e6 / navtools::TWO_PI<>;
+  Eigen::Matrix3Xd ant_xyz{
+      {0.0, 0.09514, 0.0, 0.09514}, {0.0, 0.0, -0.09514, -0.09514}, {0.0, 0.0, 0.0, 0.0}};
+  Eigen::VectorXcd prompt(4);
+  const Eigen::Vector3d u{0.5, 0.5, -std::sqrt(0.5)};
+  for (int k = 0; k < 4; k++) {
+    prompt(k) = std::exp(-navtools::COMPLEX_I<> * u.dot(ant_xyz.col(k)) / lamb);
+  }
+  double az, el;
+  sturdins::MUSIC(az, el, prompt, ant_xyz, 4, lamb, navtools::DEG2RAD<> * 0.005, 1);
+
+  // --- a worker thread that exits before the counters are read ---
+  const int n_worker = 5000;
+  std::thread worker([&]() {
+    sturdins::Strapdown<double> sd(lla(0), lla(1), lla(2), truth.vn, truth.ve, truth.vd, 0, 0, 0);
+    for (int k = 0; k < n_worker; k++) {
+      sd.Mechanize(wb, fb, T);
+    }
+  });
+  worker.join();
+
+  // --- counters ---
+  const sturdins::Stage stages[sturdins::N_STAGES] = {
+      sturdins::Stage::MECHANIZE,
+      sturdins::Stage::PROPAGATE,
+      sturdins::Stage::MEASUREMENT_MODEL,
+      sturdins::Stage::KALMAN_UPDATE,
+      sturdins::Stage::GNSS_PVT_ITERATION,
+      sturdins::Stage::MUSIC_LEVEL};
+  const std::uint64_t expected[sturdins::N_STAGES] = {
+      static_cast<std::uint64_t>(n_imu + n_worker),
+      static_cast<std::uint64_t>(n_imu),
+      static_cast<std::uint64_t>(n_gnss),
+      static_cast<std::uint64_t>(n_gnss),
+      static_cast<std::uint64_t>(n_iter),
+      3};
+  bool counted = true, timed = true;
+  std::cout << "Instrumentation " << (sturdins::INSTRUMENTATION_ENABLED ? "enabled" : "disabled")
+            << "\n";
+  for (int s = 0; s < sturdins::N_STAGES; s++) {
+    const sturdins::StageCounters c = sturdins::GetStageCounters(stages[s]);
+    std::cout << "  " << std::setw(18) << std::left << sturdins::StageName(stages[s]) << std::right
+              << std::setw(8) << c.calls_ << " calls, " << std::setw(10)
+              << (c.calls_ ? static_cast<double>(c.nanoseconds_) / c.calls_ : 0.0)
+              << " ns per call\n";
+    if (sturdins::INSTRUMENTATION_ENABLED) {
+      counted = counted && c.calls_ == expected[s];
+      timed = timed && c.nanoseconds_ > 0;
+    } else {
+      counted = counted && c.calls_ == 0;
+      timed = timed && c.nanoseconds_ == 0;
+    }
+  }
+  sturdins::ResetStageCounters();
+  bool reset = true;
+  for (int s = 0; s < sturdins::N_STAGES; s++) {
+    const sturdins::StageCounters c = sturdins::GetStageCounters(stages[s]);
+    reset = reset && c.calls_ == 0 && c.nanoseconds_ == 0;
+  }
+  if (!counted || !timed) {
+    std::cerr << "Stage counters do not match the calls made!\n";
+    return 1;
+  }
+  if (!reset) {
+    std::cerr << "Stage counters were not reset!\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,92 @@
+#include <Eigen/Dense>
+#include <chrono>
+#include <complex>
+#include <iomanip>
+#include <iostream>
+#include <navtools/constants.hpp>
+
+#include "sturdins/least-squares.hpp"
+
+// Recovers known arrival angles with MUSIC on the test_attitude_ls array geometry, checks the
+// cached MusicManifold against MUSIC, and reports the cost of a single (coarse 1 deg grid +
+// refinement) spectrum search.
+int main() {
+  std::cout << std::setprecision(6);
+
+  // 4 element (half wavelength) L1 array from test_attitude_ls
+  const int n_ant = 4;
+  const double lamb = navtools::LIGHT_SPEED<> / 1575.42e6 / navtools::TWO_PI<>;
+  Eigen::Matrix3Xd ant_xyz{
+      {0.0, 0.09514, 0.0, 0.09514}, {0.0, 0.0, -0.09514, -0.09514}, {0.0, 0.0, 0.0, 0.0}};
+  const double A = std::sqrt(2.0 * std::pow(10.0, 4.4) * 0.02);
+
+  // simulate (noise free) prompt correlators from known directions
+  const int N = 12;
+  Eigen::VectorXd true_az(N), true_el(N);
+  Eigen::MatrixXcd prompt(n_ant, N);
+  for (int i = 0; i < N; i++) {
+    true_az(i) = navtools::DEG2RAD<> * (-170.0 + 360.0 * i / N + 3.3);
+    true_el(i) = navtools::DEG2RAD<> * (-10.0 - 70.0 * (i % 5) / 4.0);
+    Eigen::Vector3d u{
+        std::cos(true_az(i)) * std::cos(true_el(i)),
+        std::sin(true_az(i)) * std::cos(true_el(i)),
+        -std::sin(true_el(i))};
+    for (int k = 0; k < n_ant; k++) {
+      prompt(k, i) = A * std::exp(-navtools::COMPLEX_I<> * u.dot(ant_xyz.col(k)) / lamb);
+    }
+  }
+
+  // --- validation ---
+  sturdins::MusicManifold manifold(ant_xyz, n_ant, lamb);
+  double az, el, az_m, el_m, max_err = 0.0, max_diff = 0.0;
+  for (int i = 0; i < N; i++) {
+    sturdins::MUSIC(az, el, prompt.col(i), ant_xyz, n_ant, lamb, 1e-4);
+    double d_az = std::abs(std::remainder(az - true_az(i), navtools::TWO_PI<>));
+    double d_el = std::abs(el - true_el(i));
+    max_err = std::max(max_err, navtools::RAD2DEG<> * std::max(d_az * std::cos(el), d_el));
+    manifold.Estimate(az_m, el_m, prompt.col(i), 1e-4);
+    max_diff = std::max({max_diff, std::abs(az_m - az), std::abs(el_m - el)});
+  }
+  std::cout << "max MUSIC angle error: " << max_err << " deg\n";
+  std::cout << "max MusicManifold difference: " << navtools::RAD2DEG<> * max_diff << " deg\n";
+  std::cout << "MusicManifold memory: " << manifold.MemoryFootprint() / 1024.0 << " kB ("
+            << manifold.GridSize() << " grid points)\n";
+  if (max_err > 0.05) {
+    std::cerr << "MUSIC did not recover the arrival angles!\n";
+    return 1;
+  }
+  if (max_diff > 1e-12) {
+    std::cerr << "MusicManifold does not match MUSIC!\n";
+    return 1;
+  }
+
+  // --- benchmark ---
+  auto bench = [&](const int n_threads) {
+    double best = 1e300;
+    for (int r = 0; r < 5; r++) {
+      auto t0 = std::chrono::steady_clock::now();
+      for (int i = 0; i < N; i++) {
+        sturdins::MUSIC(az, el, prompt.col(i), ant_xyz, n_ant, lamb, 1e-4, n_threads);
+      }
+      auto t1 = std::chrono::steady_clock::now();
+      best = std::min(best, std::chrono::duration<double, std::micro>(t1 - t0).count() / N);
+    }
+    return best;
+  };
+  double t_single = bench(1);
+  double t_multi = bench(0);
+  double t_manifold = 1e300;
+  for (int r = 0; r < 5; r++) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; i++) {
+      manifold.Estimate(az, el, prompt.col(i), 1e-4);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    t_manifold =
+        std::min(t_manifold, std::chrono::duration<double, std::micro>(t1 - t0).count() / N);
+  }
+  std::cout << "MUSIC (1 thread):    " << t_single << " us per call\n";
+  std::cout << "MUSIC (all threads): " << t_multi << " us per call\n";
+  std::cout << "MusicManifold:       " << t_manifold << " us per call\n";
+  return 0;
+}
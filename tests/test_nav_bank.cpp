@@ -0,0 +1,117 @@
+#include <Eigen/Dense>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <navtools/constants.hpp>
+#include <navtools/frames.hpp>
+#include <vector>
+
+#include "sturdins/kinematic-nav-bank.hpp"
+#include "sturdins/kinematic-nav.hpp"
+
+// Validates KinematicNavBank against independent (sequential update) KinematicNav filters and
+// compares the cost of running the bank against a loop over the individual filters.
+int main() {
+  std::cout << std::setprecision(6);
+
+  // receiver
+  const double lat = navtools::DEG2RAD<> * 32.586279;
+  const double lon = navtools::DEG2RAD<> * -85.494372;
+  const double alt = 190.0;
+  const double dt = 0.02;
+  Eigen::Vector3d lla{lat, lon, alt};
+  Eigen::Vector3d ecef_p;
+  navtools::lla2ecef<double>(ecef_p, lla);
+
+  // synthetic satellites spread across the sky
+  const int M = 10;
+  const int L = 256;
+  Eigen::Matrix3Xd sv_pos(3, M), sv_vel(3, M);
+  Eigen::MatrixXd psr(L, M), psrdot(L, M), psr_var(L, M), psrdot_var(L, M);
+  for (int i = 0; i < M; i++) {
+    const double az = navtools::TWO_PI<> * i / M;
+    const double el = navtools::DEG2RAD<> * (15.0 + 60.0 * (i % 4) / 3.0);
+    Eigen::Vector3d ned_u{std::cos(el) * std::cos(az), std::cos(el) * std::sin(az), -std::sin(el)};
+    Eigen::Vector3d ecef_u;
+    navtools::ned2ecefv<double>(ecef_u, ned_u, lla);
+    sv_pos.col(i) = ecef_p + 2.0e7 * ecef_u;
+    sv_vel.col(i) = 3.0e3 * ecef_u.cross(Eigen::Vector3d::UnitZ()).normalized();
+    for (int l = 0; l < L; l++) {
+      psr(l, i) = 2.0e7 + 3.0 + 0.1 * l + 0.5 * std::sin(i + l);
+      psrdot(l, i) = -ecef_u.dot(sv_vel.col(i)) + 0.01 * std::cos(i * l);
+      psr_var(l, i) = 30.0;
+      psrdot_var(l, i) = 0.01;
+    }
+  }
+  psr_var(3, 2) = -1.0;  // satellite 2 is not tracked in lane 3
+
+  // filters with slightly different initial states
+  sturdins::KinematicNavBank bank(L);
+  std::vector<sturdins::KinematicNav<>> filt(L);
+  for (int l = 0; l < L; l++) {
+    filt[l] = sturdins::KinematicNav<>(lat, lon, alt + 0.01 * l, 0.1, -0.1, 0.0, 0.0, 0.0);
+    filt[l].SetClockSpec(2e-21, 1e-22, 2e-20);
+    filt[l].SetProcessNoise(1.0, 0.1);
+    filt[l].SetUpdateStrategy(sturdins::UpdateStrategy::SEQUENTIAL);
+    bank.Set(l, filt[l]);
+  }
+
+  // --- validation ---
+  Eigen::VectorXd var(M);
+  for (int k = 0; k < 50; k++) {
+    bank.Propagate(dt);
+    bank.GnssUpdate(sv_pos, sv_vel, psr, psrdot, psr_var, psrdot_var);
+    for (int l = 0; l < L; l++) {
+      filt[l].Propagate(dt);
+      var = psr_var.row(l).transpose();
+      if (l == 3) {
+        var(2) = 1e300;  // effectively the same as skipping the satellite
+      }
+      filt[l].GnssUpdate(
+          sv_pos, sv_vel, psr.row(l).transpose(), psrdot.row(l).transpose(), var,
+          psrdot_var.row(l).transpose());
+    }
+  }
+  double max_pos = 0.0, max_rel_P = 0.0;
+  sturdins::KinematicNav<> tmp;
+  for (int l = 0; l < L; l++) {
+    bank.Get(l, tmp);
+    sturdins::KinematicNavView view = bank[l];
+    max_pos = std::max(max_pos, std::abs(view.h_ - filt[l].h_));
+    max_pos = std::max(max_pos, std::abs(view.cb_ - filt[l].cb_));
+    max_pos = std::max(max_pos, navtools::WGS84_R0<> * std::abs(view.phi_ - filt[l].phi_));
+    max_rel_P = std::max(
+        max_rel_P,
+        (tmp.P_ - filt[l].P_).cwiseAbs().maxCoeff() / filt[l].P_.cwiseAbs().maxCoeff());
+  }
+  std::cout << "max state difference (bank vs KinematicNav): " << max_pos << " m\n";
+  std::cout << "max relative covariance difference (bank vs KinematicNav): " << max_rel_P << "\n";
+  if (max_pos > 1e-6 || max_rel_P > 1e-8) {
+    std::cerr << "KinematicNavBank does not match the individual filters!\n";
+    return 1;
+  }
+
+  // --- benchmark ---
+  const int N = 200;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int k = 0; k < N; k++) {
+    bank.Propagate(dt);
+    bank.GnssUpdate(sv_pos, sv_vel, psr, psrdot, psr_var, psrdot_var);
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  for (int k = 0; k < N; k++) {
+    for (int l = 0; l < L; l++) {
+      filt[l].Propagate(dt);
+      filt[l].GnssUpdate(
+          sv_pos, sv_vel, psr.row(l).transpose(), psrdot.row(l).transpose(),
+          psr_var.row(l).transpose(), psrdot_var.row(l).transpose());
+    }
+  }
+  auto t2 = std::chrono::steady_clock::now();
+  double t_bank = std::chrono::duration<double, std::nano>(t1 - t0).count() / (N * L);
+  double t_loop = std::chrono::duration<double, std::nano>(t2 - t1).count() / (N * L);
+  std::cout << "individual filters: " << t_loop << " ns per filter epoch\n";
+  std::cout << "KinematicNavBank:   " << t_bank << " ns per filter epoch (" << t_loop / t_bank
+            << "x)\n";
+  return 0;
+}
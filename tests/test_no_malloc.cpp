@@ -0,0 +1,150 @@
+#include <Eigen/Dense>
+#include <cstdint>
+#include <iostream>
+#include <navtools/constants.hpp>
+#include <navtools/frames.hpp>
+
+#include "sturdins/inertial-nav.hpp"
+#include "sturdins/kinematic-nav.hpp"
+
+// Configure with -DSTURDINS_RUNTIME_NO_MALLOC=ON -DCMAKE_BUILD_TYPE=Debug, Eigen only checks
+// for heap allocations when assertions are enabled.
+#if defined(EIGEN_RUNTIME_NO_MALLOC) && !defined(NDEBUG)
+#define SET_MALLOC_ALLOWED(x) Eigen::internal::set_is_malloc_allowed(x)
+#else
+#define SET_MALLOC_ALLOWED(x)
+#endif
+
+int main() {
+#if !defined(EIGEN_RUNTIME_NO_MALLOC) || defined(NDEBUG)
+  std::cout << "test_no_malloc: built without EIGEN_RUNTIME_NO_MALLOC (or with NDEBUG), "
+               "allocations are not checked\n";
+#endif
+
+  // receiver
+  const double lat = navtools::DEG2RAD<> * 32.586279;
+  const double lon = navtools::DEG2RAD<> * -85.494372;
+  const double alt = 190.0;
+  Eigen::Vector3d lla{lat, lon, alt};
+  Eigen::Vector3d ecef_p;
+  navtools::lla2ecef<double>(ecef_p, lla);
+
+  // synthetic satellites spread across the sky (more than MAX_SV to exercise block splitting)
+  const int N = sturdins::MAX_SV + 4;
+  Eigen::Matrix3Xd sv_pos(3, N), sv_vel(3, N);
+  Eigen::VectorXd psr(N), psrdot(N), psr_var(N), psrdot_var(N);
+  for (int i = 0; i < N; i++) {
+    const double az = navtools::TWO_PI<> * i / N;
+    const double el = navtools::DEG2RAD<> * (15.0 + 60.0 * (i % 4) / 3.0);
+    Eigen::Vector3d ned_u{std::cos(el) * std::cos(az), std::cos(el) * std::sin(az), -std::sin(el)};
+    Eigen::Vector3d ecef_u;
+    navtools::ned2ecefv<double>(ecef_u, ned_u, lla);
+    sv_pos.col(i) = ecef_p + 2.0e7 * ecef_u;
+    sv_vel.col(i) = 3.0e3 * ecef_u.cross(Eigen::Vector3d::UnitZ()).normalized();
+    psr(i) = 2.0e7 + 3.0;
+    psrdot(i) = -ecef_u.dot(sv_vel.col(i));
+    psr_var(i) = 30.0;
+    psrdot_var(i) = 0.01;
+  }
+
+  // 4 element array (every phased array update also splits into blocks)
+  const int n_ant = 4;
+  const double lamb = navtools::LIGHT_SPEED<> / 1575.42e6 / navtools::TWO_PI<>;
+  Eigen::Matrix3Xd ant_xyz{
+      {0.0, 0.09514, 0.0, 0.09514}, {0.0, 0.0, -0.09514, -0.09514}, {0.0, 0.0, 0.0, 0.0}};
+  Eigen::MatrixXd phase{Eigen::MatrixXd::Zero(n_ant, N)};
+  Eigen::MatrixXd phase_var{0.01 * Eigen::MatrixXd::Ones(n_ant, N)};
+
+  // --- KinematicNav ---
+  sturdins::KinematicNav<> kns(lat, lon, alt, 0.0, 0.0, 0.0, 0.0, 0.0);
+  kns.SetClockSpec(2e-21, 1e-22, 2e-20);
+  kns.SetProcessNoise(1.0, 0.1);
+  kns.Propagate(0.02);
+  kns.GnssUpdate(sv_pos, sv_vel, psr, psrdot, psr_var, psrdot_var);
+  SET_MALLOC_ALLOWED(false);
+  for (int k = 0; k < 10; k++) {
+    kns.Propagate(0.02);
+    kns.GnssUpdate(sv_pos, sv_vel, psr, psrdot, psr_var, psrdot_var);
+  }
+  kns.SetUpdateStrategy(sturdins::UpdateStrategy::SEQUENTIAL);
+  for (int k = 0; k < 10; k++) {
+    kns.Propagate(0.02);
+    kns.GnssUpdate(sv_pos, sv_vel, psr, psrdot, psr_var, psrdot_var);
+  }
+  sturdins::KinematicNavSnapshot<> kns_snap;
+  for (int k = 0; k < 10; k++) {
+    kns.SaveSnapshot(kns_snap);
+    kns.Propagate(0.02);
+    kns.GnssUpdate(sv_pos, sv_vel, psr, psrdot, psr_var, psrdot_var);
+    kns.RestoreSnapshot(kns_snap);
+  }
+  SET_MALLOC_ALLOWED(true);
+
+  // rejected_ grows to (n_ant + 1) * N on the first phased array update
+  kns.PhasedArrayUpdate(
+      sv_pos, sv_vel, psr, psrdot, phase, psr_var, psrdot_var, phase_var, ant_xyz, n_ant, lamb);
+  SET_MALLOC_ALLOWED(false);
+  for (int k = 0; k < 10; k++) {
+    kns.Propagate(0.02);
+    kns.PhasedArrayUpdate(
+        sv_pos, sv_vel, psr, psrdot, phase, psr_var, psrdot_var, phase_var, ant_xyz, n_ant, lamb);
+  }
+  SET_MALLOC_ALLOWED(true);
+
+  // --- InertialNav ---
+  Eigen::Vector3d wb{0.0, 0.0, 0.0};
+  Eigen::Vector3d fb{0.0, 0.0, -9.80665};
+  sturdins::InertialNav<> ins(lat, lon, alt, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  ins.SetImuSpec(1.2, 0.5884, 180.0, 3.0);
+  ins.SetClockSpec(2e-21, 1e-22, 2e-20);
+  ins.Mechanize(wb, fb, 0.01);
+  ins.Propagate(wb, fb, 0.01);
+  ins.GnssUpdate(sv_pos, sv_vel, psr, psrdot, psr_var, psrdot_var);
+  SET_MALLOC_ALLOWED(false);
+  for (int k = 0; k < 10; k++) {
+    ins.Mechanize(wb, fb, 0.01);
+    ins.Propagate(wb, fb, 0.01);
+    ins.GnssUpdate(sv_pos, sv_vel, psr, psrdot, psr_var, psrdot_var);
+  }
+  ins.SetUpdateStrategy(sturdins::UpdateStrategy::SEQUENTIAL);
+  for (int k = 0; k < 10; k++) {
+    ins.Mechanize(wb, fb, 0.01);
+    ins.Propagate(wb, fb, 0.01);
+    ins.GnssUpdate(sv_pos, sv_vel, psr, psrdot, psr_var, psrdot_var);
+  }
+  ins.SetSquareRoot(true);
+  for (int k = 0; k < 10; k++) {
+    ins.Mechanize(wb, fb, 0.01);
+    ins.Propagate(wb, fb, 0.01);
+    ins.GnssUpdate(sv_pos, sv_vel, psr, psrdot, psr_var, psrdot_var);
+  }
+  sturdins::InertialNavSnapshot<> ins_snap;
+  std::uint8_t bytes[sizeof(ins_snap)];
+  for (int k = 0; k < 10; k++) {
+    ins.SaveSnapshot(ins_snap);
+    sturdins::SerializeSnapshot(bytes, sizeof(bytes), ins_snap);
+    ins.Mechanize(wb, fb, 0.01);
+    ins.Propagate(wb, fb, 0.01);
+    ins.GnssUpdate(sv_pos, sv_vel, psr, psrdot, psr_var, psrdot_var);
+    sturdins::DeserializeSnapshot(ins_snap, bytes, sizeof(bytes));
+    ins.RestoreSnapshot(ins_snap);
+  }
+  SET_MALLOC_ALLOWED(true);
+
+  ins.PhasedArrayUpdate(
+      sv_pos, sv_vel, psr, psrdot, phase, psr_var, psrdot_var, phase_var, ant_xyz, n_ant, lamb);
+  SET_MALLOC_ALLOWED(false);
+  for (int k = 0; k < 10; k++) {
+    ins.Mechanize(wb, fb, 0.01);
+    ins.Propagate(wb, fb, 0.01);
+    ins.PhasedArrayUpdate(
+        sv_pos, sv_vel, psr, psrdot, phase, psr_var, psrdot_var, phase_var, ant_xyz, n_ant, lamb);
+  }
+  SET_MALLOC_ALLOWED(true);
+
+  std::cout << "test_no_malloc: steady-state Propagate + GnssUpdate + PhasedArrayUpdate + "
+               "snapshots completed\n";
+  std::cout << "KinematicNav: [" << kns.phi_ << ", " << kns.lam_ << ", " << kns.h_ << "]\n";
+  std::cout << "InertialNav:  [" << ins.phi_ << ", " << ins.lam_ << ", " << ins.h_ << "]\n";
+  return 0;
+}
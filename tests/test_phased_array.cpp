@@ -0,0 +1,136 @@
+#include <Eigen/Dense>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <navtools/attitude.hpp>
+#include <navtools/constants.hpp>
+#include <navtools/math.hpp>
+
+#include "sturdins/least-squares.hpp"
+
+// Solves a synthetic 4 element array (10 satellites) over a slowly rotating 200 epoch run. Checks
+// a cold solve matches PhasedArrayAttitude bit for bit and recovers the attitude, warm starts from
+// the previous epoch need fewer iterations and track the attitude (also with a baseline of several
+// wavelengths, where the whole cycles are only resolved near the warm start), and reports the cost
+// per iteration.
+int main() {
+  std::cout << std::setprecision(6);
+  const double lamb = navtools::LIGHT_SPEED<> / 1575.42e6 / navtools::TWO_PI<>;  // [m/rad]
+  const int N = 10;
+  const int n_ant = 4;
+  const int n_epoch = 200;
+  Eigen::MatrixXd ant_xyz{
+      {0.0, 0.09514, 0.0, 0.09514}, {0.0, 0.0, -0.09514, -0.09514}, {0.0, 0.0, 0.0, 0.0}};
+  Eigen::MatrixXd ant_long = 8.0 * ant_xyz;
+
+  // satellites spread in azimuth and elevation
+  Eigen::Matrix3Xd u_ned(3, N);
+  for (int i = 0; i < N; i++) {
+    const double az = navtools::TWO_PI<> * i / N;
+    const double el = navtools::DEG2RAD<> * (15.0 + 7.0 * i);
+    u_ned.col(i) << std::cos(az) * std::cos(el), std::sin(az) * std::cos(el), -std::sin(el);
+  }
+  Eigen::MatrixXd phase_var{Eigen::MatrixXd::Ones(n_ant, N)};
+  auto simulate = [&](Eigen::MatrixXd &phase, const Eigen::Matrix3d &C, const Eigen::MatrixXd &a) {
+    phase = (C * a).transpose() * u_ned / lamb;
+    for (int i = 0; i < N; i++) {
+      for (int j = 0; j < n_ant; j++) {
+        phase(j, i) += 1e-3 * std::sin(7.0 * i + 3.0 * j);  // small deterministic noise
+        navtools::WrapPiToPi<double>(phase(j, i));
+      }
+    }
+  };
+  auto truth = [&](const int &e) {
+    Eigen::Vector3d rpy{2.5, -15.1 + 0.02 * e, -67.9 + 0.3 * e};
+    return navtools::euler2dcm<double>(navtools::DEG2RAD<> * rpy, true);
+  };
+  auto att_err = [](const Eigen::Matrix3d &C, const Eigen::Matrix3d &C_true) {
+    return Eigen::AngleAxisd(C * C_true.transpose()).angle();
+  };
+
+  // --- cold solve ---
+  Eigen::MatrixXd phase(n_ant, N);
+  simulate(phase, truth(0), ant_xyz);
+  const Eigen::Matrix3d C_guess =
+      Eigen::AngleAxisd(navtools::DEG2RAD<> * 20.0, Eigen::Vector3d{1.0, 2.0, -1.0}.normalized())
+          .matrix() *
+      truth(0);
+  Eigen::Matrix3d C_free = C_guess, C_solver = C_guess;
+  const bool free_ok = sturdins::PhasedArrayAttitude(
+      C_free, u_ned, phase, phase_var, ant_xyz, n_ant, lamb, 1e-12);
+  sturdins::PhasedArrayAttitudeSolver solver(1e-12);
+  sturdins::PhasedArrayResult cold =
+      solver.Solve(C_solver, u_ned, phase, phase_var, ant_xyz, n_ant, lamb);
+  const double cold_err = att_err(C_solver, truth(0));
+
+  // --- tracking, cold from a 20 deg error vs warm from the previous epoch ---
+  auto track = [&](const Eigen::MatrixXd &a, const bool &warm, int &n_iter, double &max_err) {
+    sturdins::PhasedArrayAttitudeSolver s(1e-12);
+    Eigen::Matrix3d C = C_guess;
+    s.Solve(C, u_ned, phase, phase_var, ant_xyz, n_ant, lamb);  // first epoch, half wavelength
+    n_iter = 0;
+    max_err = 0.0;
+    bool ok = true;
+    for (int e = 1; e < n_epoch; e++) {
+      simulate(phase, truth(e), a);
+      if (!warm) {
+        C = Eigen::AngleAxisd(navtools::DEG2RAD<> * 20.0, Eigen::Vector3d::UnitZ()).matrix() *
+            truth(e);
+      }
+      sturdins::PhasedArrayResult r = s.Solve(C, u_ned, phase, phase_var, a, n_ant, lamb, warm);
+      ok = ok && r.converged_;
+      n_iter += r.iterations_;
+      max_err = std::max(max_err, att_err(C, truth(e)));
+    }
+    return ok;
+  };
+  simulate(phase, truth(0), ant_xyz);
+  int it_cold, it_warm, it_long;
+  double err_cold, err_warm, err_long;
+  const bool cold_ok = track(ant_xyz, false, it_cold, err_cold);
+  simulate(phase, truth(0), ant_xyz);
+  const bool warm_ok = track(ant_xyz, true, it_warm, err_warm);
+  simulate(phase, truth(0), ant_xyz);
+  const bool long_ok = track(ant_long, true, it_long, err_long);
+
+  // --- cost ---
+  const int n_rep = 20000;
+  simulate(phase, truth(0), ant_xyz);
+  Eigen::Matrix3d C = truth(0);
+  sturdins::PhasedArrayAttitudeSolver fixed(0.0, 4);  // always 4 iterations
+  int n_run = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < n_rep; r++) {
+    n_run += fixed.Solve(C, u_ned, phase, phase_var, ant_xyz, n_ant, lamb).iterations_;
+  }
+  auto t1 = std::chrono::steady_clock::now();
+
+  std::cout << "Cold solve: " << cold.iterations_ << " iterations, error "
+            << navtools::RAD2DEG<> * cold_err << " deg\n";
+  std::cout << "Iterations per epoch cold/warm: " << static_cast<double>(it_cold) / (n_epoch - 1)
+            << " / " << static_cast<double>(it_warm) / (n_epoch - 1) << ", max error "
+            << navtools::RAD2DEG<> * err_cold << " / " << navtools::RAD2DEG<> * err_warm
+            << " deg\n";
+  std::cout << "Long baseline warm: " << static_cast<double>(it_long) / (n_epoch - 1)
+            << " iterations per epoch, max error " << navtools::RAD2DEG<> * err_long << " deg\n";
+  std::cout << "Cost: " << std::chrono::duration<double, std::nano>(t1 - t0).count() / n_run
+            << " ns per iteration (" << n_ant << " antennas, " << N << " satellites)\n";
+  if (!free_ok || !cold.converged_ || C_free != C_solver) {
+    std::cerr << "Solver does not match PhasedArrayAttitude!\n";
+    return 1;
+  }
+  if (cold_err > 1e-3 || !cold_ok || !warm_ok || err_warm > 1e-3) {
+    std::cerr << "Attitude was not recovered!\n";
+    return 1;
+  }
+  if (it_warm >= it_cold) {
+    std::cerr << "Warm starts did not reduce the iterations!\n";
+    return 1;
+  }
+  if (!long_ok || err_long > 1e-3) {
+    std::cerr << "Warm starts did not resolve the long baseline cycles!\n";
+    return 1;
+  }
+  return 0;
+}
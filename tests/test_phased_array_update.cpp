@@ -0,0 +1,169 @@
+#include <Eigen/Dense>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <navtools/attitude.hpp>
+#include <navtools/constants.hpp>
+#include <navtools/frames.hpp>
+#include <navtools/math.hpp>
+
+#include "sturdins/inertial-nav.hpp"
+#include "sturdins/kinematic-nav.hpp"
+#include "sturdins/least-squares.hpp"
+#include "test_common.hpp"
+
+// Checks BatchPhaseDifference on a 16 element array (20 satellites, phases of several cycles)
+// against the per satellite/antenna model it replaces (fmod wraps and a Skew per pair) and reports
+// the cost of both, then runs the KinematicNav and InertialNav phased array updates from a 3 degree
+// attitude error on noise free phases and checks they recover the attitude (InertialNav more
+// slowly, its phase jacobian carries a factor of 2).
+int main() {
+  std::cout << std::setprecision(6);
+  const double lamb = navtools::LIGHT_SPEED<> / 1575.42e6 / navtools::TWO_PI<>;  // [m/rad]
+  const int N = 20;
+  const int n_ant = 16;
+  const int A = n_ant - 1;
+  const int R = 2000;
+
+  // 4x4 half wavelength array, antenna 0 is the reference
+  Eigen::Matrix3Xd ant_xyz(3, n_ant);
+  for (int j = 0; j < n_ant; j++) {
+    ant_xyz.col(j) << 0.09514 * (j % 4), -0.09514 * (j / 4), 0.0;
+  }
+  Eigen::Vector3d rpy{2.5, -15.1, -67.9};
+  const Eigen::Matrix3d C_true = navtools::euler2dcm<double>(navtools::DEG2RAD<> * rpy, true);
+
+  // --- batch model vs per pair model ---
+  Eigen::MatrixX3d u_ned(N, 3);
+  Eigen::MatrixXd phase(A, N);
+  for (int i = 0; i < N; i++) {
+    const double az = navtools::TWO_PI<> * i / N;
+    const double el = navtools::DEG2RAD<> * (15.0 + 3.5 * i);
+    u_ned.row(i) << -std::cos(az) * std::cos(el), -std::sin(az) * std::cos(el), std::sin(el);
+    for (int j = 0; j < A; j++) {
+      phase(j, i) = 20.0 * std::sin(7.0 * i + 3.0 * j);  // several cycles, not wrapped
+    }
+  }
+  const Eigen::Matrix3Xd ant_ned = C_true * ant_xyz.rightCols(A);
+  Eigen::VectorXd dy(A * N), dy_ref(A * N);
+  Eigen::MatrixX3d H(A * N, 3), H_ref(A * N, 3);
+  auto reference = [&]() {
+    Eigen::Vector3d u, a;
+    double pred, r;
+    for (int i = 0; i < N; i++) {
+      u = u_ned.row(i).transpose();
+      for (int j = 0; j < A; j++) {
+        a = C_true * ant_xyz.col(j + 1);
+        pred = -a.dot(u) / lamb;
+        pred = std::fmod(pred + navtools::PI<>, navtools::TWO_PI<>) - navtools::PI<>;
+        if (pred < -navtools::PI<>) {
+          pred += navtools::TWO_PI<>;
+        } else if (pred > navtools::PI<>) {
+          pred -= navtools::TWO_PI<>;
+        }
+        r = std::fmod(phase(j, i) - pred + navtools::PI<>, navtools::TWO_PI<>) - navtools::PI<>;
+        if (r < -navtools::PI<>) {
+          r += navtools::TWO_PI<>;
+        } else if (r > navtools::PI<>) {
+          r -= navtools::TWO_PI<>;
+        }
+        dy_ref(A * i + j) = r;
+        H_ref.row(A * i + j) = (navtools::Skew(a).transpose() * u).transpose() / lamb;
+      }
+    }
+  };
+  auto t0 = std::chrono::steady_clock::now();
+  for (int k = 0; k < R; k++) {
+    reference();
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  for (int k = 0; k < R; k++) {
+    sturdins::BatchPhaseDifference(ant_ned, u_ned, phase, lamb, 1.0, dy, H);
+  }
+  auto t2 = std::chrono::steady_clock::now();
+  std::chrono::duration<double, std::micro> t_ref = t1 - t0, t_batch = t2 - t1;
+
+  // residuals within rounding of the +-pi boundary may wrap to either end
+  Eigen::ArrayXd d = dy - dy_ref;
+  d -= navtools::TWO_PI<> * (d / navtools::TWO_PI<>).rint();
+  const double max_dy = d.abs().maxCoeff();
+  const double max_H = (H - H_ref).cwiseAbs().maxCoeff() / H_ref.cwiseAbs().maxCoeff();
+  std::cout << "BatchPhaseDifference max difference: " << max_dy << " rad residual, " << max_H
+            << " relative jacobian\n";
+  std::cout << "Phase model (" << A * N << " pairs): " << t_ref.count() / R << " us per pair loop, "
+            << t_batch.count() / R << " us batch (" << t_ref.count() / t_batch.count() << "x)\n";
+  if (max_dy > 1e-9 || max_H > 1e-12 || dy.cwiseAbs().maxCoeff() > navtools::PI<>) {
+    std::cerr << "BatchPhaseDifference does not match the per pair phase model!\n";
+    return 1;
+  }
+
+  // --- filter updates ---
+  const Eigen::Vector3d lla{
+      navtools::DEG2RAD<> * 32.586279, navtools::DEG2RAD<> * -85.494372, 190.0};
+  Eigen::Vector3d ecef_p, ecef_u;
+  navtools::lla2ecef<double>(ecef_p, lla);
+  Eigen::Matrix3Xd sv_pos(3, N), sv_vel(3, N);
+  Eigen::VectorXd psr(N), psrdot(N);
+  Eigen::VectorXd psr_var{30.0 * Eigen::VectorXd::Ones(N)};
+  Eigen::VectorXd psrdot_var{0.01 * Eigen::VectorXd::Ones(N)};
+  Eigen::MatrixXd meas_phase{Eigen::MatrixXd::Zero(n_ant, N)};
+  Eigen::MatrixXd phase_var{0.01 * Eigen::MatrixXd::Ones(n_ant, N)};
+  for (int i = 0; i < N; i++) {
+    const Eigen::Vector3d los = -u_ned.row(i).transpose();  // user to satellite
+    navtools::ned2ecefv<double>(ecef_u, los, lla);
+    sv_pos.col(i) = ecef_p + 2.0e7 * ecef_u;
+    sv_vel.col(i) = 3.0e3 * ecef_u.cross(Eigen::Vector3d::UnitZ()).normalized();
+    psr(i) = 2.0e7;
+    psrdot(i) = -ecef_u.dot(sv_vel.col(i));
+    for (int j = 1; j < n_ant; j++) {
+      meas_phase(j, i) = (C_true * ant_xyz.col(j)).dot(los) / lamb;
+      navtools::WrapPiToPi<double>(meas_phase(j, i));
+    }
+  }
+  const Eigen::Vector3d rpy0 = navtools::DEG2RAD<> * (rpy + Eigen::Vector3d{2.0, -1.5, 1.5});
+  sturdins::KinematicNav<> kns(
+      lla(0), lla(1), lla(2), 0.0, 0.0, 0.0, rpy0(0), rpy0(1), rpy0(2), 0.0, 0.0);
+  kns.SetClockSpec(h0, h1, h2);
+  kns.SetProcessNoise(0.01, 0.001);
+  sturdins::InertialNav<> ins(
+      lla(0), lla(1), lla(2), 0.0, 0.0, 0.0, rpy0(0), rpy0(1), rpy0(2), 0.0, 0.0);
+  ins.SetImuSpec(1.2, 0.5884, 180.0, 3.0);
+  ins.SetClockSpec(h0, h1, h2);
+  auto att_err = [&](const Eigen::Matrix3d &C) {
+    return navtools::RAD2DEG<> * Eigen::AngleAxisd(C * C_true.transpose()).angle();
+  };
+  const double err0 = att_err(kns.C_b_l_);
+  std::chrono::duration<double, std::micro> t_kns{0.0}, t_ins{0.0};
+  const int E = 50;
+  const Eigen::Vector3d wb{Eigen::Vector3d::Zero()};
+  const Eigen::Vector3d fb{C_true.transpose() * Eigen::Vector3d{0.0, 0.0, -9.79}};
+  for (int e = 0; e < E; e++) {
+    kns.Propagate(0.02);
+    auto t3 = std::chrono::steady_clock::now();
+    kns.PhasedArrayUpdate(
+        sv_pos, sv_vel, psr, psrdot, meas_phase, psr_var, psrdot_var, phase_var, ant_xyz, n_ant,
+        lamb);
+    auto t4 = std::chrono::steady_clock::now();
+    ins.Propagate(wb, fb, 0.02);
+    auto t5 = std::chrono::steady_clock::now();
+    ins.PhasedArrayUpdate(
+        sv_pos, sv_vel, psr, psrdot, meas_phase, psr_var, psrdot_var, phase_var, ant_xyz, n_ant,
+        lamb);
+    auto t6 = std::chrono::steady_clock::now();
+    t_kns += t4 - t3;
+    t_ins += t6 - t5;
+  }
+  const double err_kns = att_err(kns.C_b_l_);
+  const double err_ins = att_err(ins.C_b_l_);
+  std::cout << "Attitude error: " << err0 << " deg initial, " << err_kns << " deg KinematicNav, "
+            << err_ins << " deg InertialNav after " << E << " updates\n";
+  std::cout << "PhasedArrayUpdate (" << N << " satellites, " << n_ant
+            << " antennas): " << t_kns.count() / E << " us KinematicNav, " << t_ins.count() / E
+            << " us InertialNav\n";
+  if (err_kns > 0.05 || err_ins > 0.25 * err0) {
+    std::cerr << "Phased array updates did not recover the attitude!\n";
+    return 1;
+  }
+  return 0;
+}
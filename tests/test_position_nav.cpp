@@ -0,0 +1,142 @@
+#include <Eigen/Dense>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <navtools/constants.hpp>
+#include <navtools/frames.hpp>
+#include <satutils/ephemeris.hpp>
+#include <vector>
+
+#include "sturdins/kinematic-nav.hpp"
+#include "test_common.hpp"
+
+// Runs the 11-state KinematicNav and the 8-state PositionNav (no attitude) over the 5 Hz GNSS
+// epochs of truth_data.bin. Without attitude measurements the attitude states never correlate with
+// the others, so both filters must give the same position, velocity and clock and the same
+// covariance of those states. Also checks the (packed) snapshot round trip of the smaller layout
+// and reports the cost of a Propagate + GnssUpdate epoch of each.
+int main() {
+  std::cout << std::setprecision(6);
+
+  // --- simulate the sensors ---
+  std::vector<satutils::KeplerEphem<double>> eph =
+      ParseEphemeris<double>("src/sturdins/tests/sv_ephem.bin");
+  std::ifstream fin("src/sturdins/tests/truth_data.bin", std::ios::binary);
+  if (!fin) {
+    std::cerr << "Error opening file!\n";
+    return 1;
+  }
+  const double T = 0.01;
+  double ToW = 521400;
+  NavData<double> truth, truth0;
+  std::vector<MeasurementData> gnss;
+  Eigen::Vector3d lla, ned_v, ecef_p, ecef_v;
+  Eigen::Vector2d clock_sim_state{Eigen::Vector2d::Zero()};
+  int i = 0;
+  while (fin.read(reinterpret_cast<char *>(&truth), sizeof(truth))) {
+    if (i == 0) {
+      truth0 = truth;
+    }
+    lla << navtools::DEG2RAD<> * truth.lat, navtools::DEG2RAD<> * truth.lon, truth.h;
+    ned_v << truth.vn, truth.ve, truth.vd;
+    navtools::lla2ecef<double>(ecef_p, lla);
+    navtools::ned2ecefv<double>(ecef_v, ned_v, lla);
+    ClockModel(clock_sim_state, T);
+    if (i % 20 == 0) {
+      gnss.push_back(MeasurementModel(
+          ToW, 5.48, 0.1, ecef_p, ecef_v, clock_sim_state(0), clock_sim_state(1), eph));
+    }
+    ToW += T;
+    i++;
+  }
+  fin.close();
+  const int E = gnss.size();
+  if (E < 10) {
+    std::cerr << "No truth data!\n";
+    return 1;
+  }
+  Eigen::VectorXd psr_var = 30.0 * Eigen::VectorXd::Ones(eph.size());
+  Eigen::VectorXd psrdot_var = 0.01 * Eigen::VectorXd::Ones(eph.size());
+
+  // --- both layouts ---
+  sturdins::KinematicNav<> kns(
+      navtools::DEG2RAD<> * truth0.lat,
+      navtools::DEG2RAD<> * truth0.lon,
+      truth0.h,
+      truth0.vn,
+      truth0.ve,
+      truth0.vd,
+      0.0,
+      0.0);
+  sturdins::PositionNav<> pns(
+      navtools::DEG2RAD<> * truth0.lat,
+      navtools::DEG2RAD<> * truth0.lon,
+      truth0.h,
+      truth0.vn,
+      truth0.ve,
+      truth0.vd,
+      0.0,
+      0.0);
+  kns.SetClockSpec(h0, h1, h2);
+  kns.SetProcessNoise(1.0, 0.1);
+  pns.SetClockSpec(h0, h1, h2);
+  pns.SetProcessNoise(1.0, 0.1);
+
+  // 11-state indices of the 8 PositionNav states
+  const int idx[8] = {0, 1, 2, 3, 4, 5, 9, 10};
+  double max_pos = 0.0, max_clk = 0.0, max_rel_P = 0.0;
+  std::chrono::duration<double, std::micro> t_kns{0.0}, t_pns{0.0};
+  for (int e = 0; e < E; e++) {
+    const MeasurementData &m = gnss[e];
+    auto t0 = std::chrono::steady_clock::now();
+    kns.Propagate(0.2);
+    kns.GnssUpdate(m.sv_pos, m.sv_vel, m.psr, m.psrdot, psr_var, psrdot_var);
+    auto t1 = std::chrono::steady_clock::now();
+    pns.Propagate(0.2);
+    pns.GnssUpdate(m.sv_pos, m.sv_vel, m.psr, m.psrdot, psr_var, psrdot_var);
+    auto t2 = std::chrono::steady_clock::now();
+    t_kns += t1 - t0;
+    t_pns += t2 - t1;
+
+    max_pos = std::max(max_pos, (kns.ecef_p_ - pns.ecef_p_).norm());
+    max_clk = std::max(max_clk, std::abs(kns.cb_ - pns.cb_));
+    double dP = 0.0;
+    for (int r = 0; r < 8; r++) {
+      for (int c = 0; c < 8; c++) {
+        dP = std::max(dP, std::abs(kns.P_(idx[r], idx[c]) - pns.P_(r, c)));
+      }
+    }
+    max_rel_P = std::max(max_rel_P, dP / pns.P_.cwiseAbs().maxCoeff());
+  }
+
+  // --- snapshots of the 8-state layout ---
+  sturdins::PositionNav<>::Snapshot snap;
+  pns.SaveSnapshot(snap);
+  sturdins::PositionNav<> restored;
+  restored.RestoreSnapshot(snap);
+  sturdins::PositionNav<>::Snapshot again;
+  restored.SaveSnapshot(again);
+  Eigen::VectorXd x0(sturdins::PositionNav<>::STATE_SIZE), x1(sturdins::PositionNav<>::STATE_SIZE);
+  pns.GetStateVector(x0);
+  restored.GetStateVector(x1);
+
+  std::cout << "Error states: " << sturdins::KinematicNav<>::ERROR_SIZE << " (KinematicNav), "
+            << sturdins::PositionNav<>::ERROR_SIZE << " (PositionNav)\n";
+  std::cout << "Max difference (KinematicNav vs PositionNav): " << max_pos << " m position, "
+            << max_clk << " m clock bias, " << max_rel_P << " relative covariance\n";
+  std::cout << "Snapshot size: " << sizeof(sturdins::KinematicNav<>::Snapshot) << " / "
+            << sizeof(snap) << " bytes\n";
+  std::cout << "KinematicNav: " << t_kns.count() / E << " us, PositionNav: " << t_pns.count() / E
+            << " us per epoch (" << t_kns.count() / t_pns.count() << "x)\n";
+  if (max_pos > 1e-6 || max_clk > 1e-6 || max_rel_P > 1e-10) {
+    std::cerr << "PositionNav does not match the KinematicNav position, velocity and clock!\n";
+    return 1;
+  }
+  if (x0 != x1 || std::memcmp(&snap, &again, sizeof(snap))) {
+    std::cerr << "PositionNav snapshot did not round trip!\n";
+    return 1;
+  }
+  return 0;
+}
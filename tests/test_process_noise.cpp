@@ -0,0 +1,197 @@
+#include <Eigen/Dense>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <navtools/constants.hpp>
+#include <vector>
+
+#include "sturdins/inertial-nav.hpp"
+#include "sturdins/kinematic-nav.hpp"
+#include "sturdins/nav-clock.hpp"
+#include "sturdins/nav-imu.hpp"
+#include "sturdins/process-noise.hpp"
+
+// Checks the cached blocks of a ProcessNoiseModel against the uncached evaluation and
+// NavClockProcessCov, then propagates InertialNav (full rate and decimated) and a set of
+// KinematicNav filters alternating between two IMU/GNSS rates with one shared model and with the
+// models built by their own SetImuSpec/SetClockSpec/SetProcessNoise. The covariances must match
+// (the decimated interval of the shared model is the cached 10*dt rather than the accumulated sum),
+// and the cost of a Propagate call with each model is reported.
+int main() {
+  std::cout << std::setprecision(6);
+
+  const double lat = navtools::DEG2RAD<> * 32.586279;
+  const double lon = navtools::DEG2RAD<> * -85.494372;
+  const double alt = 190.0;
+  const double dt[2] = {0.01, 0.005};
+  const sturdins::NavigationClock clock = sturdins::HIGH_QUALITY_TCXO;
+  const sturdins::NavigationIMU imu{1.2, 0.0, 0.5884, 0.0, 180.0, 0.0, 3.0, 0.0};
+  const int N = 4000;
+
+  // --- cached blocks ---
+  auto ins_model = std::make_shared<const sturdins::ProcessNoiseModel>(
+      clock, imu, std::vector<double>{dt[0], dt[1], 10.0 * dt[0]});
+  sturdins::ProcessNoiseModel uncached(clock, imu);
+  sturdins::ProcessNoiseBlocks s0, s1;
+  double max_block = 0.0;
+  for (const double &t : {dt[0], dt[1], 10.0 * dt[0]}) {
+    const sturdins::ProcessNoiseBlocks &a = ins_model->Blocks(t, s0);
+    const sturdins::ProcessNoiseBlocks &b = uncached.Blocks(t, s1);
+    if (&a == &s0 || &b != &s1) {
+      std::cerr << "Process noise blocks were not looked up in the cache!\n";
+      return 1;
+    }
+    max_block = std::max(max_block, (a.ins_ - b.ins_).cwiseAbs().maxCoeff());
+    max_block = std::max(max_block, (a.clock_ - b.clock_).cwiseAbs().maxCoeff());
+    max_block = std::max(
+        max_block, (a.clock_ - sturdins::NavClockProcessCov(clock, t)).cwiseAbs().maxCoeff());
+  }
+  if (!ins_model->IsCached(dt[0]) || ins_model->IsCached(0.02) || max_block > 0.0) {
+    std::cerr << "Cached process noise blocks do not match their evaluation!\n";
+    return 1;
+  }
+
+  // --- InertialNav clock block (Q applied twice per step, h0 and h1 cross terms halved) ---
+  // baseline formula, which left the lower cross term Q(16,15) at zero (an asymmetric Q), the
+  // shared model mirrors the upper cross term instead
+  auto baseline_clock = [&](const double &t) {
+    const double LS2 = navtools::LIGHT_SPEED<> * navtools::LIGHT_SPEED<>;
+    const double c0 = LS2 * clock.h0 / 2.0, c1 = LS2 * 2.0 * clock.h1;
+    const double c2 = LS2 * navtools::PI_SQU<> * clock.h2;
+    Eigen::Matrix2d Q;
+    Q(0, 0) = 0.5 * (c0 * t) + (c1 * t * t) + (2.0 / 3.0 * c2 * t * t * t);
+    Q(0, 1) = 0.5 * (c1 * t) + (c2 * t * t);
+    Q(1, 0) = 0.0;
+    Q(1, 1) = 0.5 * (c0 / t) + c1 + (8.0 / 3.0 * c2 * t);
+    return Q;
+  };
+  double max_clock = 0.0;
+  bool symmetric = true;
+  for (const double &t : {dt[0], dt[1], 10.0 * dt[0]}) {
+    const Eigen::Matrix2d Q = baseline_clock(t);
+    const Eigen::Matrix2d &Qi = ins_model->Blocks(t, s0).ins_clock_;
+    const double scale = Q.cwiseAbs().maxCoeff();
+    max_clock = std::max(max_clock, std::abs(Qi(0, 0) - Q(0, 0)) / scale);
+    max_clock = std::max(max_clock, std::abs(Qi(0, 1) - Q(0, 1)) / scale);
+    max_clock = std::max(max_clock, std::abs(Qi(1, 1) - Q(1, 1)) / scale);
+    symmetric = symmetric && (Qi(1, 0) == Qi(0, 1));
+  }
+  sturdins::InertialNav<> ins_clk(lat, lon, alt, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  ins_clk.SetImuSpec(imu.Ba, imu.Na, imu.Bg, imu.Ng);
+  ins_clk.SetClockSpec(clock.h0, clock.h1, clock.h2);
+  ins_clk.Propagate(Eigen::Vector3d::Zero(), Eigen::Vector3d{0.0, 0.0, -9.81}, dt[0]);
+  const Eigen::Matrix2d Fc{{1.0, dt[0]}, {0.0, 1.0}};
+  Eigen::Matrix2d Qc = baseline_clock(dt[0]);
+  Qc(1, 0) = Qc(0, 1);
+  const Eigen::Matrix2d Pc = Fc * Qc * Fc.transpose() + Qc;
+  max_clock = std::max(
+      max_clock,
+      (ins_clk.P_.block<2, 2>(15, 15) - Pc).cwiseAbs().maxCoeff() / Pc.cwiseAbs().maxCoeff());
+  symmetric = symmetric && (ins_clk.P_(16, 15) == ins_clk.P_(15, 16));
+  std::cout << "InertialNav clock block max relative difference from the two-sided Q tuning: "
+            << max_clock << (symmetric ? " (symmetric)" : " (asymmetric)") << "\n";
+  if (max_clock > 1e-12) {
+    std::cerr << "InertialNav clock process noise changed!\n";
+    return 1;
+  }
+  if (!symmetric) {
+    std::cerr << "InertialNav clock process noise cross terms are not symmetric!\n";
+    return 1;
+  }
+
+  // --- InertialNav, shared vs own model ---
+  sturdins::InertialNav<> ins_own(lat, lon, alt, 10.0, -5.0, 0.5, 0.01, -0.02, 1.2, 0.0, 0.0);
+  ins_own.SetImuSpec(imu.Ba, imu.Na, imu.Bg, imu.Ng);
+  ins_own.SetClockSpec(clock.h0, clock.h1, clock.h2);
+  Eigen::Vector<double, 17> p0;
+  p0 << 9.0, 9.0, 9.0, 0.05, 0.05, 0.05, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 1e-4, 1e-4, 1e-4, 3.0,
+      0.1;
+  ins_own.P_ = p0.asDiagonal();
+  sturdins::InertialNav<> ins_shared = ins_own;
+  ins_shared.SetProcessNoiseModel(ins_model);
+  sturdins::InertialNav<> dec_own = ins_own;
+  dec_own.SetPropagationInterval(10);
+  sturdins::InertialNav<> dec_shared = ins_shared;
+  dec_shared.SetPropagationInterval(10);
+
+  Eigen::Vector3d wb{0.01, -0.02, 0.05};
+  Eigen::Vector3d fb{0.3, 0.1, -9.81};
+  double max_ins = 0.0, max_dec = 0.0;
+  std::chrono::duration<double, std::nano> t_own{0.0}, t_shared{0.0};
+  for (int k = 0; k < N; k++) {
+    const double T = dt[(k / 500) % 2];
+    ins_own.Mechanize(wb, fb, T);
+    ins_shared.Mechanize(wb, fb, T);
+    dec_own.Mechanize(wb, fb, dt[0]);
+    dec_shared.Mechanize(wb, fb, dt[0]);
+    auto t0 = std::chrono::steady_clock::now();
+    ins_own.Propagate(wb, fb, T);
+    auto t1 = std::chrono::steady_clock::now();
+    ins_shared.Propagate(wb, fb, T);
+    auto t2 = std::chrono::steady_clock::now();
+    t_own += t1 - t0;
+    t_shared += t2 - t1;
+    dec_own.Propagate(wb, fb, dt[0]);
+    dec_shared.Propagate(wb, fb, dt[0]);
+    max_ins = std::max(max_ins, (ins_own.P_ - ins_shared.P_).cwiseAbs().maxCoeff());
+    max_dec = std::max(
+        max_dec,
+        (dec_own.P_ - dec_shared.P_).cwiseAbs().maxCoeff() / dec_own.P_.cwiseAbs().maxCoeff());
+  }
+  std::cout << "InertialNav max covariance difference (own vs shared model): " << max_ins
+            << ", max relative difference decimated: " << max_dec << "\n";
+  std::cout << "InertialNav Propagate: " << t_own.count() / N << " ns (own model), "
+            << t_shared.count() / N << " ns (shared model)\n";
+  if (max_ins > 0.0 || max_dec > 1e-12) {
+    std::cerr << "InertialNav covariance differs with the shared process noise model!\n";
+    return 1;
+  }
+
+  // --- KinematicNav filters sharing one model ---
+  const int M = 32;
+  const double Svel = 1.0, Satt = 0.1;
+  const sturdins::NavigationClock kns_clock{1.1 * clock.h0, 1.1 * clock.h1, 1.1 * clock.h2};
+  auto kns_model = std::make_shared<const sturdins::ProcessNoiseModel>(
+      kns_clock, sturdins::NavigationIMU{}, std::vector<double>{dt[0], dt[1]}, Svel, Satt);
+  std::vector<sturdins::KinematicNav<>> kns_own, kns_shared;
+  for (int m = 0; m < M; m++) {
+    kns_own.emplace_back(lat, lon, alt, 10.0 + m, -5.0, 0.5, 0.0, 0.0);
+    kns_own.back().SetClockSpec(clock.h0, clock.h1, clock.h2);
+    kns_own.back().SetProcessNoise(Svel, Satt);
+    kns_shared.push_back(kns_own.back());
+    kns_shared.back().SetProcessNoiseModel(kns_model);
+  }
+  if (kns_shared[0].GetProcessNoiseModel() != kns_shared[M - 1].GetProcessNoiseModel()) {
+    std::cerr << "KinematicNav filters do not share the process noise model!\n";
+    return 1;
+  }
+  double max_kns = 0.0;
+  t_own = t_shared = std::chrono::duration<double, std::nano>{0.0};
+  for (int k = 0; k < N / 10; k++) {
+    const double T = dt[(k / 50) % 2];
+    auto t0 = std::chrono::steady_clock::now();
+    for (int m = 0; m < M; m++) {
+      kns_own[m].Propagate(T);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int m = 0; m < M; m++) {
+      kns_shared[m].Propagate(T);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    t_own += t1 - t0;
+    t_shared += t2 - t1;
+    for (int m = 0; m < M; m++) {
+      max_kns = std::max(max_kns, (kns_own[m].P_ - kns_shared[m].P_).cwiseAbs().maxCoeff());
+    }
+  }
+  std::cout << "KinematicNav max covariance difference (own vs shared model): " << max_kns << "\n";
+  std::cout << "KinematicNav Propagate: " << t_own.count() / (N / 10 * M) << " ns (own model), "
+            << t_shared.count() / (N / 10 * M) << " ns (shared model)\n";
+  if (max_kns > 0.0) {
+    std::cerr << "KinematicNav covariance differs with the shared process noise model!\n";
+    return 1;
+  }
+  return 0;
+}
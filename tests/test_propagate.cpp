@@ -0,0 +1,111 @@
+#include <Eigen/Dense>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <navtools/constants.hpp>
+
+#include "sturdins/inertial-nav.hpp"
+
+// Validates the block-structured covariance propagation of InertialNav against the dense
+// F*(P+Q)*F' + Q products, checks the square root (QR) propagation against both, compares decimated
+// (10 Hz) covariance propagation against full rate propagation, and reports the cost of a single
+// Propagate call.
+int main() {
+  std::cout << std::setprecision(6);
+
+  const double lat = navtools::DEG2RAD<> * 32.586279;
+  const double lon = navtools::DEG2RAD<> * -85.494372;
+  const double alt = 190.0;
+  const double dt = 0.0025;  // 400 Hz
+  const int N = 100000;
+
+  sturdins::InertialNav<> sparse(lat, lon, alt, 10.0, -5.0, 0.5, 0.01, -0.02, 1.2, 0.0, 0.0);
+  sparse.SetImuSpec(1.2, 0.5884, 180.0, 3.0);
+  sparse.SetClockSpec(2e-21, 1e-22, 2e-20);
+  Eigen::Vector<double, 17> p0;
+  p0 << 9.0, 9.0, 9.0, 0.05, 0.05, 0.05, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 1e-4, 1e-4, 1e-4, 3.0,
+      0.1;
+  sparse.P_ = p0.asDiagonal();
+  sturdins::InertialNav<> dense = sparse;
+  dense.SetDensePropagation(true);
+  sturdins::InertialNav<> decimated = sparse;
+  decimated.SetPropagationInterval(40);
+  sturdins::InertialNav<> sqrt_form = sparse;
+  sqrt_form.SetSquareRoot(true);
+
+  // --- validation ---
+  Eigen::Vector3d wb{0.01, -0.02, 0.05};
+  Eigen::Vector3d fb{0.3, 0.1, -9.81};
+  double max_rel = 0.0, max_rel_sqrt = 0.0;
+  for (int k = 0; k < 4000; k++) {
+    wb(2) = 0.05 * std::sin(0.001 * k);
+    sparse.Mechanize(wb, fb, dt);
+    sparse.Propagate(wb, fb, dt);
+    dense.Mechanize(wb, fb, dt);
+    dense.Propagate(wb, fb, dt);
+    sqrt_form.Mechanize(wb, fb, dt);
+    sqrt_form.Propagate(wb, fb, dt);
+    double rel = (sparse.P_ - dense.P_).cwiseAbs().maxCoeff() / dense.P_.cwiseAbs().maxCoeff();
+    max_rel = std::max(max_rel, rel);
+    rel = (sqrt_form.P_ - dense.P_).cwiseAbs().maxCoeff() / dense.P_.cwiseAbs().maxCoeff();
+    max_rel_sqrt = std::max(max_rel_sqrt, rel);
+  }
+  std::cout << "max relative difference (block vs dense): " << max_rel << "\n";
+  std::cout << "max relative difference (square root vs dense): " << max_rel_sqrt << "\n";
+  if (max_rel > 1e-12) {
+    std::cerr << "block-structured covariance propagation does not match the dense path!\n";
+    return 1;
+  }
+  if (max_rel_sqrt > 1e-10) {
+    std::cerr << "square root covariance propagation does not match the dense path!\n";
+    return 1;
+  }
+
+  // --- decimated propagation (navigation and bias states, clock noise is evaluated per interval)
+  sturdins::InertialNav<> full = decimated;
+  full.SetPropagationInterval(1);
+  max_rel = 0.0;
+  for (int k = 0; k < 4000; k++) {
+    wb(2) = 0.05 * std::sin(0.001 * k);
+    full.Mechanize(wb, fb, dt);
+    full.Propagate(wb, fb, dt);
+    decimated.Mechanize(wb, fb, dt);
+    decimated.Propagate(wb, fb, dt);
+    if ((k + 1) % 40 == 0) {
+      Eigen::Matrix<double, 15, 15> dP =
+          decimated.P_.topLeftCorner<15, 15>() - full.P_.topLeftCorner<15, 15>();
+      double rel =
+          (dP.diagonal().array() / full.P_.diagonal().head<15>().array()).abs().maxCoeff();
+      max_rel = std::max(max_rel, rel);
+    }
+  }
+  std::cout << "max relative variance difference (decimated vs full rate): " << max_rel << "\n";
+  if (max_rel > 1e-2) {
+    std::cerr << "decimated covariance propagation diverged from full rate propagation!\n";
+    return 1;
+  }
+
+  // --- benchmark ---
+  auto bench = [&](sturdins::InertialNav<> &filt) {
+    double best = 1e300;
+    for (int r = 0; r < 5; r++) {
+      auto t0 = std::chrono::steady_clock::now();
+      for (int k = 0; k < N; k++) {
+        filt.Propagate(wb, fb, dt);
+      }
+      auto t1 = std::chrono::steady_clock::now();
+      best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count() / N);
+    }
+    return best;
+  };
+  double t_dense = bench(dense);
+  double t_sparse = bench(sparse);
+  double t_decimated = bench(decimated);
+  double t_sqrt = bench(sqrt_form);
+  std::cout << "dense Propagate: " << t_dense << " ns\n";
+  std::cout << "block Propagate: " << t_sparse << " ns (" << t_dense / t_sparse << "x)\n";
+  std::cout << "decimated Propagate (1 in 40): " << t_decimated << " ns ("
+            << t_dense / t_decimated << "x)\n";
+  std::cout << "square root Propagate: " << t_sqrt << " ns (" << t_dense / t_sqrt << "x)\n";
+  return 0;
+}
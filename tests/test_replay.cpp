@@ -0,0 +1,199 @@
+#include <Eigen/Dense>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <navtools/attitude.hpp>
+#include <navtools/constants.hpp>
+#include <navtools/frames.hpp>
+#include <vector>
+
+#include "sturdins/inertial-nav.hpp"
+#include "sturdins/replay.hpp"
+#include "test_common.hpp"
+
+// Replays truth_data.bin through InertialNav twice with the same noise seed: once sequentially
+// (ifstream reads, generation and filtering on one thread) and once through the threaded Replay
+// pipeline (memory mapped reads, lock-free rings, results written with a RecordWriter). Checks the
+// mapped records match the ifstream records and the pipeline results read back from disk match
+// the sequential ones bit for bit, and reports the throughput of each.
+int main() {
+  std::cout << std::setprecision(6);
+
+  const std::string truth_file = "src/sturdins/tests/truth_data.bin";
+  const std::string result_file = "src/sturdins/tests/replay_results.bin";
+  sturdins::RecordReader<NavData<double>> truth(truth_file);
+  sturdins::RecordReader<satutils::KeplerElements<double>> elems("src/sturdins/tests/sv_ephem.bin");
+  if (!truth.IsOpen() || !elems.IsOpen()) {
+    std::cerr << "Error opening file!\n";
+    return 1;
+  }
+
+  // --- mapped records vs ifstream ---
+  std::vector<NavData<double>> stream_truth;
+  auto t0 = std::chrono::steady_clock::now();
+  {
+    std::ifstream fin(truth_file, std::ios::binary);
+    NavData<double> rec;
+    while (fin.read(reinterpret_cast<char *>(&rec), sizeof(rec))) {
+      stream_truth.push_back(rec);
+    }
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  double sink = 0.0;
+  for (const NavData<double> &rec : truth) {
+    sink += rec.t;
+  }
+  auto t2 = std::chrono::steady_clock::now();
+  std::cout << "Records: " << truth.Size() << " truth, " << elems.Size() << " ephemerides\n";
+  std::cout << "ifstream read:  " << std::chrono::duration<double, std::nano>(t1 - t0).count() /
+                                         stream_truth.size()
+            << " ns per record\n";
+  std::cout << "mapped read:    "
+            << std::chrono::duration<double, std::nano>(t2 - t1).count() / truth.Size()
+            << " ns per record\n";
+  if (stream_truth.size() != truth.Size() ||
+      std::memcmp(stream_truth.data(), truth.Data(), truth.Size() * sizeof(NavData<double>))) {
+    std::cerr << "Mapped records do not match the file!\n";
+    return 1;
+  }
+
+  // --- replay stages ---
+  const double T = 0.01;
+  const double ToW0 = 521400;
+  sturdins::MeasurementGenerator gen(elems);
+  sturdins::InertialNav<> filt;
+  Eigen::Vector3d drift_a, drift_g, lla, ned_v, ecef_p, ecef_v;
+  Eigen::Vector2d clock_sim_state;
+  Eigen::VectorXd psr_var = 30.0 * Eigen::VectorXd::Ones(gen.Size());
+  Eigen::VectorXd psrdot_var = 0.01 * Eigen::VectorXd::Ones(gen.Size());
+  auto reset = [&]() {
+    noise_gen.seed(1);
+    drift_a.setZero();
+    drift_g.setZero();
+    clock_sim_state.setZero();
+    filt = sturdins::InertialNav<>();
+  };
+
+  // simulate the imu, clock and 5 Hz gnss measurements of a record
+  auto generate = [&](sturdins::ReplaySample &s) {
+    NavData<double> &rec = s.truth_;
+    Eigen::Vector3d wb{rec.wx, rec.wy, rec.wz}, fb{rec.fx, rec.fy, rec.fz};
+    ImuModel(wb, fb, drift_g, drift_a);
+    rec.wx = wb(0);
+    rec.wy = wb(1);
+    rec.wz = wb(2);
+    rec.fx = fb(0);
+    rec.fy = fb(1);
+    rec.fz = fb(2);
+    ClockModel(clock_sim_state, T);
+    if (s.index_ % 20 == 0) {
+      lla << navtools::DEG2RAD<> * rec.lat, navtools::DEG2RAD<> * rec.lon, rec.h;
+      ned_v << rec.vn, rec.ve, rec.vd;
+      navtools::lla2ecef<double>(ecef_p, lla);
+      navtools::ned2ecefv<double>(ecef_v, ned_v, lla);
+      gen.Generate(
+          s.gnss_, ToW0 + T * s.index_, ecef_p, ecef_v, clock_sim_state(0), clock_sim_state(1));
+      AddMeasurementNoise(s.gnss_, 5.48, 0.1);
+      s.has_gnss_ = true;
+    }
+  };
+
+  // run the filter on a record, returns true when a result is ready
+  auto filter = [&](const sturdins::ReplaySample &s, NavResult<double> &result) {
+    const NavData<double> &rec = s.truth_;
+    if (s.index_ == 0) {
+      filt.SetPosition(navtools::DEG2RAD<> * rec.lat, navtools::DEG2RAD<> * rec.lon, rec.h);
+      filt.SetVelocity(rec.vn, rec.ve, rec.vd);
+      filt.SetAttitude(
+          navtools::DEG2RAD<> * rec.roll,
+          navtools::DEG2RAD<> * rec.pitch,
+          navtools::DEG2RAD<> * rec.yaw);
+      filt.SetClock(0.0, 0.0);
+      filt.SetClockSpec(h0, h1, h2);
+      filt.SetImuSpec(Ba, Na, Bg, Ng);
+    }
+    Eigen::Vector3d wb{rec.wx, rec.wy, rec.wz}, fb{rec.fx, rec.fy, rec.fz};
+    filt.Mechanize(wb, fb, T);
+    filt.Propagate(wb, fb, T);
+    if (!s.has_gnss_) {
+      return false;
+    }
+    filt.GnssUpdate(
+        s.gnss_.sv_pos_, s.gnss_.sv_vel_, s.gnss_.psr_, s.gnss_.psrdot_, psr_var, psrdot_var);
+    Eigen::Vector3d f_rpy = navtools::dcm2euler<double>(filt.C_b_l_, true);
+    result = {
+        T * s.index_,
+        navtools::RAD2DEG<> * filt.phi_,
+        navtools::RAD2DEG<> * filt.lam_,
+        filt.h_,
+        filt.vn_,
+        filt.ve_,
+        filt.vd_,
+        navtools::RAD2DEG<> * f_rpy(0),
+        navtools::RAD2DEG<> * f_rpy(1),
+        navtools::RAD2DEG<> * f_rpy(2),
+        filt.cb_,
+        filt.cd_};
+    return true;
+  };
+
+  // --- sequential ---
+  reset();
+  std::vector<NavResult<double>> seq_results;
+  seq_results.reserve(truth.Size() / 20 + 1);
+  NavResult<double> result;
+  auto sample = std::make_unique<sturdins::ReplaySample>();
+  t0 = std::chrono::steady_clock::now();
+  {
+    std::ifstream fin(truth_file, std::ios::binary);
+    std::size_t i = 0;
+    while (fin.read(reinterpret_cast<char *>(&sample->truth_), sizeof(sample->truth_))) {
+      sample->index_ = i++;
+      sample->has_gnss_ = false;
+      generate(*sample);
+      if (filter(*sample, result)) {
+        seq_results.push_back(result);
+      }
+    }
+  }
+  t1 = std::chrono::steady_clock::now();
+
+  // --- pipeline ---
+  reset();
+  std::size_t n;
+  {
+    sturdins::RecordWriter<NavResult<double>> fout(result_file);
+    if (!fout.IsOpen()) {
+      std::cerr << "Error opening file!\n";
+      return 1;
+    }
+    n = sturdins::Replay(truth, generate, [&](const sturdins::ReplaySample &s) {
+      if (filter(s, result)) {
+        fout.Write(result);
+      }
+    });
+    if (!fout.Close()) {
+      std::cerr << "Error writing file!\n";
+      return 1;
+    }
+  }
+  t2 = std::chrono::steady_clock::now();
+
+  double t_seq = std::chrono::duration<double>(t1 - t0).count();
+  double t_pipe = std::chrono::duration<double>(t2 - t1).count();
+  std::cout << "Sequential replay: " << truth.Size() / t_seq << " records/s\n";
+  std::cout << "Pipeline replay:   " << n / t_pipe << " records/s\n";
+
+  sturdins::RecordReader<NavResult<double>> pipe_results(result_file);
+  if (n != truth.Size() || pipe_results.Size() != seq_results.size() ||
+      std::memcmp(
+          seq_results.data(),
+          pipe_results.Data(),
+          seq_results.size() * sizeof(NavResult<double>))) {
+    std::cerr << "Pipeline replay does not match the sequential replay!\n";
+    return 1;
+  }
+  return sink > 0.0 ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+#include <Eigen/Dense>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <navtools/constants.hpp>
+#include <navtools/frames.hpp>
+#include <satutils/ephemeris.hpp>
+#include <vector>
+
+#include "sturdins/least-squares.hpp"
+#include "test_common.hpp"
+
+// Solves every 1 s GNSS epoch of truth_data.bin from a cold start (zero state) with the Gauss-
+// Newton GnssPVT and with the Levenberg-Marquardt SolveRobust, then again with a 150 m fault on
+// one pseudorange. Checks the LM solver converges as often and as fast as Gauss-Newton, the
+// robust losses bound the fault's position error below the least squares one, the RAIM test
+// statistic flags the fault, and reports the cost of each solver.
+int main() {
+  std::cout << std::setprecision(6);
+
+  // --- simulate the sensors ---
+  std::vector<satutils::KeplerEphem<double>> eph =
+      ParseEphemeris<double>("src/sturdins/tests/sv_ephem.bin");
+  std::ifstream fin("src/sturdins/tests/truth_data.bin", std::ios::binary);
+  if (!fin) {
+    std::cerr << "Error opening file!\n";
+    return 1;
+  }
+  const double T = 0.01;
+  double ToW = 521400;
+  NavData<double> truth;
+  std::vector<MeasurementData> gnss;
+  std::vector<Eigen::Vector3d> truth_p;
+  Eigen::Vector3d lla, ned_v, ecef_p, ecef_v;
+  Eigen::Vector2d clock_sim_state{Eigen::Vector2d::Zero()};
+  int i = 0;
+  while (fin.read(reinterpret_cast<char *>(&truth), sizeof(truth))) {
+    lla << navtools::DEG2RAD<> * truth.lat, navtools::DEG2RAD<> * truth.lon, truth.h;
+    ned_v << truth.vn, truth.ve, truth.vd;
+    navtools::lla2ecef<double>(ecef_p, lla);
+    navtools::ned2ecefv<double>(ecef_v, ned_v, lla);
+    ClockModel(clock_sim_state, T);
+    if (i % 100 == 0) {
+      gnss.push_back(MeasurementModel(
+          ToW, 5.48, 0.1, ecef_p, ecef_v, clock_sim_state(0), clock_sim_state(1), eph));
+      truth_p.push_back(ecef_p);
+    }
+    ToW += T;
+    i++;
+  }
+  fin.close();
+  const int E = gnss.size();
+  if (E < 10) {
+    std::cerr << "No truth data!\n";
+    return 1;
+  }
+  Eigen::VectorXd psr_var = 30.0 * Eigen::VectorXd::Ones(eph.size());
+  Eigen::VectorXd psrdot_var = 0.01 * Eigen::VectorXd::Ones(eph.size());
+  const int dof = 2 * eph.size() - 8;
+
+  // --- cold starts ---
+  sturdins::GnssPVTWorkspace ws;
+  Eigen::VectorXd x(8);
+  Eigen::MatrixXd P(8, 8);
+  int gn_ok = 0, gn_iter = 0, lm_ok = 0, lm_iter = 0;
+  double gn_err = 0.0, lm_err = 0.0, mean_stat = 0.0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int e = 0; e < E; e++) {
+    const MeasurementData &m = gnss[e];
+    x.setZero();
+    ws.Reset();
+    gn_ok += ws.Solve(x, P, m.sv_pos, m.sv_vel, m.psr, m.psrdot, psr_var, psrdot_var);
+    gn_iter += ws.Iterations();
+    gn_err = std::max(gn_err, (x.head(3) - truth_p[e]).norm());
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  for (int e = 0; e < E; e++) {
+    const MeasurementData &m = gnss[e];
+    x.setZero();
+    sturdins::GnssPVTResult r = ws.SolveRobust(
+        x, P, m.sv_pos, m.sv_vel, m.psr, m.psrdot, psr_var, psrdot_var, sturdins::RobustLoss::NONE);
+    lm_ok += r.converged_;
+    lm_iter += r.iterations_;
+    lm_err = std::max(lm_err, (x.head(3) - truth_p[e]).norm());
+    mean_stat += r.test_stat_ / E;
+  }
+  auto t2 = std::chrono::steady_clock::now();
+
+  // --- a pseudorange fault ---
+  std::vector<double> ls_fault(E), huber_fault(E), tukey_fault(E);
+  double min_stat = 1e300;
+  int n_flagged = 0;
+  for (int e = 0; e < E; e++) {
+    MeasurementData m = gnss[e];
+    m.psr(e % m.psr.size()) += 150.0;
+    x.setZero();
+    ws.SolveRobust(
+        x, P, m.sv_pos, m.sv_vel, m.psr, m.psrdot, psr_var, psrdot_var, sturdins::RobustLoss::NONE);
+    ls_fault[e] = (x.head(3) - truth_p[e]).norm();
+    x.setZero();
+    ws.SolveRobust(x, P, m.sv_pos, m.sv_vel, m.psr, m.psrdot, psr_var, psrdot_var);
+    huber_fault[e] = (x.head(3) - truth_p[e]).norm();
+    x.setZero();
+    sturdins::GnssPVTResult r = ws.SolveRobust(
+        x,
+        P,
+        m.sv_pos,
+        m.sv_vel,
+        m.psr,
+        m.psrdot,
+        psr_var,
+        psrdot_var,
+        sturdins::RobustLoss::TUKEY,
+        4.685);
+    tukey_fault[e] = (x.head(3) - truth_p[e]).norm();
+    min_stat = std::min(min_stat, r.test_stat_);
+    n_flagged += r.n_outliers_ > 0;
+  }
+
+  auto median = [](std::vector<double> &v) {
+    std::nth_element(v.begin(), v.begin() + v.size() / 2, v.end());
+    return v[v.size() / 2];
+  };
+  const double ls_med = median(ls_fault);
+  const double huber_med = median(huber_fault);
+  const double tukey_med = median(tukey_fault);
+  const double chi2_thresh = dof + 5.0 * std::sqrt(2.0 * dof);  // ~5 sigma of the chi-square
+  std::cout << "Cold start converged (Gauss-Newton / LM): " << gn_ok << " / " << lm_ok << " of "
+            << E << ", mean iterations " << static_cast<double>(gn_iter) / E << " / "
+            << static_cast<double>(lm_iter) / E << "\n";
+  std::cout << "Max position error (Gauss-Newton / LM): " << gn_err << " / " << lm_err << " m\n";
+  std::cout << "Mean test statistic without faults: " << mean_stat << " (dof " << dof
+            << "), smallest with a 150 m fault: " << min_stat << " (threshold " << chi2_thresh
+            << ")\n";
+  std::cout << "Median position error with the fault (LS / Huber / Tukey): " << ls_med << " / "
+            << huber_med << " / " << tukey_med << " m, fault flagged in " << n_flagged
+            << " of " << E << " epochs\n";
+  std::cout << "Gauss-Newton: " << std::chrono::duration<double, std::micro>(t1 - t0).count() / E
+            << " us, LM: " << std::chrono::duration<double, std::micro>(t2 - t1).count() / E
+            << " us per cold start\n";
+  if (lm_ok < gn_ok || lm_ok != E || lm_err > 50.0) {
+    std::cerr << "Levenberg-Marquardt cold starts failed!\n";
+    return 1;
+  }
+  if (huber_med >= ls_med || tukey_med >= huber_med) {
+    std::cerr << "Robust losses did not bound the fault!\n";
+    return 1;
+  }
+  if (mean_stat > chi2_thresh || min_stat < chi2_thresh || n_flagged != E) {
+    std::cerr << "Test statistic did not detect the fault!\n";
+    return 1;
+  }
+  return 0;
+}
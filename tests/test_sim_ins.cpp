@@ -7,7 +7,7 @@
 
 #include "navtools/attitude.hpp"
 #include "navtools/constants.hpp"
-#include "sturdins/ins.hpp"
+#include "sturdins/inertial-nav.hpp"
 #include "sturdins/least-squares.hpp"
 #include "test_common.hpp"
 
@@ -28,7 +28,7 @@ int main() {
     std::cerr << "Error opening file!\n";
   }
 
-  sturdins::Ins filt;
+  sturdins::InertialNav<> filt;
   NavData<double> truth;
   NavResult<double> result;
   Eigen::Vector3d lla, ned_v, ecef_p, ecef_v, rpy, wb, fb;
@@ -6,7 +6,7 @@
 #include <satutils/ephemeris.hpp>
 
 #include "navtools/constants.hpp"
-#include "sturdins/kns.hpp"
+#include "sturdins/kinematic-nav.hpp"
 #include "sturdins/least-squares.hpp"
 #include "test_common.hpp"
 
@@ -27,7 +27,7 @@ int main() {
     std::cerr << "Error opening file!\n";
   }
 
-  sturdins::Kns filt;
+  sturdins::KinematicNav<> filt;
   NavData<double> truth;
   NavResult<double> result;
   Eigen::Vector3d lla, ned_v, ecef_p, ecef_v;
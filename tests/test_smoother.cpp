@@ -0,0 +1,221 @@
+#include <Eigen/Dense>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <navtools/constants.hpp>
+#include <navtools/frames.hpp>
+#include <satutils/ephemeris.hpp>
+#include <vector>
+
+#include "sturdins/inertial-nav.hpp"
+#include "sturdins/kinematic-nav.hpp"
+#include "sturdins/rts-smoother.hpp"
+#include "test_common.hpp"
+
+// Runs InertialNav (recorded at every 100 Hz IMU sample) and KinematicNav (recorded at every 5 Hz
+// GNSS epoch) over truth_data.bin and smooths both runs. Checks the smoothed position error is
+// below the filtered one, the segment parallel backward pass matches the serial one, a store
+// spilled to a file smooths bit for bit like one kept in memory, and reports the storage per epoch
+// and the cost of each pass.
+int main() {
+  std::cout << std::setprecision(6);
+
+  // --- simulate the sensors ---
+  std::vector<satutils::KeplerEphem<double>> eph =
+      ParseEphemeris<double>("src/sturdins/tests/sv_ephem.bin");
+  std::ifstream fin("src/sturdins/tests/truth_data.bin", std::ios::binary);
+  if (!fin) {
+    std::cerr << "Error opening file!\n";
+    return 1;
+  }
+  const double T = 0.01;
+  double ToW = 521400;
+  NavData<double> truth, init;
+  std::vector<Eigen::Vector3d> imu_wb, imu_fb, truth_p;
+  std::vector<MeasurementData> gnss;
+  Eigen::Vector3d lla, ned_v, ecef_p, ecef_v, wb, fb;
+  Eigen::Vector3d drift_a{Eigen::Vector3d::Zero()};
+  Eigen::Vector3d drift_g{Eigen::Vector3d::Zero()};
+  Eigen::Vector2d clock_sim_state{Eigen::Vector2d::Zero()};
+  int i = 0;
+  while (fin.read(reinterpret_cast<char *>(&truth), sizeof(truth))) {
+    if (i == 0) {
+      init = truth;
+    }
+    lla << navtools::DEG2RAD<> * truth.lat, navtools::DEG2RAD<> * truth.lon, truth.h;
+    ned_v << truth.vn, truth.ve, truth.vd;
+    wb << truth.wx, truth.wy, truth.wz;
+    fb << truth.fx, truth.fy, truth.fz;
+    navtools::lla2ecef<double>(ecef_p, lla);
+    navtools::ned2ecefv<double>(ecef_v, ned_v, lla);
+    ImuModel(wb, fb, drift_g, drift_a);
+    ClockModel(clock_sim_state, T);
+    imu_wb.push_back(wb);
+    imu_fb.push_back(fb);
+    truth_p.push_back(ecef_p);
+    if (i % 20 == 0) {
+      gnss.push_back(MeasurementModel(
+          ToW, 5.48, 0.1, ecef_p, ecef_v, clock_sim_state(0), clock_sim_state(1), eph));
+    }
+    ToW += T;
+    i++;
+  }
+  fin.close();
+  const int N = imu_wb.size() - 1;  // the state after sample k is compared to truth k + 1
+  const int M = gnss.size();
+  if (N < 200) {
+    std::cerr << "No truth data!\n";
+    return 1;
+  }
+  Eigen::VectorXd psr_var = 30.0 * Eigen::VectorXd::Ones(eph.size());
+  Eigen::VectorXd psrdot_var = 0.01 * Eigen::VectorXd::Ones(eph.size());
+
+  // rms position error of the state rows (from 10 s on, after the filters settle)
+  auto rms_err = [&](const sturdins::RowMatrixXd &x, const int &step, const int &offset) {
+    double sum = 0.0;
+    int n = 0;
+    Eigen::Vector3d p;
+    for (int k = 1000 / step; k < x.rows(); k++) {
+      navtools::lla2ecef<double>(p, Eigen::Vector3d{x(k, 0), x(k, 1), x(k, 2)});
+      sum += (p - truth_p[step * k + offset]).squaredNorm();
+      n++;
+    }
+    return std::sqrt(sum / n);
+  };
+
+  // --- InertialNav ---
+  using Ins = sturdins::InertialNav<>;
+  auto run_ins = [&](sturdins::RtsSmoother<Ins> &smoother,
+                     sturdins::RowMatrixXd &filtered,
+                     sturdins::RowMatrixXd &filtered_var) {
+    Ins f;
+    f.SetPosition(navtools::DEG2RAD<> * init.lat, navtools::DEG2RAD<> * init.lon, init.h);
+    f.SetVelocity(init.vn, init.ve, init.vd);
+    f.SetAttitude(
+        navtools::DEG2RAD<> * init.roll,
+        navtools::DEG2RAD<> * init.pitch,
+        navtools::DEG2RAD<> * init.yaw);
+    f.SetClock(0.0, 0.0);
+    f.SetClockSpec(h0, h1, h2);
+    f.SetImuSpec(Ba, Na, Bg, Ng);
+    filtered.resize(N, Ins::STATE_SIZE);
+    filtered_var.resize(N, Ins::ERROR_SIZE);
+    bool ok = true;
+    for (int k = 0; k < N; k++) {
+      f.Mechanize(imu_wb[k], imu_fb[k], T);
+      f.Propagate(imu_wb[k], imu_fb[k], T);
+      if (k % 20 == 0) {
+        const MeasurementData &m = gnss[k / 20];
+        f.GnssUpdate(m.sv_pos, m.sv_vel, m.psr, m.psrdot, psr_var, psrdot_var);
+      }
+      ok = smoother.Record((k + 1) * T, f) && ok;
+      f.GetStateVector(filtered.row(k).transpose());
+      filtered_var.row(k) = f.P_.diagonal().transpose();
+    }
+    return ok;
+  };
+  sturdins::RtsSmoother<Ins> ins_mem, ins_spill(256, "smoother_spill.bin");
+  sturdins::RowMatrixXd ins_filt, ins_filt_spill, ins_var, ins_var_spill;
+  auto t0 = std::chrono::steady_clock::now();
+  bool ok = run_ins(ins_mem, ins_filt, ins_var);
+  auto t1 = std::chrono::steady_clock::now();
+  ok = run_ins(ins_spill, ins_filt_spill, ins_var_spill) && ok;
+
+  Eigen::VectorXd t(N), t_par(N), t_spill(N);
+  sturdins::RowMatrixXd x(N, Ins::STATE_SIZE), x_par(N, Ins::STATE_SIZE);
+  sturdins::RowMatrixXd x_spill(N, Ins::STATE_SIZE);
+  sturdins::RowMatrixXd P(N, Ins::ERROR_SIZE), P_par(N, Ins::ERROR_SIZE);
+  sturdins::RowMatrixXd P_spill(N, Ins::ERROR_SIZE);
+  auto t2 = std::chrono::steady_clock::now();
+  ok = ins_mem.Smooth(t, x, P) && ok;
+  auto t3 = std::chrono::steady_clock::now();
+  ok = ins_mem.Smooth(t_par, x_par, P_par, 4) && ok;
+  auto t4 = std::chrono::steady_clock::now();
+  ok = ins_spill.Smooth(t_spill, x_spill, P_spill) && ok;
+  Ins late;
+  const bool record_after_spill = ins_spill.Record(0.0, late);
+
+  const double ins_filt_err = rms_err(ins_filt, 1, 1);
+  const double ins_smooth_err = rms_err(x, 1, 1);
+  const double d_par_pos = std::max(
+      navtools::WGS84_R0<> * (x - x_par).leftCols(2).cwiseAbs().maxCoeff(),
+      (x - x_par).col(2).cwiseAbs().maxCoeff());
+  const double d_par_cov = ((P - P_par).array() / P.array()).abs().maxCoeff();
+  const bool spill_equal =
+      (t.array() == t_spill.array()).all() && (x.array() == x_spill.array()).all() &&
+      (P.array() == P_spill.array()).all() && (ins_filt.array() == ins_filt_spill.array()).all();
+  const bool ins_cov_bounded =
+      (P.array() > 0.0).all() && (P.array() <= ins_var.array() * (1.0 + 1e-6)).all();
+
+  // --- KinematicNav ---
+  using Kns = sturdins::KinematicNav<>;
+  Kns kns(
+      navtools::DEG2RAD<> * init.lat,
+      navtools::DEG2RAD<> * init.lon,
+      init.h,
+      init.vn,
+      init.ve,
+      init.vd,
+      0.0,
+      0.0);
+  kns.SetClockSpec(h0, h1, h2);
+  kns.SetProcessNoise(1.0, 0.1);
+  const int M_kns = (N - 1) / 20 + 1 < M ? (N - 1) / 20 + 1 : M;
+  sturdins::RtsSmoother<Kns> kns_smoother;
+  sturdins::RowMatrixXd kns_filt(M_kns - 1, Kns::STATE_SIZE);
+  for (int j = 1; j < M_kns; j++) {
+    kns.Propagate(20 * T);
+    kns.GnssUpdate(
+        gnss[j].sv_pos, gnss[j].sv_vel, gnss[j].psr, gnss[j].psrdot, psr_var, psrdot_var);
+    ok = kns_smoother.Record(j * 20 * T, kns) && ok;
+    kns.GetStateVector(kns_filt.row(j - 1).transpose());
+  }
+  Eigen::VectorXd t_kns(M_kns - 1);
+  sturdins::RowMatrixXd x_kns(M_kns - 1, Kns::STATE_SIZE), P_kns(M_kns - 1, Kns::ERROR_SIZE);
+  ok = kns_smoother.Smooth(t_kns, x_kns, P_kns, 2) && ok;
+  const double kns_filt_err = rms_err(kns_filt, 20, 20);
+  const double kns_smooth_err = rms_err(x_kns, 20, 20);
+
+  // the packed, columnar store against keeping the states and every matrix of an epoch whole
+  const std::size_t naive =
+      (1 + Ins::STATE_SIZE + Ins::ERROR_SIZE) * sizeof(double) + 3 * sizeof(Ins::P_);
+
+  std::cout << "Storage per epoch: " << ins_mem.BytesPerEpoch() << " bytes (InertialNav), "
+            << kns_smoother.BytesPerEpoch() << " bytes (KinematicNav), " << naive
+            << " bytes keeping the matrices whole\n";
+  std::cout << "InertialNav position error filtered/smoothed:  " << ins_filt_err << " / "
+            << ins_smooth_err << " m\n";
+  std::cout << "KinematicNav position error filtered/smoothed: " << kns_filt_err << " / "
+            << kns_smooth_err << " m\n";
+  std::cout << "Serial vs 4 segments: " << d_par_pos << " m, " << d_par_cov
+            << " (relative covariance)\n";
+  std::cout << "Forward pass (with recording): "
+            << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms\n";
+  std::cout << "Backward pass, 1 / 4 segments: "
+            << std::chrono::duration<double, std::milli>(t3 - t2).count() << " / "
+            << std::chrono::duration<double, std::milli>(t4 - t3).count() << " ms (" << N
+            << " epochs)\n";
+  if (!ok || record_after_spill || ins_mem.Size() != static_cast<std::size_t>(N)) {
+    std::cerr << "Smoother store failed!\n";
+    return 1;
+  }
+  if (!spill_equal) {
+    std::cerr << "Spilled store does not match the store in memory!\n";
+    return 1;
+  }
+  if (!ins_cov_bounded) {
+    std::cerr << "Smoothed variances are not within (0, filtered]!\n";
+    return 1;
+  }
+  if (ins_smooth_err >= ins_filt_err || kns_smooth_err >= kns_filt_err) {
+    std::cerr << "Smoothing did not reduce the position error!\n";
+    return 1;
+  }
+  if (d_par_pos > 1e-6 || d_par_cov > 1e-6) {
+    std::cerr << "Segmented backward pass does not match the serial one!\n";
+    return 1;
+  }
+  return 0;
+}
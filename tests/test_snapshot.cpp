@@ -0,0 +1,213 @@
+#include <Eigen/Dense>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <navtools/constants.hpp>
+#include <navtools/frames.hpp>
+#include <satutils/ephemeris.hpp>
+#include <vector>
+
+#include "sturdins/inertial-nav.hpp"
+#include "sturdins/kinematic-nav.hpp"
+#include "sturdins/nav-snapshot.hpp"
+#include "test_common.hpp"
+
+// Runs InertialNav and KinematicNav over truth_data.bin (100 Hz IMU, 5 Hz GNSS), saves a snapshot
+// half way and branches the filters from it. Checks a branch restored from the snapshot (directly
+// and through its serialized bytes) repeats itself bit for bit and stays with the unbranched
+// filter, a snapshot survives a restore unchanged, bytes of another scalar type are rejected, and
+// reports the cost of a snapshot against copying the filter.
+int main() {
+  std::cout << std::setprecision(6);
+
+  // --- simulate the sensors ---
+  std::vector<satutils::KeplerEphem<double>> eph =
+      ParseEphemeris<double>("src/sturdins/tests/sv_ephem.bin");
+  std::ifstream fin("src/sturdins/tests/truth_data.bin", std::ios::binary);
+  if (!fin) {
+    std::cerr << "Error opening file!\n";
+    return 1;
+  }
+  const double T = 0.01;
+  double ToW = 521400;
+  NavData<double> truth, init;
+  std::vector<Eigen::Vector3d> imu_wb, imu_fb;
+  std::vector<MeasurementData> gnss;
+  Eigen::Vector3d lla, ned_v, ecef_p, ecef_v, wb, fb;
+  Eigen::Vector3d drift_a{Eigen::Vector3d::Zero()};
+  Eigen::Vector3d drift_g{Eigen::Vector3d::Zero()};
+  Eigen::Vector2d clock_sim_state{Eigen::Vector2d::Zero()};
+  int i = 0;
+  while (fin.read(reinterpret_cast<char *>(&truth), sizeof(truth))) {
+    if (i == 0) {
+      init = truth;
+    }
+    lla << navtools::DEG2RAD<> * truth.lat, navtools::DEG2RAD<> * truth.lon, truth.h;
+    ned_v << truth.vn, truth.ve, truth.vd;
+    wb << truth.wx, truth.wy, truth.wz;
+    fb << truth.fx, truth.fy, truth.fz;
+    navtools::lla2ecef<double>(ecef_p, lla);
+    navtools::ned2ecefv<double>(ecef_v, ned_v, lla);
+    ImuModel(wb, fb, drift_g, drift_a);
+    ClockModel(clock_sim_state, T);
+    imu_wb.push_back(wb);
+    imu_fb.push_back(fb);
+    if (i % 20 == 0) {
+      gnss.push_back(MeasurementModel(
+          ToW, 5.48, 0.1, ecef_p, ecef_v, clock_sim_state(0), clock_sim_state(1), eph));
+    }
+    ToW += T;
+    i++;
+  }
+  fin.close();
+  const int N = imu_wb.size();
+  const int k_snap = (N / 40) * 20;  // half way, just after a GNSS epoch
+  if (k_snap < 20) {
+    std::cerr << "No truth data!\n";
+    return 1;
+  }
+  Eigen::VectorXd psr_var = 30.0 * Eigen::VectorXd::Ones(eph.size());
+  Eigen::VectorXd psrdot_var = 0.01 * Eigen::VectorXd::Ones(eph.size());
+
+  // --- InertialNav ---
+  sturdins::InertialNav<> ins;
+  ins.SetPosition(navtools::DEG2RAD<> * init.lat, navtools::DEG2RAD<> * init.lon, init.h);
+  ins.SetVelocity(init.vn, init.ve, init.vd);
+  ins.SetAttitude(
+      navtools::DEG2RAD<> * init.roll,
+      navtools::DEG2RAD<> * init.pitch,
+      navtools::DEG2RAD<> * init.yaw);
+  ins.SetClock(0.0, 0.0);
+  ins.SetClockSpec(h0, h1, h2);
+  ins.SetImuSpec(Ba, Na, Bg, Ng);
+  auto run_ins = [&](sturdins::InertialNav<> &f, const int &k0, const int &k1) {
+    for (int k = k0; k < k1; k++) {
+      f.Mechanize(imu_wb[k], imu_fb[k], T);
+      f.Propagate(imu_wb[k], imu_fb[k], T);
+      if (k % 20 == 0) {
+        const MeasurementData &m = gnss[k / 20];
+        f.GnssUpdate(m.sv_pos, m.sv_vel, m.psr, m.psrdot, psr_var, psrdot_var);
+      }
+    }
+  };
+  auto ins_diff = [](const sturdins::InertialNav<> &a, const sturdins::InertialNav<> &b) {
+    const int n = sturdins::InertialNav<>::STATE_SIZE;
+    Eigen::VectorXd xa(n), xb(n);
+    a.GetStateVector(xa);
+    b.GetStateVector(xb);
+    return std::max((xa - xb).cwiseAbs().maxCoeff(), (a.P_ - b.P_).cwiseAbs().maxCoeff());
+  };
+
+  run_ins(ins, 0, k_snap + 1);
+  sturdins::InertialNavSnapshot<> ins_snap, ins_again;
+  ins.SaveSnapshot(ins_snap);
+
+  // unbranched, and two branches from the snapshot (directly and through bytes)
+  sturdins::InertialNav<> branch_a(ins), branch_b(ins);
+  run_ins(ins, k_snap + 1, N);
+  branch_a.RestoreSnapshot(ins_snap);
+  branch_a.SaveSnapshot(ins_again);
+  run_ins(branch_a, k_snap + 1, N);
+  std::vector<std::uint8_t> bytes(sizeof(ins_snap));
+  sturdins::InertialNavSnapshot<> ins_copy;
+  const std::size_t n_bytes = sturdins::SerializeSnapshot(bytes.data(), bytes.size(), ins_snap);
+  const bool ins_bytes_ok = sturdins::DeserializeSnapshot(ins_copy, bytes.data(), n_bytes);
+  branch_b.Mechanize(imu_wb[0], imu_fb[0], T);  // disturb the branch before restoring
+  branch_b.RestoreSnapshot(ins_copy);
+  run_ins(branch_b, k_snap + 1, N);
+  sturdins::InertialNavSnapshot<float> ins_float;
+  const bool float_rejected = !sturdins::DeserializeSnapshot(ins_float, bytes.data(), n_bytes);
+
+  // --- KinematicNav ---
+  sturdins::KinematicNav<> kns(
+      navtools::DEG2RAD<> * init.lat,
+      navtools::DEG2RAD<> * init.lon,
+      init.h,
+      init.vn,
+      init.ve,
+      init.vd,
+      0.0,
+      0.0);
+  kns.SetClockSpec(h0, h1, h2);
+  kns.SetProcessNoise(1.0, 0.1);
+  auto run_kns = [&](sturdins::KinematicNav<> &f, const int &j0, const int &j1) {
+    for (int j = j0; j < j1; j++) {
+      f.Propagate(20 * T);
+      f.GnssUpdate(
+          gnss[j].sv_pos, gnss[j].sv_vel, gnss[j].psr, gnss[j].psrdot, psr_var, psrdot_var);
+    }
+  };
+  const int j_snap = k_snap / 20 + 1;
+  const int M = gnss.size();
+  run_kns(kns, 1, j_snap);
+  sturdins::KinematicNavSnapshot<> kns_snap, kns_again;
+  kns.SaveSnapshot(kns_snap);
+  sturdins::KinematicNav<> kns_a(kns), kns_b(kns);
+  run_kns(kns, j_snap, M);
+  kns_a.RestoreSnapshot(kns_snap);
+  kns_a.SaveSnapshot(kns_again);
+  run_kns(kns_a, j_snap, M);
+  run_kns(kns_b, j_snap, j_snap + 5);
+  kns_b.RestoreSnapshot(kns_snap);
+  run_kns(kns_b, j_snap, M);
+  Eigen::VectorXd xk(sturdins::KinematicNav<>::STATE_SIZE), xa(xk.size()), xb(xk.size());
+  kns.GetStateVector(xk);
+  kns_a.GetStateVector(xa);
+  kns_b.GetStateVector(xb);
+
+  double d_ins_branch = ins_diff(branch_a, branch_b);
+  double d_ins = ins_diff(ins, branch_a);
+  double d_kns_branch =
+      std::max((xa - xb).cwiseAbs().maxCoeff(), (kns_a.P_ - kns_b.P_).cwiseAbs().maxCoeff());
+  double d_kns =
+      std::max((xk - xa).cwiseAbs().maxCoeff(), (kns.P_ - kns_a.P_).cwiseAbs().maxCoeff());
+
+  // --- cost ---
+  const int n_rep = 100000;
+  std::vector<sturdins::InertialNavSnapshot<>> slots(16);
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < n_rep; r++) {
+    ins.SaveSnapshot(slots[r % slots.size()]);
+    branch_a.RestoreSnapshot(slots[r % slots.size()]);
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  for (int r = 0; r < n_rep; r++) {
+    branch_b = ins;
+    ins = branch_b;
+  }
+  auto t2 = std::chrono::steady_clock::now();
+
+  std::cout << "Snapshot size: " << sizeof(ins_snap) << " bytes (InertialNav), " << sizeof(kns_snap)
+            << " bytes (KinematicNav)\n";
+  std::cout << "InertialNav branches (direct vs bytes): " << d_ins_branch
+            << ", branch vs unbranched: " << d_ins << "\n";
+  std::cout << "KinematicNav branches: " << d_kns_branch << ", branch vs unbranched: " << d_kns
+            << "\n";
+  std::cout << "Save + restore:       "
+            << std::chrono::duration<double, std::nano>(t1 - t0).count() / n_rep << " ns\n";
+  std::cout << "Copy filter (twice):  "
+            << std::chrono::duration<double, std::nano>(t2 - t1).count() / n_rep << " ns\n";
+  if (!ins_bytes_ok || n_bytes != sizeof(ins_snap) || !float_rejected) {
+    std::cerr << "Snapshot bytes did not round trip!\n";
+    return 1;
+  }
+  if (std::memcmp(&ins_snap.P_, &ins_again.P_, sizeof(ins_snap.P_)) ||
+      std::memcmp(&ins_snap.pos_, &ins_again.pos_, sizeof(ins_snap.pos_)) ||
+      std::memcmp(&kns_snap.P_, &kns_again.P_, sizeof(kns_snap.P_)) ||
+      std::memcmp(&kns_snap.pos_, &kns_again.pos_, sizeof(kns_snap.pos_))) {
+    std::cerr << "Restoring a snapshot changed it!\n";
+    return 1;
+  }
+  if (d_ins_branch != 0.0 || d_kns_branch != 0.0) {
+    std::cerr << "Branches from the same snapshot differ!\n";
+    return 1;
+  }
+  if (d_ins > 1e-9 || d_kns > 1e-9) {
+    std::cerr << "Branch diverged from the unbranched filter!\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,164 @@
+#include <Eigen/Dense>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <navtools/constants.hpp>
+#include <navtools/frames.hpp>
+#include <satutils/ephemeris.hpp>
+#include <thread>
+#include <vector>
+
+#include "sturdins/kinematic-nav.hpp"
+#include "sturdins/sv-state-cache.hpp"
+#include "test_common.hpp"
+
+// Checks the SvStateCache interpolation against a Kepler solve per request at the 5 Hz GNSS epochs
+// of truth_data.bin and at sub-epoch times, then runs F KinematicNav filters on F threads that
+// share one cache and checks every filter matches a single KinematicNav fed by the direct solves.
+// Reports the ephemeris evaluations of both and the cost of a request.
+int main() {
+  std::cout << std::setprecision(6);
+
+  // --- simulate the measurements ---
+  std::vector<satutils::KeplerEphem<double>> eph =
+      ParseEphemeris<double>("src/sturdins/tests/sv_ephem.bin");
+  std::ifstream fin("src/sturdins/tests/truth_data.bin", std::ios::binary);
+  if (!fin) {
+    std::cerr << "Error opening file!\n";
+    return 1;
+  }
+  const double T = 0.01;
+  double ToW = 521400;
+  NavData<double> truth, truth0;
+  std::vector<MeasurementData> gnss;
+  std::vector<double> gnss_tow;
+  Eigen::Vector3d lla, ned_v, ecef_p, ecef_v;
+  Eigen::Vector2d clock_sim_state{Eigen::Vector2d::Zero()};
+  int i = 0;
+  while (fin.read(reinterpret_cast<char *>(&truth), sizeof(truth))) {
+    if (i == 0) {
+      truth0 = truth;
+    }
+    lla << navtools::DEG2RAD<> * truth.lat, navtools::DEG2RAD<> * truth.lon, truth.h;
+    ned_v << truth.vn, truth.ve, truth.vd;
+    navtools::lla2ecef<double>(ecef_p, lla);
+    navtools::ned2ecefv<double>(ecef_v, ned_v, lla);
+    ClockModel(clock_sim_state, T);
+    if (i % 20 == 0) {
+      gnss.push_back(MeasurementModel(
+          ToW, 5.48, 0.1, ecef_p, ecef_v, clock_sim_state(0), clock_sim_state(1), eph));
+      gnss_tow.push_back(ToW);
+    }
+    ToW += T;
+    i++;
+  }
+  fin.close();
+  const int E = gnss.size();
+  const int N = eph.size();
+  if (E < 10) {
+    std::cerr << "No truth data!\n";
+    return 1;
+  }
+
+  // --- interpolation vs direct solves (epochs and halfway between them) ---
+  sturdins::SvStateCache cache(eph);
+  Eigen::Matrix3Xd sv_pos(3, N), sv_vel(3, N);
+  Eigen::Vector3d clk, pos, vel, acc;
+  double max_pos = 0.0, max_vel = 0.0;
+  for (int e = 0; e < E; e++) {
+    for (const double &t : {gnss_tow[e], gnss_tow[e] + 0.1}) {
+      cache.Evaluate(t, sv_pos, sv_vel);
+      for (int k = 0; k < N; k++) {
+        eph[k].CalcNavStates<false>(clk, pos, vel, acc, t);
+        max_pos = std::max(max_pos, (pos - sv_pos.col(k)).norm());
+        max_vel = std::max(max_vel, (vel - sv_vel.col(k)).norm());
+      }
+    }
+  }
+  std::cout << "SvStateCache max difference: " << max_pos << " m position, " << max_vel
+            << " m/s velocity (" << cache.Evaluations() << " ephemeris evaluations for " << 2 * E
+            << " requests)\n";
+  if (max_pos > 1e-3 || max_vel > 1e-6) {
+    std::cerr << "SvStateCache does not match the ephemerides!\n";
+    return 1;
+  }
+
+  // --- request cost ---
+  const int R = 20000;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < R; r++) {
+    for (int k = 0; k < N; k++) {
+      eph[k].CalcNavStates<false>(clk, sv_pos.col(k), sv_vel.col(k), acc, gnss_tow[r % E]);
+    }
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  for (int r = 0; r < R; r++) {
+    cache.Evaluate(gnss_tow[r % E], sv_pos, sv_vel);
+  }
+  auto t2 = std::chrono::steady_clock::now();
+  std::chrono::duration<double, std::micro> t_direct = t1 - t0, t_cache = t2 - t1;
+  std::cout << "Constellation (" << N << " satellites): " << t_direct.count() / R
+            << " us direct, " << t_cache.count() / R << " us cached ("
+            << t_direct.count() / t_cache.count() << "x)\n";
+
+  // --- F filters on F threads sharing one cache vs one filter fed by direct solves ---
+  Eigen::VectorXd psr_var = 30.0 * Eigen::VectorXd::Ones(N);
+  Eigen::VectorXd psrdot_var = 0.01 * Eigen::VectorXd::Ones(N);
+  auto make_filter = [&]() {
+    sturdins::KinematicNav<> kns(
+        navtools::DEG2RAD<> * truth0.lat,
+        navtools::DEG2RAD<> * truth0.lon,
+        truth0.h,
+        truth0.vn,
+        truth0.ve,
+        truth0.vd,
+        0.0,
+        0.0);
+    kns.SetClockSpec(h0, h1, h2);
+    kns.SetProcessNoise(1.0, 0.01);
+    return kns;
+  };
+  sturdins::KinematicNav<> ref = make_filter();
+  for (int e = 1; e < E; e++) {
+    ref.Propagate(20 * T);
+    ref.GnssUpdate(
+        gnss[e].sv_pos, gnss[e].sv_vel, gnss[e].psr, gnss[e].psrdot, psr_var, psrdot_var);
+  }
+
+  const int F = 8;
+  sturdins::SvStateCache shared(eph);
+  std::vector<Eigen::Vector3d> result(F);
+  std::vector<std::thread> workers;
+  for (int f = 0; f < F; f++) {
+    workers.emplace_back([&, f]() {
+      sturdins::KinematicNav<> kns = make_filter();
+      sturdins::GnssEpoch epoch;
+      for (int e = 1; e < E; e++) {
+        kns.Propagate(20 * T);
+        shared.Evaluate(gnss_tow[e], epoch);
+        kns.GnssUpdate(
+            epoch.sv_pos_, epoch.sv_vel_, gnss[e].psr, gnss[e].psrdot, psr_var, psrdot_var);
+      }
+      result[f] << kns.phi_, kns.lam_, kns.h_;
+    });
+  }
+  for (std::thread &w : workers) {
+    w.join();
+  }
+  double max_diff = 0.0;
+  const Eigen::Vector3d scale{navtools::WGS84_R0<>, navtools::WGS84_R0<>, 1.0};
+  for (int f = 0; f < F; f++) {
+    const Eigen::Vector3d d{result[f] - Eigen::Vector3d{ref.phi_, ref.lam_, ref.h_}};
+    max_diff = std::max(max_diff, d.cwiseProduct(scale).cwiseAbs().maxCoeff());
+  }
+  std::cout << F << " filters sharing one cache: " << shared.Evaluations()
+            << " ephemeris evaluations (" << static_cast<std::size_t>(F) * (E - 1) * N
+            << " direct), max difference from the direct filter " << max_diff << " m\n";
+  if (max_diff > 1e-3) {
+    std::cerr << "Filters fed by the shared cache do not match the direct filter!\n";
+    return 1;
+  }
+  return 0;
+}